@@ -0,0 +1,50 @@
+/**
+ * Tests that the featureCompatibilityVersion cannot be downgraded to 4.2 while an index stores its
+ * keys in KeyString V2, and that the downgrade succeeds once such indexes have been dropped.
+ *
+ * @tags: [requires_wiredtiger]
+ */
+(function() {
+"use strict";
+
+load("jstests/libs/feature_compatibility_version.js");
+
+const conn = MongoRunner.runMongod({setParameter: {wiredTigerIndexKeyStringV2: true}});
+assert.neq(null, conn, "mongod was unable to start up");
+
+const adminDB = conn.getDB("admin");
+const testDB = conn.getDB("test");
+const coll = testDB.keystring_v2_index_fcv_downgrade;
+
+checkFCV(adminDB, latestFCV);
+
+// Indexes created while fully upgraded use KeyString V2.
+assert.commandWorked(coll.insert({_id: 0, date: new Date()}));
+assert.commandWorked(coll.createIndex({date: 1}));
+assert.commandWorked(coll.createIndex({date: -1}, {unique: true}));
+
+// The downgrade fails without changing the featureCompatibilityVersion.
+assert.commandFailedWithCode(adminDB.runCommand({setFeatureCompatibilityVersion: lastStableFCV}),
+                             ErrorCodes.IllegalOperation);
+checkFCV(adminDB, latestFCV);
+
+// Dropping one index is not enough while the other remains.
+assert.commandWorked(coll.dropIndex({date: 1}));
+assert.commandFailedWithCode(adminDB.runCommand({setFeatureCompatibilityVersion: lastStableFCV}),
+                             ErrorCodes.IllegalOperation);
+checkFCV(adminDB, latestFCV);
+
+// Once no KeyString V2 index is left the downgrade succeeds, and indexes created afterwards use
+// KeyString V1 so they do not block a later downgrade.
+assert.commandWorked(coll.dropIndex({date: -1}));
+assert.commandWorked(adminDB.runCommand({setFeatureCompatibilityVersion: lastStableFCV}));
+checkFCV(adminDB, lastStableFCV);
+assert.commandWorked(coll.createIndex({date: -1}, {unique: true}));
+assert.eq(1, coll.find({date: {$lte: new Date()}}).hint({date: -1}).itcount());
+
+assert.commandWorked(adminDB.runCommand({setFeatureCompatibilityVersion: latestFCV}));
+assert.commandWorked(adminDB.runCommand({setFeatureCompatibilityVersion: lastStableFCV}));
+checkFCV(adminDB, lastStableFCV);
+
+MongoRunner.stopMongod(conn);
+}());
@@ -0,0 +1,42 @@
+// Tests that a $group evaluated in parallel over RecordId ranges of a collection returns the same
+// groups as the serial $group, and that the profiler still reports the plan summary and the
+// documents examined by all the range scans.
+// @tags: [requires_profiling, requires_wiredtiger]
+
+(function() {
+"use strict";
+
+load("jstests/libs/profiler.js");
+
+const options = {
+    setParameter: "internalDocumentSourceGroupParallelConsumers=4"
+};
+const conn = MongoRunner.runMongod(options);
+assert.neq(null, conn, "mongod was unable to start up with options: " + tojson(options));
+
+const testDB = conn.getDB("test");
+const coll = testDB.getCollection("coll");
+
+const nDocs = 1000;
+const bulk = coll.initializeUnorderedBulkOp();
+for (let i = 0; i < nDocs; ++i) {
+    bulk.insert({a: i % 10, b: i});
+}
+assert.commandWorked(bulk.execute());
+
+const pipeline = [{$group: {_id: "$a", count: {$sum: 1}, total: {$sum: "$b"}}}, {$sort: {_id: 1}}];
+
+testDB.setProfilingLevel(2);
+const parallelResults = coll.aggregate(pipeline).toArray();
+const profileObj = getLatestProfilerEntry(testDB, {op: "command", "command.aggregate": "coll"});
+testDB.setProfilingLevel(0);
+
+assert.eq(profileObj.planSummary, "COLLSCAN", tojson(profileObj));
+assert.eq(profileObj.docsExamined, nDocs, tojson(profileObj));
+
+assert.commandWorked(
+    testDB.adminCommand({setParameter: 1, internalDocumentSourceGroupParallelConsumers: 0}));
+assert.eq(parallelResults, coll.aggregate(pipeline).toArray());
+
+MongoRunner.stopMongod(conn);
+})();
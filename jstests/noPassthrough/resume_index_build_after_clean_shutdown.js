@@ -0,0 +1,74 @@
+/**
+ * Tests that a hybrid index build interrupted by a clean shutdown during its collection scan
+ * resumes after the restart, and that the index it finishes is identical to one built from scratch.
+ *
+ * @tags: [requires_persistence, requires_wiredtiger]
+ */
+(function() {
+"use strict";
+
+load("jstests/libs/check_log.js");
+
+const dbName = "test";
+const collName = "resume_index_build_after_clean_shutdown";
+const numDocs = 1000;
+
+let conn = MongoRunner.runMongod();
+assert.neq(null, conn, "mongod was unable to start up");
+let coll = conn.getDB(dbName).getCollection(collName);
+
+// Every tenth document holds an array, so the index is multikey.
+let bulk = coll.initializeUnorderedBulkOp();
+for (let i = 0; i < numDocs; i++) {
+    bulk.insert({i: i, a: (i % 10 === 0) ? [i, -i - 1] : i});
+}
+assert.commandWorked(bulk.execute());
+
+// Hang the collection scan halfway through.
+assert.commandWorked(conn.adminCommand(
+    {configureFailPoint: "hangBeforeIndexBuildOf", mode: "alwaysOn", data: {i: numDocs / 2}}));
+const awaitCreateIndex = startParallelShell(
+    funWithArgs(function(dbName, collName) {
+        db.getSiblingDB(dbName).getCollection(collName).createIndex({a: 1}, {background: true});
+    }, dbName, collName), conn.port);
+checkLog.contains(conn, "Hanging before index build of i=" + numDocs / 2);
+
+// These writes are only recorded in the side writes table of the build.
+assert.commandWorked(coll.insert({i: numDocs, a: [numDocs, -numDocs - 1]}));
+assert.commandWorked(coll.update({i: 1}, {$set: {a: "updated"}}));
+assert.commandWorked(coll.remove({i: numDocs - 1}));
+
+// The clean shutdown interrupts the build, which persists its progress.
+MongoRunner.stopMongod(conn);
+awaitCreateIndex({checkExitSuccess: false});
+
+conn = MongoRunner.runMongod({restart: true, dbpath: conn.dbpath, cleanData: false});
+assert.neq(null, conn, "mongod was unable to restart");
+checkLog.contains(conn, "index build: resuming on " + dbName + "." + collName);
+coll = conn.getDB(dbName).getCollection(collName);
+
+const res = assert.commandWorked(coll.validate({full: true}));
+assert(res.valid, tojson(res));
+
+const readIndex = function() {
+    const explain = coll.find({a: {$gte: MinKey}}).hint({a: 1}).explain();
+    const ixscan = explain.queryPlanner.winningPlan.inputStage;
+    assert.eq("IXSCAN", ixscan.stage, tojson(explain));
+    return {
+        keys: coll.find().hint({a: 1}).returnKey().showRecordId().toArray(),
+        isMultiKey: ixscan.isMultiKey,
+    };
+};
+
+// Each array holds two keys: the one of every tenth document and the one inserted above.
+const resumed = readIndex();
+assert.eq(numDocs + numDocs / 10 + 1, resumed.keys.length);
+assert(resumed.isMultiKey);
+
+// Build the same index from scratch and compare.
+assert.commandWorked(coll.dropIndex({a: 1}));
+assert.commandWorked(coll.createIndex({a: 1}));
+assert.docEq(readIndex(), resumed);
+
+MongoRunner.stopMongod(conn);
+}());
@@ -75,6 +75,10 @@ public:
     std::unique_ptr<TemporaryRecordStore> makeTemporaryRecordStore(OperationContext* opCtx) final {
         return {};
     }
+    std::unique_ptr<TemporaryRecordStore> makeTemporaryRecordStoreFromExistingIdent(
+        OperationContext* opCtx, StringData ident) final {
+        return {};
+    }
     void cleanShutdown() final {}
     void setJournalListener(JournalListener* jl) final {}
     bool supportsPendingDrops() const final {
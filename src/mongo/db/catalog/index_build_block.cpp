@@ -67,7 +67,16 @@ void IndexBuildBlock::deleteTemporaryTables(OperationContext* opCtx) {
     }
 }
 
-Status IndexBuildBlock::init(OperationContext* opCtx, Collection* collection) {
+void IndexBuildBlock::keepTemporaryTables(OperationContext* opCtx) {
+    if (_indexBuildInterceptor) {
+        _indexBuildInterceptor->keepTemporaryTables(opCtx);
+    }
+}
+
+Status IndexBuildBlock::init(OperationContext* opCtx,
+                             Collection* collection,
+                             boost::optional<std::string> resumeSideWritesIdent,
+                             boost::optional<MultikeyPaths> resumeMultikeyPaths) {
     // Being in a WUOW means all timestamping responsibility can be pushed up to the caller.
     invariant(opCtx->lockState()->inAWriteUnitOfWork());
 
@@ -105,7 +114,12 @@ Status IndexBuildBlock::init(OperationContext* opCtx, Collection* collection) {
         _indexCatalog->createIndexEntry(opCtx, std::move(descriptor), initFromDisk, isReadyIndex);
 
     if (_method == IndexBuildMethod::kHybrid) {
-        _indexBuildInterceptor = std::make_unique<IndexBuildInterceptor>(opCtx, _indexCatalogEntry);
+        _indexBuildInterceptor = resumeSideWritesIdent
+            ? std::make_unique<IndexBuildInterceptor>(opCtx,
+                                                      _indexCatalogEntry,
+                                                      *resumeSideWritesIdent,
+                                                      std::move(resumeMultikeyPaths))
+            : std::make_unique<IndexBuildInterceptor>(opCtx, _indexCatalogEntry);
         _indexCatalogEntry->setIndexBuildInterceptor(_indexBuildInterceptor.get());
 
         if (IndexBuildProtocol::kTwoPhase == protocol) {
@@ -56,15 +56,28 @@ public:
      */
     void deleteTemporaryTables(OperationContext* opCtx);
 
+    /**
+     * May be called instead of deleteTemporaryTables() to retain the side writes table of a hybrid
+     * index build that will be resumed after a restart.
+     */
+    void keepTemporaryTables(OperationContext* opCtx);
+
     /**
      * Initializes a new entry for the index in the IndexCatalog.
      *
      * On success, holds pointer to newly created IndexCatalogEntry that can be accessed using
      * getEntry(). IndexCatalog will still own the entry.
      *
+     * When resuming a hybrid index build, 'resumeSideWritesIdent' names the side writes table kept
+     * by keepTemporaryTables() and 'resumeMultikeyPaths' holds the multikey paths that had been
+     * tracked by its side writes.
+     *
      * Must be called from within a `WriteUnitOfWork`
      */
-    Status init(OperationContext* opCtx, Collection* collection);
+    Status init(OperationContext* opCtx,
+                Collection* collection,
+                boost::optional<std::string> resumeSideWritesIdent = boost::none,
+                boost::optional<MultikeyPaths> resumeMultikeyPaths = boost::none);
 
     /**
      * Marks the state of the index as 'ready' and commits the index to disk.
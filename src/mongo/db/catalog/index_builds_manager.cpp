@@ -97,6 +97,10 @@ Status IndexBuildsManager::setUpIndexBuild(OperationContext* opCtx,
         builder->ignoreUniqueConstraint();
     }
 
+    if (!options.resumeInfos.empty()) {
+        builder->setResumeInfos(std::move(options.resumeInfos));
+    }
+
     std::vector<BSONObj> indexes;
     try {
         indexes = writeConflictRetry(opCtx, "IndexBuildsManager::setUpIndexBuild", nss.ns(), [&]() {
@@ -147,6 +151,24 @@ StatusWith<std::pair<long long, long long>> IndexBuildsManager::startBuildingInd
 
     auto cursor = rs->getCursor(opCtx);
     auto record = cursor->next();
+
+    // A resumed index build already holds the keys of the documents up to the one it was
+    // interrupted after.
+    const auto resumeAfterRecordId = builder->getResumeAfterRecordId();
+    if (resumeAfterRecordId) {
+        record = cursor->seekExact(*resumeAfterRecordId);
+        if (record) {
+            record = cursor->next();
+        } else {
+            cursor = rs->getCursor(opCtx);
+            record = cursor->next();
+            while (record && record->id <= *resumeAfterRecordId) {
+                record = cursor->next();
+            }
+        }
+        log() << "Resuming index build on " << ns << " after document " << *resumeAfterRecordId;
+    }
+
     while (record) {
         opCtx->checkForInterrupt();
         // Cursor is left one past the end of the batch inside writeConflictRetry
@@ -196,6 +218,12 @@ StatusWith<std::pair<long long, long long>> IndexBuildsManager::startBuildingInd
     if (!status.isOK()) {
         return status;
     }
+
+    // Only part of the collection was iterated, but a resumed build follows a clean shutdown, so
+    // the collection's own record count and data size can be trusted.
+    if (resumeAfterRecordId) {
+        return std::make_pair(rs->numRecords(opCtx), rs->dataSize(opCtx));
+    }
     return std::make_pair(numRecords, dataSize);
 }
 
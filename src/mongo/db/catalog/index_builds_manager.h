@@ -68,6 +68,9 @@ public:
         SetupOptions();
         IndexConstraints indexConstraints = IndexConstraints::kEnforce;
         bool forRecovery = false;
+        // When non-empty, the index build resumes an interrupted one. See
+        // MultiIndexBlock::setResumeInfos().
+        std::vector<MultiIndexBlock::ResumeInfo> resumeInfos;
     };
 
     IndexBuildsManager() = default;
@@ -107,9 +110,10 @@ public:
 
     /**
      * Iterates through every record in the collection to index it while also removing documents
-     * that are not valid BSON objects.
+     * that are not valid BSON objects. A build that resumes an interrupted one only iterates the
+     * records it had not reached yet.
      *
-     * Returns the number of records and the size of the data iterated over.
+     * Returns the number of records and the size of the data in the collection.
      */
     StatusWith<std::pair<long long, long long>> startBuildingIndexForRecovery(
         OperationContext* opCtx, NamespaceString ns, const UUID& buildUUID);
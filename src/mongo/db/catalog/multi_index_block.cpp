@@ -33,11 +33,14 @@
 
 #include "mongo/db/catalog/multi_index_block.h"
 
+#include <algorithm>
+#include <deque>
 #include <ostream>
 
 #include "mongo/base/error_codes.h"
 #include "mongo/db/audit.h"
 #include "mongo/db/catalog/collection.h"
+#include "mongo/db/catalog/collection_catalog.h"
 #include "mongo/db/catalog/index_timestamp_helper.h"
 #include "mongo/db/catalog/multi_index_block_gen.h"
 #include "mongo/db/client.h"
@@ -51,21 +54,30 @@
 #include "mongo/db/repl/repl_set_config.h"
 #include "mongo/db/repl/replication_coordinator.h"
 #include "mongo/db/server_options.h"
+#include "mongo/db/storage/durable_catalog.h"
+#include "mongo/db/storage/storage_engine.h"
 #include "mongo/db/storage/storage_options.h"
 #include "mongo/db/storage/write_unit_of_work.h"
 #include "mongo/logger/redaction.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/fail_point.h"
 #include "mongo/util/log.h"
 #include "mongo/util/progress_meter.h"
 #include "mongo/util/quick_exit.h"
 #include "mongo/util/scopeguard.h"
+#include "mongo/util/time_support.h"
 #include "mongo/util/uuid.h"
 
 namespace mongo {
 
 namespace {
 
+// Below this many documents the cost of starting the key generation threads is not worth paying.
+constexpr long long kMinRecordsForParallelKeyGeneration = 1000;
+
 /**
  * We do not need synchronization with step up and step down. Dropping the RSTL is important because
  * otherwise if we held the RSTL it would create deadlocks with prepared transactions on step up and
@@ -207,6 +219,20 @@ void MultiIndexBlock::ignoreUniqueConstraint() {
     _ignoreUnique = true;
 }
 
+void MultiIndexBlock::setResumeInfos(std::vector<ResumeInfo> resumeInfos) {
+    invariant(_indexes.empty());
+    invariant(!resumeInfos.empty());
+    invariant(areHybridIndexBuildsEnabled());
+
+    // Every index was scanned by the same collection scan.
+    _resumeAfterRecordId = RecordId(resumeInfos.front().state["lastRecordId"].numberLong());
+    for (const auto& resumeInfo : resumeInfos) {
+        invariant(RecordId(resumeInfo.state["lastRecordId"].numberLong()) == *_resumeAfterRecordId,
+                  str::stream() << "Resume state: " << resumeInfo.state);
+    }
+    _resumeInfos = std::move(resumeInfos);
+}
+
 MultiIndexBlock::OnInitFn MultiIndexBlock::kNoopOnInitFn =
     [](std::vector<BSONObj>& specs) -> Status { return Status::OK(); };
 
@@ -302,6 +328,9 @@ StatusWith<std::vector<BSONObj>> MultiIndexBlock::init(OperationContext* opCtx,
         }
     }
 
+    invariant(_resumeInfos.empty() || _resumeInfos.size() == indexSpecs.size());
+    invariant(_resumeInfos.empty() || _method == IndexBuildMethod::kHybrid);
+
     std::vector<BSONObj> indexInfoObjs;
     indexInfoObjs.reserve(indexSpecs.size());
     std::size_t eachIndexBuildMaxMemoryUsageBytes = 0;
@@ -311,6 +340,18 @@ StatusWith<std::vector<BSONObj>> MultiIndexBlock::init(OperationContext* opCtx,
             indexSpecs.size();
     }
 
+    // Hybrid and foreground builds only add the keys of scanned documents to bulk builders, which
+    // does not touch storage, so key generation can be moved off the scanning thread. The threads
+    // split the memory budget of each index between them.
+    _numKeyGenerationThreads = 1;
+    const auto maxKeyGenerationThreads = maxIndexBuildKeyGenerationThreads.load();
+    if (_method != IndexBuildMethod::kBackground && maxKeyGenerationThreads > 1 &&
+        collection->numRecords(opCtx) >= kMinRecordsForParallelKeyGeneration) {
+        _numKeyGenerationThreads = static_cast<size_t>(maxKeyGenerationThreads);
+    }
+    _keyGenerationMaxMemoryUsageBytes =
+        eachIndexBuildMaxMemoryUsageBytes / _numKeyGenerationThreads;
+
     for (size_t i = 0; i < indexSpecs.size(); i++) {
         BSONObj info = indexSpecs[i];
         StatusWith<BSONObj> statusWithInfo =
@@ -334,7 +375,17 @@ StatusWith<std::vector<BSONObj>> MultiIndexBlock::init(OperationContext* opCtx,
         IndexToBuild index;
         index.block = std::make_unique<IndexBuildBlock>(
             collection->getIndexCatalog(), collection->ns(), info, _method);
-        status = index.block->init(opCtx, collection);
+        if (_resumeInfos.empty()) {
+            status = index.block->init(opCtx, collection);
+        } else {
+            const auto& resumeInfo = _resumeInfos[i];
+            boost::optional<MultikeyPaths> sideWritesMultikeyPaths;
+            if (auto pathsElem = resumeInfo.state["sideWritesMultikeyPaths"]) {
+                sideWritesMultikeyPaths = MultikeyPathTracker::parseMultikeyPaths(pathsElem);
+            }
+            status = index.block->init(
+                opCtx, collection, resumeInfo.sideWritesIdent, std::move(sideWritesMultikeyPaths));
+        }
         if (!status.isOK())
             return status;
 
@@ -352,7 +403,10 @@ StatusWith<std::vector<BSONObj>> MultiIndexBlock::init(OperationContext* opCtx,
         if (useBulk) {
             // Bulk build process requires foreground building as it assumes nothing is changing
             // under it.
-            index.bulk = index.real->initiateBulk(eachIndexBuildMaxMemoryUsageBytes);
+            index.bulk = _resumeInfos.empty()
+                ? index.real->initiateBulk(_keyGenerationMaxMemoryUsageBytes)
+                : index.real->resumeBulk(_keyGenerationMaxMemoryUsageBytes,
+                                         _resumeInfos[i].state["bulk"].Obj());
         }
 
         const IndexDescriptor* descriptor = index.block->getEntry()->descriptor();
@@ -369,8 +423,8 @@ StatusWith<std::vector<BSONObj>> MultiIndexBlock::init(OperationContext* opCtx,
         }
         index.options.fromIndexBuilder = true;
 
-        log() << "index build: starting on " << ns << " properties: " << descriptor->toString()
-              << " using method: " << _method;
+        log() << "index build: " << (_resumeInfos.empty() ? "starting" : "resuming") << " on "
+              << ns << " properties: " << descriptor->toString() << " using method: " << _method;
         if (index.bulk)
             log() << "build may temporarily use up to "
                   << eachIndexBuildMaxMemoryUsageBytes / 1024 / 1024 << " megabytes of RAM";
@@ -394,21 +448,222 @@ StatusWith<std::vector<BSONObj>> MultiIndexBlock::init(OperationContext* opCtx,
 
     wunit.commit();
 
+    _resumeInfos.clear();
     _setState(State::kRunning);
 
     return indexInfoObjs;
 }
 
-void failPointHangDuringBuild(FailPoint* fp, StringData where, const BSONObj& doc) {
+void failPointHangDuringBuild(OperationContext* opCtx,
+                              FailPoint* fp,
+                              StringData where,
+                              const BSONObj& doc) {
     MONGO_FAIL_POINT_BLOCK(*fp, data) {
         int i = doc.getIntField("i");
         if (data.getData()["i"].numberInt() == i) {
             log() << "Hanging " << where << " index build of i=" << i;
-            MONGO_FAIL_POINT_PAUSE_WHILE_SET((*fp));
+            // Stop hanging once interrupted, so that a shutdown can interrupt the collection scan
+            // at this document.
+            while (MONGO_FAIL_POINT((*fp)) && opCtx->checkForInterruptNoAssert().isOK()) {
+                sleepmillis(100);
+            }
         }
     }
 }
 
+/**
+ * Generates the index keys of the documents found by the collection scan on a set of threads, so
+ * that the scanning thread only has to read documents. The first thread fills the bulk builders of
+ * the MultiIndexBlock, every other thread a bulk builder of its own for each index. finish() folds
+ * the latter into the former, so the keys of all threads still reach each index in a single sorted
+ * bulk load.
+ *
+ * Only usable when every index is built through a bulk builder.
+ */
+class MultiIndexBlock::KeyGenerationWorkers {
+public:
+    KeyGenerationWorkers(MultiIndexBlock* block, size_t numThreads, size_t maxMemoryUsageBytes)
+        : _block(block) {
+        for (size_t i = 0; i < numThreads; ++i) {
+            std::vector<IndexAccessMethod::BulkBuilder*> bulks;
+            std::vector<std::unique_ptr<IndexAccessMethod::BulkBuilder>> ownedBulks;
+            for (auto&& index : _block->_indexes) {
+                invariant(index.bulk);
+                if (i == 0) {
+                    bulks.push_back(index.bulk.get());
+                } else {
+                    ownedBulks.push_back(index.real->initiateBulk(maxMemoryUsageBytes));
+                    bulks.push_back(ownedBulks.back().get());
+                }
+            }
+            _bulksPerThread.push_back(std::move(bulks));
+            if (i > 0) {
+                _ownedBulks.push_back(std::move(ownedBulks));
+            }
+        }
+
+        for (size_t i = 0; i < numThreads; ++i) {
+            _threads.emplace_back([this, i] { _run(i); });
+        }
+    }
+
+    ~KeyGenerationWorkers() {
+        _stop(true /* discardQueuedDocuments */);
+    }
+
+    /**
+     * Queues the owned document 'doc' to have its keys generated. Returns the first error that any
+     * thread has run into, after which the index build must fail.
+     */
+    Status add(BSONObj doc, const RecordId& loc) {
+        invariant(doc.isOwned());
+        _batch.emplace_back(std::move(doc), loc);
+        if (_batch.size() < kBatchSize) {
+            return Status::OK();
+        }
+        return _queueBatch();
+    }
+
+    /**
+     * Waits for the keys of every queued document to be generated and hands them to the bulk
+     * builders of the MultiIndexBlock.
+     */
+    Status finish() {
+        Status status = _queueBatch();
+        _stop(false /* discardQueuedDocuments */);
+        if (!status.isOK()) {
+            return status;
+        }
+        if (!_status.isOK()) {
+            return _status;
+        }
+
+        for (auto&& bulks : _ownedBulks) {
+            for (size_t i = 0; i < bulks.size(); ++i) {
+                _block->_indexes[i].bulk->absorb(std::move(bulks[i]));
+            }
+        }
+        _ownedBulks.clear();
+        return Status::OK();
+    }
+
+private:
+    using Batch = std::vector<std::pair<BSONObj, RecordId>>;
+
+    static constexpr size_t kBatchSize = 128;
+
+    // Batches queued per thread before the scan waits for the threads to catch up.
+    static constexpr size_t kQueuedBatchesPerThread = 2;
+
+    Status _queueBatch() {
+        if (_batch.empty()) {
+            return Status::OK();
+        }
+
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        _spaceAvailable.wait(lk, [&] {
+            return !_status.isOK() || _queue.size() < kQueuedBatchesPerThread * _threads.size();
+        });
+        if (!_status.isOK()) {
+            return _status;
+        }
+
+        _queue.push_back(std::move(_batch));
+        _batch = Batch();
+        _workAvailable.notify_one();
+        return Status::OK();
+    }
+
+    void _run(size_t thread) {
+        Client::initThread("IndexBuildKeyGeneration");
+        auto opCtx = cc().makeOperationContext();
+        const auto& bulks = _bulksPerThread[thread];
+
+        while (true) {
+            Batch batch;
+            {
+                stdx::unique_lock<stdx::mutex> lk(_mutex);
+                _workAvailable.wait(lk, [&] { return _stopping || !_queue.empty(); });
+                if (_queue.empty()) {
+                    return;
+                }
+                batch = std::move(_queue.front());
+                _queue.pop_front();
+                _spaceAvailable.notify_one();
+            }
+
+            Status status = _insertBatch(opCtx.get(), bulks, batch);
+            if (!status.isOK()) {
+                stdx::lock_guard<stdx::mutex> lk(_mutex);
+                if (_status.isOK()) {
+                    _status = status;
+                }
+                // Nothing else queued will be used.
+                _queue.clear();
+                _spaceAvailable.notify_all();
+            }
+        }
+    }
+
+    Status _insertBatch(OperationContext* opCtx,
+                        const std::vector<IndexAccessMethod::BulkBuilder*>& bulks,
+                        const Batch& batch) try {
+        for (const auto& docAndLoc : batch) {
+            const BSONObj& doc = docAndLoc.first;
+            for (size_t i = 0; i < _block->_indexes.size(); ++i) {
+                const auto& index = _block->_indexes[i];
+                if (index.filterExpression && !index.filterExpression->matchesBSON(doc)) {
+                    continue;
+                }
+
+                Status status = bulks[i]->insert(opCtx, doc, docAndLoc.second, index.options);
+                if (!status.isOK()) {
+                    return status;
+                }
+            }
+        }
+        return Status::OK();
+    } catch (...) {
+        return exceptionToStatus();
+    }
+
+    void _stop(bool discardQueuedDocuments) {
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            _stopping = true;
+            if (discardQueuedDocuments) {
+                _queue.clear();
+            }
+        }
+        _workAvailable.notify_all();
+
+        for (auto&& thread : _threads) {
+            thread.join();
+        }
+        _threads.clear();
+    }
+
+    MultiIndexBlock* const _block;
+
+    // _bulksPerThread[t][i] receives the keys that thread 't' generates for _block->_indexes[i].
+    std::vector<std::vector<IndexAccessMethod::BulkBuilder*>> _bulksPerThread;
+
+    // The bulk builders of every thread but the first, which finish() hands to the MultiIndexBlock.
+    std::vector<std::vector<std::unique_ptr<IndexAccessMethod::BulkBuilder>>> _ownedBulks;
+    std::vector<stdx::thread> _threads;
+
+    // The batch being filled by the scanning thread.
+    Batch _batch;
+
+    // Protects the members below.
+    stdx::mutex _mutex;
+    stdx::condition_variable _workAvailable;
+    stdx::condition_variable _spaceAvailable;
+    std::deque<Batch> _queue;
+    bool _stopping = false;
+    Status _status = Status::OK();  // The first error any thread ran into.
+};
+
 Status MultiIndexBlock::insertAllDocumentsInCollection(OperationContext* opCtx,
                                                        Collection* collection) {
     invariant(opCtx->lockState()->isNoop() || !opCtx->lockState()->inAWriteUnitOfWork());
@@ -473,8 +728,19 @@ Status MultiIndexBlock::insertAllDocumentsInCollection(OperationContext* opCtx,
         _method != IndexBuildMethod::kBackground && useReadOnceCursorsForIndexBuilds.load();
     opCtx->recoveryUnit()->setReadOnce(readOnce);
 
+    std::unique_ptr<KeyGenerationWorkers> keyGenerationWorkers;
+    const bool allIndexesUseBulk =
+        std::all_of(_indexes.begin(), _indexes.end(), [](const IndexToBuild& index) {
+            return index.bulk != nullptr;
+        });
+    if (_numKeyGenerationThreads > 1 && allIndexesUseBulk && !_indexes.empty()) {
+        keyGenerationWorkers = std::make_unique<KeyGenerationWorkers>(
+            this, _numKeyGenerationThreads, _keyGenerationMaxMemoryUsageBytes);
+    }
+
     Snapshotted<BSONObj> objToIndex;
     RecordId loc;
+    RecordId lastQueuedRecordId;
     PlanExecutor::ExecState state;
     int retries = 0;  // non-zero when retrying our last document.
     while (retries ||
@@ -482,8 +748,15 @@ Status MultiIndexBlock::insertAllDocumentsInCollection(OperationContext* opCtx,
            MONGO_FAIL_POINT(hangAfterStartingIndexBuild)) {
         try {
             auto interruptStatus = opCtx->checkForInterruptNoAssert();
-            if (!interruptStatus.isOK())
+            if (!interruptStatus.isOK()) {
+                // Let the key generation threads catch up, so that the keys of every document
+                // scanned so far are in the bulk builders should the build be resumed later.
+                if (keyGenerationWorkers && !lastQueuedRecordId.isNull() &&
+                    keyGenerationWorkers->finish().isOK()) {
+                    _lastRecordIdInserted = lastQueuedRecordId;
+                }
                 return opCtx->checkForInterruptNoAssert();
+            }
 
             if (!retries && PlanExecutor::ADVANCED != state) {
                 continue;
@@ -500,7 +773,27 @@ Status MultiIndexBlock::insertAllDocumentsInCollection(OperationContext* opCtx,
             // Done before insert so we can retry document if it WCEs.
             progress->setTotalWhileRunning(collection->numRecords(opCtx));
 
-            failPointHangDuringBuild(&hangBeforeIndexBuildOf, "before", objToIndex.value());
+            failPointHangDuringBuild(opCtx, &hangBeforeIndexBuildOf, "before", objToIndex.value());
+
+            if (keyGenerationWorkers) {
+                if (State::kAborted == _getState()) {
+                    return {ErrorCodes::IndexBuildAborted,
+                            str::stream() << "Index build aborted: " << _abortReason};
+                }
+
+                Status ret = keyGenerationWorkers->add(objToIndex.value().getOwned(), loc);
+                if (!ret.isOK()) {
+                    return ret;
+                }
+                lastQueuedRecordId = loc;
+
+                failPointHangDuringBuild(
+                    opCtx, &hangAfterIndexBuildOf, "after", objToIndex.value());
+                progress->hit();
+                n++;
+                retries = 0;
+                continue;
+            }
 
             WriteUnitOfWork wunit(opCtx);
             Status ret = insert(opCtx, objToIndex.value(), loc);
@@ -511,6 +804,7 @@ Status MultiIndexBlock::insertAllDocumentsInCollection(OperationContext* opCtx,
                 return ret;
             }
             wunit.commit();
+            _lastRecordIdInserted = loc;
             if (_method == IndexBuildMethod::kBackground) {
                 try {
                     exec->restoreState();  // Handles any WCEs internally.
@@ -519,7 +813,7 @@ Status MultiIndexBlock::insertAllDocumentsInCollection(OperationContext* opCtx,
                 }
             }
 
-            failPointHangDuringBuild(&hangAfterIndexBuildOf, "after", objToIndex.value());
+            failPointHangDuringBuild(opCtx, &hangAfterIndexBuildOf, "after", objToIndex.value());
 
             // Go to the next document
             progress->hit();
@@ -550,6 +844,16 @@ Status MultiIndexBlock::insertAllDocumentsInCollection(OperationContext* opCtx,
         return exec->getMemberObjectStatus(objToIndex.value());
     }
 
+    if (keyGenerationWorkers) {
+        Status status = keyGenerationWorkers->finish();
+        if (!status.isOK()) {
+            return status;
+        }
+        if (!lastQueuedRecordId.isNull()) {
+            _lastRecordIdInserted = lastQueuedRecordId;
+        }
+    }
+
     if (MONGO_FAIL_POINT(leaveIndexBuildUnfinishedForShutdown)) {
         log() << "Index build interrupted due to 'leaveIndexBuildUnfinishedForShutdown' failpoint. "
                  "Mimicing shutdown error code.";
@@ -627,6 +931,10 @@ Status MultiIndexBlock::dumpInsertsFromBulk(OperationContext* opCtx,
     }
 
     invariant(opCtx->lockState()->isNoop() || !opCtx->lockState()->inAWriteUnitOfWork());
+
+    // The keys gathered by the bulk builders are about to be consumed.
+    _lastRecordIdInserted = boost::none;
+
     for (size_t i = 0; i < _indexes.size(); i++) {
         if (_indexes[i].bulk == nullptr)
             continue;
@@ -730,23 +1038,113 @@ Status MultiIndexBlock::checkConstraints(OperationContext* opCtx) {
 }
 
 void MultiIndexBlock::abortWithoutCleanup(OperationContext* opCtx) {
+    // Only a build that was still running has progress worth keeping.
+    const bool canResume = _getState() == State::kRunning && _canResumeAfterShutdown(opCtx);
     _setStateToAbortedIfNotCommitted("aborted without cleanup"_sd);
 
     UninterruptibleLockGuard noInterrupt(opCtx->lockState());
     // Lock if it's not already locked, to ensure storage engine cannot be destructed out from
-    // underneath us.
+    // underneath us. Persisting the state to resume from writes to the catalog.
     boost::optional<Lock::GlobalLock> lk;
     if (!opCtx->lockState()->isWriteLocked()) {
-        lk.emplace(opCtx, MODE_IS);
+        lk.emplace(opCtx, canResume ? MODE_IX : MODE_IS);
     }
 
-    for (auto& index : _indexes) {
-        index.block->deleteTemporaryTables(opCtx);
+    if (!canResume || !_persistResumeInfosForShutdown(opCtx)) {
+        for (auto& index : _indexes) {
+            index.block->deleteTemporaryTables(opCtx);
+        }
     }
     _indexes.clear();
     _needToCleanup = false;
 }
 
+bool MultiIndexBlock::_canResumeAfterShutdown(OperationContext* opCtx) const {
+    if (_method != IndexBuildMethod::kHybrid || !_lastRecordIdInserted || !_collectionUUID ||
+        _indexes.empty()) {
+        return false;
+    }
+
+    const bool allIndexesUseBulk =
+        std::all_of(_indexes.begin(), _indexes.end(), [](const IndexToBuild& index) {
+            return index.bulk != nullptr;
+        });
+    if (!allIndexesUseBulk) {
+        return false;
+    }
+
+    // Replica set members recover from a checkpoint at the stable timestamp, which the sorted data
+    // and the untimestamped side writes table would not be consistent with.
+    auto replCoord = repl::ReplicationCoordinator::get(opCtx);
+    if (replCoord && replCoord->isReplEnabled()) {
+        return false;
+    }
+
+    return !storageGlobalParams.readOnly &&
+        !opCtx->getServiceContext()->getStorageEngine()->isEphemeral();
+}
+
+bool MultiIndexBlock::_persistResumeInfosForShutdown(OperationContext* opCtx) {
+    auto nss = CollectionCatalog::get(opCtx).lookupNSSByUUID(*_collectionUUID);
+    if (!nss) {
+        return false;
+    }
+
+    std::vector<BSONObj> resumeStates;
+    try {
+        for (auto& index : _indexes) {
+            BSONObjBuilder builder;
+            builder.append("lastRecordId", static_cast<long long>(_lastRecordIdInserted->repr()));
+            builder.append("bulk", index.bulk->persistDataForShutdown());
+            auto interceptor = index.block->getEntry()->indexBuildInterceptor();
+            if (auto multikeyPaths = interceptor->getMultikeyPaths()) {
+                builder.append("sideWritesMultikeyPaths",
+                               MultikeyPathTracker::serializeMultikeyPaths(*multikeyPaths));
+            }
+            resumeStates.push_back(builder.obj());
+        }
+    } catch (const std::exception& e) {
+        warning() << "Unable to persist the state of the index build on " << *nss
+                  << " to resume it after the restart: " << e.what();
+        return false;
+    }
+
+    boost::optional<Lock::DBLock> dbLock;
+    boost::optional<Lock::CollectionLock> collLock;
+    if (!opCtx->lockState()->isCollectionLockedForMode(*nss, MODE_X)) {
+        dbLock.emplace(opCtx, nss->db(), MODE_IX);
+        collLock.emplace(opCtx, *nss, MODE_X);
+    }
+
+    try {
+        writeConflictRetry(opCtx, "MultiIndexBlock::abortWithoutCleanup", nss->ns(), [&] {
+            WriteUnitOfWork wunit(opCtx);
+            for (size_t i = 0; i < _indexes.size(); i++) {
+                auto entry = _indexes[i].block->getEntry();
+                DurableCatalog::get(opCtx)->setIndexBuildResumeState(
+                    opCtx,
+                    *nss,
+                    _indexes[i].block->getIndexName(),
+                    entry->indexBuildInterceptor()->getSideWritesTableIdent(),
+                    resumeStates[i]);
+            }
+            wunit.commit();
+        });
+    } catch (const DBException& e) {
+        warning() << "Unable to persist the state of the index build on " << *nss
+                  << " to resume it after the restart: " << redact(e);
+        return false;
+    }
+
+    for (auto& index : _indexes) {
+        index.block->keepTemporaryTables(opCtx);
+    }
+
+    log() << "Index build on " << *nss << " will resume after document "
+          << *_lastRecordIdInserted << " after the restart";
+    return true;
+}
+
 MultiIndexBlock::OnCreateEachFn MultiIndexBlock::kNoopOnCreateEachFn = [](const BSONObj& spec) {};
 MultiIndexBlock::OnCommitFn MultiIndexBlock::kNoopOnCommitFn = []() {};
 
@@ -100,6 +100,33 @@ public:
      */
     void ignoreUniqueConstraint();
 
+    /**
+     * What abortWithoutCleanup() recorded in the durable catalog for one index of a build that
+     * can resume after a clean shutdown: the side writes table that was kept and the state
+     * returned by DurableCatalog::getIndexBuildResumeState().
+     */
+    struct ResumeInfo {
+        std::string sideWritesIdent;
+        BSONObj state;
+    };
+
+    /**
+     * If this is called before init(), the indexes pick up from the keys and side writes that the
+     * interrupted build had gathered, as described by 'resumeInfos' in the order of the specs
+     * passed to init(). The collection scan then only needs to cover the documents after
+     * getResumeAfterRecordId().
+     *
+     * Only hybrid index builds can be resumed.
+     */
+    void setResumeInfos(std::vector<ResumeInfo> resumeInfos);
+
+    /**
+     * Returns the RecordId of the last document indexed by the build this one resumes, if any.
+     */
+    boost::optional<RecordId> getResumeAfterRecordId() const {
+        return _resumeAfterRecordId;
+    }
+
     /**
      * Prepares the index(es) for building and returns the canonicalized form of the requested index
      * specifications.
@@ -259,6 +286,10 @@ public:
      * to try to remove the indexes again. Also, replication uses this to ensure that indexes
      * that are being built on shutdown are resumed on startup.
      *
+     * A hybrid index build on a standalone node that is interrupted during its collection scan
+     * persists its progress instead of discarding it, so that the build resumes where it left off
+     * on startup rather than scanning the whole collection again.
+     *
      * Do not use this unless you are really sure you need to.
      *
      * Does not matter whether it is called inside of a WriteUnitOfWork. Will not be rolled
@@ -305,9 +336,24 @@ private:
         InsertDeleteOptions options;
     };
 
+    // Generates keys for the collection scan of insertAllDocumentsInCollection() on other threads.
+    class KeyGenerationWorkers;
+
     Status _dumpInsertsFromBulk(std::set<RecordId>* dupRecords,
                                 std::vector<BSONObj>* dupKeysInserted);
 
+    /**
+     * Returns true if the progress of the collection scan can be persisted for the index build to
+     * resume after a restart.
+     */
+    bool _canResumeAfterShutdown(OperationContext* opCtx) const;
+
+    /**
+     * Persists the state from which the index build can resume after a restart and keeps the side
+     * writes tables. Returns false if the state could not be persisted.
+     */
+    bool _persistResumeInfosForShutdown(OperationContext* opCtx);
+
     /**
      * Returns the current state.
      */
@@ -343,6 +389,19 @@ private:
     // Duplicate key constraints should be checked at least once in the MultiIndexBlock.
     bool _constraintsChecked = false;
 
+    // Set by setResumeInfos() and consumed by init().
+    std::vector<ResumeInfo> _resumeInfos;
+    boost::optional<RecordId> _resumeAfterRecordId;
+
+    // Set by init(). The number of threads insertAllDocumentsInCollection() generates keys on, and
+    // the memory each of them may use per index. One of them fills the builders in '_indexes'.
+    size_t _numKeyGenerationThreads = 1;
+    std::size_t _keyGenerationMaxMemoryUsageBytes = 0;
+
+    // The last document of the collection scan whose keys were given to every bulk builder. Unset
+    // once the bulk builders have been committed.
+    boost::optional<RecordId> _lastRecordIdInserted;
+
     // Protects member variables of this class declared below.
     mutable stdx::mutex _mutex;
 
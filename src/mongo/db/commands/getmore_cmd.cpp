@@ -44,6 +44,7 @@
 #include "mongo/db/cursor_manager.h"
 #include "mongo/db/db_raii.h"
 #include "mongo/db/exec/working_set_common.h"
+#include "mongo/db/pipeline/document_buffer_cache.h"
 #include "mongo/db/query/cursor_response.h"
 #include "mongo/db/query/find.h"
 #include "mongo/db/query/find_common.h"
@@ -265,6 +266,10 @@ public:
                              std::uint64_t* numResults) {
             PlanExecutor* exec = cursor->getExecutor();
 
+            // Aggregation cursors build and release many Documents per batch; let them recycle
+            // each other's buffers.
+            DocumentBufferCache::Scope documentBufferScope;
+
             // If an awaitData getMore is killed during this process due to our max time expiring at
             // an interrupt point, we just continue as normal and return rather than reporting a
             // timeout to the user.
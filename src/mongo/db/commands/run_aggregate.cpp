@@ -38,6 +38,7 @@
 #include <vector>
 
 #include "mongo/db/auth/authorization_session.h"
+#include "mongo/db/catalog/collection.h"
 #include "mongo/db/catalog/database.h"
 #include "mongo/db/curop.h"
 #include "mongo/db/cursor_manager.h"
@@ -47,9 +48,12 @@
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/pipeline/accumulator.h"
 #include "mongo/db/pipeline/document.h"
+#include "mongo/db/pipeline/document_buffer_cache.h"
 #include "mongo/db/pipeline/document_source.h"
+#include "mongo/db/pipeline/document_source_cursor.h"
 #include "mongo/db/pipeline/document_source_exchange.h"
 #include "mongo/db/pipeline/document_source_geo_near.h"
+#include "mongo/db/pipeline/document_source_group.h"
 #include "mongo/db/pipeline/expression.h"
 #include "mongo/db/pipeline/expression_context.h"
 #include "mongo/db/pipeline/lite_parsed_pipeline.h"
@@ -62,6 +66,7 @@
 #include "mongo/db/query/find_common.h"
 #include "mongo/db/query/get_executor.h"
 #include "mongo/db/query/plan_summary_stats.h"
+#include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/db/query/query_planner_common.h"
 #include "mongo/db/read_concern.h"
 #include "mongo/db/repl/oplog.h"
@@ -69,6 +74,7 @@
 #include "mongo/db/repl/speculative_majority_read_info.h"
 #include "mongo/db/s/sharding_state.h"
 #include "mongo/db/service_context.h"
+#include "mongo/db/storage/record_store.h"
 #include "mongo/db/storage/storage_options.h"
 #include "mongo/db/views/view.h"
 #include "mongo/db/views/view_catalog.h"
@@ -172,6 +178,9 @@ bool handleCursorCommand(OperationContext* opCtx,
     auto exec = cursor->getExecutor();
     invariant(exec);
 
+    // Let the Documents released while producing this batch recycle each other's buffers.
+    DocumentBufferCache::Scope documentBufferScope;
+
     BSONObj next;
     bool stashedResult = false;
     for (int objCount = 0; objCount < batchSize; objCount++) {
@@ -447,6 +456,95 @@ std::vector<std::unique_ptr<Pipeline, PipelineDeleter>> createExchangePipelinesI
     return pipelines;
 }
 
+/**
+ * If the 'pipeline' starts with a $group directly following a collection scan and parallel $group
+ * evaluation is enabled, split the $group across several threads: the collection is divided into
+ * RecordId ranges, every range is scanned by a consumer pipeline accumulating partial groups on a
+ * thread of the shared gather pool, and the partial groups are gathered and merged by a merging
+ * $group which replaces the $cursor and $group stages of 'pipeline'. Otherwise, return the original
+ * 'pipeline'.
+ */
+std::unique_ptr<Pipeline, PipelineDeleter> createParallelGroupPipelineIfNeeded(
+    OperationContext* opCtx,
+    boost::intrusive_ptr<ExpressionContext> expCtx,
+    const AggregationRequest& request,
+    Collection* collection,
+    std::unique_ptr<Pipeline, PipelineDeleter> pipeline) {
+    // The maximum number of bytes of partial groups buffered between the consumers and the merging
+    // $group.
+    const size_t kGatherBufferSizeBytes = 16 * 1024 * 1024;
+
+    const size_t nConsumers = internalDocumentSourceGroupParallelConsumers.load();
+    if (nConsumers < 2 || request.getExchangeSpec() || expCtx->explain ||
+        expCtx->tailableMode != TailableModeEnum::kNormal || opCtx->inMultiDocumentTransaction() ||
+        ShardingState::get(opCtx)->enabled()) {
+        return pipeline;
+    }
+
+    // The consumers read the collection with their own operation contexts, which only see the
+    // latest data. Other read concerns must be served by the current operation alone.
+    if (repl::ReadConcernArgs::get(opCtx).getLevel() != repl::ReadConcernLevel::kLocalReadConcern) {
+        return pipeline;
+    }
+
+    auto& sources = pipeline->getSources();
+    if (sources.size() < 2 ||
+        !PipelineD::canSplitCursorSourceIntoRanges(collection, pipeline.get())) {
+        return pipeline;
+    }
+
+    auto group = dynamic_cast<DocumentSourceGroup*>(std::next(sources.begin())->get());
+    if (!group || group->doingMerge()) {
+        return pipeline;
+    }
+
+    auto boundaries = collection->getRecordStore()->getRangeBoundaries(opCtx, nConsumers);
+    if (boundaries.empty()) {
+        // The collection is too small to be split.
+        return pipeline;
+    }
+
+    // The partial groups are merged the same way as the partial groups computed by the shards of
+    // a sharded cluster.
+    const BSONObj groupSpec = group->serialize().getDocument().toBson();
+    auto mergingGroup = group->distributedPlanLogic()->mergingStage;
+
+    std::vector<std::unique_ptr<Pipeline, PipelineDeleter>> consumers;
+    for (size_t idx = 0; idx <= boundaries.size(); ++idx) {
+        // Every consumer runs on a different thread, hence it needs its own ExpressionContext and
+        // MongoProcessInterface, and its own copy of the $group. The consumers output partial
+        // groups to be merged.
+        auto consumerExpCtx = expCtx->copyWith(expCtx->ns, expCtx->uuid);
+        consumerExpCtx->mongoProcessInterface = MongoProcessInterface::create(opCtx);
+        consumerExpCtx->needsMerge = true;
+
+        auto partialGroup =
+            DocumentSourceGroup::createFromBson(groupSpec.firstElement(), consumerExpCtx);
+        consumers.emplace_back(uassertStatusOK(Pipeline::create({partialGroup}, consumerExpCtx)));
+
+        boost::optional<RecordId> minRecord;
+        boost::optional<RecordId> maxRecord;
+        if (idx > 0) {
+            minRecord = boundaries[idx - 1];
+        }
+        if (idx < boundaries.size()) {
+            maxRecord = boundaries[idx];
+        }
+        PipelineD::addRangeCursorSource(
+            collection, pipeline.get(), consumers.back().get(), minRecord, maxRecord);
+    }
+
+    // Replace the $cursor and $group stages with the merging $group reading the partial groups.
+    auto cursor = pipeline->popFront();
+    pipeline->popFront();
+    cursor->dispose();
+
+    pipeline->addInitialSource(mergingGroup);
+    pipeline->addInitialSource(new DocumentSourceExchangeGather(
+        expCtx, std::move(consumers), kGatherBufferSizeBytes));
+    return pipeline;
+}
+
 /**
  * Create a PlanExecutor to execute the given 'pipeline'.
  */
@@ -668,6 +766,9 @@ Status runAggregate(OperationContext* opCtx,
             // adding the initial cursor stage.
             pipeline->optimizePipeline();
 
+            pipeline = createParallelGroupPipelineIfNeeded(
+                opCtx, expCtx, request, collection, std::move(pipeline));
+
             auto pipelines =
                 createExchangePipelinesIfNeeded(opCtx, expCtx, request, std::move(pipeline), uuid);
             for (auto&& pipelineIt : pipelines) {
@@ -33,6 +33,7 @@
 
 #include "mongo/db/auth/authorization_session.h"
 #include "mongo/db/catalog/coll_mod.h"
+#include "mongo/db/catalog/collection_catalog_helper.h"
 #include "mongo/db/catalog/database.h"
 #include "mongo/db/catalog/database_holder.h"
 #include "mongo/db/commands.h"
@@ -42,9 +43,11 @@
 #include "mongo/db/commands/feature_compatibility_version_parser.h"
 #include "mongo/db/concurrency/d_concurrency.h"
 #include "mongo/db/db_raii.h"
+#include "mongo/db/index/index_access_method.h"
 #include "mongo/db/repl/repl_client_info.h"
 #include "mongo/db/s/config/sharding_catalog_manager.h"
 #include "mongo/db/server_options.h"
+#include "mongo/db/storage/key_string.h"
 #include "mongo/rpc/get_status_from_command_result.h"
 #include "mongo/s/catalog/type_collection.h"
 #include "mongo/s/database_version_helpers.h"
@@ -61,6 +64,36 @@ namespace {
 MONGO_FAIL_POINT_DEFINE(featureCompatibilityDowngrade);
 MONGO_FAIL_POINT_DEFINE(featureCompatibilityUpgrade);
 
+/**
+ * Fails with IllegalOperation if any index, including unfinished ones, stores its keys in KeyString
+ * V2. Such indexes cannot be opened by 4.2 binaries and must be dropped before downgrading; indexes
+ * created once the downgrade has started use KeyString V1.
+ */
+void uassertNoKeyStringV2Indexes(OperationContext* opCtx) {
+    for (const auto& dbName : CollectionCatalog::get(opCtx).getAllDbNames()) {
+        Lock::DBLock dbLock(opCtx, dbName, MODE_IS);
+        catalog::forEachCollectionFromDb(
+            opCtx, dbName, MODE_IS, [&](const Collection* collection) {
+                auto it = collection->getIndexCatalog()->getIndexIterator(
+                    opCtx, true /* includeUnfinishedIndexes */);
+                while (it->more()) {
+                    const IndexCatalogEntry* entry = it->next();
+                    const auto keyStringVersion =
+                        entry->accessMethod()->getSortedDataInterface()->getKeyStringVersion();
+                    uassert(ErrorCodes::IllegalOperation,
+                            str::stream()
+                                << "cannot downgrade featureCompatibilityVersion to 4.2 while "
+                                   "index '"
+                                << entry->descriptor()->indexName() << "' on collection "
+                                << collection->ns() << " uses KeyString V2. Drop the index, then "
+                                << "retry the downgrade and recreate the index.",
+                            keyStringVersion != KeyString::Version::V2);
+                }
+                return true;
+            });
+    }
+}
+
 /**
  * Sets the minimum allowed version for the cluster. If it is 4.2, then the node should not use 4.4
  * features.
@@ -202,6 +235,10 @@ public:
                 return true;
             }
 
+            // Fail before changing anything in the common case. This is repeated below, once no
+            // new index can pick KeyString V2.
+            uassertNoKeyStringV2Indexes(opCtx);
+
             FeatureCompatibilityVersion::setTargetDowngrade(opCtx);
 
             {
@@ -215,6 +252,10 @@ public:
                 Lock::GlobalLock lk(opCtx, MODE_S);
             }
 
+            // Indexes only choose KeyString V2 while fully upgraded to 4.4, so after the barrier
+            // above this check cannot race with an index creation.
+            uassertNoKeyStringV2Indexes(opCtx);
+
             // Downgrade shards before config finishes its downgrade.
             if (serverGlobalParams.clusterRole == ClusterRole::ConfigServer) {
                 uassertStatusOK(
@@ -42,6 +42,9 @@ namespace {
 
 const int kMaxPerfThreads = 16;  // max number of threads to use for lock perf
 
+// Intent locks are partitioned per CPU, so they should keep scaling past kMaxPerfThreads.
+const int kMaxIntentLockPerfThreads = 128;
+
 
 class DConcurrencyTest : public benchmark::Fixture {
 public:
@@ -90,6 +93,15 @@ BENCHMARK_DEFINE_F(DConcurrencyTest, BM_ResourceMutexExclusive)(benchmark::State
     }
 }
 
+BENCHMARK_DEFINE_F(DConcurrencyTest, BM_NewLockerGlobalIntentSharedLock)(benchmark::State& state) {
+    // Each operation gets a new Locker, so this measures the per-operation locking overhead.
+    for (auto keepRunning : state) {
+        auto locker = std::make_unique<LockerImpl>();
+        locker->lockGlobal(MODE_IS);
+        locker->unlockGlobal();
+    }
+}
+
 BENCHMARK_DEFINE_F(DConcurrencyTest, BM_CollectionIntentSharedLock)(benchmark::State& state) {
     std::unique_ptr<ForceSupportsDocLocking> supportDocLocking;
 
@@ -171,10 +183,13 @@ BENCHMARK_REGISTER_F(DConcurrencyTest, BM_StdMutex)->ThreadRange(1, kMaxPerfThre
 BENCHMARK_REGISTER_F(DConcurrencyTest, BM_ResourceMutexShared)->ThreadRange(1, kMaxPerfThreads);
 BENCHMARK_REGISTER_F(DConcurrencyTest, BM_ResourceMutexExclusive)->ThreadRange(1, kMaxPerfThreads);
 
+BENCHMARK_REGISTER_F(DConcurrencyTest, BM_NewLockerGlobalIntentSharedLock)
+    ->ThreadRange(1, kMaxIntentLockPerfThreads);
+
 BENCHMARK_REGISTER_F(DConcurrencyTest, BM_CollectionIntentSharedLock)
-    ->ThreadRange(1, kMaxPerfThreads);
+    ->ThreadRange(1, kMaxIntentLockPerfThreads);
 BENCHMARK_REGISTER_F(DConcurrencyTest, BM_CollectionIntentExclusiveLock)
-    ->ThreadRange(1, kMaxPerfThreads);
+    ->ThreadRange(1, kMaxIntentLockPerfThreads);
 
 BENCHMARK_REGISTER_F(DConcurrencyTest, BM_MMAPv1CollectionSharedLock)
     ->ThreadRange(1, kMaxPerfThreads);
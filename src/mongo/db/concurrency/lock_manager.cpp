@@ -33,6 +33,12 @@
 
 #include "mongo/db/concurrency/lock_manager.h"
 
+#include <algorithm>
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
 #include "mongo/base/data_type_endian.h"
 #include "mongo/base/data_view.h"
 #include "mongo/base/static_assert.h"
@@ -41,6 +47,7 @@
 #include "mongo/db/catalog/collection_catalog.h"
 #include "mongo/db/concurrency/d_concurrency.h"
 #include "mongo/db/concurrency/locker.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/log.h"
 #include "mongo/util/str.h"
@@ -396,11 +403,15 @@ void LockHead::migratePartitionedLockHeads() {
 // Have more buckets than CPUs to reduce contention on lock and caches
 const unsigned LockManager::_numLockBuckets(128);
 
-// Balance scalability of intent locks against potential added cost of conflicting locks.
-// The exact value doesn't appear very important, but should be power of two
-const unsigned LockManager::_numPartitions = 32;
+namespace {
+// Balance scalability of intent locks against potential added cost of conflicting locks. Intent
+// locks are partitioned by CPU, so there is one partition per hardware thread, but no fewer than
+// this many.
+const unsigned kMinPartitions = 32;
+}  // namespace
 
-LockManager::LockManager() {
+LockManager::LockManager()
+    : _numPartitions(std::max(kMinPartitions, stdx::thread::hardware_concurrency())) {
     _lockBuckets = new LockBucket[_numLockBuckets];
     _partitions = new Partition[_numPartitions];
 }
@@ -424,6 +435,9 @@ LockResult LockManager::lock(ResourceId resId, LockRequest* request, LockMode mo
 
     request->partitioned = (mode == MODE_IX || mode == MODE_IS);
     request->mode = mode;
+    if (request->partitioned) {
+        request->partitionId = _choosePartition(request);
+    }
 
     // For intent modes, try the PartitionedLockHead
     if (request->partitioned) {
@@ -795,8 +809,18 @@ LockManager::LockBucket* LockManager::_getBucket(ResourceId resId) const {
     return &_lockBuckets[resId % _numLockBuckets];
 }
 
+unsigned LockManager::_choosePartition(const LockRequest* request) const {
+#if defined(__linux__)
+    const int cpu = sched_getcpu();
+    if (cpu >= 0) {
+        return static_cast<unsigned>(cpu) % _numPartitions;
+    }
+#endif
+    return request->locker->getId() % _numPartitions;
+}
+
 LockManager::Partition* LockManager::_getPartition(LockRequest* request) const {
-    return &_partitions[request->locker->getId() % _numPartitions];
+    return &_partitions[request->partitionId];
 }
 
 void LockManager::dump() const {
@@ -999,6 +1023,7 @@ void LockRequest::initNew(Locker* locker, LockGrantNotification* notify) {
     next = nullptr;
     status = STATUS_NEW;
     partitioned = false;
+    partitionId = 0;
     mode = MODE_NONE;
     convertMode = MODE_NONE;
     unlockPending = 0;
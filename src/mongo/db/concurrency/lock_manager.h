@@ -42,6 +42,7 @@
 #include "mongo/platform/compiler.h"
 #include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/mutex.h"
+#include "mongo/stdx/new.h"
 #include "mongo/stdx/unordered_map.h"
 #include "mongo/util/concurrency/mutex.h"
 
@@ -146,10 +147,11 @@ private:
         LockHead* findOrInsert(ResourceId resId);
     };
 
-    // Each locker maps to a partition that is used for resources acquired in intent modes
+    // Each CPU maps to a partition that is used for resources acquired in intent modes
     // modes and potentially other modes that don't conflict with themselves. This avoids
-    // contention on the regular LockHead in the lock manager.
-    struct Partition {
+    // contention on the regular LockHead in the lock manager. Partitions are cache line aligned,
+    // so that threads running on different CPUs don't share a cache line when locking their own.
+    struct alignas(stdx::hardware_destructive_interference_size) Partition {
         PartitionedLockHead* find(ResourceId resId);
         PartitionedLockHead* findOrInsert(ResourceId resId);
         typedef stdx::unordered_map<ResourceId, PartitionedLockHead*> Map;
@@ -165,7 +167,13 @@ private:
 
 
     /**
-     * Retrieves the Partition that a particular LockRequest should use for intent locking.
+     * Picks the partition a new intent mode request should use: the one of the CPU the calling
+     * thread is running on, or one based on the request's locker where that is unavailable.
+     */
+    unsigned _choosePartition(const LockRequest* request) const;
+
+    /**
+     * Retrieves the Partition that a particular LockRequest uses for intent locking.
      */
     Partition* _getPartition(LockRequest* request) const;
 
@@ -213,7 +221,7 @@ private:
     static const unsigned _numLockBuckets;
     LockBucket* _lockBuckets;
 
-    static const unsigned _numPartitions;
+    const unsigned _numPartitions;
     Partition* _partitions;
 };
 }  // namespace mongo
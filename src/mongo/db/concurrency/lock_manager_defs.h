@@ -398,6 +398,15 @@ struct LockRequest {
     // No synchronization
     bool partitioned;
 
+    // Index of the LockManager partition used by this request while it is partitioned. It is picked
+    // when the request is first locked, so that unlock finds the same partition even if the thread
+    // has since moved to another CPU.
+    //
+    // Written by LockManager on Locker thread
+    // Read by LockManager on Locker thread
+    // No synchronization
+    unsigned partitionId;
+
     // How many times has LockManager::lock been called for this request. Locks are released when
     // their recursive count drops to zero.
     //
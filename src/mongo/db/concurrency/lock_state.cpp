@@ -33,14 +33,23 @@
 
 #include "mongo/db/concurrency/lock_state.h"
 
+#include <algorithm>
+#include <memory>
+#include <type_traits>
 #include <vector>
 
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+#include "mongo/base/static_assert.h"
 #include "mongo/db/concurrency/flow_control_ticketholder.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/storage/flow_control.h"
 #include "mongo/platform/compiler.h"
 #include "mongo/stdx/new.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/util/background.h"
 #include "mongo/util/concurrency/ticketholder.h"
 #include "mongo/util/debug_util.h"
@@ -59,18 +68,22 @@ namespace {
  * Tracks global (across all clients) lock acquisition statistics, partitioned into multiple
  * buckets to minimize concurrent access conflicts.
  *
- * Each client has a LockerId that monotonically increases across all client instances. The
- * LockerId % 8 is used to index into one of 8 LockStats instances. These LockStats objects must be
- * atomically accessed, so maintaining 8 that are indexed by LockerId reduces client conflicts and
- * improves concurrent write access. A reader, to collect global lock statics for reporting, will
- * sum the results of all 8 disjoint 'buckets' of stats.
+ * There is one bucket of LockStats per hardware thread, and statistics are recorded in the bucket
+ * of the CPU the recording thread runs on, so that operations running on different CPUs never
+ * write to the same cache line. Where the current CPU can't be determined, the LockerId picks the
+ * bucket instead. A thread can be preempted or migrated while recording, so the LockStats objects
+ * must still be atomically accessed, but those accesses are almost never contended. A reader, to
+ * collect global lock statics for reporting, will sum the results of all the disjoint 'buckets' of
+ * stats.
  */
 class PartitionedInstanceWideLockStats {
     PartitionedInstanceWideLockStats(const PartitionedInstanceWideLockStats&) = delete;
     PartitionedInstanceWideLockStats& operator=(const PartitionedInstanceWideLockStats&) = delete;
 
 public:
-    PartitionedInstanceWideLockStats() {}
+    PartitionedInstanceWideLockStats()
+        : _numPartitions(std::max(1u, stdx::thread::hardware_concurrency())),
+          _partitions(new AlignedLockStats[_numPartitions]) {}
 
     void recordAcquisition(LockerId id, ResourceId resId, LockMode mode) {
         _get(id).recordAcquisition(resId, mode);
@@ -85,13 +98,13 @@ public:
     }
 
     void report(SingleThreadedLockStats* outStats) const {
-        for (int i = 0; i < NumPartitions; i++) {
+        for (unsigned i = 0; i < _numPartitions; i++) {
             outStats->append(_partitions[i].stats);
         }
     }
 
     void reset() {
-        for (int i = 0; i < NumPartitions; i++) {
+        for (unsigned i = 0; i < _numPartitions; i++) {
             _partitions[i].stats.reset();
         }
     }
@@ -103,17 +116,81 @@ private:
         AtomicLockStats stats;
     };
 
-    enum { NumPartitions = 8 };
+    AtomicLockStats& _get(LockerId id) {
+#if defined(__linux__)
+        const int cpu = sched_getcpu();
+        if (cpu >= 0) {
+            return _partitions[static_cast<unsigned>(cpu) % _numPartitions].stats;
+        }
+#endif
+        return _partitions[id % _numPartitions].stats;
+    }
 
+    const unsigned _numPartitions;
+    std::unique_ptr<AlignedLockStats[]> _partitions;
+};
 
-    AtomicLockStats& _get(LockerId id) {
-        return _partitions[id % NumPartitions].stats;
+/**
+ * Keeps the memory of up to kMaxCached destroyed LockerImpls for reuse by the next LockerImpls
+ * created on the same thread. A thread runs its operations one after another, so most of the time
+ * a single cached block is enough, and it is likely still in this CPU's cache.
+ */
+class LockerImplAllocationCache {
+public:
+    void* allocate() {
+        if (_numCached <= 0) {
+            return ::operator new(sizeof(LockerImpl));
+        }
+        return _blocks[--_numCached];
+    }
+
+    void deallocate(void* ptr) {
+        if (_numCached < 0 || _numCached == kMaxCached) {
+            ::operator delete(ptr);
+            return;
+        }
+        if (_numCached == 0) {
+            _registerDrain();
+        }
+        _blocks[_numCached++] = ptr;
+    }
+
+private:
+    // Frees the blocks cached by this thread when it exits.
+    class Drain {
+    public:
+        explicit Drain(LockerImplAllocationCache* cache) : _cache(cache) {}
+
+        ~Drain() {
+            for (int i = 0; i < _cache->_numCached; i++) {
+                ::operator delete(_cache->_blocks[i]);
+            }
+            // LockerImpls destroyed later in this thread's shutdown go straight to the allocator.
+            _cache->_numCached = -1;
+        }
+
+    private:
+        LockerImplAllocationCache* const _cache;
+    };
+
+    void _registerDrain() {
+        // Constructed the first time a block is cached, so it is destroyed before any thread_local
+        // that was already holding a LockerImpl.
+        thread_local Drain drain(this);
     }
 
+    static constexpr int kMaxCached = 4;
 
-    AlignedLockStats _partitions[NumPartitions];
+    void* _blocks[kMaxCached];
+    // -1 once this thread's cache has been drained.
+    int _numCached;
 };
 
+// Trivially destructible and zero-initialized, so that it remains usable while the other
+// thread_locals of an exiting thread, which may own LockerImpls, are destroyed. The cached blocks
+// are freed by LockerImplAllocationCache::Drain instead.
+MONGO_STATIC_ASSERT(std::is_trivially_destructible<LockerImplAllocationCache>::value);
+thread_local LockerImplAllocationCache lockerImplAllocationCache;
 
 // Global lock manager instance.
 LockManager globalLockManager;
@@ -124,8 +201,22 @@ const Milliseconds MaxWaitTime = Milliseconds(500);
 // Dispenses unique LockerId identifiers
 AtomicWord<unsigned long long> idCounter(0);
 
-// Tracks lock statistics across all Locker instances. Distributes stats across multiple buckets
-// indexed by LockerId in order to minimize concurrent access conflicts.
+// LockerIds are handed out to each thread in blocks of this many, so that threads creating a Locker
+// for every operation don't all contend on 'idCounter'.
+const unsigned long long kLockerIdBlockSize = 64;
+
+LockerId nextLockerId() {
+    thread_local LockerId nextId = 0;
+    thread_local LockerId endOfBlock = 0;
+    if (nextId == endOfBlock) {
+        endOfBlock = idCounter.addAndFetch(kLockerIdBlockSize) + 1;
+        nextId = endOfBlock - kLockerIdBlockSize;
+    }
+    return nextId++;
+}
+
+// Tracks lock statistics across all Locker instances. Distributes stats across per-CPU buckets in
+// order to minimize concurrent access conflicts.
 PartitionedInstanceWideLockStats globalStats;
 
 }  // namespace
@@ -266,7 +357,23 @@ void Locker::setGlobalThrottling(class TicketHolder* reading, class TicketHolder
 }
 
 LockerImpl::LockerImpl()
-    : _id(idCounter.addAndFetch(1)), _wuowNestingLevel(0), _threadId(stdx::this_thread::get_id()) {}
+    : _id(nextLockerId()), _wuowNestingLevel(0), _threadId(stdx::this_thread::get_id()) {}
+
+void* LockerImpl::operator new(std::size_t size) {
+    // Only exact LockerImpls are cached, not subclasses.
+    if (size != sizeof(LockerImpl)) {
+        return ::operator new(size);
+    }
+    return lockerImplAllocationCache.allocate();
+}
+
+void LockerImpl::operator delete(void* ptr, std::size_t size) {
+    if (size != sizeof(LockerImpl)) {
+        ::operator delete(ptr);
+        return;
+    }
+    lockerImplAllocationCache.deallocate(ptr);
+}
 
 stdx::thread::id LockerImpl::getThreadId() const {
     return _threadId;
@@ -343,10 +450,15 @@ bool LockerImpl::_acquireTicket(OperationContext* opCtx, LockMode mode, Date_t d
         // If the ticket wait is interrupted, restore the state of the client.
         auto restoreStateOnErrorGuard = makeGuard([&] { _clientState.store(kInactive); });
 
+        auto priority = _admissionPriority.value_or(
+            opCtx && opCtx->getClient() && opCtx->getClient()->isFromUserConnection()
+                ? AdmissionPriority::kInteractive
+                : AdmissionPriority::kInternal);
+
         OperationContext* interruptible = _uninterruptibleLocksRequested ? nullptr : opCtx;
         if (deadline == Date_t::max()) {
-            holder->waitForTicket(interruptible);
-        } else if (!holder->waitForTicketUntil(interruptible, deadline)) {
+            holder->waitForTicket(interruptible, priority);
+        } else if (!holder->waitForTicketUntil(interruptible, deadline, priority)) {
             return false;
         }
         restoreStateOnErrorGuard.dismiss();
@@ -102,6 +102,14 @@ public:
 
     virtual ~LockerImpl();
 
+    /**
+     * A LockerImpl is created and destroyed for every operation, so the memory of destroyed
+     * instances is kept in a small per-thread cache and handed to the next one created on the same
+     * thread, instead of going back to the allocator.
+     */
+    static void* operator new(std::size_t size);
+    static void operator delete(void* ptr, std::size_t size);
+
     virtual ClientState getClientState() const;
 
     virtual LockerId getId() const {
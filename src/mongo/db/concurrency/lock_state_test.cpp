@@ -39,6 +39,7 @@
 #include "mongo/db/concurrency/lock_manager_test_help.h"
 #include "mongo/db/concurrency/locker.h"
 #include "mongo/db/service_context_test_fixture.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/log.h"
@@ -1149,4 +1150,55 @@ TEST_F(LockerImplTest, ConvertLockPendingUnlockAndUnlock) {
     locker.unlockGlobal();
 }
 
+TEST_F(LockerImplTest, LockerIdsAreUniqueAcrossThreads) {
+    const int kNumThreads = 4;
+    const int kLockersPerThread = 200;
+    std::vector<std::vector<LockerId>> ids(kNumThreads);
+    std::vector<stdx::thread> threads;
+    for (int i = 0; i < kNumThreads; i++) {
+        threads.emplace_back([&ids, i] {
+            for (int j = 0; j < kLockersPerThread; j++) {
+                ids[i].push_back(std::make_unique<LockerImpl>()->getId());
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    std::vector<LockerId> allIds;
+    for (const auto& threadIds : ids) {
+        allIds.insert(allIds.end(), threadIds.begin(), threadIds.end());
+    }
+    std::sort(allIds.begin(), allIds.end());
+    ASSERT(std::adjacent_find(allIds.begin(), allIds.end()) == allIds.end());
+}
+
+TEST_F(LockerImplTest, LockerReusingMemoryOfDestroyedLockerStartsClean) {
+    const ResourceId resId(RESOURCE_COLLECTION, "TestDB.collection"_sd);
+
+    auto locker = std::make_unique<LockerImpl>();
+    const void* const firstAddress = locker.get();
+    const LockerId firstId = locker->getId();
+    locker->lockGlobal(MODE_IX);
+    locker->lock(resId, MODE_X);
+    locker->beginWriteUnitOfWork();
+    locker->endWriteUnitOfWork();
+    ASSERT(locker->unlock(resId));
+    locker->unlockGlobal();
+    locker.reset();
+
+    locker = std::make_unique<LockerImpl>();
+    ASSERT_EQ(firstAddress, locker.get());
+    ASSERT_NE(firstId, locker->getId());
+    ASSERT(locker->getClientState() == Locker::kInactive);
+    ASSERT(!locker->isLocked());
+    ASSERT_EQ(MODE_NONE, locker->getLockMode(resId));
+
+    Locker::LockerInfo info;
+    locker->getLockerInfo(&info, boost::none);
+    ASSERT(info.locks.empty());
+    ASSERT_EQUALS(0, info.stats.get(resId, MODE_X).numAcquisitions);
+}
+
 }  // namespace mongo
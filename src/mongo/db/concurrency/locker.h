@@ -37,6 +37,7 @@
 #include "mongo/db/concurrency/lock_stats.h"
 #include "mongo/db/operation_context.h"
 #include "mongo/stdx/thread.h"
+#include "mongo/util/concurrency/admission_priority.h"
 
 namespace mongo {
 
@@ -512,6 +513,18 @@ public:
         return _shouldAcquireTicket;
     }
 
+    /**
+     * Sets the lane this locker queues in when it waits for a ticket. If not set, operations from
+     * user connections are interactive and the others are internal.
+     */
+    void setAdmissionPriority(AdmissionPriority priority) {
+        _admissionPriority = priority;
+    }
+
+    boost::optional<AdmissionPriority> getAdmissionPriority() const {
+        return _admissionPriority;
+    }
+
     /**
      * Acquire a flow control admission ticket into the system. Flow control is used as a
      * backpressure mechanism to limit replication majority point lag.
@@ -560,6 +573,7 @@ protected:
 private:
     bool _shouldConflictWithSecondaryBatchApplication = true;
     bool _shouldAcquireTicket = true;
+    boost::optional<AdmissionPriority> _admissionPriority;
     std::string _debugInfo;  // Extra info about this locker for debugging purpose
 };
 
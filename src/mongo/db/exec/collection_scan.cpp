@@ -41,8 +41,10 @@
 #include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/exec/working_set.h"
 #include "mongo/db/exec/working_set_common.h"
+#include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/db/repl/optime.h"
 #include "mongo/db/storage/oplog_hack.h"
+#include "mongo/util/elapsed_tracker.h"
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/log.h"
 
@@ -77,6 +79,10 @@ CollectionScan::CollectionScan(OperationContext* opCtx,
         invariant(collection->ns().isOplog());
     }
     invariant(!_params.shouldTrackLatestOplogTimestamp || collection->ns().isOplog());
+    if (params.minRecord || params.maxRecord) {
+        // Bounding a scan by RecordId is exclusive with the oplog and tailable optimizations.
+        invariant(!params.minTs && !params.maxTs && !params.tailable);
+    }
 
     // Set early stop condition.
     if (params.maxTs) {
@@ -150,8 +156,17 @@ PlanStage::StageState CollectionScan::doWork(WorkingSetID* out) {
             }
         }
 
-        if (!record) {
-            record = _cursor->next();
+        const bool forward = _params.direction == CollectionScanParams::FORWARD;
+        const auto& rangeStart = forward ? _params.minRecord : _params.maxRecord;
+        if (_lastSeenId.isNull() && rangeStart &&
+            collection()->getRecordStore()->isInRecordIdOrder()) {
+            // The record at the start of the range may have been deleted since the range was
+            // computed, in which case the scan starts at the next record.
+            record = _cursor->seekAtOrPast(*rangeStart);
+            if (!record) {
+                _commonStats.isEOF = true;
+                return PlanStage::IS_EOF;
+            }
         }
     } catch (const WriteConflictException&) {
         // Leave us in a state to try again next time.
@@ -161,35 +176,72 @@ PlanStage::StageState CollectionScan::doWork(WorkingSetID* out) {
         return PlanStage::NEED_YIELD;
     }
 
-    if (!record) {
-        // We just hit EOF. If we are tailable and have already returned data, leave us in a
-        // state to pick up where we left off on the next call to work(). Otherwise EOF is
-        // permanent.
-        if (_params.tailable && !_lastSeenId.isNull()) {
-            _cursor.reset();
-        } else {
+    // Records which fail the filter are discarded without returning NEED_TIME up the tree, so
+    // that a selective scan tests a block of records per call to work() instead of paying for a
+    // full trip through the plan and the executor for every document. The block is bounded by the
+    // same iteration count and period that drive yielding, so that the executor still gets to
+    // yield and check for interrupt on schedule.
+    ElapsedTracker batchTracker(getClock(),
+                                std::min(internalQueryExecCollectionScanFilterBatchSize.load(),
+                                         internalQueryExecYieldIterations.load()),
+                                Milliseconds(internalQueryExecYieldPeriodMS.load()));
+    while (true) {
+        if (!record) {
+            try {
+                record = _cursor->next();
+            } catch (const WriteConflictException&) {
+                *out = WorkingSet::INVALID_ID;
+                return PlanStage::NEED_YIELD;
+            }
+        }
+
+        if (!record) {
+            // We just hit EOF. If we are tailable and have already returned data, leave us in a
+            // state to pick up where we left off on the next call to work(). Otherwise EOF is
+            // permanent.
+            if (_params.tailable && !_lastSeenId.isNull()) {
+                _cursor.reset();
+            } else {
+                _commonStats.isEOF = true;
+            }
+
+            return PlanStage::IS_EOF;
+        }
+
+        _lastSeenId = record->id;
+        if (pastEndOfRange(record->id) && collection()->getRecordStore()->isInRecordIdOrder()) {
             _commonStats.isEOF = true;
+            return PlanStage::IS_EOF;
         }
 
-        return PlanStage::IS_EOF;
-    }
+        if (beforeStartOfRange(record->id) || pastEndOfRange(record->id)) {
+            record = boost::none;
+            if (batchTracker.intervalHasElapsed()) {
+                return PlanStage::NEED_TIME;
+            }
+            continue;
+        }
 
-    _lastSeenId = record->id;
-    if (_params.shouldTrackLatestOplogTimestamp) {
-        auto status = setLatestOplogEntryTimestamp(*record);
-        if (!status.isOK()) {
-            *out = WorkingSetCommon::allocateStatusMember(_workingSet, status);
-            return PlanStage::FAILURE;
+        if (_params.shouldTrackLatestOplogTimestamp) {
+            auto status = setLatestOplogEntryTimestamp(*record);
+            if (!status.isOK()) {
+                *out = WorkingSetCommon::allocateStatusMember(_workingSet, status);
+                return PlanStage::FAILURE;
+            }
         }
-    }
 
-    WorkingSetID id = _workingSet->allocate();
-    WorkingSetMember* member = _workingSet->get(id);
-    member->recordId = record->id;
-    member->obj = {getOpCtx()->recoveryUnit()->getSnapshotId(), record->data.releaseToBson()};
-    _workingSet->transitionToRecordIdAndObj(id);
+        WorkingSetID id = _workingSet->allocate();
+        WorkingSetMember* member = _workingSet->get(id);
+        member->recordId = record->id;
+        member->obj = {getOpCtx()->recoveryUnit()->getSnapshotId(), record->data.releaseToBson()};
+        _workingSet->transitionToRecordIdAndObj(id);
 
-    return returnIfMatches(member, id, out);
+        const StageState state = returnIfMatches(member, id, out);
+        if (state != PlanStage::NEED_TIME || batchTracker.intervalHasElapsed()) {
+            return state;
+        }
+        record = boost::none;
+    }
 }
 
 Status CollectionScan::setLatestOplogEntryTimestamp(const Record& record) {
@@ -205,6 +257,20 @@ Status CollectionScan::setLatestOplogEntryTimestamp(const Record& record) {
     return Status::OK();
 }
 
+bool CollectionScan::beforeStartOfRange(const RecordId& id) const {
+    if (_params.direction == CollectionScanParams::FORWARD) {
+        return _params.minRecord && id < *_params.minRecord;
+    }
+    return _params.maxRecord && id >= *_params.maxRecord;
+}
+
+bool CollectionScan::pastEndOfRange(const RecordId& id) const {
+    if (_params.direction == CollectionScanParams::FORWARD) {
+        return _params.maxRecord && id >= *_params.maxRecord;
+    }
+    return _params.minRecord && id < *_params.minRecord;
+}
+
 PlanStage::StageState CollectionScan::returnIfMatches(WorkingSetMember* member,
                                                       WorkingSetID memberID,
                                                       WorkingSetID* out) {
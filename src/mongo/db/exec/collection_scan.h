@@ -47,6 +47,9 @@ class OperationContext;
  * Scans over a collection, starting at the RecordId provided in params and continuing until
  * there are no more records in the collection.
  *
+ * Records which do not pass the filter are skipped inside a single call to work(), up to a batch
+ * bounded by 'internalQueryExecCollectionScanFilterBatchSize' and the yield knobs.
+ *
  * Preconditions: Valid RecordId.
  */
 class CollectionScan final : public RequiresCollectionStage {
@@ -96,6 +99,18 @@ private:
      */
     Status setLatestOplogEntryTimestamp(const Record& record);
 
+    /**
+     * Returns true if 'id' precedes the [minRecord, maxRecord) range of the scan in the direction
+     * of the scan.
+     */
+    bool beforeStartOfRange(const RecordId& id) const;
+
+    /**
+     * Returns true if 'id' follows the [minRecord, maxRecord) range of the scan in the direction
+     * of the scan.
+     */
+    bool pastEndOfRange(const RecordId& id) const;
+
     // WorkingSet is not owned by us.
     WorkingSet* _workingSet;
 
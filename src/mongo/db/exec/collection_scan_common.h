@@ -51,6 +51,15 @@ struct CollectionScanParams {
     // oplog scans.
     boost::optional<Timestamp> maxTs;
 
+    // If present, the collection scan only returns records whose RecordId lies within the range
+    // [minRecord, maxRecord), such as one of the ranges computed by
+    // RecordStore::getRangeBoundaries(). Either end may be left open. The scan seeks directly to
+    // the start of the range if it is still present in the collection, and returns EOF once it
+    // moves past the end of the range if the RecordStore returns records in RecordId order. Must
+    // not be set on tailable or oplog ('minTs'/'maxTs') scans.
+    boost::optional<RecordId> minRecord;
+    boost::optional<RecordId> maxRecord;
+
     Direction direction = FORWARD;
 
     // Do we want the scan to be 'tailable'?  Only meaningful if the collection is capped.
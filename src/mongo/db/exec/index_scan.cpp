@@ -42,6 +42,7 @@
 #include "mongo/db/index/index_access_method.h"
 #include "mongo/db/index_names.h"
 #include "mongo/db/query/index_bounds_builder.h"
+#include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/util/log.h"
 
 namespace {
@@ -88,10 +89,27 @@ IndexScan::IndexScan(OperationContext* opCtx,
                                    .getOwned();
 }
 
+void IndexScan::setCoveredProjection(const BSONObj& coveredKeyObj,
+                                     const std::vector<bool>* includeKey,
+                                     const std::vector<StringData>* keyFieldNames) {
+    invariant(_scanState == INITIALIZING);
+    if (!coveredKeyObj.binaryEqual(_keyPattern) ||
+        !internalQueryExecDecodeCoveredIndexFields.load()) {
+        return;
+    }
+    _coveredIncludeKey = includeKey;
+    _coveredKeyFieldNames = keyFieldNames;
+}
+
 boost::optional<IndexKeyEntry> IndexScan::initIndexScan() {
     // Perform the possibly heavy-duty initialization of the underlying index cursor.
     _indexCursor = indexAccessMethod()->newCursor(getOpCtx(), _forward);
 
+    // The filter and the key metadata need the whole key, and so does the bounds checker, which
+    // is set up below.
+    _decodeCoveredFields = _coveredIncludeKey && !_filter && !_addKeyMetadata &&
+        _indexCursor->canAppendKeyFields();
+
     // We always seek once to establish the cursor position.
     ++_specificStats.seeks;
 
@@ -100,7 +118,7 @@ boost::optional<IndexKeyEntry> IndexScan::initIndexScan() {
         _startKey = _bounds.startKey;
         _endKey = _bounds.endKey;
         _indexCursor->setEndPosition(_endKey, _endKeyInclusive);
-        return _indexCursor->seek(_startKey, _startKeyInclusive);
+        return _indexCursor->seek(_startKey, _startKeyInclusive, requestedInfo());
     } else {
         // For single intervals, we can use an optimized scan which checks against the position
         // of an end cursor.  For all other index scans, we fall back on using
@@ -108,9 +126,10 @@ boost::optional<IndexKeyEntry> IndexScan::initIndexScan() {
         if (IndexBoundsBuilder::isSingleInterval(
                 _bounds, &_startKey, &_startKeyInclusive, &_endKey, &_endKeyInclusive)) {
             _indexCursor->setEndPosition(_endKey, _endKeyInclusive);
-            return _indexCursor->seek(_startKey, _startKeyInclusive);
+            return _indexCursor->seek(_startKey, _startKeyInclusive, requestedInfo());
         } else {
             _checker.reset(new IndexBoundsChecker(&_bounds, _keyPattern, _direction));
+            _decodeCoveredFields = false;
 
             if (!_checker->getStartSeekPoint(&_seekPoint))
                 return boost::none;
@@ -129,7 +148,7 @@ PlanStage::StageState IndexScan::doWork(WorkingSetID* out) {
                 kv = initIndexScan();
                 break;
             case GETTING_NEXT:
-                kv = _indexCursor->next();
+                kv = _indexCursor->next(requestedInfo());
                 break;
             case NEED_SEEK:
                 ++_specificStats.seeks;
@@ -145,7 +164,7 @@ PlanStage::StageState IndexScan::doWork(WorkingSetID* out) {
 
     if (kv) {
         // In debug mode, check that the cursor isn't lying to us.
-        if (kDebugBuild && !_startKey.isEmpty()) {
+        if (kDebugBuild && !_decodeCoveredFields && !_startKey.isEmpty()) {
             int cmp = kv->key.woCompare(_startKey,
                                         Ordering::make(_keyPattern),
                                         /*compareFieldNames*/ false);
@@ -154,7 +173,7 @@ PlanStage::StageState IndexScan::doWork(WorkingSetID* out) {
             dassert(_forward ? cmp >= 0 : cmp <= 0);
         }
 
-        if (kDebugBuild && !_endKey.isEmpty()) {
+        if (kDebugBuild && !_decodeCoveredFields && !_endKey.isEmpty()) {
             int cmp = kv->key.woCompare(_endKey,
                                         Ordering::make(_keyPattern),
                                         /*compareFieldNames*/ false);
@@ -205,12 +224,22 @@ PlanStage::StageState IndexScan::doWork(WorkingSetID* out) {
         }
     }
 
-    if (!kv->key.isOwned())
-        kv->key = kv->key.getOwned();
-
     // We found something to return, so fill out the WSM.
     WorkingSetID id = _workingSet->allocate();
     WorkingSetMember* member = _workingSet->get(id);
+
+    if (_decodeCoveredFields) {
+        // Our parent covered projection passes this object through unchanged.
+        BSONObjBuilder bob;
+        _indexCursor->appendKeyFields(*_coveredIncludeKey, *_coveredKeyFieldNames, &bob);
+        member->obj = Snapshotted<BSONObj>(SnapshotId(), bob.obj());
+        _workingSet->transitionToOwnedObj(id);
+        *out = id;
+        return PlanStage::ADVANCED;
+    }
+
+    if (!kv->key.isOwned())
+        kv->key = kv->key.getOwned();
     member->recordId = kv->loc;
     member->keyData.push_back(IndexKeyDatum(_keyPattern, kv->key, indexAccessMethod()));
     _workingSet->transitionToRecordIdAndIdx(id);
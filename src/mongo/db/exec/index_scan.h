@@ -128,6 +128,17 @@ public:
 
     static const char* kStageType;
 
+    /**
+     * Called by a ProjectionStageCovered over 'coveredKeyObj' whose direct child is this stage.
+     * When nothing else needs to inspect the full index key, this stage decodes just the fields
+     * selected by 'includeKey' from the index cursor into an owned object named by
+     * 'keyFieldNames', and returns that object instead of the index key. The vectors are owned
+     * by the parent stage and must outlive this stage.
+     */
+    void setCoveredProjection(const BSONObj& coveredKeyObj,
+                              const std::vector<bool>* includeKey,
+                              const std::vector<StringData>* keyFieldNames);
+
 protected:
     void doSaveStateRequiresIndex() final;
 
@@ -139,6 +150,14 @@ private:
      */
     boost::optional<IndexKeyEntry> initIndexScan();
 
+    /**
+     * Returns what the index cursor needs to return for each entry.
+     */
+    SortedDataInterface::Cursor::RequestedInfo requestedInfo() const {
+        return _decodeCoveredFields ? SortedDataInterface::Cursor::kWantLoc
+                                    : SortedDataInterface::Cursor::kKeyAndLoc;
+    }
+
     // The WorkingSet we fill with results.  Not owned by us.
     WorkingSet* const _workingSet;
 
@@ -160,6 +179,14 @@ private:
     // Do we want to add the key as metadata?
     const bool _addKeyMetadata;
 
+    // The fields of the key that our parent covered projection wants, if any. Not owned by us.
+    const std::vector<bool>* _coveredIncludeKey = nullptr;
+    const std::vector<StringData>* _coveredKeyFieldNames = nullptr;
+
+    // Are we decoding the covered fields straight from the index cursor rather than returning
+    // the whole key?
+    bool _decodeCoveredFields = false;
+
     // Stats
     IndexScanStats _specificStats;
 
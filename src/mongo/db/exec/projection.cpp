@@ -34,6 +34,7 @@
 #include <boost/optional.hpp>
 #include <memory>
 
+#include "mongo/db/exec/index_scan.h"
 #include "mongo/db/exec/plan_stage.h"
 #include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/exec/working_set_common.h"
@@ -257,9 +258,20 @@ ProjectionStageCovered::ProjectionStageCovered(OperationContext* opCtx,
             _includeKey.push_back(true);
         }
     }
+
+    if (STAGE_IXSCAN == child()->stageType()) {
+        static_cast<IndexScan*>(child().get())
+            ->setCoveredProjection(_coveredKeyObj, &_includeKey, &_keyFieldNames);
+    }
 }
 
 Status ProjectionStageCovered::transform(WorkingSetMember* member) const {
+    // Our child may already have decoded just the included fields from the index, see
+    // IndexScan::setCoveredProjection().
+    if (member->getState() == WorkingSetMember::OWNED_OBJ) {
+        return Status::OK();
+    }
+
     BSONObjBuilder bob;
 
     // We're pulling data out of the key.
@@ -30,7 +30,8 @@
 #include "mongo/platform/basic.h"
 
 #include "mongo/db/exec/sort_executor.h"
-#include "mongo/db/pipeline/value_comparator.h"
+
+#include "mongo/bson/ordering.h"
 
 namespace mongo {
 namespace {
@@ -58,44 +59,52 @@ SortExecutor::SortExecutor(SortPattern sortPattern,
       _limit(limit),
       _maxMemoryUsageBytes(maxMemoryUsageBytes),
       _tempDir(std::move(tempDir)),
-      _diskUseAllowed(allowDiskUse) {}
-
-int SortExecutor::Comparator::operator()(const DocumentSorter::Data& lhs,
-                                         const DocumentSorter::Data& rhs) const {
-    Value lhsKey = lhs.first;
-    Value rhsKey = rhs.first;
-    // DocumentSourceSort::populate() has already guaranteed that the sort key is non-empty.
-    // However, the tricky part is deciding what to do if none of the sort keys are present. In that
-    // case, consider the document "less".
-    //
-    // Note that 'comparator' must use binary comparisons here, as both 'lhs' and 'rhs' are
-    // collation comparison keys.
-    ValueComparator comparator;
-    const size_t n = _sort.size();
-    if (n == 1) {  // simple fast case
-        if (_sort[0].isAscending)
-            return comparator.compare(lhsKey, rhsKey);
-        else
-            return -comparator.compare(lhsKey, rhsKey);
+      _diskUseAllowed(allowDiskUse) {
+    for (size_t begin = 0; begin < _sortPattern.size(); begin += Ordering::kMaxCompoundIndexKeys) {
+        const size_t end = std::min(begin + Ordering::kMaxCompoundIndexKeys, _sortPattern.size());
+        BSONObjBuilder directions;
+        for (size_t i = begin; i < end; ++i) {
+            directions.append("", _sortPattern[i].isAscending ? 1 : -1);
+        }
+        _sortKeyOrderings.push_back(Ordering::make(directions.obj()));
     }
+}
 
-    // compound sort
-    for (size_t i = 0; i < n; i++) {
-        int cmp = comparator.compare(lhsKey[i], rhsKey[i]);
-        if (cmp) {
-            /* if necessary, adjust the return value by the key ordering */
-            if (!_sort[i].isAscending)
-                cmp = -cmp;
-
-            return cmp;
+KeyString::Value SortExecutor::encodeSortKey(const Value& sortKey) const {
+    // DocumentSourceSort::populate() has already guaranteed that the sort key is non-empty. Missing
+    // components are encoded as undefined, which compares equal to missing, so that documents
+    // lacking a sort field still sort first.
+    //
+    // Note that the components are encoded as they are, without a collator, since they are already
+    // collation comparison keys.
+    //
+    // An Ordering only describes kMaxCompoundIndexKeys components, so longer sort patterns are
+    // encoded in groups. Every group ends in the same terminator and no component's encoding is a
+    // prefix of another's, so the concatenation still compares component by component.
+    BufBuilder encoded;
+    for (size_t group = 0; group < _sortKeyOrderings.size(); ++group) {
+        const size_t begin = group * Ordering::kMaxCompoundIndexKeys;
+        const size_t end = std::min(begin + Ordering::kMaxCompoundIndexKeys, _sortPattern.size());
+
+        BSONObjBuilder components;
+        for (size_t i = begin; i < end; ++i) {
+            const Value component = _sortPattern.isSingleElementKey() ? sortKey : sortKey[i];
+            if (component.missing()) {
+                components.appendUndefined("");
+            } else {
+                component.addToBsonObj(&components, ""_sd);
+            }
         }
+
+        KeyString::Builder builder(
+            KeyString::Version::kLatestVersion, components.obj(), _sortKeyOrderings[group]);
+        encoded.appendBuf(builder.getBuffer(), builder.getSize());
     }
 
-    /*
-      If we got here, everything matched (or didn't exist), so we'll
-      consider the documents equal for purposes of this sort.
-    */
-    return 0;
+    // The key is never decoded, so its type bits are left empty.
+    const int32_t keySize = encoded.len();
+    encoded.appendChar(0);
+    return {KeyString::Version::kLatestVersion, keySize, encoded.len(), encoded.release()};
 }
 
 boost::optional<Document> SortExecutor::getNext() {
@@ -114,21 +123,28 @@ boost::optional<Document> SortExecutor::getNext() {
 
 void SortExecutor::add(Value sortKey, Document data) {
     if (!_sorter) {
-        _sorter.reset(DocumentSorter::make(makeSortOptions(), Comparator(_sortPattern)));
+        makeSorter();
     }
-    _sorter->add(std::move(sortKey), std::move(data));
+    _sorter->add(encodeSortKey(sortKey), std::move(data));
 }
 
 void SortExecutor::loadingDone() {
     // This conditional should only pass if no documents were added to the sorter.
     if (!_sorter) {
-        _sorter.reset(DocumentSorter::make(makeSortOptions(), Comparator(_sortPattern)));
+        makeSorter();
     }
     _output.reset(_sorter->done());
     _wasDiskUsed = _wasDiskUsed || _sorter->usedDisk();
     _sorter.reset();
 }
 
+void SortExecutor::makeSorter() {
+    _sorter.reset(DocumentSorter::make(
+        makeSortOptions(),
+        Comparator(),
+        DocumentSorter::Settings({KeyString::Version::kLatestVersion}, {})));
+}
+
 SortOptions SortExecutor::makeSortOptions() const {
     SortOptions opts;
     if (_limit) {
@@ -33,6 +33,7 @@
 #include "mongo/db/pipeline/expression.h"
 #include "mongo/db/query/sort_pattern.h"
 #include "mongo/db/sorter/sorter.h"
+#include "mongo/db/storage/key_string.h"
 
 namespace mongo {
 /**
@@ -90,19 +91,31 @@ public:
     void add(Value, Document);
 
 private:
-    using DocumentSorter = Sorter<Value, Document>;
-    class Comparator {
-    public:
-        Comparator(const SortPattern& sortPattern) : _sort(sortPattern) {}
-        int operator()(const DocumentSorter::Data& lhs, const DocumentSorter::Data& rhs) const;
-
-    private:
-        const SortPattern& _sort;
+    // Sort keys are encoded to KeyString once, when the document is added, so that the Sorter can
+    // order documents by comparing (and radix sorting) bytes rather than Values.
+    using DocumentSorter = Sorter<KeyString::Value, Document>;
+    struct Comparator {
+        static constexpr bool kComparesKeyBytes = true;
+
+        int operator()(const DocumentSorter::Data& lhs, const DocumentSorter::Data& rhs) const {
+            return lhs.first.compare(rhs.first);
+        }
     };
 
+    /**
+     * Encodes 'sortKey' so that comparing the bytes of two encoded keys gives the same result as
+     * comparing the keys component by component with binary comparisons, honoring the direction of
+     * each component of the sort pattern.
+     */
+    KeyString::Value encodeSortKey(const Value& sortKey) const;
+
     SortOptions makeSortOptions() const;
+    void makeSorter();
 
     SortPattern _sortPattern;
+
+    // One Ordering per group of up to Ordering::kMaxCompoundIndexKeys sort pattern components.
+    std::vector<Ordering> _sortKeyOrderings;
     //  A limit of zero is defined as no limit.
     uint64_t _limit;
     uint64_t _maxMemoryUsageBytes;
@@ -33,9 +33,11 @@
 
 #include "mongo/db/index/btree_access_method.h"
 
+#include <boost/filesystem/operations.hpp>
 #include <utility>
 #include <vector>
 
+#include "mongo/base/checked_cast.h"
 #include "mongo/base/error_codes.h"
 #include "mongo/base/status.h"
 #include "mongo/db/catalog/index_catalog.h"
@@ -46,14 +48,17 @@
 #include "mongo/db/index/index_descriptor.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/keypattern.h"
+#include "mongo/db/multi_key_path_tracker.h"
 #include "mongo/db/operation_context.h"
 #include "mongo/db/repl/replication_coordinator.h"
 #include "mongo/db/repl/timestamp_block.h"
 #include "mongo/db/storage/durable_catalog.h"
+#include "mongo/db/storage/storage_file_util.h"
 #include "mongo/db/storage/storage_options.h"
 #include "mongo/util/log.h"
 #include "mongo/util/progress_meter.h"
 #include "mongo/util/scopeguard.h"
+#include "mongo/util/uuid.h"
 
 namespace mongo {
 
@@ -88,6 +93,10 @@ std::vector<KeyString::Value> asVector(const KeyStringSet& keySet) {
 
 struct BtreeExternalSortComparison {
     typedef std::pair<KeyString::Value, mongo::NullValue> Data;
+
+    // Lets the Sorter radix sort the keys' bytes instead of calling operator().
+    static constexpr bool kComparesKeyBytes = true;
+
     int operator()(const Data& l, const Data& r) const {
         return l.first.compare(r.first);
     }
@@ -454,6 +463,15 @@ public:
                     const IndexDescriptor* descriptor,
                     size_t maxMemoryUsageBytes);
 
+    /**
+     * Starts out with the keys that a builder of the same index spilled to 'fileName' in
+     * resumeDir() before persisting them with persistDataForShutdown().
+     */
+    BulkBuilderImpl(const IndexAccessMethod* index,
+                    size_t maxMemoryUsageBytes,
+                    const std::string& fileName,
+                    const std::vector<SorterRange>& ranges);
+
     Status insert(OperationContext* opCtx,
                   const BSONObj& obj,
                   const RecordId& loc,
@@ -471,11 +489,37 @@ public:
 
     int64_t getKeysInserted() const final;
 
+    void absorb(std::unique_ptr<BulkBuilder> other) final;
+
+    BSONObj persistDataForShutdown() final;
+
+    /**
+     * Restores the multikey state and keys inserted count saved by persistDataForShutdown().
+     */
+    void restoreMultikeyState(const BSONObj& persistedState);
+
 private:
+    static Sorter::Settings makeSorterSettings(const IndexAccessMethod* index);
+
+    void mergeMultikeyPaths(const MultikeyPaths& multikeyPaths);
+
+    /**
+     * Persists the data of '_sorter' and moves its spill file to resumeDir(), returning where the
+     * data can be found.
+     */
+    BSONObj persistSorterDataForShutdown();
+
+    // The directory '_sorter' spills to.
+    const std::string _tempDir;
+
     std::unique_ptr<Sorter> _sorter;
     const IndexAccessMethod* _real;
     int64_t _keysInserted = 0;
 
+    // Builders whose sorted keys done() merges with those of '_sorter'. They own the Sorters, and
+    // therefore the spill files, behind the merged iterator, so they live as long as this does.
+    std::vector<std::unique_ptr<BulkBuilderImpl>> _absorbed;
+
     // Set to true if any document added to the BulkBuilder causes the index to become multikey.
     bool _isMultiKey = false;
 
@@ -494,17 +538,119 @@ std::unique_ptr<IndexAccessMethod::BulkBuilder> AbstractIndexAccessMethod::initi
     return std::make_unique<BulkBuilderImpl>(this, _descriptor, maxMemoryUsageBytes);
 }
 
+std::unique_ptr<IndexAccessMethod::BulkBuilder> AbstractIndexAccessMethod::resumeBulk(
+    size_t maxMemoryUsageBytes, const BSONObj& persistedState) {
+    auto sortersElem = persistedState["sorters"];
+    uassert(ErrorCodes::FailedToParse,
+            str::stream() << "Invalid persisted bulk builder state: " << persistedState,
+            sortersElem.type() == Array && !sortersElem.Obj().isEmpty());
+
+    // The first sorter belonged to the persisted builder itself, the others to the builders it had
+    // absorbed.
+    std::unique_ptr<BulkBuilderImpl> bulk;
+    for (const auto& sorterElem : sortersElem.Obj()) {
+        uassert(ErrorCodes::FailedToParse,
+                str::stream() << "Invalid persisted sorter state: " << sorterElem,
+                sorterElem.type() == Object && sorterElem["fileName"].type() == String &&
+                    sorterElem["ranges"].type() == Array);
+
+        std::vector<SorterRange> ranges;
+        for (const auto& rangeElem : sorterElem["ranges"].Obj()) {
+            uassert(ErrorCodes::FailedToParse,
+                    str::stream() << "Invalid persisted sorter range: " << rangeElem,
+                    rangeElem.type() == Object);
+            const BSONObj range = rangeElem.Obj();
+            ranges.push_back({range["startOffset"].safeNumberLong(),
+                              range["endOffset"].safeNumberLong(),
+                              static_cast<uint32_t>(range["checksum"].safeNumberLong())});
+        }
+
+        auto sorterBulk = std::make_unique<BulkBuilderImpl>(
+            this, maxMemoryUsageBytes, sorterElem["fileName"].String(), ranges);
+        if (!bulk) {
+            bulk = std::move(sorterBulk);
+        } else {
+            bulk->absorb(std::move(sorterBulk));
+        }
+    }
+
+    bulk->restoreMultikeyState(persistedState);
+    return std::move(bulk);
+}
+
+// static
+std::string IndexAccessMethod::BulkBuilder::resumeDir() {
+    return storageGlobalParams.dbpath + "/_resumableIndexBuilds";
+}
+
+// static
+Status IndexAccessMethod::BulkBuilder::checkPersistedFiles(const BSONObj& persistedState) {
+    auto sortersElem = persistedState["sorters"];
+    if (sortersElem.type() != Array) {
+        return {ErrorCodes::FailedToParse,
+                str::stream() << "Invalid persisted bulk builder state: " << persistedState};
+    }
+
+    for (const auto& sorterElem : sortersElem.Obj()) {
+        if (sorterElem.type() != Object || sorterElem["fileName"].type() != String ||
+            !sorterElem["fileSize"].isNumber() || sorterElem["ranges"].type() != Array) {
+            return {ErrorCodes::FailedToParse,
+                    str::stream() << "Invalid persisted sorter state: " << sorterElem};
+        }
+
+        // A sorter that never spilled has no file.
+        if (sorterElem["ranges"].Obj().isEmpty()) {
+            continue;
+        }
+
+        const auto path = boost::filesystem::path(resumeDir()) / sorterElem["fileName"].String();
+        boost::system::error_code ec;
+        const auto fileSize = boost::filesystem::file_size(path, ec);
+        if (ec) {
+            return {ErrorCodes::NonExistentPath,
+                    str::stream() << "Cannot read the size of " << path.string() << ": "
+                                  << ec.message()};
+        }
+        if (static_cast<long long>(fileSize) != sorterElem["fileSize"].safeNumberLong()) {
+            return {ErrorCodes::InvalidLength,
+                    str::stream() << path.string() << " is " << fileSize
+                                  << " bytes long, expected " << sorterElem["fileSize"]};
+        }
+    }
+    return Status::OK();
+}
+
+// static
+IndexAccessMethod::BulkBuilder::Sorter::Settings
+AbstractIndexAccessMethod::BulkBuilderImpl::makeSorterSettings(const IndexAccessMethod* index) {
+    return {{index->getSortedDataInterface()->getKeyStringVersion()}, {}};
+}
+
 AbstractIndexAccessMethod::BulkBuilderImpl::BulkBuilderImpl(const IndexAccessMethod* index,
                                                             const IndexDescriptor* descriptor,
                                                             size_t maxMemoryUsageBytes)
-    : _sorter(Sorter::make(SortOptions()
-                               .TempDir(storageGlobalParams.dbpath + "/_tmp")
+    : _tempDir(storageGlobalParams.dbpath + "/_tmp"),
+      _sorter(Sorter::make(SortOptions()
+                               .TempDir(_tempDir)
                                .ExtSortAllowed()
                                .MaxMemoryUsageBytes(maxMemoryUsageBytes),
                            BtreeExternalSortComparison(),
-                           std::pair<KeyString::Value::SorterDeserializeSettings,
-                                     mongo::NullValue::SorterDeserializeSettings>(
-                               {index->getSortedDataInterface()->getKeyStringVersion()}, {}))),
+                           makeSorterSettings(index))),
+      _real(index) {}
+
+AbstractIndexAccessMethod::BulkBuilderImpl::BulkBuilderImpl(const IndexAccessMethod* index,
+                                                            size_t maxMemoryUsageBytes,
+                                                            const std::string& fileName,
+                                                            const std::vector<SorterRange>& ranges)
+    : _tempDir(resumeDir()),
+      _sorter(Sorter::makeFromExistingRanges(fileName,
+                                             ranges,
+                                             SortOptions()
+                                                 .TempDir(_tempDir)
+                                                 .ExtSortAllowed()
+                                                 .MaxMemoryUsageBytes(maxMemoryUsageBytes),
+                                             BtreeExternalSortComparison(),
+                                             makeSorterSettings(index))),
       _real(index) {}
 
 Status AbstractIndexAccessMethod::BulkBuilderImpl::insert(OperationContext* opCtx,
@@ -521,16 +667,7 @@ Status AbstractIndexAccessMethod::BulkBuilderImpl::insert(OperationContext* opCt
         return exceptionToStatus();
     }
 
-    if (!multikeyPaths.empty()) {
-        if (_indexMultikeyPaths.empty()) {
-            _indexMultikeyPaths = multikeyPaths;
-        } else {
-            invariant(_indexMultikeyPaths.size() == multikeyPaths.size());
-            for (size_t i = 0; i < multikeyPaths.size(); ++i) {
-                _indexMultikeyPaths[i].insert(multikeyPaths[i].begin(), multikeyPaths[i].end());
-            }
-        }
-    }
+    mergeMultikeyPaths(multikeyPaths);
 
     for (const auto& keyString : keys) {
         _sorter->add(keyString, mongo::NullValue());
@@ -546,6 +683,23 @@ Status AbstractIndexAccessMethod::BulkBuilderImpl::insert(OperationContext* opCt
     return Status::OK();
 }
 
+void AbstractIndexAccessMethod::BulkBuilderImpl::mergeMultikeyPaths(
+    const MultikeyPaths& multikeyPaths) {
+    if (multikeyPaths.empty()) {
+        return;
+    }
+
+    if (_indexMultikeyPaths.empty()) {
+        _indexMultikeyPaths = multikeyPaths;
+        return;
+    }
+
+    invariant(_indexMultikeyPaths.size() == multikeyPaths.size());
+    for (size_t i = 0; i < multikeyPaths.size(); ++i) {
+        _indexMultikeyPaths[i].insert(multikeyPaths[i].begin(), multikeyPaths[i].end());
+    }
+}
+
 const MultikeyPaths& AbstractIndexAccessMethod::BulkBuilderImpl::getMultikeyPaths() const {
     return _indexMultikeyPaths;
 }
@@ -560,13 +714,131 @@ AbstractIndexAccessMethod::BulkBuilderImpl::done() {
         _sorter->add(keyString, mongo::NullValue());
         ++_keysInserted;
     }
-    return _sorter->done();
+
+    if (_absorbed.empty()) {
+        return _sorter->done();
+    }
+
+    std::vector<std::shared_ptr<Sorter::Iterator>> iters;
+    iters.emplace_back(_sorter->done());
+    for (auto&& other : _absorbed) {
+        iters.emplace_back(other->_sorter->done());
+    }
+
+    // Each iterator removes its own spill file, so there is no file for the merge to clean up.
+    return Sorter::Iterator::merge(iters, "", SortOptions(), BtreeExternalSortComparison());
 }
 
 int64_t AbstractIndexAccessMethod::BulkBuilderImpl::getKeysInserted() const {
     return _keysInserted;
 }
 
+void AbstractIndexAccessMethod::BulkBuilderImpl::absorb(std::unique_ptr<BulkBuilder> other) {
+    std::unique_ptr<BulkBuilderImpl> otherImpl(checked_cast<BulkBuilderImpl*>(other.release()));
+    invariant(otherImpl->_real == _real);
+    invariant(otherImpl->_absorbed.empty());
+
+    _keysInserted += otherImpl->_keysInserted;
+    _isMultiKey = _isMultiKey || otherImpl->_isMultiKey;
+    mergeMultikeyPaths(otherImpl->_indexMultikeyPaths);
+
+    // Multikey metadata keys must only be added to the sorter once, so this builder adds them all.
+    _multikeyMetadataKeys.insert(otherImpl->_multikeyMetadataKeys.begin(),
+                                 otherImpl->_multikeyMetadataKeys.end());
+    otherImpl->_multikeyMetadataKeys.clear();
+
+    _absorbed.push_back(std::move(otherImpl));
+}
+
+BSONObj AbstractIndexAccessMethod::BulkBuilderImpl::persistSorterDataForShutdown() {
+    const SorterPersistedState state = _sorter->persistDataForShutdown();
+    const auto dir = resumeDir();
+
+    // A builder that is persisted again after resuming already spills to resumeDir(). Otherwise the
+    // file is given a name that cannot clash with the files of Sorters after the restart. Nothing
+    // was spilled, and there is no file to move, if the builder never received a key.
+    const std::string fileName =
+        (_tempDir == dir) ? state.fileName : "extsort-index." + UUID::gen().toString();
+    const auto path = boost::filesystem::path(dir) / fileName;
+
+    // The catalog entry that refers to the file is written once this returns, so the file and its
+    // directory entry must be durable first.
+    long long fileSize = 0;
+    if (!state.ranges.empty()) {
+        if (_tempDir != dir) {
+            boost::filesystem::create_directories(dir);
+            uassertStatusOK(fsyncParentDirectory(dir));
+            uassertStatusOK(fsyncRename(boost::filesystem::path(_tempDir) / state.fileName, path));
+        } else {
+            uassertStatusOK(fsyncFile(path));
+            uassertStatusOK(fsyncParentDirectory(path));
+        }
+        fileSize = static_cast<long long>(boost::filesystem::file_size(path));
+    }
+
+    BSONObjBuilder builder;
+    builder.append("fileName", fileName);
+    builder.append("fileSize", fileSize);
+    BSONArrayBuilder ranges(builder.subarrayStart("ranges"));
+    for (const auto& range : state.ranges) {
+        ranges.append(BSON("startOffset" << static_cast<long long>(range.startOffset)
+                                         << "endOffset" << static_cast<long long>(range.endOffset)
+                                         << "checksum" << static_cast<long long>(range.checksum)));
+    }
+    ranges.done();
+    return builder.obj();
+}
+
+BSONObj AbstractIndexAccessMethod::BulkBuilderImpl::persistDataForShutdown() {
+    BSONObjBuilder builder;
+    {
+        BSONArrayBuilder sorters(builder.subarrayStart("sorters"));
+        sorters.append(persistSorterDataForShutdown());
+        for (auto&& other : _absorbed) {
+            sorters.append(other->persistSorterDataForShutdown());
+        }
+    }
+
+    builder.append("keysInserted", static_cast<long long>(_keysInserted));
+    builder.append("isMultikey", _isMultiKey);
+    builder.append("multikeyPaths",
+                   MultikeyPathTracker::serializeMultikeyPaths(_indexMultikeyPaths));
+
+    // The multikey metadata keys are only added to the sorter by done(), so they are kept here.
+    BSONArrayBuilder multikeyMetadataKeys(builder.subarrayStart("multikeyMetadataKeys"));
+    for (const auto& keyString : _multikeyMetadataKeys) {
+        BufBuilder buf;
+        keyString.serializeForSorter(buf);
+        multikeyMetadataKeys.appendBinData(buf.len(), BinDataGeneral, buf.buf());
+    }
+    multikeyMetadataKeys.done();
+    return builder.obj();
+}
+
+void AbstractIndexAccessMethod::BulkBuilderImpl::restoreMultikeyState(
+    const BSONObj& persistedState) {
+    uassert(ErrorCodes::FailedToParse,
+            str::stream() << "Invalid persisted bulk builder state: " << persistedState,
+            persistedState["keysInserted"].isNumber() &&
+                persistedState["isMultikey"].type() == Bool &&
+                persistedState["multikeyMetadataKeys"].type() == Array);
+
+    _keysInserted = persistedState["keysInserted"].safeNumberLong();
+    _isMultiKey = persistedState["isMultikey"].Bool();
+    mergeMultikeyPaths(MultikeyPathTracker::parseMultikeyPaths(persistedState["multikeyPaths"]));
+
+    const auto settings = makeSorterSettings(_real).first;
+    for (const auto& keyElem : persistedState["multikeyMetadataKeys"].Obj()) {
+        uassert(ErrorCodes::FailedToParse,
+                str::stream() << "Invalid persisted multikey metadata key: " << keyElem,
+                keyElem.type() == BinData);
+        int len;
+        const char* data = keyElem.binData(len);
+        BufReader reader(data, len);
+        _multikeyMetadataKeys.insert(KeyString::Value::deserializeForSorter(reader, settings));
+    }
+}
+
 Status AbstractIndexAccessMethod::commitBulk(OperationContext* opCtx,
                                              BulkBuilder* bulk,
                                              bool dupsAllowed,
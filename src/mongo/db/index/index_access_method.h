@@ -237,6 +237,35 @@ public:
          * Returns number of keys inserted using this BulkBuilder.
          */
         virtual int64_t getKeysInserted() const = 0;
+
+        /**
+         * Takes over the keys and multikey state gathered by 'other', which must have been started
+         * by initiateBulk() on the same index, so that done() returns them merged with this
+         * builder's own keys. Lets several threads generate keys into builders of their own and
+         * commit them as a single bulk load.
+         */
+        virtual void absorb(std::unique_ptr<BulkBuilder> other) = 0;
+
+        /**
+         * Spills every key this builder and the builders it absorbed hold to disk and moves the
+         * spilled data to resumeDir(), where it is fsynced so that it survives a restart. Returns a
+         * description of that data and of the multikey state gathered so far, from which
+         * resumeBulk() creates an equivalent builder. This builder cannot be used afterwards.
+         */
+        virtual BSONObj persistDataForShutdown() = 0;
+
+        /**
+         * Returns the directory holding the data of builders persisted by persistDataForShutdown().
+         * Unlike the directory keys are sorted in, it is not emptied at startup.
+         */
+        static std::string resumeDir();
+
+        /**
+         * Checks that the files in resumeDir() that 'persistedState', as returned by
+         * persistDataForShutdown(), refers to still exist and have the size they were persisted
+         * with. The checksums of their contents are verified as resumeBulk() reads them back.
+         */
+        static Status checkPersistedFiles(const BSONObj& persistedState);
     };
 
     /**
@@ -251,6 +280,14 @@ public:
      */
     virtual std::unique_ptr<BulkBuilder> initiateBulk(size_t maxMemoryUsageBytes) = 0;
 
+    /**
+     * Starts a bulk operation that carries on from 'persistedState', as returned by
+     * BulkBuilder::persistDataForShutdown() for a builder of the same index, which may have been
+     * before a restart. Throws if the persisted data cannot be used.
+     */
+    virtual std::unique_ptr<BulkBuilder> resumeBulk(size_t maxMemoryUsageBytes,
+                                                    const BSONObj& persistedState) = 0;
+
     /**
      * Call this when you are ready to finish your bulk work.
      * Pass in the BulkBuilder returned from initiateBulk.
@@ -508,6 +545,9 @@ public:
 
     std::unique_ptr<BulkBuilder> initiateBulk(size_t maxMemoryUsageBytes) final;
 
+    std::unique_ptr<BulkBuilder> resumeBulk(size_t maxMemoryUsageBytes,
+                                            const BSONObj& persistedState) final;
+
     Status commitBulk(OperationContext* opCtx,
                       BulkBuilder* bulk,
                       bool dupsAllowed,
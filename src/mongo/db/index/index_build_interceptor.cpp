@@ -66,6 +66,23 @@ IndexBuildInterceptor::IndexBuildInterceptor(OperationContext* opCtx, IndexCatal
     }
 }
 
+IndexBuildInterceptor::IndexBuildInterceptor(OperationContext* opCtx,
+                                             IndexCatalogEntry* entry,
+                                             StringData sideWritesIdent,
+                                             boost::optional<MultikeyPaths> multikeyPaths)
+    : _indexCatalogEntry(entry),
+      _sideWritesTable(
+          opCtx->getServiceContext()->getStorageEngine()->makeTemporaryRecordStoreFromExistingIdent(
+              opCtx, sideWritesIdent)),
+      _sideWritesCounter(std::make_shared<AtomicWord<long long>>(
+          _sideWritesTable->rs()->numRecords(opCtx))),
+      _multikeyPaths(std::move(multikeyPaths)) {
+
+    if (entry->descriptor()->unique()) {
+        _duplicateKeyTracker = std::make_unique<DuplicateKeyTracker>(opCtx, entry);
+    }
+}
+
 void IndexBuildInterceptor::deleteTemporaryTables(OperationContext* opCtx) {
     _sideWritesTable->deleteTemporaryTable(opCtx);
     if (_duplicateKeyTracker) {
@@ -73,6 +90,13 @@ void IndexBuildInterceptor::deleteTemporaryTables(OperationContext* opCtx) {
     }
 }
 
+void IndexBuildInterceptor::keepTemporaryTables(OperationContext* opCtx) {
+    _sideWritesTable->keep();
+    if (_duplicateKeyTracker) {
+        _duplicateKeyTracker->deleteTemporaryTable(opCtx);
+    }
+}
+
 Status IndexBuildInterceptor::recordDuplicateKeys(OperationContext* opCtx,
                                                   const std::vector<BSONObj>& keys) {
     invariant(_indexCatalogEntry->descriptor()->unique());
@@ -57,12 +57,31 @@ public:
      */
     IndexBuildInterceptor(OperationContext* opCtx, IndexCatalogEntry* entry);
 
+    /**
+     * Resumes intercepting writes into the existing side writes table identified by
+     * 'sideWritesIdent', which was kept by keepTemporaryTables() when the index build was
+     * interrupted. Writes already in the table are treated as not yet applied. 'multikeyPaths' are
+     * the paths the side writes had tracked at the time of the interruption, if any.
+     */
+    IndexBuildInterceptor(OperationContext* opCtx,
+                          IndexCatalogEntry* entry,
+                          StringData sideWritesIdent,
+                          boost::optional<MultikeyPaths> multikeyPaths);
+
     /**
      * Deletes the temporary side writes and duplicate key constraint violations tables. Must be
      * called before object destruction.
      */
     void deleteTemporaryTables(OperationContext* opCtx);
 
+    /**
+     * Retains the side writes table so that an interrupted index build can be resumed from it
+     * after a restart, and deletes the duplicate key constraint violations table. Used in place of
+     * deleteTemporaryTables(). No duplicate keys can have been recorded while the collection scan
+     * was still running, so the constraint violations table is recreated empty upon resuming.
+     */
+    void keepTemporaryTables(OperationContext* opCtx);
+
     /**
      * Client writes that are concurrent with an index build will have their index updates written
      * to a temporary table. After the index table scan is complete, these updates will be applied
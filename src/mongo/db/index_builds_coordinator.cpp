@@ -41,6 +41,7 @@
 #include "mongo/db/concurrency/locker.h"
 #include "mongo/db/curop.h"
 #include "mongo/db/db_raii.h"
+#include "mongo/db/index/index_access_method.h"
 #include "mongo/db/index_build_entry_helpers.h"
 #include "mongo/db/op_observer.h"
 #include "mongo/db/operation_context.h"
@@ -50,6 +51,8 @@
 #include "mongo/db/s/database_sharding_state.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/storage/durable_catalog.h"
+#include "mongo/db/storage/storage_engine.h"
+#include "mongo/db/storage/storage_options.h"
 #include "mongo/s/shard_key_pattern.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/log.h"
@@ -119,6 +122,64 @@ void logFailure(Status status,
           << replState->collectionUUID << " ): " << status;
 }
 
+/**
+ * Returns what is needed to resume the builds of the unfinished indexes 'indexNames' where they
+ * were interrupted by a clean shutdown. The indexes are rebuilt together, so they can only resume
+ * if all of them were interrupted by the same collection scan. Otherwise returns nothing, after
+ * dropping the side writes tables that were kept for resuming.
+ */
+std::vector<MultiIndexBlock::ResumeInfo> getResumeInfosForRecovery(
+    OperationContext* opCtx,
+    const NamespaceString& nss,
+    const std::vector<std::string>& indexNames) {
+    auto durableCatalog = DurableCatalog::get(opCtx);
+
+    std::vector<MultiIndexBlock::ResumeInfo> resumeInfos;
+    // Repair may have changed the collection since the index builds were interrupted.
+    bool canResume =
+        MultiIndexBlock::areHybridIndexBuildsEnabled() && !storageGlobalParams.repair;
+    for (const auto& indexName : indexNames) {
+        auto resumeState = durableCatalog->getIndexBuildResumeState(opCtx, nss, indexName);
+        auto sideWritesIdent = durableCatalog->getSideWritesIdent(opCtx, nss, indexName);
+        if (!resumeState || !sideWritesIdent) {
+            canResume = false;
+            continue;
+        }
+
+        if (!resumeInfos.empty() &&
+            (*resumeState)["lastRecordId"].numberLong() !=
+                resumeInfos.front().state["lastRecordId"].numberLong()) {
+            canResume = false;
+        }
+
+        // The sorter files are written outside of the storage engine, so they may have been lost
+        // or truncated even though the catalog entry referring to them survived.
+        auto bulkElem = (*resumeState)["bulk"];
+        auto filesStatus = bulkElem.type() == Object
+            ? IndexAccessMethod::BulkBuilder::checkPersistedFiles(bulkElem.Obj())
+            : Status(ErrorCodes::FailedToParse, "Missing persisted bulk builder state");
+        if (!filesStatus.isOK()) {
+            warning() << "Index build on " << nss << " for index " << indexName
+                      << " cannot use the data it persisted for resuming: " << filesStatus;
+            canResume = false;
+        }
+        resumeInfos.push_back({*sideWritesIdent, *resumeState});
+    }
+
+    if (canResume) {
+        return resumeInfos;
+    }
+
+    auto storageEngine = opCtx->getServiceContext()->getStorageEngine();
+    for (const auto& resumeInfo : resumeInfos) {
+        log() << "Index build on " << nss << " cannot resume, dropping side writes table "
+              << resumeInfo.sideWritesIdent;
+        storageEngine->makeTemporaryRecordStoreFromExistingIdent(opCtx, resumeInfo.sideWritesIdent)
+            ->deleteTemporaryTable(opCtx);
+    }
+    return {};
+}
+
 }  // namespace
 
 const auto getIndexBuildsCoord =
@@ -175,6 +236,9 @@ StatusWith<std::pair<long long, long long>> IndexBuildsCoordinator::startIndexRe
     auto& collectionCatalog = CollectionCatalog::get(getGlobalServiceContext());
     Collection* collection = collectionCatalog.lookupCollectionByNamespace(nss);
     auto indexCatalog = collection->getIndexCatalog();
+
+    // Must be read before the indexes are removed from the catalog below.
+    auto resumeInfos = getResumeInfosForRecovery(opCtx, nss, indexNames);
     {
         // These steps are combined into a single WUOW to ensure there are no commits without
         // the indexes.
@@ -233,6 +297,7 @@ StatusWith<std::pair<long long, long long>> IndexBuildsCoordinator::startIndexRe
 
         IndexBuildsManager::SetupOptions options;
         options.forRecovery = true;
+        options.resumeInfos = std::move(resumeInfos);
         status = _indexBuildsManager.setUpIndexBuild(
             opCtx, collection, specs, buildUUID, MultiIndexBlock::kNoopOnInitFn, options);
         if (!status.isOK()) {
@@ -1002,6 +1067,11 @@ StatusWith<std::pair<long long, long long>> IndexBuildsCoordinator::_runIndexReb
         std::tie(numRecords, dataSize) = uassertStatusOK(
             _indexBuildsManager.startBuildingIndexForRecovery(opCtx, collection->ns(), buildUUID));
 
+        // A resumed index build still has to apply the writes that were made while it was
+        // scanning the collection before the shutdown.
+        uassertStatusOK(_indexBuildsManager.drainBackgroundWrites(
+            opCtx, replState->buildUUID, RecoveryUnit::ReadSource::kUnset));
+
         uassertStatusOK(
             _indexBuildsManager.checkIndexConstraintViolations(opCtx, replState->buildUUID));
 
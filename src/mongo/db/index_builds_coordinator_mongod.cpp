@@ -190,6 +190,9 @@ IndexBuildsCoordinatorMongod::startIndexBuild(OperationContext* opCtx,
 
         opCtx->setDeadlineByDate(deadline, timeoutError);
 
+        // Index builds can wait behind client operations for storage engine tickets.
+        opCtx->lockState()->setAdmissionPriority(AdmissionPriority::kBackground);
+
         boost::optional<repl::UnreplicatedWritesBlock> unreplicatedWrites;
         if (!writesAreReplicated) {
             unreplicatedWrites.emplace(opCtx.get());
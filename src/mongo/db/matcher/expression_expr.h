@@ -34,6 +34,7 @@
 #include "mongo/db/matcher/expression.h"
 #include "mongo/db/matcher/expression_tree.h"
 #include "mongo/db/matcher/rewrite_expr.h"
+#include "mongo/db/pipeline/compiled_expression.h"
 #include "mongo/db/pipeline/expression.h"
 #include "mongo/db/pipeline/expression_context.h"
 
@@ -106,6 +107,9 @@ private:
 
     boost::intrusive_ptr<Expression> _expression;
 
+    // Compiled from '_expression' once it has been optimized, and evaluated in its place if set.
+    std::unique_ptr<CompiledExpression> _compiledExpression;
+
     boost::optional<RewriteExpr::RewriteResult> _rewriteResult;
 };
 
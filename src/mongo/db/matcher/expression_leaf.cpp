@@ -31,6 +31,7 @@
 
 #include "mongo/db/matcher/expression_leaf.h"
 
+#include <boost/optional.hpp>
 #include <cmath>
 #include <memory>
 #include <pcrecpp.h>
@@ -49,6 +50,80 @@
 
 namespace mongo {
 
+namespace {
+
+/**
+ * Compares 'l' and 'r', which must be of the same BSON type, for the scalar types that can be
+ * compared directly. This skips the canonical type and NaN checks done by the general comparison
+ * path, which dominate the cost of comparing two numbers or two short strings. Returns boost::none
+ * if the general path must be used: for other types, for NaN doubles, and for strings compared
+ * under a collation.
+ */
+boost::optional<int> compareSameTypeScalars(const BSONElement& l,
+                                            const BSONElement& r,
+                                            const CollatorInterface* collator) {
+    dassert(l.type() == r.type());
+    switch (l.type()) {
+        case BSONType::NumberInt: {
+            const int a = l._numberInt();
+            const int b = r._numberInt();
+            return (a > b) - (a < b);
+        }
+        case BSONType::NumberLong: {
+            const long long a = l._numberLong();
+            const long long b = r._numberLong();
+            return (a > b) - (a < b);
+        }
+        case BSONType::NumberDouble: {
+            const double a = l._numberDouble();
+            const double b = r._numberDouble();
+            if (std::isnan(a) || std::isnan(b)) {
+                return boost::none;
+            }
+            return (a > b) - (a < b);
+        }
+        case BSONType::Date: {
+            const Date_t a = l.date();
+            const Date_t b = r.date();
+            return (a > b) - (a < b);
+        }
+        case BSONType::jstOID:
+            return memcmp(l.value(), r.value(), OID::kOIDSize);
+        case BSONType::String:
+            if (collator) {
+                return boost::none;
+            }
+            return l.valueStringData().compare(r.valueStringData());
+        default:
+            return boost::none;
+    }
+}
+
+/**
+ * Returns whether the three-way comparison result 'cmp' of a document value against the operand
+ * satisfies the comparison 'matchType'.
+ */
+bool comparisonResultMatches(MatchExpression::MatchType matchType, int cmp) {
+    switch (matchType) {
+        case MatchExpression::LT:
+            return cmp < 0;
+        case MatchExpression::LTE:
+            return cmp <= 0;
+        case MatchExpression::EQ:
+            return cmp == 0;
+        case MatchExpression::GT:
+            return cmp > 0;
+        case MatchExpression::GTE:
+            return cmp >= 0;
+        default:
+            // This is a comparison match expression, so it must be either
+            // a $lt, $lte, $gt, $gte, or equality expression.
+            fassertFailed(16828);
+    }
+}
+
+}  // namespace
+
 ComparisonMatchExpressionBase::ComparisonMatchExpressionBase(
     MatchType type,
     StringData path,
@@ -116,6 +191,14 @@ ComparisonMatchExpression::ComparisonMatchExpression(MatchType type,
 
 bool ComparisonMatchExpression::matchesSingleElement(const BSONElement& e,
                                                      MatchDetails* details) const {
+    // Most filters compare values of the same type as the operand, so try the direct comparison
+    // before falling back to the general rules for mixed types and NaN.
+    if (e.type() == _rhs.type()) {
+        if (auto cmp = compareSameTypeScalars(e, _rhs, _collator)) {
+            return comparisonResultMatches(matchType(), *cmp);
+        }
+    }
+
     if (e.canonicalType() != _rhs.canonicalType()) {
         // We can't call 'compareElements' on elements of different canonical types.  Usually
         // elements with different canonical types should never match any comparison, but there are
@@ -173,22 +256,7 @@ bool ComparisonMatchExpression::matchesSingleElement(const BSONElement& e,
 
     int x = BSONElement::compareElements(
         e, _rhs, BSONElement::ComparisonRules::kConsiderFieldName, _collator);
-    switch (matchType()) {
-        case LT:
-            return x < 0;
-        case LTE:
-            return x <= 0;
-        case EQ:
-            return x == 0;
-        case GT:
-            return x > 0;
-        case GTE:
-            return x >= 0;
-        default:
-            // This is a comparison match expression, so it must be either
-            // a $lt, $lte, $gt, $gte, or equality expression.
-            fassertFailed(16828);
-    }
+    return comparisonResultMatches(matchType(), x);
 }
 
 constexpr StringData EqualityMatchExpression::kName;
@@ -376,6 +444,9 @@ std::unique_ptr<MatchExpression> InMatchExpression::shallowClone() const {
     next->_hasEmptyArray = _hasEmptyArray;
     next->_equalitySet = _equalitySet;
     next->_originalEqualityVector = _originalEqualityVector;
+    if (_equalityHashSet) {
+        next->buildEqualityHashSet();
+    }
     for (auto&& regex : _regexes) {
         std::unique_ptr<RegexMatchExpression> clonedRegex(
             static_cast<RegexMatchExpression*>(regex->shallowClone().release()));
@@ -385,9 +456,18 @@ std::unique_ptr<MatchExpression> InMatchExpression::shallowClone() const {
 }
 
 bool InMatchExpression::contains(const BSONElement& e) const {
+    if (_equalityHashSet) {
+        return _equalityHashSet->find(e) != _equalityHashSet->end();
+    }
     return std::binary_search(_equalitySet.begin(), _equalitySet.end(), e, _eltCmp.makeLessThan());
 }
 
+void InMatchExpression::buildEqualityHashSet() {
+    _equalityHashSet = std::make_unique<BSONEltUnorderedSet>(_eltCmp.makeBSONEltUnorderedSet());
+    _equalityHashSet->reserve(_equalitySet.size());
+    _equalityHashSet->insert(_equalitySet.begin(), _equalitySet.end());
+}
+
 bool InMatchExpression::matchesSingleElement(const BSONElement& e, MatchDetails* details) const {
     if (_hasNull && e.eoo()) {
         return true;
@@ -496,6 +576,11 @@ void InMatchExpression::_doSetCollator(const CollatorInterface* collator) {
                      _originalEqualityVector.end(),
                      std::back_inserter(_equalitySet),
                      _eltCmp.makeEqualTo());
+
+    // The hash function depends on the collator as well, so the hash set must be rebuilt too.
+    if (_equalityHashSet) {
+        buildEqualityHashSet();
+    }
 }
 
 Status InMatchExpression::setEqualities(std::vector<BSONElement> equalities) {
@@ -530,6 +615,10 @@ Status InMatchExpression::setEqualities(std::vector<BSONElement> equalities) {
                      std::back_inserter(_equalitySet),
                      _eltCmp.makeEqualTo());
 
+    if (_equalityHashSet) {
+        buildEqualityHashSet();
+    }
+
     return Status::OK();
 }
 
@@ -569,6 +658,14 @@ MatchExpression::ExpressionOptimizerFunc InMatchExpression::getOptimizer() const
             return std::move(simplifiedExpression);
         }
 
+        // An optimized expression is about to be matched against many documents, so this is the
+        // point at which it is worth paying for a hash set over a long list of equalities.
+        auto& inExpression = static_cast<InMatchExpression&>(*expression);
+        if (!inExpression._equalityHashSet &&
+            equalitySet.size() >= InMatchExpression::kMinEqualitiesForHashedLookup) {
+            inExpression.buildEqualityHashSet();
+        }
+
         return expression;
     };
 }
@@ -406,6 +406,10 @@ private:
  */
 class InMatchExpression : public LeafMatchExpression {
 public:
+    // Lists with at least this many distinct equalities are looked up through a hash set once the
+    // expression has been optimized. Shorter lists keep using binary search over '_equalitySet'.
+    static constexpr size_t kMinEqualitiesForHashedLookup = 32;
+
     explicit InMatchExpression(StringData path);
 
     virtual std::unique_ptr<MatchExpression> shallowClone() const;
@@ -449,9 +453,23 @@ public:
         return _hasEmptyArray;
     }
 
+    /**
+     * Returns true if lookups into the equality list are served by a hash set rather than by
+     * binary search.
+     */
+    bool usesHashedLookup() const {
+        return static_cast<bool>(_equalityHashSet);
+    }
+
 private:
     ExpressionOptimizerFunc getOptimizer() const final;
 
+    /**
+     * Builds '_equalityHashSet' from the current contents of '_equalitySet', using the current
+     * collation-aware comparator.
+     */
+    void buildEqualityHashSet();
+
     // Whether or not '_equalities' has a jstNULL element in it.
     bool _hasNull = false;
 
@@ -475,10 +493,14 @@ private:
     // support std::binary_search. Because we need to sort the elements anyway for things like index
     // bounds building, using binary search avoids the overhead of inserting into a hash table which
     // doesn't pay for itself in the common case where lookups are done a few times if ever.
-    // TODO It may be worth dynamically creating a hashset after matchesSingleElement() has been
-    // called "many" times.
     std::vector<BSONElement> _equalitySet;
 
+    // Hashed view of '_equalitySet', used by contains() when present. It is only built when the
+    // expression is optimized and has at least 'kMinEqualitiesForHashedLookup' equalities, since
+    // optimized expressions are the ones which go on to be matched against many documents. Once
+    // built, it is rebuilt whenever the equalities or the collator change.
+    std::unique_ptr<BSONEltUnorderedSet> _equalityHashSet;
+
     // Container of regex elements this object owns.
     std::vector<std::unique_ptr<RegexMatchExpression>> _regexes;
 };
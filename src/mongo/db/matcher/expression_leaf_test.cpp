@@ -85,6 +85,66 @@ TEST(ComparisonMatchExpression, StringMatchingRespectsCollation) {
                           nullptr));
 }
 
+TEST(ComparisonMatchExpression, SameTypeComparisonsAgreeWithGeneralComparison) {
+    const auto now = Date_t::now();
+    const auto oid1 = OID::gen();
+    const auto oid2 = OID::gen();
+    const std::vector<BSONObj> values{BSON("a" << 1),
+                                      BSON("a" << -3),
+                                      BSON("a" << 7LL),
+                                      BSON("a" << std::numeric_limits<long long>::min()),
+                                      BSON("a" << 2.5),
+                                      BSON("a" << -0.0),
+                                      BSON("a" << 0.0),
+                                      BSON("a" << std::numeric_limits<double>::infinity()),
+                                      BSON("a" << now),
+                                      BSON("a" << (now - Milliseconds(1))),
+                                      BSON("a" << oid1),
+                                      BSON("a" << oid2),
+                                      BSON("a"
+                                           << ""),
+                                      BSON("a"
+                                           << "abc"),
+                                      BSON("a"
+                                           << "abd"),
+                                      BSON("a"
+                                           << "ab")};
+
+    for (auto&& operand : values) {
+        EqualityMatchExpression eq("a", operand["a"]);
+        LTMatchExpression lt("a", operand["a"]);
+        LTEMatchExpression lte("a", operand["a"]);
+        GTMatchExpression gt("a", operand["a"]);
+        GTEMatchExpression gte("a", operand["a"]);
+        for (auto&& doc : values) {
+            if (doc["a"].canonicalType() != operand["a"].canonicalType()) {
+                continue;
+            }
+            const int cmp = doc["a"].woCompare(operand["a"], false);
+            ASSERT_EQ(eq.matchesBSON(doc), cmp == 0) << doc << " vs " << operand;
+            ASSERT_EQ(lt.matchesBSON(doc), cmp < 0) << doc << " vs " << operand;
+            ASSERT_EQ(lte.matchesBSON(doc), cmp <= 0) << doc << " vs " << operand;
+            ASSERT_EQ(gt.matchesBSON(doc), cmp > 0) << doc << " vs " << operand;
+            ASSERT_EQ(gte.matchesBSON(doc), cmp >= 0) << doc << " vs " << operand;
+        }
+    }
+}
+
+TEST(ComparisonMatchExpression, SameTypeDoubleComparisonHandlesNaN) {
+    BSONObj nan = BSON("a" << std::numeric_limits<double>::quiet_NaN());
+    BSONObj one = BSON("a" << 1.0);
+
+    EqualityMatchExpression eqNaN("a", nan["a"]);
+    ASSERT(eqNaN.matchesBSON(nan));
+    ASSERT(!eqNaN.matchesBSON(one));
+
+    LTMatchExpression ltOne("a", one["a"]);
+    ASSERT(!ltOne.matchesBSON(nan));
+    GTEMatchExpression gteNaN("a", nan["a"]);
+    ASSERT(gteNaN.matchesBSON(nan));
+    ASSERT(!gteNaN.matchesBSON(one));
+}
+
 TEST(EqOp, MatchesElement) {
     BSONObj operand = BSON("a" << 5);
     BSONObj match = BSON("a" << 5.0);
@@ -1370,6 +1430,83 @@ TEST(InMatchExpression, ChangingCollationAfterAddingEqualitiesPreservesEqualitie
     ASSERT(in.contains(obj2.firstElement()));
 }
 
+TEST(InMatchExpression, OptimizingLongListSwitchesToHashedLookup) {
+    BSONArrayBuilder bab;
+    for (size_t i = 0; i < InMatchExpression::kMinEqualitiesForHashedLookup; ++i) {
+        bab.append(static_cast<int>(i) * 2);
+    }
+    BSONArray operand = bab.arr();
+
+    auto in = std::make_unique<InMatchExpression>("a");
+    std::vector<BSONElement> equalities;
+    operand.elems(equalities);
+    ASSERT_OK(in->setEqualities(std::move(equalities)));
+    ASSERT_FALSE(in->usesHashedLookup());
+
+    auto optimized = MatchExpression::optimize(std::move(in));
+    ASSERT_EQ(optimized->matchType(), MatchExpression::MATCH_IN);
+    auto optimizedIn = static_cast<InMatchExpression*>(optimized.get());
+    ASSERT_TRUE(optimizedIn->usesHashedLookup());
+
+    // Numeric equivalence must be preserved by the hashed lookup.
+    ASSERT(optimizedIn->matchesBSON(BSON("a" << 4)));
+    ASSERT(optimizedIn->matchesBSON(BSON("a" << 4LL)));
+    ASSERT(optimizedIn->matchesBSON(BSON("a" << 4.0)));
+    ASSERT(optimizedIn->matchesBSON(BSON("a" << BSON_ARRAY(1 << 3 << 6))));
+    ASSERT(!optimizedIn->matchesBSON(BSON("a" << 5)));
+    ASSERT(!optimizedIn->matchesBSON(BSON("a"
+                                          << "4")));
+
+    auto clone = optimizedIn->shallowClone();
+    auto clonedIn = static_cast<InMatchExpression*>(clone.get());
+    ASSERT_TRUE(clonedIn->usesHashedLookup());
+    ASSERT(clonedIn->matchesBSON(BSON("a" << 2)));
+    ASSERT(!clonedIn->matchesBSON(BSON("a" << 3)));
+}
+
+TEST(InMatchExpression, ShortListKeepsBinarySearchAfterOptimization) {
+    BSONArray operand = BSON_ARRAY(1 << 2 << 3);
+    auto in = std::make_unique<InMatchExpression>("a");
+    std::vector<BSONElement> equalities;
+    operand.elems(equalities);
+    ASSERT_OK(in->setEqualities(std::move(equalities)));
+
+    auto optimized = MatchExpression::optimize(std::move(in));
+    ASSERT_EQ(optimized->matchType(), MatchExpression::MATCH_IN);
+    ASSERT_FALSE(static_cast<InMatchExpression*>(optimized.get())->usesHashedLookup());
+}
+
+TEST(InMatchExpression, HashedLookupRespectsCollation) {
+    BSONArrayBuilder bab;
+    for (size_t i = 0; i < InMatchExpression::kMinEqualitiesForHashedLookup; ++i) {
+        bab.append(std::string(i + 1, 'a'));
+    }
+    BSONArray operand = bab.arr();
+
+    CollatorInterfaceMock collator(CollatorInterfaceMock::MockType::kToLowerString);
+    auto in = std::make_unique<InMatchExpression>("a");
+    in->setCollator(&collator);
+    std::vector<BSONElement> equalities;
+    operand.elems(equalities);
+    ASSERT_OK(in->setEqualities(std::move(equalities)));
+
+    auto optimized = MatchExpression::optimize(std::move(in));
+    auto optimizedIn = static_cast<InMatchExpression*>(optimized.get());
+    ASSERT_TRUE(optimizedIn->usesHashedLookup());
+    ASSERT(optimizedIn->matchesBSON(BSON("a"
+                                         << "AAA")));
+    ASSERT(!optimizedIn->matchesBSON(BSON("a"
+                                          << "AAB")));
+
+    // Changing the collator after the hash set has been built must rebuild it.
+    optimizedIn->setCollator(nullptr);
+    ASSERT_TRUE(optimizedIn->usesHashedLookup());
+    ASSERT(!optimizedIn->matchesBSON(BSON("a"
+                                          << "AAA")));
+    ASSERT(optimizedIn->matchesBSON(BSON("a"
+                                         << "aaa")));
+}
+
 std::vector<uint32_t> bsonArrayToBitPositions(const BSONArray& ba) {
     std::vector<uint32_t> bitPositions;
 
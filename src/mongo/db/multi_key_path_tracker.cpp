@@ -33,6 +33,7 @@
 
 #include "mongo/db/multi_key_path_tracker.h"
 
+#include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/str.h"
 
@@ -68,6 +69,42 @@ void MultikeyPathTracker::mergeMultikeyPaths(MultikeyPaths* toMergeInto,
     }
 }
 
+// static
+BSONArray MultikeyPathTracker::serializeMultikeyPaths(const MultikeyPaths& multikeyPaths) {
+    BSONArrayBuilder paths;
+    for (const auto& multikeyComponents : multikeyPaths) {
+        BSONArrayBuilder components(paths.subarrayStart());
+        for (const auto& multikeyComponent : multikeyComponents) {
+            components.append(static_cast<long long>(multikeyComponent));
+        }
+    }
+    return paths.arr();
+}
+
+// static
+MultikeyPaths MultikeyPathTracker::parseMultikeyPaths(const BSONElement& elem) {
+    uassert(ErrorCodes::TypeMismatch,
+            str::stream() << "multikey paths must be an array: " << elem,
+            elem.type() == Array);
+
+    MultikeyPaths multikeyPaths;
+    for (const auto& components : elem.Obj()) {
+        uassert(ErrorCodes::TypeMismatch,
+                str::stream() << "multikey path components must be an array: " << components,
+                components.type() == Array);
+        std::set<std::size_t> multikeyComponents;
+        for (const auto& component : components.Obj()) {
+            uassert(ErrorCodes::TypeMismatch,
+                    str::stream() << "multikey path component must be a non-negative number: "
+                                  << component,
+                    component.isNumber() && component.safeNumberLong() >= 0);
+            multikeyComponents.insert(static_cast<std::size_t>(component.safeNumberLong()));
+        }
+        multikeyPaths.push_back(std::move(multikeyComponents));
+    }
+    return multikeyPaths;
+}
+
 void MultikeyPathTracker::addMultikeyPathInfo(MultikeyPathInfo info) {
     invariant(_trackMultikeyPathInfo);
     // Merge the `MultikeyPathInfo` input into the accumulated value being tracked for the
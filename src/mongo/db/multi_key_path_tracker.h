@@ -33,6 +33,8 @@
 
 #include <boost/optional.hpp>
 
+#include "mongo/bson/bsonelement.h"
+#include "mongo/bson/bsonobj.h"
 #include "mongo/db/index/multikey_paths.h"
 #include "mongo/db/operation_context.h"
 
@@ -63,6 +65,13 @@ public:
 
     static void mergeMultikeyPaths(MultikeyPaths* toMergeInto, const MultikeyPaths& newPaths);
 
+    /**
+     * Converts MultikeyPaths to and from an array of arrays of path component positions, e.g.
+     * [[0], [], [0, 1]], so that the paths can be persisted alongside other index build state.
+     */
+    static BSONArray serializeMultikeyPaths(const MultikeyPaths& multikeyPaths);
+    static MultikeyPaths parseMultikeyPaths(const BSONElement& elem);
+
     // Decoration requires a default constructor.
     MultikeyPathTracker() = default;
 
@@ -35,6 +35,7 @@
 
 #include <sstream>
 
+#include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/db/multi_key_path_tracker.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/str.h"
@@ -76,5 +77,23 @@ TEST(MultikeyPathTracker, TestMergeMultikeyPaths) {
         assertMultikeyPathsAreEqual(mutablePaths, {{0, 1}, {0, 1}, {0, 1, 2}});
     }
 }
+
+TEST(MultikeyPathTracker, TestSerializeAndParseMultikeyPaths) {
+    MultikeyPaths paths = {{0, 1}, {}, {2}};
+    BSONObj serialized = BSON("paths" << MultikeyPathTracker::serializeMultikeyPaths(paths));
+    ASSERT_BSONOBJ_EQ(
+        serialized,
+        BSON("paths" << BSON_ARRAY(BSON_ARRAY(0LL << 1LL) << BSONArray() << BSON_ARRAY(2LL))));
+    assertMultikeyPathsAreEqual(MultikeyPathTracker::parseMultikeyPaths(serialized["paths"]),
+                                paths);
+
+    ASSERT_THROWS_CODE(MultikeyPathTracker::parseMultikeyPaths(BSON("paths" << 1)["paths"]),
+                       DBException,
+                       ErrorCodes::TypeMismatch);
+    BSONObj negative = BSON("paths" << BSON_ARRAY(BSON_ARRAY(-1)));
+    ASSERT_THROWS_CODE(MultikeyPathTracker::parseMultikeyPaths(negative["paths"]),
+                       DBException,
+                       ErrorCodes::TypeMismatch);
+}
 }  // namespace
 }  // namespace mongo
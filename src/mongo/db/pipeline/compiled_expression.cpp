@@ -0,0 +1,411 @@
+/**
+ *    Copyright (C) 2019-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/compiled_expression.h"
+
+#include <algorithm>
+#include <boost/container/small_vector.hpp>
+#include <cmath>
+
+#include "mongo/db/query/query_knobs_gen.h"
+#include "mongo/platform/overflow_arithmetic.h"
+
+namespace mongo {
+
+namespace {
+
+// Programs with at most this many registers are evaluated without allocating a register file.
+constexpr size_t kInlineRegisters = 16;
+
+/**
+ * Returns the value at 'path' in 'root', or boost::none if 'path' traverses an array, in which case
+ * the caller must apply the array semantics of ExpressionFieldPath.
+ */
+boost::optional<Value> getNestedFieldWithoutArrays(const Document& root, const FieldPath& path) {
+    Value value = root[path.getFieldName(0)];
+    for (size_t i = 1; i < path.getPathLength(); ++i) {
+        switch (value.getType()) {
+            case BSONType::Object:
+                value = value.getDocument()[path.getFieldName(i)];
+                break;
+            case BSONType::Array:
+                return boost::none;
+            default:
+                return Value();
+        }
+    }
+    return value;
+}
+
+bool isFastPathNumeric(const Value& value) {
+    auto type = value.getType();
+    return type == NumberInt || type == NumberLong || type == NumberDouble;
+}
+
+/**
+ * Returns the result of ExpressionCompare's three-way comparison of 'lhs' and 'rhs'.
+ */
+int compareValues(const ExpressionCompare& compare, const Value& lhs, const Value& rhs) {
+    if (lhs.getType() == rhs.getType()) {
+        switch (lhs.getType()) {
+            case NumberInt:
+                return lhs.getInt() < rhs.getInt() ? -1 : (lhs.getInt() > rhs.getInt() ? 1 : 0);
+            case NumberLong:
+                return lhs.getLong() < rhs.getLong() ? -1 : (lhs.getLong() > rhs.getLong() ? 1 : 0);
+            case NumberDouble:
+                // NaN sorts before every other number, which the comparator takes care of.
+                if (!std::isnan(lhs.getDouble()) && !std::isnan(rhs.getDouble())) {
+                    return lhs.getDouble() < rhs.getDouble()
+                        ? -1
+                        : (lhs.getDouble() > rhs.getDouble() ? 1 : 0);
+                }
+                break;
+            default:
+                break;
+        }
+    }
+    return compare.getExpressionContext()->getValueComparator().compare(lhs, rhs);
+}
+
+/**
+ * The following return the result of $add, $subtract or $multiply for operands which are all ints,
+ * longs or doubles, computed exactly as the corresponding Expression would compute it. Return
+ * boost::none for any other operands.
+ */
+boost::optional<Value> fastAdd(const Value* operands, size_t numOperands) {
+    bool haveLong = false;
+    bool haveDouble = false;
+    for (size_t i = 0; i < numOperands; ++i) {
+        switch (operands[i].getType()) {
+            case NumberInt:
+                break;
+            case NumberLong:
+                haveLong = true;
+                break;
+            case NumberDouble:
+                haveDouble = true;
+                break;
+            default:
+                return boost::none;
+        }
+    }
+
+    if (!haveDouble) {
+        long long sum = 0;
+        for (size_t i = 0; i < numOperands; ++i) {
+            if (mongoSignedAddOverflow64(sum, operands[i].coerceToLong(), &sum)) {
+                return boost::none;
+            }
+        }
+        return haveLong ? Value(sum) : Value::createIntOrLong(sum);
+    }
+
+    // $add sums doubles with compensation, which only agrees with plain addition when there are
+    // two finite operands which are exactly representable as doubles.
+    if (numOperands == 2 && !haveLong) {
+        const double lhs = operands[0].coerceToDouble();
+        const double rhs = operands[1].coerceToDouble();
+        const double sum = lhs + rhs;
+        if (std::isfinite(lhs) && std::isfinite(rhs) && std::isfinite(sum)) {
+            return Value(sum);
+        }
+    }
+    return boost::none;
+}
+
+boost::optional<Value> fastSubtract(const Value& lhs, const Value& rhs) {
+    if (!isFastPathNumeric(lhs) || !isFastPathNumeric(rhs)) {
+        return boost::none;
+    }
+
+    switch (Value::getWidestNumeric(rhs.getType(), lhs.getType())) {
+        case NumberDouble:
+            return Value(lhs.coerceToDouble() - rhs.coerceToDouble());
+        case NumberLong:
+            return Value(lhs.coerceToLong() - rhs.coerceToLong());
+        default:
+            return Value::createIntOrLong(lhs.coerceToLong() - rhs.coerceToLong());
+    }
+}
+
+boost::optional<Value> fastMultiply(const Value* operands, size_t numOperands) {
+    double doubleProduct = 1;
+    long long longProduct = 1;
+    BSONType productType = NumberInt;
+    for (size_t i = 0; i < numOperands; ++i) {
+        const auto& operand = operands[i];
+        if (!isFastPathNumeric(operand)) {
+            return boost::none;
+        }
+        productType = Value::getWidestNumeric(productType, operand.getType());
+        doubleProduct *= operand.coerceToDouble();
+        if (mongoSignedMultiplyOverflow64(longProduct, operand.coerceToLong(), &longProduct)) {
+            // The 'longProduct' would have overflowed, so we're abandoning it.
+            productType = NumberDouble;
+        }
+    }
+
+    switch (productType) {
+        case NumberDouble:
+            return Value(doubleProduct);
+        case NumberLong:
+            return Value(longProduct);
+        default:
+            return Value::createIntOrLong(longProduct);
+    }
+}
+
+/**
+ * Returns true if 'expression' can be evaluated before it is needed without changing the outcome,
+ * because it cannot fail.
+ */
+bool cannotFail(const Expression* expression) {
+    if (dynamic_cast<const ExpressionConstant*>(expression)) {
+        return true;
+    }
+    auto fieldPath = dynamic_cast<const ExpressionFieldPath*>(expression);
+    return fieldPath && fieldPath->getVariableId() == Variables::kRootId;
+}
+
+}  // namespace
+
+/**
+ * Lowers an Expression tree into a CompiledExpression. Each sub-expression is compiled into code
+ * which leaves its value in a given register. Registers holding the operands of an instruction are
+ * allocated from a stack, and are released once that instruction has been emitted.
+ */
+class CompiledExpression::Compiler {
+public:
+    explicit Compiler(CompiledExpression* out) : _out(out) {}
+
+    uint32_t allocateRegisters(uint32_t count) {
+        const auto first = _nextRegister;
+        _nextRegister += count;
+        _out->_numRegisters = std::max<size_t>(_out->_numRegisters, _nextRegister);
+        return first;
+    }
+
+    void compile(const boost::intrusive_ptr<Expression>& expression, uint32_t dst) {
+        const auto firstTemporaryRegister = _nextRegister;
+        const auto& children = expression->getChildren();
+
+        if (auto constant = dynamic_cast<ExpressionConstant*>(expression.get())) {
+            _out->_constants.push_back(constant->getValue());
+            emit(OpCode::kLoadConstant, dst, _out->_constants.size() - 1);
+        } else if (auto fieldPath = dynamic_cast<ExpressionFieldPath*>(expression.get());
+                   fieldPath && fieldPath->getVariableId() == Variables::kRootId &&
+                   fieldPath->getFieldPath().getPathLength() > 1) {
+            _out->_paths.push_back(fieldPath->getFieldPathWithoutCurrentPrefix());
+            emit(OpCode::kLoadFieldPath, dst, _out->_paths.size() - 1, 0, addNode(expression));
+        } else if (dynamic_cast<ExpressionCompare*>(expression.get())) {
+            const auto operands = compileOperands(children);
+            emit(OpCode::kCompare, dst, operands, operands + 1, addNode(expression));
+        } else if (dynamic_cast<ExpressionSubtract*>(expression.get())) {
+            const auto operands = compileOperands(children);
+            emit(OpCode::kSubtract, dst, operands, 2, addNode(expression));
+        } else if ((dynamic_cast<ExpressionAdd*>(expression.get()) ||
+                    dynamic_cast<ExpressionMultiply*>(expression.get())) &&
+                   std::all_of(children.begin() + std::min<size_t>(children.size(), 1),
+                               children.end(),
+                               [](auto&& child) { return cannotFail(child.get()); })) {
+            // $add and $multiply stop evaluating their operands at the first null one, so only the
+            // first operand may be one which could fail.
+            const auto operands = compileOperands(children);
+            emit(dynamic_cast<ExpressionAdd*>(expression.get()) ? OpCode::kAdd
+                                                                : OpCode::kMultiply,
+                 dst,
+                 operands,
+                 children.size(),
+                 addNode(expression));
+        } else if (dynamic_cast<ExpressionAnd*>(expression.get()) ||
+                   dynamic_cast<ExpressionOr*>(expression.get())) {
+            // Short-circuit on the first operand which decides the result, leaving each operand in
+            // 'dst' while it is tested.
+            const bool isAnd = dynamic_cast<ExpressionAnd*>(expression.get());
+            std::vector<size_t> shortCircuits;
+            for (auto&& child : children) {
+                compile(child, dst);
+                shortCircuits.push_back(
+                    emit(isAnd ? OpCode::kJumpIfFalse : OpCode::kJumpIfTrue, dst));
+            }
+            emit(OpCode::kLoadBool, dst, isAnd);
+            const auto jumpToEnd = emit(OpCode::kJump);
+            for (auto jump : shortCircuits) {
+                patchJump(jump);
+            }
+            emit(OpCode::kLoadBool, dst, !isAnd);
+            patchJump(jumpToEnd);
+        } else if (dynamic_cast<ExpressionNot*>(expression.get())) {
+            compile(children[0], dst);
+            emit(OpCode::kNot, dst, dst);
+        } else if (dynamic_cast<ExpressionCond*>(expression.get())) {
+            compile(children[0], dst);
+            const auto jumpToElse = emit(OpCode::kJumpIfFalse, dst);
+            compile(children[1], dst);
+            const auto jumpToEnd = emit(OpCode::kJump);
+            patchJump(jumpToElse);
+            compile(children[2], dst);
+            patchJump(jumpToEnd);
+        } else if (dynamic_cast<ExpressionIfNull*>(expression.get())) {
+            compile(children[0], dst);
+            const auto jumpToEnd = emit(OpCode::kJumpIfNotNullish, dst);
+            compile(children[1], dst);
+            patchJump(jumpToEnd);
+        } else {
+            emit(OpCode::kEvaluate, dst, 0, 0, addNode(expression));
+        }
+
+        _nextRegister = firstTemporaryRegister;
+    }
+
+private:
+    /**
+     * Compiles 'operands' into consecutive registers, and returns the first of them.
+     */
+    uint32_t compileOperands(const std::vector<boost::intrusive_ptr<Expression>>& operands) {
+        const auto first = allocateRegisters(operands.size());
+        for (size_t i = 0; i < operands.size(); ++i) {
+            compile(operands[i], first + i);
+        }
+        return first;
+    }
+
+    uint32_t addNode(const boost::intrusive_ptr<Expression>& expression) {
+        _out->_nodes.push_back(expression);
+        return _out->_nodes.size() - 1;
+    }
+
+    size_t emit(OpCode op, uint32_t dst = 0, uint32_t a = 0, uint32_t b = 0, uint32_t node = 0) {
+        _out->_program.push_back({op, dst, a, b, node});
+        return _out->_program.size() - 1;
+    }
+
+    /**
+     * Points the jump at 'jumpIndex' to the next instruction to be emitted.
+     */
+    void patchJump(size_t jumpIndex) {
+        _out->_program[jumpIndex].a = _out->_program.size();
+    }
+
+    CompiledExpression* _out;
+    uint32_t _nextRegister = 0;
+};
+
+std::unique_ptr<CompiledExpression> CompiledExpression::compile(
+    const boost::intrusive_ptr<Expression>& expression) {
+    if (!expression || !internalQueryEnableCompiledExpressions.load()) {
+        return nullptr;
+    }
+
+    std::unique_ptr<CompiledExpression> compiled(new CompiledExpression());
+    Compiler compiler(compiled.get());
+    compiler.compile(expression, compiler.allocateRegisters(1));
+
+    if (compiled->_program.size() == 1 && compiled->_program[0].op == OpCode::kEvaluate) {
+        // Running the program would only add overhead to evaluating the tree.
+        return nullptr;
+    }
+    return compiled;
+}
+
+Value CompiledExpression::evaluate(const Document& root, Variables* variables) const {
+    boost::container::small_vector<Value, kInlineRegisters> registers(_numRegisters);
+
+    size_t pc = 0;
+    while (pc < _program.size()) {
+        const auto& instruction = _program[pc++];
+        auto& dst = registers[instruction.dst];
+        switch (instruction.op) {
+            case OpCode::kLoadConstant:
+                dst = _constants[instruction.a];
+                break;
+            case OpCode::kLoadFieldPath:
+                if (auto value = getNestedFieldWithoutArrays(root, _paths[instruction.a])) {
+                    dst = std::move(*value);
+                } else {
+                    dst = _nodes[instruction.node]->evaluate(root, variables);
+                }
+                break;
+            case OpCode::kEvaluate:
+                dst = _nodes[instruction.node]->evaluate(root, variables);
+                break;
+            case OpCode::kCompare: {
+                const auto& compare =
+                    static_cast<const ExpressionCompare&>(*_nodes[instruction.node]);
+                dst = ExpressionCompare::evaluateCmp(
+                    compare.getOp(),
+                    compareValues(compare, registers[instruction.a], registers[instruction.b]));
+                break;
+            }
+            case OpCode::kAdd:
+            case OpCode::kSubtract:
+            case OpCode::kMultiply: {
+                const Value* operands = &registers[instruction.a];
+                auto result = instruction.op == OpCode::kAdd
+                    ? fastAdd(operands, instruction.b)
+                    : instruction.op == OpCode::kSubtract ? fastSubtract(operands[0], operands[1])
+                                                          : fastMultiply(operands, instruction.b);
+                // Without a fast path for these operands, evaluate the subtree again. Doing so has
+                // no side effects, and is only needed for nulls, dates and decimals.
+                dst = result ? std::move(*result)
+                             : _nodes[instruction.node]->evaluate(root, variables);
+                break;
+            }
+            case OpCode::kNot:
+                dst = Value(!registers[instruction.a].coerceToBool());
+                break;
+            case OpCode::kLoadBool:
+                dst = Value(instruction.a != 0);
+                break;
+            case OpCode::kJump:
+                pc = instruction.a;
+                break;
+            case OpCode::kJumpIfTrue:
+                if (dst.coerceToBool()) {
+                    pc = instruction.a;
+                }
+                break;
+            case OpCode::kJumpIfFalse:
+                if (!dst.coerceToBool()) {
+                    pc = instruction.a;
+                }
+                break;
+            case OpCode::kJumpIfNotNullish:
+                if (!dst.nullish()) {
+                    pc = instruction.a;
+                }
+                break;
+        }
+    }
+    return std::move(registers[0]);
+}
+
+}  // namespace mongo
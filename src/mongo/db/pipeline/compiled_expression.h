@@ -0,0 +1,122 @@
+/**
+ *    Copyright (C) 2019-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <boost/intrusive_ptr.hpp>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "mongo/db/pipeline/expression.h"
+#include "mongo/db/pipeline/field_path.h"
+
+namespace mongo {
+
+/**
+ * A flat program equivalent to an optimized Expression tree, run by a register-based interpreter
+ * rather than by recursive calls to Expression::evaluate(). Field paths rooted at $$ROOT,
+ * comparisons, $add, $subtract, $multiply, $and, $or, $not, $cond and $ifNull are lowered to
+ * instructions with typed fast paths for the common numeric cases. Any other sub-expression is
+ * kept as a single instruction which evaluates that subtree in the usual way.
+ *
+ * The program holds references to the nodes of the tree it was compiled from, so it must be
+ * discarded whenever the tree is optimized or otherwise replaced. Like Expression::evaluate(),
+ * evaluate() may be called from several threads at once as long as each passes its own Variables.
+ */
+class CompiledExpression {
+public:
+    /**
+     * Compiles 'expression', which should already have been optimized. Returns nullptr if
+     * compiled expressions are disabled, or if the program would do no more than evaluate the
+     * tree, in which case the caller should evaluate 'expression' directly.
+     */
+    static std::unique_ptr<CompiledExpression> compile(
+        const boost::intrusive_ptr<Expression>& expression);
+
+    /**
+     * Equivalent to calling evaluate() on the Expression this program was compiled from.
+     */
+    Value evaluate(const Document& root, Variables* variables) const;
+
+    /**
+     * Returns the number of instructions in the program. Exposed for testing.
+     */
+    size_t numInstructions() const {
+        return _program.size();
+    }
+
+private:
+    enum class OpCode : uint8_t {
+        // reg[dst] = constants[a]
+        kLoadConstant,
+        // reg[dst] = the value at paths[a] in the root document. Falls back to evaluating
+        // nodes[node] if the path traverses an array.
+        kLoadFieldPath,
+        // reg[dst] = nodes[node]->evaluate()
+        kEvaluate,
+        // reg[dst] = the comparison nodes[node] applied to reg[a] and reg[b]
+        kCompare,
+        // reg[dst] = the sum, difference or product of the 'b' registers starting at reg[a]. Falls
+        // back to evaluating nodes[node] for operand types without a fast path.
+        kAdd,
+        kSubtract,
+        kMultiply,
+        // reg[dst] = the negation of reg[a] coerced to bool
+        kNot,
+        // reg[dst] = a != 0
+        kLoadBool,
+        // Jumps to instruction 'a', unconditionally or depending on reg[dst].
+        kJump,
+        kJumpIfTrue,
+        kJumpIfFalse,
+        kJumpIfNotNullish,
+    };
+
+    struct Instruction {
+        OpCode op;
+        uint32_t dst = 0;
+        uint32_t a = 0;
+        uint32_t b = 0;
+        uint32_t node = 0;
+    };
+
+    class Compiler;
+
+    CompiledExpression() = default;
+
+    std::vector<Instruction> _program;
+    size_t _numRegisters = 0;
+
+    std::vector<Value> _constants;
+    std::vector<FieldPath> _paths;
+    std::vector<boost::intrusive_ptr<Expression>> _nodes;
+};
+
+}  // namespace mongo
@@ -0,0 +1,174 @@
+/**
+ *    Copyright (C) 2019-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <string>
+#include <vector>
+
+#include "mongo/bson/json.h"
+#include "mongo/db/pipeline/aggregation_context_fixture.h"
+#include "mongo/db/pipeline/compiled_expression.h"
+#include "mongo/db/pipeline/document_value_test_util.h"
+#include "mongo/db/pipeline/expression.h"
+#include "mongo/db/query/collation/collator_interface_mock.h"
+#include "mongo/db/query/query_knobs_gen.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/scopeguard.h"
+
+namespace mongo {
+namespace {
+
+class CompiledExpressionTest : public AggregationContextFixture {
+protected:
+    boost::intrusive_ptr<Expression> parse(const std::string& json) {
+        auto obj = fromjson("{expr: " + json + "}");
+        return Expression::parseOperand(
+                   getExpCtx(), obj.firstElement(), getExpCtx()->variablesParseState)
+            ->optimize();
+    }
+
+    /**
+     * Asserts that the compiled form of 'json' evaluates to the same value, of the same type, as
+     * the tree it was compiled from for every document in 'docs'.
+     */
+    void assertCompiledMatchesTree(const std::string& json, const std::vector<Document>& docs) {
+        auto expression = parse(json);
+        auto compiled = CompiledExpression::compile(expression);
+        ASSERT(compiled);
+        for (auto&& doc : docs) {
+            auto expected = expression->evaluate(doc, &getExpCtx()->variables);
+            auto actual = compiled->evaluate(doc, &getExpCtx()->variables);
+            ASSERT_VALUE_EQ(actual, expected);
+            ASSERT_EQ(actual.getType(), expected.getType());
+        }
+    }
+
+    std::vector<Document> numericDocs() {
+        return {Document(fromjson("{a: 1, b: 2}")),
+                Document(fromjson("{a: 2147483647, b: 1}")),
+                Document(fromjson("{a: NumberLong(9223372036854775807), b: 1}")),
+                Document(fromjson("{a: NumberLong(3), b: 2.5}")),
+                Document(fromjson("{a: 0.1, b: 0.2}")),
+                Document(fromjson("{a: NumberDecimal('1.5'), b: 2}")),
+                Document(fromjson("{a: null, b: 2}")),
+                Document(fromjson("{b: 2}"))};
+    }
+};
+
+TEST_F(CompiledExpressionTest, ArithmeticMatchesTree) {
+    auto docs = numericDocs();
+    assertCompiledMatchesTree("{$multiply: ['$a', '$b']}", docs);
+    assertCompiledMatchesTree("{$multiply: ['$a', '$b', 1.5]}", docs);
+    assertCompiledMatchesTree("{$subtract: ['$b', {$multiply: ['$b', 2]}]}", docs);
+
+    // Dates may be added to and subtracted from, but not multiplied.
+    docs.push_back(Document(fromjson("{a: new Date(1000), b: 5}")));
+    assertCompiledMatchesTree("{$add: ['$a', '$b']}", docs);
+    assertCompiledMatchesTree("{$add: ['$a', '$b', 3]}", docs);
+    assertCompiledMatchesTree("{$subtract: ['$a', '$b']}", docs);
+}
+
+TEST_F(CompiledExpressionTest, ComparisonsMatchTree) {
+    std::vector<Document> docs{Document(fromjson("{a: 1, b: 2}")),
+                               Document(fromjson("{a: 2, b: 2.0}")),
+                               Document(fromjson("{a: NumberLong(5), b: NumberLong(4)}")),
+                               Document(fromjson("{a: NaN, b: 1.0}")),
+                               Document(fromjson("{a: 'x', b: 'y'}")),
+                               Document(fromjson("{a: null}")),
+                               Document(fromjson("{}"))};
+    for (auto&& op : {"$eq", "$ne", "$gt", "$gte", "$lt", "$lte", "$cmp"}) {
+        assertCompiledMatchesTree(std::string("{") + op + ": ['$a', '$b']}", docs);
+    }
+}
+
+TEST_F(CompiledExpressionTest, LogicalAndConditionalOperatorsMatchTree) {
+    std::vector<Document> docs{Document(fromjson("{a: 1, b: 0, c: 'c'}")),
+                               Document(fromjson("{a: 0, b: 1, c: null}")),
+                               Document(fromjson("{a: [], b: false}")),
+                               Document(fromjson("{}"))};
+    assertCompiledMatchesTree("{$and: ['$a', '$b']}", docs);
+    assertCompiledMatchesTree("{$or: ['$a', '$b']}", docs);
+    assertCompiledMatchesTree("{$not: ['$a']}", docs);
+    assertCompiledMatchesTree("{$cond: [{$gt: ['$a', '$b']}, '$c', {$not: ['$b']}]}", docs);
+    assertCompiledMatchesTree("{$ifNull: ['$c', '$a']}", docs);
+}
+
+TEST_F(CompiledExpressionTest, FieldPathsMatchTree) {
+    std::vector<Document> docs{Document(fromjson("{a: {b: {c: 1}}}")),
+                               Document(fromjson("{a: [{b: {c: 1}}, {b: [{c: 2}, {d: 3}]}, 4]}")),
+                               Document(fromjson("{a: {b: 5}}")),
+                               Document(fromjson("{a: 1}")),
+                               Document(fromjson("{}"))};
+    assertCompiledMatchesTree("{$eq: ['$a.b.c', 1]}", docs);
+    assertCompiledMatchesTree("{$ifNull: ['$a.b', '$$ROOT']}", docs);
+}
+
+TEST_F(CompiledExpressionTest, DoesNotEvaluateOperandsTheTreeWouldSkip) {
+    Document doc(fromjson("{a: false, b: null, zero: 0}"));
+    auto& variables = getExpCtx()->variables;
+
+    for (auto&& json : {"{$and: ['$a', {$divide: [1, '$zero']}]}",
+                        "{$cond: ['$a', {$divide: [1, '$zero']}, 1]}",
+                        "{$ifNull: [1, {$divide: [1, '$zero']}]}",
+                        "{$add: ['$b', {$divide: [1, '$zero']}]}",
+                        "{$multiply: ['$b', {$divide: [1, '$zero']}]}"}) {
+        auto expression = parse(json);
+        auto compiled = CompiledExpression::compile(expression);
+        ASSERT(compiled);
+        ASSERT_VALUE_EQ(compiled->evaluate(doc, &variables), expression->evaluate(doc, &variables));
+    }
+}
+
+TEST_F(CompiledExpressionTest, ComparisonsRespectCollation) {
+    CollatorInterfaceMock collator(CollatorInterfaceMock::MockType::kAlwaysEqual);
+    getExpCtx()->setCollator(&collator);
+
+    auto expression = parse("{$eq: ['$a', '$b']}");
+    auto compiled = CompiledExpression::compile(expression);
+    ASSERT(compiled);
+    ASSERT_VALUE_EQ(compiled->evaluate(Document(fromjson("{a: 'abc', b: 'def'}")),
+                                       &getExpCtx()->variables),
+                    Value(true));
+}
+
+TEST_F(CompiledExpressionTest, IsNotCompiledWhenItWouldOnlyEvaluateTheTree) {
+    ASSERT_FALSE(CompiledExpression::compile(parse("{$concat: ['$a', '$b']}")));
+}
+
+TEST_F(CompiledExpressionTest, IsNotCompiledWhenDisabled) {
+    const auto wasEnabled = internalQueryEnableCompiledExpressions.load();
+    internalQueryEnableCompiledExpressions.store(false);
+    ON_BLOCK_EXIT([&] { internalQueryEnableCompiledExpressions.store(wasEnabled); });
+
+    ASSERT_FALSE(CompiledExpression::compile(parse("{$add: ['$a', '$b']}")));
+}
+
+}  // namespace
+}  // namespace mongo
@@ -35,7 +35,9 @@
 
 #include "mongo/bson/bson_depth.h"
 #include "mongo/db/jsobj.h"
+#include "mongo/db/pipeline/document_buffer_cache.h"
 #include "mongo/db/pipeline/field_path.h"
+#include "mongo/util/scopeguard.h"
 #include "mongo/util/str.h"
 
 namespace mongo {
@@ -246,6 +248,7 @@ void DocumentStorage::alloc(unsigned newSize) {
     const bool firstAlloc = !_cache;
     const bool doingRehash = needRehash();
     const size_t oldCapacity = _cacheEnd - _cache;
+    const size_t oldAllocatedBytes = allocatedBytes();
 
     // make new bucket count big enough
     while (needRehash() || hashTabBuckets() < HASH_TAB_INIT_SIZE)
@@ -258,13 +261,14 @@ void DocumentStorage::alloc(unsigned newSize) {
 
     uassert(16490, "Tried to make oversized document", capacity <= size_t(BufferMaxSize));
 
-    std::unique_ptr<char[]> oldBuf(_cache);
-    _cache = new char[capacity];
+    char* const oldBuf = _cache;
+    ON_BLOCK_EXIT([&] { DocumentBufferCache::deallocate(oldBuf, oldAllocatedBytes); });
+    _cache = DocumentBufferCache::allocate(capacity);
     _cacheEnd = _cache + capacity - hashTabBytes();
 
     if (!firstAlloc) {
         // This just copies the elements
-        memcpy(_cache, oldBuf.get(), _usedBytes);
+        memcpy(_cache, oldBuf, _usedBytes);
 
         if (_numFields >= HASH_TAB_MIN) {
             // if we were hashing, deal with the hash table
@@ -272,7 +276,7 @@ void DocumentStorage::alloc(unsigned newSize) {
                 rehash();
             } else {
                 // no rehash needed so just slide table down to new position
-                memcpy(_hashTab, oldBuf.get() + oldCapacity, hashTabBytes());
+                memcpy(_hashTab, oldBuf + oldCapacity, hashTabBytes());
             }
         }
     }
@@ -291,7 +295,7 @@ void DocumentStorage::reserveFields(size_t expectedFields) {
 
     uassert(16491, "Tried to make oversized document", newSize <= size_t(BufferMaxSize));
 
-    _cache = new char[newSize + hashTabBytes()];
+    _cache = DocumentBufferCache::allocate(newSize + hashTabBytes());
     _cacheEnd = _cache + newSize;
 }
 
@@ -302,7 +306,7 @@ intrusive_ptr<DocumentStorage> DocumentStorage::clone() const {
         // Make a copy of the buffer with the fields.
         // It is very important that the positions of each field are the same after cloning.
         const size_t bufferBytes = allocatedBytes();
-        out->_cache = new char[bufferBytes];
+        out->_cache = DocumentBufferCache::allocate(bufferBytes);
         out->_cacheEnd = out->_cache + (_cacheEnd - _cache);
         memcpy(out->_cache, _cache, bufferBytes);
 
@@ -333,11 +337,11 @@ size_t DocumentStorage::getMetadataApproximateSize() const {
 }
 
 DocumentStorage::~DocumentStorage() {
-    std::unique_ptr<char[]> deleteBufferAtScopeEnd(_cache);
-
     for (auto it = iteratorCacheOnly(); !it.atEnd(); it.advance()) {
         it->val.~Value();  // explicit destructor call
     }
+
+    DocumentBufferCache::deallocate(_cache, allocatedBytes());
 }
 
 void DocumentStorage::reset(const BSONObj& bson, bool stripMetadata) {
@@ -351,7 +355,11 @@ void DocumentStorage::reset(const BSONObj& bson, bool stripMetadata) {
         it->val.~Value();  // explicit destructor call
     }
 
-    _cacheEnd = _cache;
+    // Give the buffer back rather than keeping it, since its capacity is not tracked once the
+    // hash table is reset. The next field added will allocate a right-sized one.
+    DocumentBufferCache::deallocate(_cache, allocatedBytes());
+    _cache = nullptr;
+    _cacheEnd = nullptr;
     _usedBytes = 0;
     _numFields = 0;
     _hashTabMask = 0;
@@ -0,0 +1,110 @@
+/**
+ *    Copyright (C) 2019-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include <benchmark/benchmark.h>
+#include <boost/optional.hpp>
+#include <vector>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/pipeline/document.h"
+#include "mongo/db/pipeline/document_buffer_cache.h"
+#include "mongo/util/str.h"
+
+namespace mongo {
+namespace {
+
+// Matches the default number of documents in the first batch of an aggregate.
+constexpr int kBatchSize = 101;
+
+std::vector<BSONObj> makeInputs(int numFields) {
+    std::vector<BSONObj> inputs;
+    for (int i = 0; i < kBatchSize; ++i) {
+        BSONObjBuilder bob;
+        bob.append("_id", i);
+        for (int j = 0; j < numFields; ++j) {
+            bob.append(str::stream() << "field" << j, i * j);
+        }
+        inputs.push_back(bob.obj());
+    }
+    return inputs;
+}
+
+/**
+ * Does the Document work of {$addFields: {total: ...}} followed by {$project: {_id: 0, field0: 1,
+ * total: 1}} for one input, then serializes the result the way a cursor batch would.
+ */
+BSONObj addFieldsThenProject(const BSONObj& input) {
+    Document inputDoc(input);
+
+    MutableDocument withTotal(inputDoc);
+    withTotal.addField("total", Value(inputDoc["field0"].coerceToLong() + 1));
+    Document added = withTotal.freeze();
+
+    MutableDocument projected;
+    projected.addField("field0", added["field0"]);
+    projected.addField("total", added["total"]);
+    return projected.freeze().toBson();
+}
+
+void runBatches(benchmark::State& state, bool useBufferCache) {
+    const auto inputs = makeInputs(state.range(0));
+    const auto callsBefore = DocumentBufferCache::allocatorCallsOnThisThread();
+
+    for (auto _ : state) {
+        boost::optional<DocumentBufferCache::Scope> batchScope;
+        if (useBufferCache) {
+            batchScope.emplace();
+        }
+        for (auto&& input : inputs) {
+            benchmark::DoNotOptimize(addFieldsThenProject(input));
+        }
+    }
+
+    const auto allocatorCalls = DocumentBufferCache::allocatorCallsOnThisThread() - callsBefore;
+    state.SetItemsProcessed(state.iterations() * kBatchSize);
+    state.counters["allocatorCallsPerDoc"] =
+        static_cast<double>(allocatorCalls) / (state.iterations() * kBatchSize);
+}
+
+void BM_addFieldsProjectBatch(benchmark::State& state) {
+    runBatches(state, false);
+}
+
+void BM_addFieldsProjectBatchWithBufferCache(benchmark::State& state) {
+    runBatches(state, true);
+}
+
+BENCHMARK(BM_addFieldsProjectBatch)->Arg(4)->Arg(16)->Arg(64);
+BENCHMARK(BM_addFieldsProjectBatchWithBufferCache)->Arg(4)->Arg(16)->Arg(64);
+
+}  // namespace
+}  // namespace mongo
@@ -0,0 +1,143 @@
+/**
+ *    Copyright (C) 2018-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/document_buffer_cache.h"
+
+#include <array>
+#include <vector>
+
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+namespace {
+
+constexpr size_t kNumSizeClasses = 8;  // 128, 256, ..., 16KB
+static_assert(DocumentBufferCache::kMinCachedBytes << (kNumSizeClasses - 1) ==
+                  DocumentBufferCache::kMaxCachedBytes,
+              "size classes must cover [kMinCachedBytes, kMaxCachedBytes]");
+
+struct ThreadBufferCache {
+    ~ThreadBufferCache() {
+        release();
+    }
+
+    void release() {
+        for (auto&& freeList : freeLists) {
+            for (char* buffer : freeList) {
+                delete[] buffer;
+            }
+            freeList.clear();
+        }
+    }
+
+    int scopeDepth = 0;
+    uint64_t allocatorCalls = 0;
+    std::array<std::vector<char*>, kNumSizeClasses> freeLists;
+};
+
+thread_local ThreadBufferCache threadCache;
+
+/**
+ * Returns the free list index for a buffer of 'bytes', or -1 if buffers of that size are not
+ * cached.
+ */
+int sizeClass(size_t bytes) {
+    if (bytes < DocumentBufferCache::kMinCachedBytes ||
+        bytes > DocumentBufferCache::kMaxCachedBytes || (bytes & (bytes - 1)) != 0) {
+        return -1;
+    }
+
+    int index = 0;
+    for (size_t size = DocumentBufferCache::kMinCachedBytes; size < bytes; size *= 2) {
+        ++index;
+    }
+    return index;
+}
+
+}  // namespace
+
+DocumentBufferCache::Scope::Scope() {
+    auto& cache = threadCache;
+    if (cache.scopeDepth == 0) {
+        // Size the free lists up front so that deallocate(), which runs from DocumentStorage's
+        // destructor, never has to allocate. release() keeps their capacity for later scopes.
+        for (auto&& freeList : cache.freeLists) {
+            freeList.reserve(kMaxCachedBuffersPerSize);
+        }
+    }
+    ++cache.scopeDepth;
+}
+
+DocumentBufferCache::Scope::~Scope() {
+    invariant(threadCache.scopeDepth > 0);
+    if (--threadCache.scopeDepth == 0) {
+        threadCache.release();
+    }
+}
+
+char* DocumentBufferCache::allocate(size_t bytes) {
+    auto& cache = threadCache;
+    if (cache.scopeDepth > 0) {
+        const int index = sizeClass(bytes);
+        if (index >= 0 && !cache.freeLists[index].empty()) {
+            char* buffer = cache.freeLists[index].back();
+            cache.freeLists[index].pop_back();
+            return buffer;
+        }
+    }
+
+    ++cache.allocatorCalls;
+    return new char[bytes];
+}
+
+void DocumentBufferCache::deallocate(char* buffer, size_t bytes) {
+    if (!buffer) {
+        return;
+    }
+
+    auto& cache = threadCache;
+    if (cache.scopeDepth > 0) {
+        const int index = sizeClass(bytes);
+        if (index >= 0 && cache.freeLists[index].size() < kMaxCachedBuffersPerSize) {
+            // Within the capacity reserved by Scope, so this does not allocate or throw.
+            cache.freeLists[index].push_back(buffer);
+            return;
+        }
+    }
+
+    delete[] buffer;
+}
+
+uint64_t DocumentBufferCache::allocatorCallsOnThisThread() {
+    return threadCache.allocatorCalls;
+}
+
+}  // namespace mongo
@@ -0,0 +1,87 @@
+/**
+ *    Copyright (C) 2019-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace mongo {
+
+/**
+ * Supplies the buffers that DocumentStorage uses to hold its cached fields and hash table.
+ *
+ * Outside of a Scope, allocate() and deallocate() simply forward to operator new[] and operator
+ * delete[]. While a Scope is alive on the current thread, buffers released on that thread are kept
+ * in per-size free lists and handed back out to later documents built on the same thread, so a
+ * pipeline which builds a new Document for each input (e.g. $project or $addFields) stops going
+ * through the allocator for every result once the first few documents of the batch have been
+ * released. Everything still held by the cache is freed when the outermost Scope ends.
+ *
+ * Every buffer is still an ordinary new[] block, so a Document which outlives its batch or is
+ * released on a different thread remains valid and is freed normally.
+ */
+class DocumentBufferCache {
+public:
+    /**
+     * Enables buffer reuse on the current thread for the lifetime of this object. Scopes may be
+     * nested; the cached buffers are released when the outermost one is destroyed.
+     */
+    class Scope {
+    public:
+        Scope();
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+
+    // Only power-of-two buffers in [kMinCachedBytes, kMaxCachedBytes] are cached, which covers
+    // every buffer DocumentStorage::alloc() makes for documents of a reasonable size.
+    static constexpr size_t kMinCachedBytes = 128;
+    static constexpr size_t kMaxCachedBytes = 16 * 1024;
+
+    // Maximum number of free buffers kept for each size.
+    static constexpr size_t kMaxCachedBuffersPerSize = 64;
+
+    static char* allocate(size_t bytes);
+
+    /**
+     * Releases a buffer returned by allocate(). 'bytes' must be the size it was allocated with.
+     */
+    static void deallocate(char* buffer, size_t bytes);
+
+    /**
+     * Returns how many times allocate() had to call into the allocator on the current thread.
+     * Intended for tests and benchmarks.
+     */
+    static uint64_t allocatorCallsOnThisThread();
+};
+
+}  // namespace mongo
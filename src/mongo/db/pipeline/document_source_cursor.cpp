@@ -34,6 +34,7 @@
 #include "mongo/db/pipeline/document_source_cursor.h"
 
 #include "mongo/db/catalog/collection.h"
+#include "mongo/db/exec/plan_stage.h"
 #include "mongo/db/exec/working_set_common.h"
 #include "mongo/db/pipeline/document.h"
 #include "mongo/db/query/collection_query_info.h"
@@ -207,6 +208,10 @@ void DocumentSourceCursor::recordPlanSummaryStats() {
     _planSummaryStats.hasSortStage = hasSortStage;
 }
 
+bool DocumentSourceCursor::isCollectionScan() const {
+    return _exec && _exec->getRootStage()->stageType() == STAGE_COLLSCAN;
+}
+
 Value DocumentSourceCursor::serialize(boost::optional<ExplainOptions::Verbosity> verbosity) const {
     // We never parse a DocumentSourceCursor, so we only serialize for explain.
     if (!verbosity)
@@ -99,6 +99,10 @@ public:
         _query = query;
     }
 
+    const BSONObj& getQuery() const {
+        return _query;
+    }
+
     /*
       Record the sort that was specified for the cursor this wraps, if
       any.
@@ -156,6 +160,12 @@ public:
         return _planSummaryStats;
     }
 
+    /**
+     * Returns true if the underlying query plan is a lone collection scan, i.e. if this stage reads
+     * its collection in natural order without the help of an index and without sorting.
+     */
+    bool isCollectionScan() const;
+
 protected:
     DocumentSourceCursor(Collection* collection,
                          std::unique_ptr<PlanExecutor, PlanExecutor::Deleter> exec,
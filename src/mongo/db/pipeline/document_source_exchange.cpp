@@ -35,10 +35,15 @@
 #include <iterator>
 #include <set>
 
+#include "mongo/db/client.h"
 #include "mongo/db/curop.h"
 #include "mongo/db/hasher.h"
 #include "mongo/db/pipeline/document_source_exchange.h"
+#include "mongo/db/query/query_knobs_gen.h"
+#include "mongo/db/service_context.h"
 #include "mongo/db/storage/key_string.h"
+#include "mongo/util/concurrency/thread_pool.h"
+#include "mongo/util/destructor_guard.h"
 #include "mongo/util/log.h"
 
 namespace mongo {
@@ -486,4 +491,238 @@ bool Exchange::ExchangeBuffer::appendDocument(DocumentSource::GetNextResult inpu
     return _bytesInBuffer >= limit;
 }
 
+namespace {
+
+/**
+ * The pool running the consumers of every DocumentSourceExchangeGather of the process.
+ */
+struct ExchangeGatherExecutor {
+    std::unique_ptr<ThreadPool> threadPool;
+};
+
+const auto exchangeGatherExecutor = ServiceContext::declareDecoration<ExchangeGatherExecutor>();
+const ServiceContext::ConstructorActionRegisterer exchangeGatherExecutorRegisterer{
+    "ExchangeGatherExecutor",
+    [](ServiceContext* service) {
+        ThreadPool::Options options;
+        options.poolName = "ExchangeGather";
+        options.minThreads = 0;
+        options.maxThreads = internalDocumentSourceGroupParallelMaxThreads.load();
+        auto& pool = exchangeGatherExecutor(service).threadPool;
+        pool = std::make_unique<ThreadPool>(std::move(options));
+        pool->startup();
+    },
+    [](ServiceContext* service) {
+        auto& pool = exchangeGatherExecutor(service).threadPool;
+        pool->shutdown();
+        pool->join();
+    }};
+
+}  // namespace
+
+const char* DocumentSourceExchangeGather::getSourceName() const {
+    return kStageName.rawData();
+}
+
+Value DocumentSourceExchangeGather::serialize(
+    boost::optional<ExplainOptions::Verbosity> explain) const {
+    return Value(DOC(getSourceName() << DOC("consumers" << static_cast<int>(_consumers.size()))));
+}
+
+DocumentSourceExchangeGather::DocumentSourceExchangeGather(
+    const boost::intrusive_ptr<ExpressionContext>& expCtx,
+    std::vector<std::unique_ptr<Pipeline, PipelineDeleter>> consumers,
+    size_t maxBufferSize)
+    : DocumentSource(kStageName, expCtx),
+      _consumers(std::move(consumers)),
+      _maxBufferSize(maxBufferSize),
+      _consumerClaimed(_consumers.size(), false),
+      _consumerOpCtxs(_consumers.size(), nullptr) {
+    invariant(!_consumers.empty());
+}
+
+DocumentSourceExchangeGather::~DocumentSourceExchangeGather() {
+    DESTRUCTOR_GUARD(stopConsumers());
+}
+
+void DocumentSourceExchangeGather::forEachIdleConsumer(
+    const std::function<void(const Pipeline&)>& callback) const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    for (size_t idx = 0; idx < _consumers.size(); ++idx) {
+        if (!_consumerOpCtxs[idx]) {
+            callback(*_consumers[idx]);
+        }
+    }
+}
+
+DocumentSource::GetNextResult DocumentSourceExchangeGather::doGetNext() {
+    if (!_started) {
+        startConsumers();
+    }
+
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    pExpCtx->opCtx->waitForConditionOrInterrupt(_haveResults, lk, [&] {
+        return !_buffer.empty() || !_consumerError.isOK() || _runningConsumers == 0;
+    });
+    uassertStatusOK(_consumerError);
+
+    if (_buffer.empty()) {
+        return GetNextResult::makeEOF();
+    }
+
+    auto doc = std::move(_buffer.front());
+    _buffer.pop_front();
+    _bytesInBuffer -= doc.getApproximateSize();
+    _haveBufferSpace.notify_all();
+
+    return std::move(doc);
+}
+
+void DocumentSourceExchangeGather::doDispose() {
+    stopConsumers();
+
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _buffer.clear();
+    _bytesInBuffer = 0;
+}
+
+void DocumentSourceExchangeGather::startConsumers() {
+    _started = true;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _runningConsumers = _consumers.size();
+    }
+
+    // The consumer pipelines are handed over to the pool threads, which attach them to operation
+    // contexts of their own.
+    for (auto&& pipeline : _consumers) {
+        pipeline->detachFromOperationContext();
+    }
+
+    // Every task holds a reference to this stage, so that a task which is still waiting for a pool
+    // thread when the consumers are stopped can find out that its consumer has been disposed of.
+    auto serviceContext = pExpCtx->opCtx->getServiceContext();
+    auto pool = exchangeGatherExecutor(serviceContext).threadPool.get();
+    for (size_t idx = 0; idx < _consumers.size(); ++idx) {
+        pool->schedule([gather = boost::intrusive_ptr<DocumentSourceExchangeGather>(this),
+                        serviceContext,
+                        idx](Status status) {
+            if (status.isOK()) {
+                gather->runConsumer(serviceContext, idx);
+                return;
+            }
+
+            // The pool is shutting down and runs the task on the thread which scheduled it.
+            {
+                stdx::lock_guard<stdx::mutex> lk(gather->_mutex);
+                gather->_consumerClaimed[idx] = true;
+            }
+            auto opCtx = gather->pExpCtx->opCtx;
+            gather->_consumers[idx]->reattachToOperationContext(opCtx);
+            gather->finishConsumer(opCtx, idx, std::move(status));
+        });
+    }
+}
+
+void DocumentSourceExchangeGather::runConsumer(ServiceContext* serviceContext, size_t consumerId) {
+    ThreadClient client(std::string{str::stream() << "exchangeGather-" << consumerId},
+                        serviceContext);
+    auto opCtx = client->makeOperationContext();
+
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        if (_consumerClaimed[consumerId]) {
+            // The consumer has been disposed of by stopConsumers() before this task started.
+            return;
+        }
+        _consumerClaimed[consumerId] = true;
+        _consumerOpCtxs[consumerId] = opCtx.get();
+    }
+
+    auto& pipeline = _consumers[consumerId];
+    pipeline->reattachToOperationContext(opCtx.get());
+
+    Status status = Status::OK();
+    try {
+        for (auto next = pipeline->getNext(); next; next = pipeline->getNext()) {
+            stdx::unique_lock<stdx::mutex> lk(_mutex);
+            _haveBufferSpace.wait(lk, [&] { return _stopping || _bytesInBuffer < _maxBufferSize; });
+            if (_stopping) {
+                break;
+            }
+
+            // The result is read by a different thread, so hand over a copy of the Document which
+            // is not referenced by this consumer anymore.
+            auto doc = next->clone();
+            _bytesInBuffer += doc.getApproximateSize();
+            _buffer.push_back(std::move(doc));
+            _haveResults.notify_one();
+        }
+    } catch (const DBException& ex) {
+        status = ex.toStatus();
+    }
+
+    finishConsumer(opCtx.get(), consumerId, std::move(status));
+}
+
+void DocumentSourceExchangeGather::finishConsumer(OperationContext* opCtx,
+                                                  size_t consumerId,
+                                                  Status status) {
+    auto& pipeline = _consumers[consumerId];
+    pipeline->dispose(opCtx);
+    pipeline.get_deleter().dismissDisposal();
+    pipeline->detachFromOperationContext();
+
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _consumerOpCtxs[consumerId] = nullptr;
+
+    // Prefer reporting the error which caused the consumers to fail over the errors it was
+    // propagated as to the other consumers.
+    if (!status.isOK() && !_stopping &&
+        (_consumerError.isOK() || _consumerError == ErrorCodes::ExchangePassthrough)) {
+        _consumerError = std::move(status);
+    }
+    --_runningConsumers;
+    _haveResults.notify_all();
+}
+
+void DocumentSourceExchangeGather::stopConsumers() {
+    if (!_started) {
+        // The consumer pipelines have never been run, but they must release their resources using
+        // the current operation context.
+        for (auto&& pipeline : _consumers) {
+            pipeline->dispose(pExpCtx->opCtx);
+            pipeline.get_deleter().dismissDisposal();
+        }
+        _started = true;
+        return;
+    }
+
+    std::vector<size_t> unclaimedConsumers;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _stopping = true;
+        for (size_t idx = 0; idx < _consumers.size(); ++idx) {
+            if (auto opCtx = _consumerOpCtxs[idx]) {
+                stdx::lock_guard<Client> clientLock(*opCtx->getClient());
+                opCtx->getServiceContext()->killOperation(clientLock, opCtx);
+            } else if (!_consumerClaimed[idx]) {
+                _consumerClaimed[idx] = true;
+                unclaimedConsumers.push_back(idx);
+            }
+        }
+        _haveBufferSpace.notify_all();
+    }
+
+    // Rather than waiting for a pool thread, dispose of the consumers which have not started yet
+    // right here. Their tasks return as soon as they run.
+    for (auto idx : unclaimedConsumers) {
+        _consumers[idx]->reattachToOperationContext(pExpCtx->opCtx);
+        finishConsumer(pExpCtx->opCtx, idx, Status::OK());
+    }
+
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    _haveResults.wait(lk, [&] { return _runningConsumers == 0; });
+}
+
 }  // namespace mongo
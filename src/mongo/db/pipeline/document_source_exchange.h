@@ -30,6 +30,7 @@
 #pragma once
 
 #include <deque>
+#include <functional>
 #include <vector>
 
 #include "mongo/bson/ordering.h"
@@ -258,4 +259,135 @@ private:
     std::unique_ptr<ResourceYielder> _resourceYielder;
 };
 
+/**
+ * Runs a set of consumer pipelines to completion on the threads of a pool shared by all operations
+ * and returns the union of their results in no particular order. The consumers are typically
+ * $cursor stages scanning disjoint RecordId ranges of a collection, each followed by a $group
+ * producing partial groups, which allows a single operation to use several cores. Every consumer
+ * runs under its own Client and OperationContext, hence the consumer pipelines must not share their
+ * ExpressionContexts with each other or with this stage.
+ *
+ * The size of the pool is set by the internalDocumentSourceGroupParallelMaxThreads startup
+ * parameter. Consumers which find all pool threads busy are queued until a thread is available, so
+ * consumers which wait for each other, such as the consumers of one Exchange, must not outnumber
+ * the pool threads.
+ */
+class DocumentSourceExchangeGather final : public DocumentSource {
+public:
+    static constexpr StringData kStageName = "$_internalExchangeGather"_sd;
+
+    /**
+     * Creates a stage gathering the results of 'consumers', which must be attached to the
+     * OperationContext of 'expCtx'. At most 'maxBufferSize' bytes of results are buffered before
+     * the consumers are blocked.
+     */
+    DocumentSourceExchangeGather(const boost::intrusive_ptr<ExpressionContext>& expCtx,
+                                 std::vector<std::unique_ptr<Pipeline, PipelineDeleter>> consumers,
+                                 size_t maxBufferSize);
+
+    ~DocumentSourceExchangeGather();
+
+    StageConstraints constraints(Pipeline::SplitState pipeState) const final {
+        StageConstraints constraints(StreamType::kStreaming,
+                                     PositionRequirement::kFirst,
+                                     HostTypeRequirement::kNone,
+                                     DiskUseRequirement::kNoDiskUse,
+                                     FacetRequirement::kNotAllowed,
+                                     TransactionRequirement::kNotAllowed,
+                                     LookupRequirement::kNotAllowed);
+        constraints.requiresInputDocSource = false;
+        return constraints;
+    }
+
+    boost::optional<DistributedPlanLogic> distributedPlanLogic() final {
+        return boost::none;
+    }
+
+    const char* getSourceName() const final;
+
+    Value serialize(boost::optional<ExplainOptions::Verbosity> explain = boost::none) const final;
+
+    /**
+     * DocumentSourceExchangeGather does not have a direct source (it is reading the results of the
+     * consumer pipelines).
+     */
+    void setSource(DocumentSource* source) final {
+        invariant(!source);
+    }
+
+    size_t getConsumers() const {
+        return _consumers.size();
+    }
+
+    /**
+     * Calls 'callback' on every consumer pipeline which is not running at the moment, i.e. which
+     * has not been started yet, is waiting for a pool thread or has finished. The state of a
+     * running consumer pipeline must not be read from another thread, so it is skipped.
+     */
+    void forEachIdleConsumer(const std::function<void(const Pipeline&)>& callback) const;
+
+private:
+    GetNextResult doGetNext() final;
+
+    void doDispose() final;
+
+    /**
+     * Schedules every consumer pipeline on the shared thread pool.
+     */
+    void startConsumers();
+
+    /**
+     * Pulls all results out of the consumer pipeline identified by 'consumerId' and appends them to
+     * '_buffer'. Runs on a thread of the shared pool, and returns right away if the consumer has
+     * already been disposed of by stopConsumers().
+     */
+    void runConsumer(ServiceContext* serviceContext, size_t consumerId);
+
+    /**
+     * Disposes of the consumer pipeline identified by 'consumerId' using 'opCtx' and records that
+     * it has finished with 'status'.
+     */
+    void finishConsumer(OperationContext* opCtx, size_t consumerId, Status status);
+
+    /**
+     * Interrupts all consumers which are still running, disposes of the ones which have not got a
+     * pool thread yet, and waits for all of them to finish.
+     */
+    void stopConsumers();
+
+    std::vector<std::unique_ptr<Pipeline, PipelineDeleter>> _consumers;
+
+    // The maximum number of bytes buffered in '_buffer'.
+    const size_t _maxBufferSize;
+
+    // Synchronization between the consumers and the thread calling getNext().
+    mutable stdx::mutex _mutex;
+    stdx::condition_variable _haveResults;
+    stdx::condition_variable _haveBufferSpace;
+
+    std::deque<Document> _buffer;
+    size_t _bytesInBuffer{0};
+
+    bool _started{false};
+
+    // The number of consumers which have not finished yet, including the ones still waiting for a
+    // pool thread.
+    size_t _runningConsumers{0};
+
+    // The first error encountered by a consumer. Once set, getNext() throws it.
+    Status _consumerError{Status::OK()};
+
+    // Set when the consumers must stop early, e.g. because this stage is disposed of before they
+    // have been exhausted.
+    bool _stopping{false};
+
+    // Set for every consumer which has been taken over by a pool thread, or which has been disposed
+    // of because the consumers were stopped before it got a pool thread.
+    std::vector<bool> _consumerClaimed;
+
+    // The operation contexts of the consumers which are running on a pool thread, so that they can
+    // be interrupted. A consumer pipeline is only accessed by its pool thread while it is set.
+    std::vector<OperationContext*> _consumerOpCtxs;
+};
+
 }  // namespace mongo
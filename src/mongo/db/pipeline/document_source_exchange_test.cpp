@@ -30,9 +30,13 @@
 #include "mongo/platform/basic.h"
 
 #include "mongo/db/hasher.h"
+#include "mongo/db/json.h"
 #include "mongo/db/pipeline/aggregation_context_fixture.h"
 #include "mongo/db/pipeline/document_source_exchange.h"
+#include "mongo/db/pipeline/document_source_group.h"
 #include "mongo/db/pipeline/document_source_mock.h"
+#include "mongo/db/pipeline/document_value_test_util.h"
+#include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/db/storage/key_string.h"
 #include "mongo/executor/network_interface_factory.h"
 #include "mongo/executor/thread_pool_task_executor.h"
@@ -641,6 +645,128 @@ TEST_F(DocumentSourceExchangeTest, RangeRandomHashExchangeNConsumer) {
     ASSERT_EQ(nDocs, processedDocs.load());
 }
 
+TEST_F(DocumentSourceExchangeTest, GatherMergesPartialGroupsOfAllConsumers) {
+    const size_t nDocs = 500;
+    const size_t nConsumers = 4;
+    const int nGroups = 10;
+
+    auto source = DocumentSourceMock::createForTest();
+    for (size_t i = 0; i < nDocs; ++i) {
+        source->emplace_back(Document{{"a", static_cast<int>(i % nGroups)}, {"b", 1}});
+    }
+
+    ExchangeSpec spec;
+    spec.setPolicy(ExchangePolicyEnum::kRoundRobin);
+    spec.setConsumers(nConsumers);
+    spec.setBufferSize(1024);
+
+    boost::intrusive_ptr<Exchange> ex =
+        new Exchange(spec, unittest::assertGet(Pipeline::create({source}, getExpCtx())));
+
+    unittest::TempDir tempDir("DocumentSourceExchangeTest");
+    const BSONObj groupSpec =
+        fromjson("{$group: {_id: '$a', sum: {$sum: '$b'}, avg: {$avg: '$b'}}}");
+
+    // Every consumer computes partial groups over its share of the documents.
+    std::vector<std::unique_ptr<Pipeline, PipelineDeleter>> consumers;
+    for (size_t idx = 0; idx < nConsumers; ++idx) {
+        boost::intrusive_ptr<ExpressionContext> consumerExpCtx =
+            new ExpressionContext(getExpCtx()->opCtx, nullptr);
+        consumerExpCtx->mongoProcessInterface =
+            std::make_shared<StubMongoProcessOkWithOpCtxChanges>();
+        consumerExpCtx->tempDir = tempDir.path();
+        consumerExpCtx->needsMerge = true;
+
+        boost::intrusive_ptr<DocumentSource> consumer =
+            new DocumentSourceExchange(consumerExpCtx, ex, idx, nullptr);
+        auto partialGroup =
+            DocumentSourceGroup::createFromBson(groupSpec.firstElement(), consumerExpCtx);
+        consumers.emplace_back(
+            unittest::assertGet(Pipeline::create({consumer, partialGroup}, consumerExpCtx)));
+    }
+
+    getExpCtx()->tempDir = tempDir.path();
+    auto group = DocumentSourceGroup::createFromBson(groupSpec.firstElement(), getExpCtx());
+    auto mergingGroup = group->distributedPlanLogic()->mergingStage;
+
+    boost::intrusive_ptr<DocumentSourceExchangeGather> gather =
+        new DocumentSourceExchangeGather(getExpCtx(), std::move(consumers), 1024);
+    mergingGroup->setSource(gather.get());
+
+    std::set<int> seenGroups;
+    auto next = mergingGroup->getNext();
+    for (; next.isAdvanced(); next = mergingGroup->getNext()) {
+        auto doc = next.releaseDocument();
+        ASSERT_TRUE(seenGroups.insert(doc["_id"].getInt()).second);
+        ASSERT_VALUE_EQ(doc["sum"], Value(static_cast<int>(nDocs / nGroups)));
+        ASSERT_VALUE_EQ(doc["avg"], Value(1.0));
+    }
+    ASSERT_TRUE(next.isEOF());
+    ASSERT_EQ(seenGroups.size(), static_cast<size_t>(nGroups));
+}
+
+TEST_F(DocumentSourceExchangeTest, GatherCanBeDisposedBeforeConsumersAreExhausted) {
+    const size_t nDocs = 500;
+    const size_t nConsumers = 3;
+
+    auto source = getMockSource(nDocs);
+
+    ExchangeSpec spec;
+    spec.setPolicy(ExchangePolicyEnum::kRoundRobin);
+    spec.setConsumers(nConsumers);
+    spec.setBufferSize(1024);
+
+    boost::intrusive_ptr<Exchange> ex =
+        new Exchange(spec, unittest::assertGet(Pipeline::create({source}, getExpCtx())));
+
+    std::vector<std::unique_ptr<Pipeline, PipelineDeleter>> consumers;
+    for (size_t idx = 0; idx < nConsumers; ++idx) {
+        boost::intrusive_ptr<ExpressionContext> consumerExpCtx =
+            new ExpressionContext(getExpCtx()->opCtx, nullptr);
+        consumerExpCtx->mongoProcessInterface =
+            std::make_shared<StubMongoProcessOkWithOpCtxChanges>();
+
+        boost::intrusive_ptr<DocumentSource> consumer =
+            new DocumentSourceExchange(consumerExpCtx, ex, idx, nullptr);
+        consumers.emplace_back(unittest::assertGet(Pipeline::create({consumer}, consumerExpCtx)));
+    }
+
+    // The gather buffer is too small to hold all documents, so the consumer threads are blocked
+    // when the stage is disposed of. Disposing must unblock and finish all of them.
+    boost::intrusive_ptr<DocumentSourceExchangeGather> gather =
+        new DocumentSourceExchangeGather(getExpCtx(), std::move(consumers), 1024);
+    ASSERT_TRUE(gather->getNext().isAdvanced());
+    gather->dispose();
+}
+
+TEST_F(DocumentSourceExchangeTest, GatherDisposesConsumersWaitingForAPoolThread) {
+    const size_t nDocs = 100;
+    const size_t nConsumers = internalDocumentSourceGroupParallelMaxThreads.load() + 4;
+
+    std::vector<std::unique_ptr<Pipeline, PipelineDeleter>> consumers;
+    for (size_t idx = 0; idx < nConsumers; ++idx) {
+        boost::intrusive_ptr<ExpressionContext> consumerExpCtx =
+            new ExpressionContext(getExpCtx()->opCtx, nullptr);
+        consumerExpCtx->mongoProcessInterface =
+            std::make_shared<StubMongoProcessOkWithOpCtxChanges>();
+        consumers.emplace_back(
+            unittest::assertGet(Pipeline::create({getMockSource(nDocs)}, consumerExpCtx)));
+    }
+
+    // The gather buffer only holds a single document, so every consumer on a pool thread is
+    // blocked, and there are more consumers than pool threads. Disposing must not wait for the
+    // consumers left without a pool thread to get one.
+    boost::intrusive_ptr<DocumentSourceExchangeGather> gather =
+        new DocumentSourceExchangeGather(getExpCtx(), std::move(consumers), 1);
+    ASSERT_TRUE(gather->getNext().isAdvanced());
+    gather->dispose();
+
+    // Once disposed of, none of the consumers is running anymore.
+    size_t idleConsumers = 0;
+    gather->forEachIdleConsumer([&](const Pipeline&) { ++idleConsumers; });
+    ASSERT_EQ(idleConsumers, nConsumers);
+}
+
 TEST_F(DocumentSourceExchangeTest, RejectNoConsumers) {
     BSONObj spec = BSON("policy"
                         << "broadcast"
@@ -32,6 +32,8 @@
 #include <boost/filesystem/operations.hpp>
 #include <memory>
 
+#include "mongo/base/counter.h"
+#include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/pipeline/accumulation_statement.h"
 #include "mongo/db/pipeline/accumulator.h"
@@ -43,6 +45,7 @@
 #include "mongo/db/pipeline/value.h"
 #include "mongo/db/pipeline/value_comparator.h"
 #include "mongo/util/destructor_guard.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 
@@ -62,6 +65,14 @@ std::string nextFileName() {
     return "extsort-doc-group." + std::to_string(documentSourceGroupFileCounter.fetchAndAdd(1));
 }
 
+Counter64 groupSpilledPartitionsCounter;
+ServerStatusMetricField<Counter64> displayGroupSpilledPartitions(
+    "query.group.spilledPartitions", &groupSpilledPartitionsCounter);
+
+Counter64 groupSpilledPartitionBytesCounter;
+ServerStatusMetricField<Counter64> displayGroupSpilledPartitionBytes(
+    "query.group.spilledPartitionBytes", &groupSpilledPartitionBytesCounter);
+
 }  // namespace
 
 using boost::intrusive_ptr;
@@ -146,7 +157,7 @@ DocumentSource::GetNextResult DocumentSourceGroup::doGetNext() {
     }
 
     if (_spilled) {
-        return getNextSpilled();
+        return _spillPartitions.empty() ? getNextSpilled() : getNextPartitioned();
     } else {
         return getNextStandard();
     }
@@ -158,25 +169,18 @@ DocumentSource::GetNextResult DocumentSourceGroup::getNextSpilled() {
         return GetNextResult::makeEOF();
 
     _currentId = _firstPartOfNextGroup.first;
-    const size_t numAccumulators = _accumulatedFields.size();
     while (pExpCtx->getValueComparator().evaluate(_currentId == _firstPartOfNextGroup.first)) {
         // Inside of this loop, _firstPartOfNextGroup is the current data being processed.
         // At loop exit, it is the first value to be processed in the next group.
-        switch (numAccumulators) {  // mirrors switch in spill()
-            case 1:                 // Single accumulators serialize as a single Value.
-                _currentAccumulators[0]->process(_firstPartOfNextGroup.second, true);
-            case 0:  // No accumulators so no Values.
-                break;
-            default: {  // Multiple accumulators serialize as an array of Values.
-                const vector<Value>& accumulatorStates = _firstPartOfNextGroup.second.getArray();
-                for (size_t i = 0; i < numAccumulators; i++) {
-                    _currentAccumulators[i]->process(accumulatorStates[i], true);
-                }
-            }
-        }
+        mergeSpilledState(_firstPartOfNextGroup.second, &_currentAccumulators);
 
         if (!_sorterIterator->more()) {
-            dispose();
+            if (_spillPartitions.empty()) {
+                dispose();
+            } else {
+                // Only the current partition has been exhausted. Move on to the next one.
+                _sorterIterator.reset();
+            }
             break;
         }
 
@@ -186,6 +190,31 @@ DocumentSource::GetNextResult DocumentSourceGroup::getNextSpilled() {
     return makeDocument(_currentId, _currentAccumulators, pExpCtx->needsMerge);
 }
 
+DocumentSource::GetNextResult DocumentSourceGroup::getNextPartitioned() {
+    // We aren't streaming, and we have spilled to disk in hash partitions. Partitions are
+    // re-aggregated and returned one at a time.
+    while (true) {
+        if (_sorterIterator) {
+            // The current partition did not fit in memory, so it is being merged from sorted runs.
+            return getNextSpilled();
+        }
+
+        if (groupsIterator != _groups->end()) {
+            Document out =
+                makeDocument(groupsIterator->first, groupsIterator->second, pExpCtx->needsMerge);
+            ++groupsIterator;
+            return std::move(out);
+        }
+
+        if (_nextSpillPartition == _spillPartitions.size()) {
+            dispose();
+            return GetNextResult::makeEOF();
+        }
+
+        loadSpilledPartition(_nextSpillPartition++);
+    }
+}
+
 DocumentSource::GetNextResult DocumentSourceGroup::getNextStandard() {
     // Not spilled, and not streaming.
     if (_groups->empty())
@@ -220,6 +249,16 @@ intrusive_ptr<DocumentSource> DocumentSourceGroup::optimize() {
         accumulatedField.expression = accumulatedField.expression->optimize();
     }
 
+    _compiledIdExpressions.clear();
+    for (auto&& idExpression : _idExpressions) {
+        _compiledIdExpressions.push_back(CompiledExpression::compile(idExpression));
+    }
+    _compiledAccumulatedExpressions.clear();
+    for (auto&& accumulatedField : _accumulatedFields) {
+        _compiledAccumulatedExpressions.push_back(
+            CompiledExpression::compile(accumulatedField.expression));
+    }
+
     return this;
 }
 
@@ -338,6 +377,7 @@ DocumentSourceGroup::DocumentSourceGroup(const intrusive_ptr<ExpressionContext>&
     if (!pExpCtx->inMongos && (pExpCtx->allowDiskUse || kDebugBuild)) {
         // We spill to disk in debug mode, regardless of allowDiskUse, to stress the system.
         _fileName = pExpCtx->tempDir + "/" + nextFileName();
+        _spillPartitions.resize(internalDocumentSourceGroupSpillPartitions.load());
     }
 }
 
@@ -349,6 +389,7 @@ DocumentSourceGroup::~DocumentSourceGroup() {
 
 void DocumentSourceGroup::addAccumulator(AccumulationStatement accumulationStatement) {
     _accumulatedFields.push_back(accumulationStatement);
+    _compiledAccumulatedExpressions.clear();
 }
 
 namespace {
@@ -383,6 +424,7 @@ intrusive_ptr<Expression> parseIdExpression(const intrusive_ptr<ExpressionContex
 }  // namespace
 
 void DocumentSourceGroup::setIdExpression(const boost::intrusive_ptr<Expression> idExpression) {
+    _compiledIdExpressions.clear();
 
     if (auto object = dynamic_cast<ExpressionObject*>(idExpression.get())) {
         auto& childExpressions = object->getChildExpressions();
@@ -476,7 +518,7 @@ DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
                     "Exceeded memory limit for $group, but didn't allow external sort."
                     " Pass allowDiskUse:true to opt in.",
                     _allowDiskUse);
-            _sortedFiles.push_back(spill());
+            spillGroups();
             _memoryUsageBytes = 0;
         }
 
@@ -511,8 +553,13 @@ DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
         dassert(numAccumulators == group.size());
 
         for (size_t i = 0; i < numAccumulators; i++) {
+            const CompiledExpression* compiled = _compiledAccumulatedExpressions.empty()
+                ? nullptr
+                : _compiledAccumulatedExpressions[i].get();
             group[i]->process(
-                _accumulatedFields[i].expression->evaluate(rootDocument, &pExpCtx->variables),
+                compiled
+                    ? compiled->evaluate(rootDocument, &pExpCtx->variables)
+                    : _accumulatedFields[i].expression->evaluate(rootDocument, &pExpCtx->variables),
                 _doingMerge);
 
             _memoryUsageBytes += group[i]->memUsageForSorter();
@@ -520,12 +567,12 @@ DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
 
         if (kDebugBuild && !storageGlobalParams.readOnly) {
             // In debug mode, spill every time we have a duplicate id to stress merge logic.
-            if (!inserted &&                 // is a dup
-                !pExpCtx->inMongos &&        // can't spill to disk in mongos
-                !_allowDiskUse &&            // don't change behavior when testing external sort
-                _sortedFiles.size() < 20) {  // don't open too many FDs
+            if (!inserted &&           // is a dup
+                !pExpCtx->inMongos &&  // can't spill to disk in mongos
+                !_allowDiskUse &&      // don't change behavior when testing external sort
+                _numSpills < 20) {     // don't open too many FDs
 
-                _sortedFiles.push_back(spill());
+                spillGroups();
             }
         }
     }
@@ -539,7 +586,15 @@ DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
         }
         case DocumentSource::GetNextResult::ReturnStatus::kEOF: {
             // Do any final steps necessary to prepare to output results.
-            if (!_sortedFiles.empty()) {
+            if (_numSpills > 0 && !_spillPartitions.empty()) {
+                _spilled = true;
+                if (!_groups->empty()) {
+                    spillToPartitions();
+                }
+
+                // Partitions are loaded into '_groups' one at a time by getNextPartitioned().
+                groupsIterator = _groups->end();
+            } else if (!_sortedFiles.empty()) {
                 _spilled = true;
                 if (!_groups->empty()) {
                     _sortedFiles.push_back(spill());
@@ -581,7 +636,21 @@ bool DocumentSourceGroup::usedDisk() {
     return _usedDisk;
 }
 
+void DocumentSourceGroup::spillGroups() {
+    if (_spillPartitions.empty()) {
+        _sortedFiles.push_back(spill());
+    } else {
+        spillToPartitions();
+    }
+    ++_numSpills;
+}
+
 shared_ptr<Sorter<Value, Value>::Iterator> DocumentSourceGroup::spill() {
+    return spill(_fileName, &_nextSortedFileWriterOffset);
+}
+
+shared_ptr<Sorter<Value, Value>::Iterator> DocumentSourceGroup::spill(const std::string& fileName,
+                                                                      unsigned int* fileOffset) {
     _usedDisk = true;
     vector<const GroupsMap::value_type*> ptrs;  // using pointers to speed sorting
     ptrs.reserve(_groups->size());
@@ -592,43 +661,168 @@ shared_ptr<Sorter<Value, Value>::Iterator> DocumentSourceGroup::spill() {
     stable_sort(ptrs.begin(), ptrs.end(), SpillSTLComparator(pExpCtx->getValueComparator()));
 
     SortedFileWriter<Value, Value> writer(
-        SortOptions().TempDir(pExpCtx->tempDir), _fileName, _nextSortedFileWriterOffset);
-    switch (_accumulatedFields.size()) {  // same as ptrs[i]->second.size() for all i.
-        case 0:                           // no values, essentially a distinct
-            for (size_t i = 0; i < ptrs.size(); i++) {
-                writer.addAlreadySorted(ptrs[i]->first, Value());
-            }
-            break;
+        SortOptions().TempDir(pExpCtx->tempDir), fileName, *fileOffset);
+    for (size_t i = 0; i < ptrs.size(); i++) {
+        writer.addAlreadySorted(ptrs[i]->first, serializeForSpill(ptrs[i]->second));
+    }
 
-        case 1:  // just one value, use optimized serialization as single Value
-            for (size_t i = 0; i < ptrs.size(); i++) {
-                writer.addAlreadySorted(ptrs[i]->first,
-                                        ptrs[i]->second[0]->getValue(/*toBeMerged=*/true));
+    _groups->clear();
+
+    Sorter<Value, Value>::Iterator* iteratorPtr = writer.done();
+    *fileOffset = writer.getFileEndOffset();
+    return shared_ptr<Sorter<Value, Value>::Iterator>(iteratorPtr);
+}
+
+void DocumentSourceGroup::spillToPartitions() {
+    _usedDisk = true;
+    const auto& valueComparator = pExpCtx->getValueComparator();
+
+    // Groups whose keys compare equal hash equally, so every partial result for a given key lands
+    // in the same partition no matter which spill it was written by.
+    vector<vector<const GroupsMap::value_type*>> partitions(_spillPartitions.size());
+    for (auto&& group : *_groups) {
+        partitions[valueComparator.hash(group.first) % partitions.size()].push_back(&group);
+    }
+
+    for (size_t partition = 0; partition < partitions.size(); ++partition) {
+        if (partitions[partition].empty()) {
+            continue;
+        }
+
+        SortedFileWriter<Value, Value> writer(
+            SortOptions().TempDir(pExpCtx->tempDir), _fileName, _nextSortedFileWriterOffset);
+        for (auto&& group : partitions[partition]) {
+            // The run is read back in the order it was written, so it does not need to be sorted.
+            writer.addAlreadySorted(group->first, serializeForSpill(group->second));
+        }
+        _spillPartitions[partition].emplace_back(writer.done());
+
+        const unsigned int endOffset = writer.getFileEndOffset();
+        groupSpilledPartitionsCounter.increment();
+        groupSpilledPartitionBytesCounter.increment(endOffset - _nextSortedFileWriterOffset);
+        _nextSortedFileWriterOffset = endOffset;
+    }
+
+    _groups->clear();
+}
+
+void DocumentSourceGroup::loadSpilledPartition(size_t partition) {
+    const size_t numAccumulators = _accumulatedFields.size();
+
+    // Groups which overflow memory while re-aggregating this partition are sorted into their own
+    // file, which the MergeIterator built over them deletes once it is done. Until then, remove it
+    // here should anything throw.
+    const std::string overflowFileName = _fileName + ".partition." + std::to_string(partition);
+    unsigned int overflowFileOffset = 0;
+    auto removeOverflowFile =
+        makeGuard([&] { DESTRUCTOR_GUARD(boost::filesystem::remove(overflowFileName)); });
+    invariant(_sortedFiles.empty());
+
+    _groups->clear();
+    _memoryUsageBytes = 0;
+    for (auto&& run : _spillPartitions[partition]) {
+        run->openSource();
+        while (run->more()) {
+            if (_memoryUsageBytes > _maxMemoryUsageBytes) {
+                _sortedFiles.push_back(spill(overflowFileName, &overflowFileOffset));
+                _memoryUsageBytes = 0;
             }
-            break;
 
-        default:  // multiple values, serialize as array-typed Value
-            for (size_t i = 0; i < ptrs.size(); i++) {
-                vector<Value> accums;
-                for (size_t j = 0; j < ptrs[i]->second.size(); j++) {
-                    accums.push_back(ptrs[i]->second[j]->getValue(/*toBeMerged=*/true));
+            auto spilledGroup = run->next();
+            const size_t oldSize = _groups->size();
+            Accumulators& group = (*_groups)[spilledGroup.first];
+            if (_groups->size() != oldSize) {
+                _memoryUsageBytes += spilledGroup.first.getApproximateSize();
+                group.reserve(numAccumulators);
+                for (auto&& accumulatedField : _accumulatedFields) {
+                    group.push_back(accumulatedField.makeAccumulator(pExpCtx));
+                }
+            } else {
+                for (auto&& accum : group) {
+                    _memoryUsageBytes -= accum->memUsageForSorter();
                 }
-                writer.addAlreadySorted(ptrs[i]->first, Value(std::move(accums)));
             }
-            break;
+
+            mergeSpilledState(spilledGroup.second, &group);
+            for (auto&& accum : group) {
+                _memoryUsageBytes += accum->memUsageForSorter();
+            }
+        }
+        run->closeSource();
     }
+    _spillPartitions[partition].clear();
 
-    _groups->clear();
+    if (_sortedFiles.empty()) {
+        removeOverflowFile.dismiss();
+        groupsIterator = _groups->begin();
+        return;
+    }
 
-    Sorter<Value, Value>::Iterator* iteratorPtr = writer.done();
-    _nextSortedFileWriterOffset = writer.getFileEndOffset();
-    return shared_ptr<Sorter<Value, Value>::Iterator>(iteratorPtr);
+    // This partition did not fit in memory by itself, so fall back to merging sorted runs of it.
+    if (!_groups->empty()) {
+        _sortedFiles.push_back(spill(overflowFileName, &overflowFileOffset));
+    }
+    groupsIterator = _groups->end();
+
+    _sorterIterator.reset(
+        Sorter<Value, Value>::Iterator::merge(_sortedFiles,
+                                              overflowFileName,
+                                              SortOptions(),
+                                              SorterComparator(pExpCtx->getValueComparator())));
+    removeOverflowFile.dismiss();
+    _sortedFiles.clear();
+
+    if (_currentAccumulators.empty()) {
+        _currentAccumulators.reserve(numAccumulators);
+        for (auto&& accumulatedField : _accumulatedFields) {
+            _currentAccumulators.push_back(accumulatedField.makeAccumulator(pExpCtx));
+        }
+    }
+
+    verify(_sorterIterator->more());  // we put data in, we should get something out.
+    _firstPartOfNextGroup = _sorterIterator->next();
+}
+
+Value DocumentSourceGroup::serializeForSpill(const Accumulators& accums) const {
+    switch (accums.size()) {  // same as _accumulatedFields.size()
+        case 0:               // no values, essentially a distinct
+            return Value();
+
+        case 1:  // just one value, use optimized serialization as single Value
+            return accums[0]->getValue(/*toBeMerged=*/true);
+
+        default: {  // multiple values, serialize as array-typed Value
+            vector<Value> states;
+            states.reserve(accums.size());
+            for (auto&& accum : accums) {
+                states.push_back(accum->getValue(/*toBeMerged=*/true));
+            }
+            return Value(std::move(states));
+        }
+    }
+}
+
+void DocumentSourceGroup::mergeSpilledState(const Value& spilledState,
+                                            Accumulators* accums) const {
+    switch (accums->size()) {  // mirrors switch in serializeForSpill()
+        case 0:                // No accumulators so no Values.
+            break;
+        case 1:  // Single accumulators serialize as a single Value.
+            (*accums)[0]->process(spilledState, true);
+            break;
+        default: {  // Multiple accumulators serialize as an array of Values.
+            const vector<Value>& accumulatorStates = spilledState.getArray();
+            for (size_t i = 0; i < accums->size(); i++) {
+                (*accums)[i]->process(accumulatorStates[i], true);
+            }
+        }
+    }
 }
 
 Value DocumentSourceGroup::computeId(const Document& root) {
     // If only one expression, return result directly
     if (_idExpressions.size() == 1) {
-        Value retValue = _idExpressions[0]->evaluate(root, &pExpCtx->variables);
+        Value retValue = evaluateIdExpression(0, root);
         return retValue.missing() ? Value(BSONNULL) : std::move(retValue);
     }
 
@@ -636,11 +830,18 @@ Value DocumentSourceGroup::computeId(const Document& root) {
     vector<Value> vals;
     vals.reserve(_idExpressions.size());
     for (size_t i = 0; i < _idExpressions.size(); i++) {
-        vals.push_back(_idExpressions[i]->evaluate(root, &pExpCtx->variables));
+        vals.push_back(evaluateIdExpression(i, root));
     }
     return Value(std::move(vals));
 }
 
+Value DocumentSourceGroup::evaluateIdExpression(size_t i, const Document& root) const {
+    if (!_compiledIdExpressions.empty() && _compiledIdExpressions[i]) {
+        return _compiledIdExpressions[i]->evaluate(root, &pExpCtx->variables);
+    }
+    return _idExpressions[i]->evaluate(root, &pExpCtx->variables);
+}
+
 Value DocumentSourceGroup::expandId(const Value& val) {
     // _id doesn't get wrapped in a document
     if (_idFieldNames.empty())
@@ -34,6 +34,7 @@
 
 #include "mongo/db/pipeline/accumulation_statement.h"
 #include "mongo/db/pipeline/accumulator.h"
+#include "mongo/db/pipeline/compiled_expression.h"
 #include "mongo/db/pipeline/document_source.h"
 #include "mongo/db/pipeline/transformer_interface.h"
 #include "mongo/db/sorter/sorter.h"
@@ -192,6 +193,7 @@ private:
      * initialize() to have been called already.
      */
     GetNextResult getNextSpilled();
+    GetNextResult getNextPartitioned();
     GetNextResult getNextStandard();
 
     /**
@@ -213,6 +215,43 @@ private:
      */
     std::shared_ptr<Sorter<Value, Value>::Iterator> spill();
 
+    /**
+     * Sorts the groups map into a single run appended to 'fileName' at '*fileOffset', and advances
+     * '*fileOffset' past the run.
+     */
+    std::shared_ptr<Sorter<Value, Value>::Iterator> spill(const std::string& fileName,
+                                                          unsigned int* fileOffset);
+
+    /**
+     * Spills the groups map to disk, either as a sorted run or split into hash partitions
+     * depending on whether '_spillPartitions' is empty.
+     */
+    void spillGroups();
+
+    /**
+     * Splits the groups map by the hash of the group key into '_spillPartitions', writing one
+     * unsorted run per non-empty partition, and then clears the map.
+     */
+    void spillToPartitions();
+
+    /**
+     * Reads back every run spilled to 'partition' and re-aggregates it into the groups map. If the
+     * partition does not fit in memory by itself, its groups are instead sorted and merged through
+     * '_sorterIterator'.
+     */
+    void loadSpilledPartition(size_t partition);
+
+    /**
+     * Returns the accumulator states of 'accums' in the form they are written to disk by a spill.
+     */
+    Value serializeForSpill(const Accumulators& accums) const;
+
+    /**
+     * Merges accumulator states read back from disk, as produced by serializeForSpill(), into
+     * 'accums'.
+     */
+    void mergeSpilledState(const Value& spilledState, Accumulators* accums) const;
+
     Document makeDocument(const Value& id, const Accumulators& accums, bool mergeableOutput);
 
     /**
@@ -220,6 +259,11 @@ private:
      */
     Value computeId(const Document& root);
 
+    /**
+     * Evaluates '_idExpressions[i]' against 'root', using its compiled program if there is one.
+     */
+    Value evaluateIdExpression(size_t i, const Document& root) const;
+
     /**
      * Converts the internal representation of the group key to the _id shape specified by the
      * user.
@@ -244,6 +288,12 @@ private:
     std::vector<std::string> _idFieldNames;  // used when id is a document
     std::vector<boost::intrusive_ptr<Expression>> _idExpressions;
 
+    // Programs compiled by optimize() from '_idExpressions' and from the expressions of
+    // '_accumulatedFields', evaluated in their place. Either is empty until optimize() is called,
+    // and an entry is null if its expression was not compiled.
+    std::vector<std::unique_ptr<CompiledExpression>> _compiledIdExpressions;
+    std::vector<std::unique_ptr<CompiledExpression>> _compiledAccumulatedExpressions;
+
     bool _initialized;
 
     Value _currentId;
@@ -257,6 +307,17 @@ private:
     std::vector<std::shared_ptr<Sorter<Value, Value>::Iterator>> _sortedFiles;
     bool _spilled;
 
+    // One list of spilled runs per hash partition of the group key. Empty if this $group spills by
+    // sorting, otherwise sized from 'internalDocumentSourceGroupSpillPartitions' on construction.
+    std::vector<std::vector<std::shared_ptr<Sorter<Value, Value>::Iterator>>> _spillPartitions;
+
+    // The next partition to be re-aggregated, when '_spilled' is true and '_spillPartitions' is in
+    // use.
+    size_t _nextSpillPartition = 0;
+
+    // The number of times the groups map has been spilled to disk.
+    size_t _numSpills = 0;
+
     // Only used when '_spilled' is false.
     GroupsMap::iterator groupsIterator;
 
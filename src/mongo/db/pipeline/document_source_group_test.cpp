@@ -49,11 +49,13 @@
 #include "mongo/db/pipeline/expression.h"
 #include "mongo/db/pipeline/expression_context_for_test.h"
 #include "mongo/db/pipeline/value_comparator.h"
+#include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/db/query/query_test_service_context.h"
 #include "mongo/dbtests/dbtests.h"
 #include "mongo/stdx/unordered_set.h"
 #include "mongo/unittest/temp_dir.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 
@@ -142,6 +144,76 @@ TEST_F(DocumentSourceGroupTest, ShouldBeAbleToPauseLoadingWhileSpilled) {
     ASSERT_EQ(idSet.count(2), 1UL);
 }
 
+/**
+ * Runs a $group over 'numDocs' documents whose 'key' cycles through 'numKeys' values, with a memory
+ * limit small enough to force spilling, and checks that every group was aggregated exactly once.
+ */
+void assertSpilledCountsAreCorrect(const intrusive_ptr<ExpressionContext>& expCtx,
+                                   int numKeys,
+                                   int numDocs) {
+    TempDir tempDir("DocumentSourceGroupTest");
+    expCtx->tempDir = tempDir.path();
+    expCtx->allowDiskUse = true;
+    const size_t maxMemoryUsageBytes = 1000;
+
+    VariablesParseState vps = expCtx->variablesParseState;
+    AccumulationStatement countStatement{"count",
+                                         ExpressionConstant::create(expCtx, Value(1)),
+                                         AccumulationStatement::getFactory("$sum")};
+    AccumulationStatement maxStatement{"max",
+                                       ExpressionFieldPath::parse(expCtx, "$n", vps),
+                                       AccumulationStatement::getFactory("$max")};
+    auto groupByExpression = ExpressionFieldPath::parse(expCtx, "$key", vps);
+    auto group = DocumentSourceGroup::create(
+        expCtx, groupByExpression, {countStatement, maxStatement}, maxMemoryUsageBytes);
+
+    deque<DocumentSource::GetNextResult> inputs;
+    for (int i = 0; i < numDocs; ++i) {
+        inputs.emplace_back(Document{{"key", i % numKeys}, {"n", i}});
+    }
+    auto mock = DocumentSourceMock::createForTest(inputs);
+    group->setSource(mock.get());
+
+    map<int, Document> results;
+    for (auto result = group->getNext(); result.isAdvanced(); result = group->getNext()) {
+        auto doc = result.releaseDocument();
+        ASSERT_TRUE(results.emplace(doc["_id"].coerceToInt(), doc).second);
+    }
+    ASSERT_TRUE(group->getNext().isEOF());
+    ASSERT_TRUE(group->usedDisk());
+
+    ASSERT_EQ(results.size(), static_cast<size_t>(numKeys));
+    for (int key = 0; key < numKeys; ++key) {
+        const int lastDoc = numKeys * ((numDocs - 1 - key) / numKeys) + key;
+        ASSERT_DOCUMENT_EQ(results[key],
+                           (Document{{"_id", key},
+                                     {"count", numDocs / numKeys + (key < numDocs % numKeys)},
+                                     {"max", lastDoc}}));
+    }
+}
+
+TEST_F(DocumentSourceGroupTest, ShouldMergeSortedSpillsCorrectly) {
+    assertSpilledCountsAreCorrect(getExpCtx(), 50, 500);
+}
+
+TEST_F(DocumentSourceGroupTest, ShouldReaggregateHashPartitionedSpillsCorrectly) {
+    const auto oldPartitions = internalDocumentSourceGroupSpillPartitions.load();
+    internalDocumentSourceGroupSpillPartitions.store(16);
+    ON_BLOCK_EXIT([&] { internalDocumentSourceGroupSpillPartitions.store(oldPartitions); });
+
+    assertSpilledCountsAreCorrect(getExpCtx(), 50, 500);
+}
+
+TEST_F(DocumentSourceGroupTest, ShouldSortAndMergeHashPartitionWhichDoesNotFitInMemory) {
+    // With a single partition, re-aggregating it needs as much memory as the whole group did, so
+    // it must fall back to sorting and merging.
+    const auto oldPartitions = internalDocumentSourceGroupSpillPartitions.load();
+    internalDocumentSourceGroupSpillPartitions.store(1);
+    ON_BLOCK_EXIT([&] { internalDocumentSourceGroupSpillPartitions.store(oldPartitions); });
+
+    assertSpilledCountsAreCorrect(getExpCtx(), 50, 500);
+}
+
 TEST_F(DocumentSourceGroupTest, ShouldErrorIfNotAllowedToSpillToDiskAndResultSetIsTooLarge) {
     auto expCtx = getExpCtx();
     const size_t maxMemoryUsageBytes = 1000;
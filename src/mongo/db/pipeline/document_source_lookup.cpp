@@ -31,11 +31,14 @@
 
 #include "mongo/db/pipeline/document_source_lookup.h"
 
+#include <algorithm>
 #include <memory>
+#include <numeric>
 
 #include "mongo/base/init.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/matcher/expression_algo.h"
+#include "mongo/db/matcher/expression_parser.h"
 #include "mongo/db/pipeline/document.h"
 #include "mongo/db/pipeline/document_path_support.h"
 #include "mongo/db/pipeline/expression.h"
@@ -225,24 +228,98 @@ BSONObj buildEqualityOrQuery(const std::string& fieldName, const BSONArray& valu
     return orBuilder.obj();
 }
 
+/**
+ * Returns the value of 'path' in the foreign document 'obj', for use as its key in the hash join
+ * table. A missing value is keyed as null. Returns boost::none if 'obj' cannot be keyed on a single
+ * value, because 'path' traverses an array or holds undefined.
+ */
+boost::optional<Value> extractHashJoinKey(const BSONObj& obj, const FieldPath& path) {
+    BSONObj current = obj;
+    for (size_t i = 0; i < path.getPathLength(); ++i) {
+        auto elem = current[path.getFieldName(i)];
+        if (elem.eoo()) {
+            return Value(BSONNULL);
+        }
+        if (elem.type() == BSONType::Array || elem.type() == BSONType::Undefined) {
+            return boost::none;
+        }
+        if (i + 1 == path.getPathLength()) {
+            return Value(elem);
+        }
+        if (elem.type() != BSONType::Object) {
+            return Value(BSONNULL);
+        }
+        current = elem.embeddedObject();
+    }
+    MONGO_UNREACHABLE;
+}
+
+StringData joinStrategyToString(DocumentSourceLookUp::JoinStrategy strategy) {
+    switch (strategy) {
+        case DocumentSourceLookUp::JoinStrategy::kNestedLoopJoin:
+            return "NestedLoopJoin"_sd;
+        case DocumentSourceLookUp::JoinStrategy::kHashJoin:
+            return "HashJoin"_sd;
+        case DocumentSourceLookUp::JoinStrategy::kBatchedNestedLoopJoin:
+            return "BatchedNestedLoopJoin"_sd;
+    }
+    MONGO_UNREACHABLE;
+}
+
 }  // namespace
 
-DocumentSource::GetNextResult DocumentSourceLookUp::doGetNext() {
-    if (_unwindSrc) {
-        return unwindResult();
+DocumentSourceLookUp::JoinStrategy DocumentSourceLookUp::getJoinStrategy() const {
+    // Only a $lookup with localField/foreignField syntax which produces one output document per
+    // input document can join more than one input document at a time.
+    if (wasConstructedWithPipelineSyntax() || _unwindSrc) {
+        return JoinStrategy::kNestedLoopJoin;
     }
 
-    auto nextInput = pSource->getNext();
-    if (!nextInput.isAdvanced()) {
-        return nextInput;
+    if (!_hashJoinAbandoned && shouldUseHashJoin()) {
+        return JoinStrategy::kHashJoin;
     }
 
-    auto inputDoc = nextInput.releaseDocument();
+    if (internalQueryLookupBatchSize.load() > 1) {
+        return JoinStrategy::kBatchedNestedLoopJoin;
+    }
+    return JoinStrategy::kNestedLoopJoin;
+}
 
-    // If we have not absorbed a $unwind, we cannot absorb a $match. If we have absorbed a $unwind,
-    // '_unwindSrc' would be non-null, and we would not have made it here.
-    invariant(!_matchSrc);
+bool DocumentSourceLookUp::shouldUseHashJoin() const {
+    if (_useHashJoin) {
+        return *_useHashJoin;
+    }
+
+    // The hash join relies on being able to read the whole foreign collection locally.
+    const auto maxBytes = internalQueryMaxLookupBuildBytes.load();
+    if (pExpCtx->inMongos || maxBytes <= 0) {
+        _useHashJoin = false;
+        return false;
+    }
+
+    // An index on the collection underlying a view does not help if the view's pipeline comes
+    // before the $match on 'foreignField'. '_resolvedPipeline' ends with a placeholder for that
+    // $match.
+    const auto processInterface = pExpCtx->mongoProcessInterface;
+    const bool foreignIsView = _resolvedPipeline.size() > 1;
+    const bool foreignFieldIsIndexed = !foreignIsView &&
+        processInterface->fieldHasSupportingIndex(_fromExpCtx, _fromNs, *_foreignField);
+    _useHashJoin = !foreignFieldIsIndexed &&
+        processInterface->getCollectionDataSize(_fromExpCtx->opCtx, _fromNs) <= maxBytes;
+    return *_useHashJoin;
+}
 
+void DocumentSourceLookUp::JoinTable::insert(BSONObj foreignDoc, const FieldPath& foreignField) {
+    const auto index = docs.size();
+    if (auto key = extractHashJoinKey(foreignDoc, foreignField)) {
+        keyedDocs[*key].push_back(index);
+    } else {
+        unkeyedDocs.push_back(index);
+    }
+    docs.push_back(std::move(foreignDoc));
+}
+
+std::vector<Value> DocumentSourceLookUp::lookUpForeignDocuments(const Document& inputDoc) {
     if (!wasConstructedWithPipelineSyntax()) {
         auto matchStage =
             makeMatchStageFromInput(inputDoc, *_localField, _foreignField->fullPath(), BSONObj());
@@ -269,10 +346,226 @@ DocumentSource::GetNextResult DocumentSourceLookUp::doGetNext() {
         if (source->usedDisk())
             _usedDisk = true;
     }
+    return results;
+}
 
-    MutableDocument output(std::move(inputDoc));
-    output.setNestedField(_as, Value(std::move(results)));
-    return output.freeze();
+void DocumentSourceLookUp::buildHashJoinTable() {
+    invariant(!_hashJoinBuilt);
+    _hashJoinBuilt = true;
+
+    // Execute the resolved view pipeline, if any, without the trailing $match placeholder so that
+    // every foreign document is returned.
+    std::vector<BSONObj> foreignPipeline(_resolvedPipeline.begin(), _resolvedPipeline.end() - 1);
+    auto pipeline = pExpCtx->mongoProcessInterface->makePipeline(foreignPipeline, _fromExpCtx);
+
+    _hashJoinTable.emplace(_fromExpCtx->getValueComparator());
+    const auto maxBytes = internalQueryMaxLookupBuildBytes.load();
+    long long totalBytes = 0;
+    while (auto result = pipeline->getNext()) {
+        auto obj = result->toBson();
+        totalBytes += obj.objsize();
+        if (totalBytes > maxBytes) {
+            _hashJoinAbandoned = true;
+            break;
+        }
+        _hashJoinTable->insert(std::move(obj), *_foreignField);
+    }
+    _usedDisk = _usedDisk || pipeline->usedDisk();
+
+    if (_hashJoinAbandoned) {
+        // The foreign collection is too large to hold in memory. Release what we have read so far
+        // and fall back to querying the foreign collection.
+        _hashJoinTable.reset();
+    }
+}
+
+std::vector<Value> DocumentSourceLookUp::probeJoinTable(const JoinTable& table,
+                                                        const Document& inputDoc) {
+    // Find the foreign documents which may join with 'inputDoc'. A null or missing 'localField'
+    // matches foreign documents which are missing 'foreignField', and a regex is matched by
+    // equality rather than by pattern, so in both cases we simply consider every foreign document.
+    bool considerAllDocs = false;
+    bool sawLocalValue = false;
+    std::vector<size_t> candidates;
+    document_path_support::visitAllValuesAtPath(inputDoc, *_localField, [&](const Value& value) {
+        sawLocalValue = true;
+        if (considerAllDocs) {
+            return;
+        }
+        if (value.nullish() || value.getType() == BSONType::RegEx) {
+            considerAllDocs = true;
+            return;
+        }
+        auto it = table.keyedDocs.find(value);
+        if (it != table.keyedDocs.end()) {
+            candidates.insert(candidates.end(), it->second.begin(), it->second.end());
+        }
+    });
+
+    if (considerAllDocs || !sawLocalValue) {
+        candidates.resize(table.docs.size());
+        std::iota(candidates.begin(), candidates.end(), 0);
+    } else {
+        candidates.insert(candidates.end(), table.unkeyedDocs.begin(), table.unkeyedDocs.end());
+        std::sort(candidates.begin(), candidates.end());
+        candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+    }
+
+    // Filter the candidates with the same predicate the nested loop join would have sent to the
+    // foreign collection, so that every strategy produces the same results.
+    auto matchStage =
+        makeMatchStageFromInput(inputDoc, *_localField, _foreignField->fullPath(), BSONObj());
+    auto matcher = uassertStatusOK(
+        MatchExpressionParser::parse(matchStage.firstElement().embeddedObject(), _fromExpCtx));
+
+    std::vector<Value> results;
+    int objsize = 0;
+    const auto maxBytes = internalLookupStageIntermediateDocumentMaxSizeBytes.load();
+    for (auto index : candidates) {
+        const auto& foreignObj = table.docs[index];
+        if (!matcher->matchesBSON(foreignObj)) {
+            continue;
+        }
+        Document foreignDoc(foreignObj);
+        objsize += foreignDoc.getApproximateSize();
+        uassert(4568,
+                str::stream() << "Total size of documents in " << _fromNs.coll()
+                              << " matching pipeline's $lookup stage exceeds " << maxBytes
+                              << " bytes",
+                objsize <= maxBytes);
+        results.emplace_back(std::move(foreignDoc));
+    }
+    return results;
+}
+
+void DocumentSourceLookUp::lookUpBatch(Document firstInputDoc) {
+    invariant(_batchedResults.empty() && !_batchedInputEnd);
+
+    std::vector<Document> inputDocs;
+    inputDocs.push_back(std::move(firstInputDoc));
+    const auto batchSize = static_cast<size_t>(internalQueryLookupBatchSize.load());
+    while (inputDocs.size() < batchSize) {
+        auto nextInput = pSource->getNext();
+        if (!nextInput.isAdvanced()) {
+            // Join the documents we have so far, and hand back the pause or EOF after them.
+            _batchedInputEnd = std::move(nextInput);
+            break;
+        }
+        inputDocs.push_back(nextInput.releaseDocument());
+    }
+
+    // Collect the distinct 'localField' values of the batch in sorted order, so that the foreign
+    // index is probed once per value and in key order.
+    auto localValues = _fromExpCtx->getValueComparator().makeOrderedValueSet();
+    bool containsRegex = false;
+    for (auto&& inputDoc : inputDocs) {
+        bool sawLocalValue = false;
+        document_path_support::visitAllValuesAtPath(
+            inputDoc, *_localField, [&](const Value& value) {
+                sawLocalValue = true;
+                containsRegex = containsRegex || value.getType() == BSONType::RegEx;
+                localValues.insert(value);
+            });
+        if (!sawLocalValue) {
+            // Missing values are treated as null.
+            localValues.insert(Value(BSONNULL));
+        }
+    }
+
+    BSONArrayBuilder valuesBuilder;
+    for (auto&& value : localValues) {
+        valuesBuilder << value;
+    }
+    const auto& foreignFieldName = _foreignField->fullPath();
+    // As in makeMatchStageFromInput(), a regex must be matched by equality, which $in would not do.
+    _resolvedPipeline.back() = BSON(
+        "$match" << (containsRegex
+                         ? buildEqualityOrQuery(foreignFieldName, valuesBuilder.arr())
+                         : BSON(foreignFieldName << BSON("$in" << valuesBuilder.arr()))));
+
+    // Read the foreign documents matching any input of the batch. If they do not fit within the
+    // limit on the results of a single input, join each input with its own query instead.
+    JoinTable table(_fromExpCtx->getValueComparator());
+    bool batchFits = true;
+    {
+        auto pipeline = buildPipeline(inputDocs.front());
+        const auto maxBytes = internalLookupStageIntermediateDocumentMaxSizeBytes.load();
+        long long totalBytes = 0;
+        while (auto result = pipeline->getNext()) {
+            auto obj = result->toBson();
+            totalBytes += obj.objsize();
+            if (totalBytes > maxBytes) {
+                batchFits = false;
+                break;
+            }
+            table.insert(std::move(obj), *_foreignField);
+        }
+        _usedDisk = _usedDisk || pipeline->usedDisk();
+    }
+
+    for (auto&& inputDoc : inputDocs) {
+        auto results =
+            batchFits ? probeJoinTable(table, inputDoc) : lookUpForeignDocuments(inputDoc);
+        MutableDocument output(std::move(inputDoc));
+        output.setNestedField(_as, Value(std::move(results)));
+        _batchedResults.push_back(output.freeze());
+    }
+}
+
+DocumentSource::GetNextResult DocumentSourceLookUp::doGetNext() {
+    if (_unwindSrc) {
+        return unwindResult();
+    }
+
+    if (!_batchedResults.empty()) {
+        auto output = std::move(_batchedResults.front());
+        _batchedResults.pop_front();
+        return output;
+    }
+
+    if (_batchedInputEnd) {
+        auto inputEnd = std::move(*_batchedInputEnd);
+        _batchedInputEnd = boost::none;
+        return inputEnd;
+    }
+
+    auto nextInput = pSource->getNext();
+    if (!nextInput.isAdvanced()) {
+        return nextInput;
+    }
+
+    auto inputDoc = nextInput.releaseDocument();
+
+    // If we have not absorbed a $unwind, we cannot absorb a $match. If we have absorbed a $unwind,
+    // '_unwindSrc' would be non-null, and we would not have made it here.
+    invariant(!_matchSrc);
+
+    if (getJoinStrategy() == JoinStrategy::kHashJoin && !_hashJoinBuilt) {
+        buildHashJoinTable();
+    }
+
+    switch (getJoinStrategy()) {
+        case JoinStrategy::kHashJoin: {
+            auto results = probeJoinTable(*_hashJoinTable, inputDoc);
+            MutableDocument output(std::move(inputDoc));
+            output.setNestedField(_as, Value(std::move(results)));
+            return output.freeze();
+        }
+        case JoinStrategy::kBatchedNestedLoopJoin: {
+            lookUpBatch(std::move(inputDoc));
+            invariant(!_batchedResults.empty());
+            auto output = std::move(_batchedResults.front());
+            _batchedResults.pop_front();
+            return output;
+        }
+        case JoinStrategy::kNestedLoopJoin: {
+            auto results = lookUpForeignDocuments(inputDoc);
+            MutableDocument output(std::move(inputDoc));
+            output.setNestedField(_as, Value(std::move(results)));
+            return output.freeze();
+        }
+    }
+    MONGO_UNREACHABLE;
 }
 
 std::unique_ptr<Pipeline, PipelineDeleter> DocumentSourceLookUp::buildPipeline(
@@ -462,6 +755,8 @@ void DocumentSourceLookUp::doDispose() {
         _pipeline->dispose(pExpCtx->opCtx);
         _pipeline.reset();
     }
+    _hashJoinTable.reset();
+    _batchedResults.clear();
 }
 
 BSONObj DocumentSourceLookUp::makeMatchStageFromInput(const Document& input,
@@ -697,6 +992,10 @@ void DocumentSourceLookUp::serializeToArray(
             output[getSourceName()]["matching"] = Value(*_additionalFilter);
         }
 
+        if (!wasConstructedWithPipelineSyntax()) {
+            output[getSourceName()]["strategy"] = Value(joinStrategyToString(getJoinStrategy()));
+        }
+
         array.push_back(Value(output.freeze()));
     } else {
         array.push_back(Value(output.freeze()));
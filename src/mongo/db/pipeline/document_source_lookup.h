@@ -30,6 +30,7 @@
 #pragma once
 
 #include <boost/optional.hpp>
+#include <deque>
 
 #include "mongo/db/pipeline/document_source.h"
 #include "mongo/db/pipeline/document_source_match.h"
@@ -51,6 +52,21 @@ public:
     static constexpr size_t kMaxSubPipelineDepth = 20;
     static constexpr StringData kStageName = "$lookup"_sd;
 
+    /**
+     * The ways in which a $lookup specified with localField/foreignField syntax may join its input
+     * documents with the foreign collection.
+     */
+    enum class JoinStrategy {
+        // Queries the foreign collection once for every input document.
+        kNestedLoopJoin,
+        // Reads the foreign collection once into an in-memory hash table keyed on 'foreignField',
+        // which is then probed with the 'localField' values of every input document.
+        kHashJoin,
+        // Buffers a batch of input documents and queries the foreign collection once for all of
+        // their distinct 'localField' values, then distributes the results among the batch.
+        kBatchedNestedLoopJoin,
+    };
+
     struct LetVariable {
         LetVariable(std::string name, boost::intrusive_ptr<Expression> expression, Variables::Id id)
             : name(std::move(name)), expression(std::move(expression)), id(id) {}
@@ -192,6 +208,12 @@ public:
         return _letVariables;
     }
 
+    /**
+     * Returns the strategy this stage uses to join its input with the foreign collection. Only
+     * meaningful for a $lookup constructed with localField/foreignField syntax.
+     */
+    JoinStrategy getJoinStrategy() const;
+
     /**
      * Returns a non-executable pipeline which can be useful for introspection. In this pipeline,
      * all view definitions are resolved. This pipeline is present in both the sub-pipeline version
@@ -292,6 +314,59 @@ private:
      */
     std::unique_ptr<Pipeline, PipelineDeleter> buildPipeline(const Document& inputDoc);
 
+    /**
+     * An in-memory set of foreign documents, indexed by their 'foreignField' value. Foreign
+     * documents which cannot be keyed on a single value, such as those with an array along the
+     * 'foreignField' path, are listed in 'unkeyedDocs' and considered for every input document.
+     */
+    struct JoinTable {
+        explicit JoinTable(const ValueComparator& comparator)
+            : keyedDocs(comparator.makeUnorderedValueMap<std::vector<size_t>>()) {}
+
+        /**
+         * Adds 'foreignDoc' to the table, keyed by its value at 'foreignField'.
+         */
+        void insert(BSONObj foreignDoc, const FieldPath& foreignField);
+
+        std::vector<BSONObj> docs;
+        ValueUnorderedMap<std::vector<size_t>> keyedDocs;
+        std::vector<size_t> unkeyedDocs;
+    };
+
+    /**
+     * Runs the foreign pipeline for 'inputDoc' and returns its results. This is the nested loop
+     * join, and the only way of executing a $lookup with pipeline syntax.
+     */
+    std::vector<Value> lookUpForeignDocuments(const Document& inputDoc);
+
+    /**
+     * Returns whether to join using the hash join strategy, deciding it on the first call. The hash
+     * join is not worth it when 'foreignField' is indexed in the foreign collection, since the
+     * nested loop join then reads only the matching documents, or when the foreign collection is
+     * larger than 'internalQueryMaxLookupBuildBytes', since the hash join would be abandoned.
+     */
+    bool shouldUseHashJoin() const;
+
+    /**
+     * Reads the foreign collection into the hash join table. If the foreign documents do not fit
+     * within 'internalQueryMaxLookupBuildBytes', the hash join is abandoned and this stage falls
+     * back to joining without it.
+     */
+    void buildHashJoinTable();
+
+    /**
+     * Returns the foreign documents in 'table' which join with 'inputDoc', using its index to
+     * avoid comparing 'inputDoc' against every foreign document.
+     */
+    std::vector<Value> probeJoinTable(const JoinTable& table, const Document& inputDoc);
+
+    /**
+     * Reads a batch of up to 'internalQueryLookupBatchSize' input documents, starting with
+     * 'firstInputDoc', joins them with a single query of the foreign collection and places the
+     * output documents in '_batchedResults'.
+     */
+    void lookUpBatch(Document firstInputDoc);
+
     /**
      * Reinitialize the cache with a new max size. May only be called if this DSLookup was created
      * with pipeline syntax, the cache has not been frozen or abandoned, and no data has been added
@@ -350,6 +425,20 @@ private:
     std::unique_ptr<Pipeline, PipelineDeleter> _pipeline;
     boost::optional<Document> _input;
     boost::optional<Document> _nextValue;
+
+    // Holds the whole foreign collection, keyed using the collation of '_fromExpCtx', when joining
+    // with the hash join strategy.
+    mutable boost::optional<bool> _useHashJoin;
+    bool _hashJoinBuilt = false;
+    bool _hashJoinAbandoned = false;
+    boost::optional<JoinTable> _hashJoinTable;
+
+    // The following members are used to hold onto state across getNext() calls when joining with
+    // the batched nested loop join strategy. '_batchedResults' holds the output documents of the
+    // current batch which have not been returned yet, and '_batchedInputEnd' holds the pause or EOF
+    // which ended the batch, to be returned once '_batchedResults' is exhausted.
+    std::deque<Document> _batchedResults;
+    boost::optional<GetNextResult> _batchedInputEnd;
 };
 
 }  // namespace mongo
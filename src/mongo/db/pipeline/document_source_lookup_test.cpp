@@ -48,6 +48,7 @@
 #include "mongo/db/repl/replication_coordinator_mock.h"
 #include "mongo/db/repl/storage_interface_mock.h"
 #include "mongo/db/server_options.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 namespace {
@@ -693,6 +694,236 @@ TEST_F(DocumentSourceLookUpTest, LookupReportsFieldsModifiedByAbsorbedUnwind) {
     lookup->dispose();
 }
 
+TEST_F(DocumentSourceLookUpTest, HashJoinProducesSameResultsAsNestedLoopJoin) {
+    auto expCtx = getExpCtx();
+    NamespaceString fromNs("test", "foreign");
+    expCtx->setResolvedNamespaces(StringMap<ExpressionContext::ResolvedNamespace>{
+        {fromNs.coll().toString(), {fromNs, std::vector<BSONObj>()}}});
+
+    auto lookupSpec = Document{{"$lookup",
+                                Document{{"from", fromNs.coll()},
+                                         {"localField", "foreignKey"_sd},
+                                         {"foreignField", "key"_sd},
+                                         {"as", "foreignDocs"_sd}}}}
+                          .toBson();
+    auto parsed = DocumentSourceLookUp::createFromBson(lookupSpec.firstElement(), expCtx);
+    auto lookup = static_cast<DocumentSourceLookUp*>(parsed.get());
+    ASSERT(lookup->getJoinStrategy() == DocumentSourceLookUp::JoinStrategy::kHashJoin);
+
+    auto mockLocalSource = DocumentSourceMock::createForTest({"{_id: 0, foreignKey: 1}",
+                                                              "{_id: 1, foreignKey: [2, 3]}",
+                                                              "{_id: 2}",
+                                                              "{_id: 3, foreignKey: 4}"});
+    lookup->setSource(mockLocalSource.get());
+
+    // Include foreign documents which cannot be keyed on a single value, or which are keyed on a
+    // value that is only reachable by an equality on null.
+    deque<DocumentSource::GetNextResult> mockForeignContents{
+        Document(fromjson("{_id: 0, key: 1}")),
+        Document(fromjson("{_id: 1, key: 2}")),
+        Document(fromjson("{_id: 2, key: [1, 3]}")),
+        Document(fromjson("{_id: 3}")),
+        Document(fromjson("{_id: 4, key: null}"))};
+    expCtx->mongoProcessInterface =
+        std::make_shared<MockMongoInterface>(std::move(mockForeignContents));
+
+    auto next = lookup->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_DOCUMENT_EQ(
+        next.releaseDocument(),
+        Document(fromjson("{_id: 0, foreignKey: 1, foreignDocs: [{_id: 0, key: 1}, "
+                          "{_id: 2, key: [1, 3]}]}")));
+
+    next = lookup->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_DOCUMENT_EQ(
+        next.releaseDocument(),
+        Document(fromjson("{_id: 1, foreignKey: [2, 3], foreignDocs: [{_id: 1, key: 2}, "
+                          "{_id: 2, key: [1, 3]}]}")));
+
+    next = lookup->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_DOCUMENT_EQ(
+        next.releaseDocument(),
+        Document(fromjson("{_id: 2, foreignDocs: [{_id: 3}, {_id: 4, key: null}]}")));
+
+    next = lookup->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_DOCUMENT_EQ(next.releaseDocument(),
+                       Document(fromjson("{_id: 3, foreignKey: 4, foreignDocs: []}")));
+
+    ASSERT_TRUE(lookup->getNext().isEOF());
+    ASSERT(lookup->getJoinStrategy() == DocumentSourceLookUp::JoinStrategy::kHashJoin);
+    lookup->dispose();
+}
+
+TEST_F(DocumentSourceLookUpTest, HashJoinFallsBackToNestedLoopJoinIfForeignDocumentsDoNotFit) {
+    const auto oldMaxBuildBytes = internalQueryMaxLookupBuildBytes.load();
+    internalQueryMaxLookupBuildBytes.store(1);
+    ON_BLOCK_EXIT([&] { internalQueryMaxLookupBuildBytes.store(oldMaxBuildBytes); });
+
+    auto expCtx = getExpCtx();
+    NamespaceString fromNs("test", "foreign");
+    expCtx->setResolvedNamespaces(StringMap<ExpressionContext::ResolvedNamespace>{
+        {fromNs.coll().toString(), {fromNs, std::vector<BSONObj>()}}});
+
+    auto lookupSpec = Document{{"$lookup",
+                                Document{{"from", fromNs.coll()},
+                                         {"localField", "foreignId"_sd},
+                                         {"foreignField", "_id"_sd},
+                                         {"as", "foreignDocs"_sd}}}}
+                          .toBson();
+    auto parsed = DocumentSourceLookUp::createFromBson(lookupSpec.firstElement(), expCtx);
+    auto lookup = static_cast<DocumentSourceLookUp*>(parsed.get());
+
+    auto mockLocalSource = DocumentSourceMock::createForTest({Document{{"foreignId", 1}}});
+    lookup->setSource(mockLocalSource.get());
+
+    deque<DocumentSource::GetNextResult> mockForeignContents{Document{{"_id", 0}},
+                                                             Document{{"_id", 1}}};
+    expCtx->mongoProcessInterface =
+        std::make_shared<MockMongoInterface>(std::move(mockForeignContents));
+
+    auto next = lookup->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_DOCUMENT_EQ(
+        next.releaseDocument(),
+        (Document{{"foreignId", 1}, {"foreignDocs", vector<Value>{Value(Document{{"_id", 1}})}}}));
+    ASSERT(lookup->getJoinStrategy() ==
+           DocumentSourceLookUp::JoinStrategy::kBatchedNestedLoopJoin);
+
+    ASSERT_TRUE(lookup->getNext().isEOF());
+    lookup->dispose();
+}
+
+/**
+ * Reports the statistics of the foreign collection that a $lookup uses to choose its join strategy.
+ */
+class MockForeignCollectionStatsInterface final : public StubMongoProcessInterface {
+public:
+    MockForeignCollectionStatsInterface(bool foreignFieldIsIndexed, long long dataSize)
+        : _foreignFieldIsIndexed(foreignFieldIsIndexed), _dataSize(dataSize) {}
+
+    bool fieldHasSupportingIndex(const boost::intrusive_ptr<ExpressionContext>& expCtx,
+                                 const NamespaceString& nss,
+                                 const FieldPath& fieldPath) const final {
+        return _foreignFieldIsIndexed;
+    }
+
+    long long getCollectionDataSize(OperationContext* opCtx,
+                                    const NamespaceString& nss) const final {
+        return _dataSize;
+    }
+
+private:
+    bool _foreignFieldIsIndexed;
+    long long _dataSize;
+};
+
+DocumentSourceLookUp::JoinStrategy joinStrategyFor(
+    const boost::intrusive_ptr<ExpressionContext>& expCtx,
+    std::vector<BSONObj> foreignViewPipeline,
+    bool foreignFieldIsIndexed,
+    long long foreignDataSize) {
+    NamespaceString fromNs("test", "foreign");
+    expCtx->setResolvedNamespaces(StringMap<ExpressionContext::ResolvedNamespace>{
+        {fromNs.coll().toString(), {fromNs, std::move(foreignViewPipeline)}}});
+    expCtx->mongoProcessInterface = std::make_shared<MockForeignCollectionStatsInterface>(
+        foreignFieldIsIndexed, foreignDataSize);
+
+    auto lookupSpec = Document{{"$lookup",
+                                Document{{"from", fromNs.coll()},
+                                         {"localField", "foreignKey"_sd},
+                                         {"foreignField", "key"_sd},
+                                         {"as", "foreignDocs"_sd}}}}
+                          .toBson();
+    auto parsed = DocumentSourceLookUp::createFromBson(lookupSpec.firstElement(), expCtx);
+    return static_cast<DocumentSourceLookUp*>(parsed.get())->getJoinStrategy();
+}
+
+TEST_F(DocumentSourceLookUpTest, HashJoinIsUsedIfForeignCollectionFitsAndIsNotIndexed) {
+    ASSERT(joinStrategyFor(getExpCtx(), {}, false, internalQueryMaxLookupBuildBytes.load()) ==
+           DocumentSourceLookUp::JoinStrategy::kHashJoin);
+}
+
+TEST_F(DocumentSourceLookUpTest, HashJoinIsNotUsedIfForeignFieldIsIndexed) {
+    ASSERT(joinStrategyFor(getExpCtx(), {}, true, 0) !=
+           DocumentSourceLookUp::JoinStrategy::kHashJoin);
+}
+
+TEST_F(DocumentSourceLookUpTest, HashJoinIsNotUsedIfForeignCollectionIsLargerThanBudget) {
+    ASSERT(joinStrategyFor(getExpCtx(), {}, false, internalQueryMaxLookupBuildBytes.load() + 1) !=
+           DocumentSourceLookUp::JoinStrategy::kHashJoin);
+}
+
+TEST_F(DocumentSourceLookUpTest, HashJoinIgnoresIndexesOfCollectionUnderlyingForeignView) {
+    ASSERT(joinStrategyFor(getExpCtx(), {fromjson("{$match: {x: 1}}")}, true, 0) ==
+           DocumentSourceLookUp::JoinStrategy::kHashJoin);
+}
+
+TEST_F(DocumentSourceLookUpTest, BatchedNestedLoopJoinShouldPropagatePausesAfterTheirBatch) {
+    const auto oldMaxBuildBytes = internalQueryMaxLookupBuildBytes.load();
+    const auto oldBatchSize = internalQueryLookupBatchSize.load();
+    internalQueryMaxLookupBuildBytes.store(0);
+    internalQueryLookupBatchSize.store(2);
+    ON_BLOCK_EXIT([&] {
+        internalQueryMaxLookupBuildBytes.store(oldMaxBuildBytes);
+        internalQueryLookupBatchSize.store(oldBatchSize);
+    });
+
+    auto expCtx = getExpCtx();
+    NamespaceString fromNs("test", "foreign");
+    expCtx->setResolvedNamespaces(StringMap<ExpressionContext::ResolvedNamespace>{
+        {fromNs.coll().toString(), {fromNs, std::vector<BSONObj>()}}});
+
+    auto lookupSpec = Document{{"$lookup",
+                                Document{{"from", fromNs.coll()},
+                                         {"localField", "foreignId"_sd},
+                                         {"foreignField", "_id"_sd},
+                                         {"as", "foreignDocs"_sd}}}}
+                          .toBson();
+    auto parsed = DocumentSourceLookUp::createFromBson(lookupSpec.firstElement(), expCtx);
+    auto lookup = static_cast<DocumentSourceLookUp*>(parsed.get());
+    ASSERT(lookup->getJoinStrategy() ==
+           DocumentSourceLookUp::JoinStrategy::kBatchedNestedLoopJoin);
+
+    // The first batch is full, while the second is cut short by a pause. Repeated join keys
+    // within a batch must each receive their own copy of the foreign documents.
+    auto mockLocalSource =
+        DocumentSourceMock::createForTest({Document{{"foreignId", 0}},
+                                           Document{{"foreignId", 0}},
+                                           Document{{"foreignId", 1}},
+                                           DocumentSource::GetNextResult::makePauseExecution(),
+                                           Document{{"foreignId", 2}}});
+    lookup->setSource(mockLocalSource.get());
+
+    deque<DocumentSource::GetNextResult> mockForeignContents{
+        Document{{"_id", 0}}, Document{{"_id", 1}}, Document{{"_id", 2}}};
+    expCtx->mongoProcessInterface =
+        std::make_shared<MockMongoInterface>(std::move(mockForeignContents));
+
+    for (int foreignId : {0, 0, 1}) {
+        auto next = lookup->getNext();
+        ASSERT_TRUE(next.isAdvanced());
+        ASSERT_DOCUMENT_EQ(next.releaseDocument(),
+                           (Document{{"foreignId", foreignId},
+                                     {"foreignDocs",
+                                      vector<Value>{Value(Document{{"_id", foreignId}})}}}));
+    }
+
+    ASSERT_TRUE(lookup->getNext().isPaused());
+
+    auto next = lookup->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_DOCUMENT_EQ(
+        next.releaseDocument(),
+        (Document{{"foreignId", 2}, {"foreignDocs", vector<Value>{Value(Document{{"_id", 2}})}}}));
+
+    ASSERT_TRUE(lookup->getNext().isEOF());
+    ASSERT_TRUE(lookup->getNext().isEOF());
+    lookup->dispose();
+}
+
 BSONObj sequentialCacheStageObj(const StringData status = "kBuilding"_sd,
                                 const long long maxSizeBytes = kDefaultMaxCacheSize) {
     return BSON("$sequentialCache" << BSON("maxSizeBytes" << maxSizeBytes << "status" << status));
@@ -35,6 +35,7 @@
 #include "mongo/db/jsobj.h"
 #include "mongo/db/json.h"
 #include "mongo/db/pipeline/document.h"
+#include "mongo/db/pipeline/document_buffer_cache.h"
 #include "mongo/db/pipeline/document_comparator.h"
 #include "mongo/db/pipeline/document_value_test_util.h"
 #include "mongo/db/pipeline/field_path.h"
@@ -172,6 +173,50 @@ TEST(DocumentSerialization, CannotSerializeDocumentThatExceedsDepthLimit) {
     throwaway.abandon();
 }
 
+TEST(DocumentBufferCache, ReusesBuffersOfReleasedDocumentsWithinScope) {
+    DocumentBufferCache::Scope scope;
+    {
+        // The first document needs a new buffer, which goes to the cache when it is released.
+        MutableDocument md;
+        md.addField("a", Value(0));
+    }
+
+    const auto callsBefore = DocumentBufferCache::allocatorCallsOnThisThread();
+    for (int i = 0; i < 10; ++i) {
+        MutableDocument md;
+        md.addField("a", Value(i));
+        md.addField("b", Value(i + 1));
+        ASSERT_BSONOBJ_EQ(BSON("a" << i << "b" << i + 1), md.freeze().toBson());
+    }
+    ASSERT_EQ(callsBefore, DocumentBufferCache::allocatorCallsOnThisThread());
+}
+
+TEST(DocumentBufferCache, DoesNotReuseBuffersOutsideScope) {
+    {
+        MutableDocument md;
+        md.addField("a", Value(1));
+    }
+
+    const auto callsBefore = DocumentBufferCache::allocatorCallsOnThisThread();
+    MutableDocument md;
+    md.addField("a", Value(1));
+    ASSERT_EQ(callsBefore + 1, DocumentBufferCache::allocatorCallsOnThisThread());
+}
+
+TEST(DocumentBufferCache, DocumentsCanOutliveScope) {
+    Document doc;
+    {
+        DocumentBufferCache::Scope scope;
+        for (int i = 0; i < 10; ++i) {
+            MutableDocument md;
+            md.addField("a", Value(i));
+            md.addField("b", Value(std::string(200, 'x')));
+            doc = md.freeze();
+        }
+    }
+    ASSERT_DOCUMENT_EQ(doc, (Document{{"a", 9}, {"b", std::string(200, 'x')}}));
+}
+
 /** Add Document fields. */
 class AddField {
 public:
@@ -811,7 +811,10 @@ Value ExpressionCompare::evaluate(const Document& root, Variables* variables) co
     Value pRight(_children[1]->evaluate(root, variables));
 
     int cmp = getExpressionContext()->getValueComparator().compare(pLeft, pRight);
+    return evaluateCmp(cmpOp, cmp);
+}
 
+Value ExpressionCompare::evaluateCmp(CmpOp cmpOp, int cmp) {
     // Make cmp one of 1, 0, or -1.
     if (cmp == 0) {
         // leave as 0
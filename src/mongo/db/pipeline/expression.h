@@ -937,6 +937,12 @@ public:
         return cmpOp;
     }
 
+    /**
+     * Returns the result of the comparison 'cmpOp' given 'cmp', the result of comparing its two
+     * arguments with a ValueComparator.
+     */
+    static Value evaluateCmp(CmpOp cmpOp, int cmp);
+
     static boost::intrusive_ptr<Expression> parse(
         const boost::intrusive_ptr<ExpressionContext>& expCtx,
         BSONElement bsonExpr,
@@ -1318,6 +1324,10 @@ public:
         return _fieldPath;
     }
 
+    Variables::Id getVariableId() const {
+        return _variable;
+    }
+
     auto getFieldPathWithoutCurrentPrefix() const {
         return _fieldPath.tail();
     }
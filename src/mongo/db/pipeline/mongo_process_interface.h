@@ -371,6 +371,24 @@ public:
         const NamespaceString& nss,
         const std::set<FieldPath>& fieldPaths) const = 0;
 
+    /**
+     * Returns true if there is an index on 'nss' which can find every document whose value at
+     * 'fieldPath' equals a given value, including null.
+     *
+     * Specifically, such an index must be a btree index whose first field is 'fieldPath', not be a
+     * partial or sparse index, and match the operation's collation as given by 'expCtx'.
+     */
+    virtual bool fieldHasSupportingIndex(const boost::intrusive_ptr<ExpressionContext>& expCtx,
+                                         const NamespaceString& nss,
+                                         const FieldPath& fieldPath) const = 0;
+
+    /**
+     * Returns the total size in bytes of the documents in the collection 'nss' on this node, or 0
+     * if the collection does not exist.
+     */
+    virtual long long getCollectionDataSize(OperationContext* opCtx,
+                                            const NamespaceString& nss) const = 0;
+
     /**
      * Refreshes the CatalogCache entry for the namespace 'nss', and returns the epoch associated
      * with that namespace, if any. Note that this refresh will not necessarily force a new
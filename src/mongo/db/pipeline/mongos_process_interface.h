@@ -223,6 +223,20 @@ public:
                                          const NamespaceString&,
                                          const std::set<FieldPath>& fieldPaths) const;
 
+    /**
+     * Only used to choose how $lookup joins with a collection it reads locally, which it never does
+     * on mongos.
+     */
+    bool fieldHasSupportingIndex(const boost::intrusive_ptr<ExpressionContext>&,
+                                 const NamespaceString&,
+                                 const FieldPath&) const final {
+        MONGO_UNREACHABLE;
+    }
+
+    long long getCollectionDataSize(OperationContext*, const NamespaceString&) const final {
+        MONGO_UNREACHABLE;
+    }
+
     void checkRoutingInfoEpochOrThrow(const boost::intrusive_ptr<ExpressionContext>&,
                                       const NamespaceString&,
                                       ChunkVersion) const final {
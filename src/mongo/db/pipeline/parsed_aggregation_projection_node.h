@@ -29,6 +29,7 @@
 
 #pragma once
 
+#include "mongo/db/pipeline/compiled_expression.h"
 #include "mongo/db/pipeline/parsed_aggregation_projection.h"
 
 #include "mongo/db/query/projection_policies.h"
@@ -152,6 +153,9 @@ protected:
     stdx::unordered_map<size_t, std::unique_ptr<ProjectionNode>> _arrayBranches;
 
     StringMap<boost::intrusive_ptr<Expression>> _expressions;
+    // Programs compiled from the entries of '_expressions' by optimize(), used to evaluate them in
+    // their place. Expressions which were not compiled, or were added since, have no entry here.
+    StringMap<std::unique_ptr<CompiledExpression>> _compiledExpressions;
     stdx::unordered_set<std::string> _projectedFields;
 
     ProjectionPolicies _policies;
@@ -58,6 +58,7 @@
 #include "mongo/db/pipeline/document_source.h"
 #include "mongo/db/pipeline/document_source_change_stream.h"
 #include "mongo/db/pipeline/document_source_cursor.h"
+#include "mongo/db/pipeline/document_source_exchange.h"
 #include "mongo/db/pipeline/document_source_geo_near.h"
 #include "mongo/db/pipeline/document_source_geo_near_cursor.h"
 #include "mongo/db/pipeline/document_source_group.h"
@@ -841,6 +842,64 @@ void PipelineD::addCursorSource(Pipeline* pipeline,
     }
 }
 
+bool PipelineD::canSplitCursorSourceIntoRanges(const Collection* collection,
+                                               const Pipeline* pipeline) {
+    // Bounded scans of a record store which does not return its records in RecordId order would
+    // all read the entire collection.
+    if (!collection || collection->ns().isOplog() ||
+        !collection->getRecordStore()->isInRecordIdOrder() || pipeline->_sources.empty()) {
+        return false;
+    }
+
+    auto docSourceCursor = dynamic_cast<DocumentSourceCursor*>(pipeline->_sources.front().get());
+    return docSourceCursor && docSourceCursor->isCollectionScan() &&
+        docSourceCursor->getLimit() == -1;
+}
+
+void PipelineD::addRangeCursorSource(Collection* collection,
+                                     const Pipeline* pipeline,
+                                     Pipeline* rangePipeline,
+                                     boost::optional<RecordId> minRecord,
+                                     boost::optional<RecordId> maxRecord) {
+    invariant(canSplitCursorSourceIntoRanges(collection, pipeline));
+    const BSONObj& queryObj =
+        static_cast<DocumentSourceCursor*>(pipeline->_sources.front().get())->getQuery();
+    auto expCtx = rangePipeline->getContext();
+
+    // The query is parsed again with the ExpressionContext of 'rangePipeline', as the range may be
+    // scanned on a different thread than the $cursor stage of 'pipeline'.
+    auto qr = std::make_unique<QueryRequest>(collection->ns());
+    qr->setFilter(queryObj);
+    qr->setCollation(expCtx->getCollator() ? expCtx->getCollator()->getSpec().toBSON()
+                                           : expCtx->collation);
+    const ExtensionsCallbackReal extensionsCallback(expCtx->opCtx, &collection->ns());
+    auto cq = uassertStatusOK(CanonicalQuery::canonicalize(expCtx->opCtx,
+                                                           std::move(qr),
+                                                           expCtx,
+                                                           extensionsCallback,
+                                                           Pipeline::kAllowedMatcherFeatures));
+
+    CollectionScanParams params;
+    params.minRecord = std::move(minRecord);
+    params.maxRecord = std::move(maxRecord);
+
+    auto ws = std::make_unique<WorkingSet>();
+    auto root =
+        std::make_unique<CollectionScan>(expCtx->opCtx, collection, params, ws.get(), cq->root());
+    auto exec = uassertStatusOK(PlanExecutor::make(expCtx->opCtx,
+                                                   std::move(ws),
+                                                   std::move(root),
+                                                   std::move(cq),
+                                                   collection,
+                                                   PlanExecutor::YIELD_AUTO));
+
+    auto deps = rangePipeline->getDependencies(DepsTracker::MetadataAvailable::kNoMetadata);
+    addCursorSource(rangePipeline,
+                    DocumentSourceCursor::create(collection, std::move(exec), expCtx),
+                    std::move(deps),
+                    queryObj);
+}
+
 Timestamp PipelineD::getLatestOplogTimestamp(const Pipeline* pipeline) {
     if (auto docSourceCursor =
             dynamic_cast<DocumentSourceCursor*>(pipeline->_sources.front().get())) {
@@ -855,19 +914,51 @@ std::string PipelineD::getPlanSummaryStr(const Pipeline* pipeline) {
         return docSourceCursor->getPlanSummaryStr();
     }
 
+    if (auto gather =
+            dynamic_cast<DocumentSourceExchangeGather*>(pipeline->_sources.front().get())) {
+        std::string planSummary;
+        gather->forEachIdleConsumer([&](const Pipeline& consumer) {
+            if (planSummary.empty()) {
+                planSummary = getPlanSummaryStr(&consumer);
+            }
+        });
+        return planSummary;
+    }
+
     return "";
 }
 
 void PipelineD::getPlanSummaryStats(const Pipeline* pipeline, PlanSummaryStats* statsOut) {
     invariant(statsOut);
 
+    bool usedDisk{false};
     if (auto docSourceCursor =
             dynamic_cast<DocumentSourceCursor*>(pipeline->_sources.front().get())) {
         *statsOut = docSourceCursor->getPlanSummaryStats();
+    } else if (auto gather = dynamic_cast<DocumentSourceExchangeGather*>(
+                   pipeline->_sources.front().get())) {
+        // The consumers scan disjoint parts of the collection, so their stats add up. They run
+        // concurrently, hence the execution time is the one of the slowest consumer.
+        gather->forEachIdleConsumer([&](const Pipeline& consumer) {
+            PlanSummaryStats consumerStats;
+            getPlanSummaryStats(&consumer, &consumerStats);
+
+            statsOut->nReturned += consumerStats.nReturned;
+            statsOut->totalKeysExamined += consumerStats.totalKeysExamined;
+            statsOut->totalDocsExamined += consumerStats.totalDocsExamined;
+            statsOut->executionTimeMillis =
+                std::max(statsOut->executionTimeMillis, consumerStats.executionTimeMillis);
+            statsOut->collectionScans += consumerStats.collectionScans;
+            statsOut->collectionScansNonTailable += consumerStats.collectionScansNonTailable;
+            statsOut->indexesUsed.insert(consumerStats.indexesUsed.begin(),
+                                         consumerStats.indexesUsed.end());
+            statsOut->fromMultiPlanner |= consumerStats.fromMultiPlanner;
+            statsOut->replanned |= consumerStats.replanned;
+            usedDisk = usedDisk || consumerStats.usedDisk;
+        });
     }
 
     bool hasSortStage{false};
-    bool usedDisk{false};
     for (auto&& source : pipeline->_sources) {
         if (dynamic_cast<DocumentSourceSort*>(source.get()))
             hasSortStage = true;
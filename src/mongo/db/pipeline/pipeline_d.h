@@ -30,6 +30,7 @@
 #pragma once
 
 #include <boost/intrusive_ptr.hpp>
+#include <boost/optional.hpp>
 #include <memory>
 
 #include "mongo/bson/bsonobj.h"
@@ -39,6 +40,7 @@
 #include "mongo/db/pipeline/document_source_cursor.h"
 #include "mongo/db/pipeline/document_source_group.h"
 #include "mongo/db/query/plan_executor.h"
+#include "mongo/db/record_id.h"
 
 namespace mongo {
 class Collection;
@@ -116,9 +118,37 @@ public:
                                                            const AggregationRequest* aggRequest,
                                                            Pipeline* pipeline);
 
+    /**
+     * Returns true if 'pipeline' begins with a $cursor stage which reads all of 'collection' with a
+     * plain collection scan, without any sort or limit, such that the scan can be split into scans
+     * of disjoint RecordId ranges by addRangeCursorSource().
+     */
+    static bool canSplitCursorSourceIntoRanges(const Collection* collection,
+                                               const Pipeline* pipeline);
+
+    /**
+     * Adds a $cursor stage to the front of 'rangePipeline' which applies the query of the $cursor
+     * stage at the front of 'pipeline' to the records of 'collection' in the RecordId range
+     * [minRecord, maxRecord) only. Either end of the range may be left open. The new stage only
+     * provides the fields 'rangePipeline' depends on. canSplitCursorSourceIntoRanges() must be true
+     * for 'pipeline'.
+     */
+    static void addRangeCursorSource(Collection* collection,
+                                     const Pipeline* pipeline,
+                                     Pipeline* rangePipeline,
+                                     boost::optional<RecordId> minRecord,
+                                     boost::optional<RecordId> maxRecord);
 
+    /**
+     * Returns the plan summary of the $cursor stage feeding 'pipeline'. When 'pipeline' gathers the
+     * results of several consumer pipelines, returns the plan summary of their $cursor stages.
+     */
     static std::string getPlanSummaryStr(const Pipeline* pipeline);
 
+    /**
+     * Fills out 'statsOut' with the execution stats of 'pipeline'. When 'pipeline' gathers the
+     * results of several consumer pipelines, the stats of their $cursor stages are summed up.
+     */
     static void getPlanSummaryStats(const Pipeline* pipeline, PlanSummaryStats* statsOut);
 
     static Timestamp getLatestOplogTimestamp(const Pipeline* pipeline);
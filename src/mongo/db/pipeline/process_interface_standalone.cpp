@@ -44,6 +44,7 @@
 #include "mongo/db/cursor_manager.h"
 #include "mongo/db/db_raii.h"
 #include "mongo/db/index/index_descriptor.h"
+#include "mongo/db/index_names.h"
 #include "mongo/db/pipeline/document_source_cursor.h"
 #include "mongo/db/pipeline/lite_parsed_pipeline.h"
 #include "mongo/db/pipeline/pipeline_d.h"
@@ -137,6 +138,16 @@ bool supportsUniqueKey(const boost::intrusive_ptr<ExpressionContext>& expCtx,
             CollatorInterface::collatorsMatch(index->getCollator(), expCtx->getCollator()));
 }
 
+bool supportsEqualityLookup(const boost::intrusive_ptr<ExpressionContext>& expCtx,
+                            const IndexCatalogEntry* index,
+                            const FieldPath& fieldPath) {
+    const auto descriptor = index->descriptor();
+    return (descriptor->getAccessMethodName() == IndexNames::BTREE && !descriptor->isPartial() &&
+            !descriptor->isSparse() &&
+            descriptor->keyPattern().firstElementFieldNameStringData() == fieldPath.fullPath() &&
+            CollatorInterface::collatorsMatch(index->getCollator(), expCtx->getCollator()));
+}
+
 }  // namespace
 
 MongoInterfaceStandalone::MongoInterfaceStandalone(OperationContext* opCtx) : _client(opCtx) {}
@@ -574,6 +585,39 @@ bool MongoInterfaceStandalone::fieldsHaveSupportingUniqueIndex(
     return false;
 }
 
+bool MongoInterfaceStandalone::fieldHasSupportingIndex(
+    const boost::intrusive_ptr<ExpressionContext>& expCtx,
+    const NamespaceString& nss,
+    const FieldPath& fieldPath) const {
+    auto* opCtx = expCtx->opCtx;
+    Lock::DBLock dbLock(opCtx, nss.db(), MODE_IS);
+    Lock::CollectionLock collLock(opCtx, nss, MODE_IS);
+    auto databaseHolder = DatabaseHolder::get(opCtx);
+    auto db = databaseHolder->getDb(opCtx, nss.db());
+    auto collection = db ? db->getCollection(opCtx, nss) : nullptr;
+    if (!collection) {
+        return false;
+    }
+
+    auto indexIterator = collection->getIndexCatalog()->getIndexIterator(opCtx, false);
+    while (indexIterator->more()) {
+        if (supportsEqualityLookup(expCtx, indexIterator->next(), fieldPath)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+long long MongoInterfaceStandalone::getCollectionDataSize(OperationContext* opCtx,
+                                                          const NamespaceString& nss) const {
+    Lock::DBLock dbLock(opCtx, nss.db(), MODE_IS);
+    Lock::CollectionLock collLock(opCtx, nss, MODE_IS);
+    auto databaseHolder = DatabaseHolder::get(opCtx);
+    auto db = databaseHolder->getDb(opCtx, nss.db());
+    auto collection = db ? db->getCollection(opCtx, nss) : nullptr;
+    return collection ? static_cast<long long>(collection->dataSize(opCtx)) : 0;
+}
+
 BSONObj MongoInterfaceStandalone::_reportCurrentOpForClient(
     OperationContext* opCtx,
     Client* client,
@@ -210,6 +210,17 @@ public:
         return true;
     }
 
+    bool fieldHasSupportingIndex(const boost::intrusive_ptr<ExpressionContext>& expCtx,
+                                 const NamespaceString& nss,
+                                 const FieldPath& fieldPath) const override {
+        return false;
+    }
+
+    long long getCollectionDataSize(OperationContext* opCtx,
+                                    const NamespaceString& nss) const override {
+        return 0;
+    }
+
     boost::optional<ChunkVersion> refreshAndGetCollectionVersion(
         const boost::intrusive_ptr<ExpressionContext>& expCtx,
         const NamespaceString& nss) const override {
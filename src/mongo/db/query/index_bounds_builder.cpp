@@ -846,43 +846,45 @@ void IndexBoundsBuilder::unionize(OrderedIntervalList* oilOut) {
     // Step 1: sort.
     std::sort(iv.begin(), iv.end(), IntervalComparison);
 
-    // Step 2: Walk through and merge.
-    size_t i = 0;
-    while (i < iv.size() - 1) {
-        // Compare i with i + 1.
-        Interval::IntervalComparison cmp = iv[i].compare(iv[i + 1]);
+    // Step 2: Walk through and merge. Merged intervals are compacted towards the front of 'iv'
+    // rather than erased in place, so that lists with many redundant intervals (such as a long $in
+    // over a hashed index) are deduplicated in a single linear pass.
+    size_t last = 0;
+    for (size_t i = 1; i < iv.size(); ++i) {
+        // Compare the last merged interval with i.
+        Interval::IntervalComparison cmp = iv[last].compare(iv[i]);
 
         // This means our sort didn't work.
         verify(Interval::INTERVAL_SUCCEEDS != cmp);
 
-        // Intervals are correctly ordered.
         if (Interval::INTERVAL_PRECEDES == cmp) {
-            // We can move to the next pair.
-            ++i;
+            // Intervals are correctly ordered, so 'i' starts a new merged interval.
+            ++last;
+            if (last != i) {
+                iv[last] = std::move(iv[i]);
+            }
         } else if (Interval::INTERVAL_EQUALS == cmp || Interval::INTERVAL_WITHIN == cmp) {
-            // Interval 'i' is equal to i+1, or is contained within i+1.
-            // Remove interval i and don't move to the next value of 'i'.
-            iv.erase(iv.begin() + i);
+            // Interval 'last' is equal to i, or is contained within i. Replace it with i.
+            iv[last] = std::move(iv[i]);
         } else if (Interval::INTERVAL_CONTAINS == cmp) {
-            // Interval 'i' contains i+1, remove i+1 and don't move to the next value of 'i'.
-            iv.erase(iv.begin() + i + 1);
+            // Interval 'last' contains i, so i can be dropped.
         } else if (Interval::INTERVAL_OVERLAPS_BEFORE == cmp ||
                    Interval::INTERVAL_PRECEDES_COULD_UNION == cmp) {
-            // We want to merge intervals i and i+1.
-            // Interval 'i' starts before interval 'i+1'.
+            // We want to merge intervals 'last' and i.
+            // Interval 'last' starts before interval i.
             BSONObjBuilder bob;
-            bob.appendAs(iv[i].start, "");
-            bob.appendAs(iv[i + 1].end, "");
+            bob.appendAs(iv[last].start, "");
+            bob.appendAs(iv[i].end, "");
             BSONObj data = bob.obj();
-            bool startInclusive = iv[i].startInclusive;
-            bool endInclusive = iv[i + 1].endInclusive;
-            iv.erase(iv.begin() + i);
-            // iv[i] is now the former iv[i + 1]
-            iv[i] = makeRangeInterval(
+            bool startInclusive = iv[last].startInclusive;
+            bool endInclusive = iv[i].endInclusive;
+            iv[last] = makeRangeInterval(
                 data, IndexBounds::makeBoundInclusionFromBoundBools(startInclusive, endInclusive));
-            // Don't increment 'i'.
+        } else {
+            MONGO_UNREACHABLE;
         }
     }
+    iv.resize(last + 1);
 }
 
 // static
@@ -1206,6 +1206,28 @@ TEST(IndexBoundsBuilderTest, UnionTwoEmptyRanges) {
     ASSERT_EQUALS(oil.intervals.size(), 0U);
 }
 
+TEST(IndexBoundsBuilderTest, UnionizeMergesRedundantIntervals) {
+    OrderedIntervalList oil("a");
+    oil.intervals.push_back(Interval(fromjson("{'': 5, '': 5}"), true, true));
+    oil.intervals.push_back(Interval(fromjson("{'': 1, '': 1}"), true, true));
+    oil.intervals.push_back(Interval(fromjson("{'': 10, '': 10}"), true, true));
+    oil.intervals.push_back(Interval(fromjson("{'': 1, '': 1}"), true, true));
+    oil.intervals.push_back(Interval(fromjson("{'': 0, '': 3}"), true, true));
+    oil.intervals.push_back(Interval(fromjson("{'': 2, '': 6}"), false, false));
+    oil.intervals.push_back(Interval(fromjson("{'': 10, '': 10}"), true, true));
+    oil.intervals.push_back(Interval(fromjson("{'': 3, '': 4}"), true, true));
+    oil.intervals.push_back(Interval(fromjson("{'': 20, '': 20}"), true, true));
+
+    IndexBoundsBuilder::unionize(&oil);
+    ASSERT_EQUALS(oil.intervals.size(), 3U);
+    ASSERT_EQUALS(Interval::INTERVAL_EQUALS,
+                  oil.intervals[0].compare(Interval(fromjson("{'': 0, '': 6}"), true, false)));
+    ASSERT_EQUALS(Interval::INTERVAL_EQUALS,
+                  oil.intervals[1].compare(Interval(fromjson("{'': 10, '': 10}"), true, true)));
+    ASSERT_EQUALS(Interval::INTERVAL_EQUALS,
+                  oil.intervals[2].compare(Interval(fromjson("{'': 20, '': 20}"), true, true)));
+}
+
 //
 // Intersection tests
 //
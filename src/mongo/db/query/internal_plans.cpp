@@ -51,7 +51,9 @@ std::unique_ptr<PlanExecutor, PlanExecutor::Deleter> InternalPlanner::collection
     StringData ns,
     Collection* collection,
     PlanExecutor::YieldPolicy yieldPolicy,
-    const Direction direction) {
+    const Direction direction,
+    boost::optional<RecordId> minRecord,
+    boost::optional<RecordId> maxRecord) {
     std::unique_ptr<WorkingSet> ws = std::make_unique<WorkingSet>();
 
     if (nullptr == collection) {
@@ -65,7 +67,8 @@ std::unique_ptr<PlanExecutor, PlanExecutor::Deleter> InternalPlanner::collection
 
     invariant(ns == collection->ns().ns());
 
-    auto cs = _collectionScan(opCtx, ws.get(), collection, direction);
+    auto cs = _collectionScan(
+        opCtx, ws.get(), collection, direction, std::move(minRecord), std::move(maxRecord));
 
     // Takes ownership of 'ws' and 'cs'.
     auto statusWithPlanExecutor =
@@ -178,11 +181,15 @@ std::unique_ptr<PlanExecutor, PlanExecutor::Deleter> InternalPlanner::updateWith
 std::unique_ptr<PlanStage> InternalPlanner::_collectionScan(OperationContext* opCtx,
                                                             WorkingSet* ws,
                                                             const Collection* collection,
-                                                            Direction direction) {
+                                                            Direction direction,
+                                                            boost::optional<RecordId> minRecord,
+                                                            boost::optional<RecordId> maxRecord) {
     invariant(collection);
 
     CollectionScanParams params;
     params.shouldWaitForOplogVisibility = shouldWaitForOplogVisibility(opCtx, collection, false);
+    params.minRecord = std::move(minRecord);
+    params.maxRecord = std::move(maxRecord);
 
     if (FORWARD == direction) {
         params.direction = CollectionScanParams::FORWARD;
@@ -33,6 +33,7 @@
 
 #include "repair_database_and_check_version.h"
 
+#include <boost/filesystem/operations.hpp>
 #include <functional>
 
 #include "mongo/db/catalog/collection.h"
@@ -46,6 +47,7 @@
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/db_raii.h"
 #include "mongo/db/dbhelpers.h"
+#include "mongo/db/index/index_access_method.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/operation_context.h"
 #include "mongo/db/repair_database.h"
@@ -59,6 +61,7 @@
 #include "mongo/util/fail_point.h"
 #include "mongo/util/log.h"
 #include "mongo/util/quick_exit.h"
+#include "mongo/util/scopeguard.h"
 
 #if !defined(_WIN32)
 #include <sys/file.h>
@@ -261,6 +264,17 @@ void rebuildIndexes(OperationContext* opCtx, StorageEngine* storageEngine) {
     std::vector<StorageEngine::CollectionIndexNamePair> indexesToRebuild =
         fassert(40593, storageEngine->reconcileCatalogAndIdents(opCtx));
 
+    // Index builds that resume below take their data from the directory that index builds
+    // interrupted by the last shutdown persisted it to. None of it is needed afterwards.
+    ON_BLOCK_EXIT([] {
+        boost::system::error_code ec;
+        boost::filesystem::remove_all(IndexAccessMethod::BulkBuilder::resumeDir(), ec);
+        if (ec) {
+            warning() << "Failed to remove " << IndexAccessMethod::BulkBuilder::resumeDir() << ": "
+                      << ec.message();
+        }
+    });
+
     if (!indexesToRebuild.empty() && serverGlobalParams.indexBuildRetry) {
         log() << "note: restart the server with --noIndexBuildRetry "
               << "to skip index rebuilds";
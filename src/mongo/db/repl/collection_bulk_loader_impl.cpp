@@ -109,6 +109,14 @@ Status CollectionBulkLoaderImpl::init(const std::vector<BSONObj>& secondaryIndex
             _idIndexBlock.reset();
         }
 
+        // Bulk loading skips the OpObserver, which is only safe for user collections. Capped
+        // collections have their indexes built up front and are never bulk loaded.
+        if (collectionBulkLoaderUseRecordStoreBulkBuilder &&
+            (_idIndexBlock || _secondaryIndexesBlock) && !_nss.isSystem() &&
+            !_nss.isOnInternalDb()) {
+            _recordStoreBulkBuilder = coll->getRecordStore()->makeBulkBuilder(_opCtx.get());
+        }
+
         return Status::OK();
     });
 }
@@ -162,6 +170,26 @@ Status CollectionBulkLoaderImpl::_insertDocumentsForUncappedCollection(
     return Status::OK();
 }
 
+Status CollectionBulkLoaderImpl::_insertDocumentsWithBulkBuilder(
+    const std::vector<BSONObj>::const_iterator begin,
+    const std::vector<BSONObj>::const_iterator end) {
+    for (auto iter = begin; iter != end; ++iter) {
+        const auto& doc = *iter;
+        auto loc = _recordStoreBulkBuilder->insertRecord(doc.objdata(), doc.objsize());
+        if (!loc.isOK()) {
+            return loc.getStatus();
+        }
+
+        // Inserts index entries into the external sorter. This will not update
+        // pre-existing indexes.
+        auto status = _addDocumentToIndexBlocks(doc, loc.getValue());
+        if (!status.isOK()) {
+            return status;
+        }
+    }
+    return Status::OK();
+}
+
 Status CollectionBulkLoaderImpl::_insertDocumentsForCappedCollection(
     const std::vector<BSONObj>::const_iterator begin,
     const std::vector<BSONObj>::const_iterator end) {
@@ -191,7 +219,9 @@ Status CollectionBulkLoaderImpl::insertDocuments(const std::vector<BSONObj>::con
                                                  const std::vector<BSONObj>::const_iterator end) {
     return _runTaskReleaseResourcesOnFailure([&] {
         UnreplicatedWritesBlock uwb(_opCtx.get());
-        if (_idIndexBlock || _secondaryIndexesBlock) {
+        if (_recordStoreBulkBuilder) {
+            return _insertDocumentsWithBulkBuilder(begin, end);
+        } else if (_idIndexBlock || _secondaryIndexesBlock) {
             return _insertDocumentsForUncappedCollection(begin, end);
         } else {
             return _insertDocumentsForCappedCollection(begin, end);
@@ -205,6 +235,16 @@ Status CollectionBulkLoaderImpl::commit() {
         LOG(2) << "Creating indexes for ns: " << _nss.ns();
         UnreplicatedWritesBlock uwb(_opCtx.get());
 
+        // Finish bulk loading first so that the documents are visible to the duplicate removal
+        // below.
+        if (_recordStoreBulkBuilder) {
+            auto status = _recordStoreBulkBuilder->commit();
+            if (!status.isOK()) {
+                return status;
+            }
+            _recordStoreBulkBuilder.reset();
+        }
+
         // Commit before deleting dups, so the dups will be removed from secondary indexes when
         // deleted.
         if (_secondaryIndexesBlock) {
@@ -304,6 +344,8 @@ Status CollectionBulkLoaderImpl::commit() {
 
 void CollectionBulkLoaderImpl::_releaseResources() {
     invariant(&cc() == _opCtx->getClient());
+    _recordStoreBulkBuilder.reset();
+
     if (_secondaryIndexesBlock) {
         _secondaryIndexesBlock->cleanUpAfterBuild(_opCtx.get(), _collection);
         _secondaryIndexesBlock.reset();
@@ -38,6 +38,7 @@
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/repl/collection_bulk_loader.h"
 #include "mongo/db/repl/storage_interface.h"
+#include "mongo/db/storage/record_store.h"
 
 namespace mongo {
 namespace repl {
@@ -97,6 +98,13 @@ private:
     Status _insertDocumentsForUncappedCollection(const std::vector<BSONObj>::const_iterator begin,
                                                  const std::vector<BSONObj>::const_iterator end);
 
+    /**
+     * For uncapped collections that the storage engine can bulk load, documents are appended
+     * through '_recordStoreBulkBuilder' without any WriteUnitOfWork.
+     */
+    Status _insertDocumentsWithBulkBuilder(const std::vector<BSONObj>::const_iterator begin,
+                                           const std::vector<BSONObj>::const_iterator end);
+
     /**
      * Adds document and associated RecordId to index blocks after inserting into RecordStore.
      */
@@ -109,6 +117,7 @@ private:
     NamespaceString _nss;
     std::unique_ptr<MultiIndexBlock> _idIndexBlock;
     std::unique_ptr<MultiIndexBlock> _secondaryIndexesBlock;
+    std::unique_ptr<RecordStore::BulkBuilder> _recordStoreBulkBuilder;
     BSONObj _idIndexSpec;
     Stats _stats;
 };
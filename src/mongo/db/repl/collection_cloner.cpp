@@ -33,6 +33,7 @@
 
 #include "mongo/db/repl/collection_cloner.h"
 
+#include <algorithm>
 #include <utility>
 
 #include "mongo/base/string_data.h"
@@ -66,6 +67,14 @@ constexpr auto kCountResponseDocumentCountFieldName = "n"_sd;
 const int kProgressMeterSecondsBetween = 60;
 const int kProgressMeterCheckInterval = 128;
 
+// Collections are only split into ranges read by separate cursors if each cursor reads at least
+// this many documents.
+const long long kMinDocumentsPerCursor = 100 * 1000;
+
+// Queries stop handing over batches while this many bytes of documents wait to be inserted, so that
+// they cannot read arbitrarily far ahead of the inserts.
+const size_t kMaxDocumentsToInsertBytes = 32 * 1024 * 1024;
+
 }  // namespace
 
 // Failpoint which causes initial sync to hang before establishing its cursor to clone the
@@ -258,9 +267,14 @@ void CollectionCloner::_cancelRemainingWork_inlock() {
     if (_queryState == QueryState::kRunning) {
         _queryState = QueryState::kCanceling;
         _clientConnection->shutdownAndDisallowReconnect();
+        for (auto&& rangeConnection : _rangeConnections) {
+            rangeConnection->shutdownAndDisallowReconnect();
+        }
     } else {
         _queryState = QueryState::kFinished;
     }
+    // Wakes up queries waiting in _handleNextBatch for the inserts to catch up.
+    _condition.notify_all();
     _dbWorkTaskRunner.cancel();
 }
 
@@ -476,6 +490,7 @@ void CollectionCloner::_beginCollectionCallback(const executor::TaskExecutor::Ca
                     stdx::lock_guard<stdx::mutex> lock(_mutex);
                     _queryState = QueryState::kFinished;
                     _clientConnection.reset();
+                    _rangeConnections.clear();
                 }
                 _condition.notify_all();
                 _finishCallback(status);
@@ -522,28 +537,168 @@ void CollectionCloner::_runQuery(const executor::TaskExecutor::CallbackArgs& cal
         }
     }
 
-    Status clientConnectionStatus = _clientConnection->connect(_source, StringData());
-    if (!clientConnectionStatus.isOK()) {
+    Status connectStatus = _connect(_clientConnection.get());
+    if (!connectStatus.isOK()) {
         stdx::lock_guard<stdx::mutex> lock(_mutex);
-        onCompletionGuard->setResultAndCancelRemainingWork_inlock(lock, clientConnectionStatus);
+        onCompletionGuard->setResultAndCancelRemainingWork_inlock(lock, connectStatus);
         return;
     }
-    if (!replAuthenticate(_clientConnection.get())) {
+
+    // Read the ranges between split keys with additional cursors, each on its own connection. This
+    // thread reads the first range.
+    const auto splitKeys = _getSplitKeys(_clientConnection.get());
+    {
+        stdx::lock_guard<stdx::mutex> lock(_mutex);
+        _stats.cursors = splitKeys.size() + 1;
+        _activeQueries = splitKeys.size() + 1;
+    }
+    for (size_t i = 0; i < splitKeys.size(); ++i) {
+        BSONObj min = splitKeys[i];
+        BSONObj max = i + 1 < splitKeys.size() ? splitKeys[i + 1] : BSONObj();
+        auto scheduleResult = _executor->scheduleWork(
+            [=](const executor::TaskExecutor::CallbackArgs& callbackData) {
+                _runRangeQuery(callbackData, onCompletionGuard, min, max);
+            });
+        if (!scheduleResult.isOK()) {
+            stdx::lock_guard<stdx::mutex> lock(_mutex);
+            onCompletionGuard->setResultAndCancelRemainingWork_inlock(lock,
+                                                                      scheduleResult.getStatus());
+            return;
+        }
+    }
+
+    _queryRange(_clientConnection.get(),
+                onCompletionGuard,
+                BSONObj(),
+                splitKeys.empty() ? BSONObj() : splitKeys.front());
+}
+
+void CollectionCloner::_runRangeQuery(const executor::TaskExecutor::CallbackArgs& callbackData,
+                                      std::shared_ptr<OnCompletionGuard> onCompletionGuard,
+                                      const BSONObj& min,
+                                      const BSONObj& max) {
+    if (!callbackData.status.isOK()) {
         stdx::lock_guard<stdx::mutex> lock(_mutex);
-        onCompletionGuard->setResultAndCancelRemainingWork_inlock(
-            lock,
-            {ErrorCodes::AuthenticationFailed,
-             str::stream() << "Failed to authenticate to " << _source});
+        onCompletionGuard->setResultAndCancelRemainingWork_inlock(lock, callbackData.status);
         return;
     }
 
+    DBClientConnection* conn = nullptr;
+    {
+        stdx::lock_guard<stdx::mutex> lock(_mutex);
+        if (_queryState != QueryState::kRunning) {
+            onCompletionGuard->setResultAndCancelRemainingWork_inlock(
+                lock, {ErrorCodes::CallbackCanceled, "Collection cloning cancelled."});
+            return;
+        }
+        _rangeConnections.push_back(_createClientFn());
+        conn = _rangeConnections.back().get();
+    }
+
+    Status connectStatus = _connect(conn);
+    if (!connectStatus.isOK()) {
+        stdx::lock_guard<stdx::mutex> lock(_mutex);
+        onCompletionGuard->setResultAndCancelRemainingWork_inlock(lock, connectStatus);
+        return;
+    }
+
+    _queryRange(conn, onCompletionGuard, min, max);
+}
+
+Status CollectionCloner::_connect(DBClientConnection* conn) {
+    Status clientConnectionStatus = conn->connect(_source, StringData());
+    if (!clientConnectionStatus.isOK()) {
+        return clientConnectionStatus;
+    }
+    if (!replAuthenticate(conn)) {
+        return {ErrorCodes::AuthenticationFailed,
+                str::stream() << "Failed to authenticate to " << _source};
+    }
+    return Status::OK();
+}
+
+std::vector<BSONObj> CollectionCloner::_getSplitKeys(DBClientConnection* conn) {
+    long long documentsToCopy = 0;
+    {
+        stdx::lock_guard<stdx::mutex> lock(_mutex);
+        if (_idIndexSpec.isEmpty()) {
+            return {};
+        }
+        documentsToCopy = _stats.documentToCopy;
+    }
+
+    const long long numRanges = std::min<long long>(
+        initialSyncMaxCursorsPerCollectionCloner.load(), documentsToCopy / kMinDocumentsPerCursor);
+    if (numRanges < 2) {
+        return {};
+    }
+
+    // splitVector picks a split key every 'maxChunkObjects' documents as long as the chunk size
+    // limit is not smaller, so pass the size of the whole collection as that limit.
+    const auto dbName = _sourceNss.db().toString();
     try {
-        _clientConnection->query(
+        BSONObj collStats;
+        if (!conn->runCommand(dbName, BSON("collStats" << _sourceNss.coll()), collStats)) {
+            LOG(1) << "Reading " << _sourceNss << " with a single cursor, collStats failed: "
+                   << getStatusFromCommandResult(collStats);
+            return {};
+        }
+
+        BSONObj splitVectorResult;
+        if (!conn->runCommand(dbName,
+                              BSON("splitVector" << _sourceNss.ns() << "keyPattern"
+                                                 << BSON("_id" << 1) << "maxChunkSizeBytes"
+                                                 << collStats["size"].safeNumberLong()
+                                                 << "maxChunkObjects"
+                                                 << (documentsToCopy + numRanges - 1) / numRanges
+                                                 << "maxSplitPoints" << numRanges - 1),
+                              splitVectorResult)) {
+            LOG(1) << "Reading " << _sourceNss << " with a single cursor, splitVector failed: "
+                   << getStatusFromCommandResult(splitVectorResult);
+            return {};
+        }
+
+        std::vector<BSONObj> splitKeys;
+        BSONElement splitKeysElem = splitVectorResult["splitKeys"];
+        if (splitKeysElem.type() == Array) {
+            for (auto&& splitKey : splitKeysElem.Obj()) {
+                if (splitKey.type() == Object) {
+                    splitKeys.push_back(splitKey.Obj().getOwned());
+                }
+            }
+        }
+        log() << "Reading " << _sourceNss << " with " << splitKeys.size() + 1 << " cursors";
+        return splitKeys;
+    } catch (const DBException& ex) {
+        LOG(1) << "Reading " << _sourceNss << " with a single cursor: " << redact(ex.toStatus());
+        return {};
+    }
+}
+
+void CollectionCloner::_queryRange(DBClientConnection* conn,
+                                   std::shared_ptr<OnCompletionGuard> onCompletionGuard,
+                                   const BSONObj& min,
+                                   const BSONObj& max) {
+    Query query = QUERY("query" << BSONObj() << "$readOnce" << true);
+    if (!min.isEmpty() || !max.isEmpty()) {
+        // Index bounds are not type bracketed, unlike range predicates, so the ranges cover
+        // documents with _id values of every type.
+        query.hint(BSON("_id" << 1));
+        if (!min.isEmpty()) {
+            query.minKey(min);
+        }
+        if (!max.isEmpty()) {
+            query.maxKey(max);
+        }
+    }
+
+    try {
+        conn->query(
             [this, onCompletionGuard](DBClientCursorBatchIterator& iter) {
                 _handleNextBatch(onCompletionGuard, iter);
             },
             NamespaceStringOrUUID(_sourceNss.db().toString(), *_options.uuid),
-            QUERY("query" << BSONObj() << "$readOnce" << true),
+            query,
             nullptr /* fieldsToReturn */,
             QueryOption_NoCursorTimeout | QueryOption_SlaveOk |
                 (collectionClonerUsesExhaust ? QueryOption_Exhaust : 0),
@@ -570,6 +725,14 @@ void CollectionCloner::_runQuery(const executor::TaskExecutor::CallbackArgs& cal
             return;
         }
     }
+
+    {
+        stdx::lock_guard<stdx::mutex> lock(_mutex);
+        invariant(_activeQueries > 0);
+        if (--_activeQueries > 0) {
+            return;
+        }
+    }
     waitForDbWorker();
     stdx::lock_guard<stdx::mutex> lock(_mutex);
     onCompletionGuard->setResultAndCancelRemainingWork_inlock(lock, Status::OK());
@@ -577,14 +740,19 @@ void CollectionCloner::_runQuery(const executor::TaskExecutor::CallbackArgs& cal
 
 void CollectionCloner::_handleNextBatch(std::shared_ptr<OnCompletionGuard> onCompletionGuard,
                                         DBClientCursorBatchIterator& iter) {
-    _stats.receivedBatches++;
     {
-        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        _stats.receivedBatches++;
+        _condition.wait(lk, [this] {
+            return _queryState == QueryState::kCanceling ||
+                _documentsToInsertBytes < kMaxDocumentsToInsertBytes;
+        });
         uassert(ErrorCodes::CallbackCanceled,
                 "Collection cloning cancelled.",
                 _queryState != QueryState::kCanceling);
         while (iter.moreInCurrentBatch()) {
             BSONObj o = iter.nextSafe();
+            _documentsToInsertBytes += o.objsize();
             _documentsToInsert.emplace_back(std::move(o));
         }
     }
@@ -689,15 +857,24 @@ void CollectionCloner::_insertDocumentsCallback(
     UniqueLock lk(_mutex);
     std::vector<BSONObj> docs;
     if (_documentsToInsert.size() == 0) {
-        warning() << "_insertDocumentsCallback, but no documents to insert for ns:" << _destNss;
+        // An earlier callback already took the documents of the batch this one was scheduled for.
+        LOG(2) << "_insertDocumentsCallback, but no documents to insert for ns:" << _destNss;
         return;
     }
     _documentsToInsert.swap(docs);
+    _documentsToInsertBytes = 0;
+    _condition.notify_all();
     _stats.documentsCopied += docs.size();
     ++_stats.fetchedBatches;
     _progressMeter.hit(int(docs.size()));
     invariant(_collLoader);
+
+    // Do not hold the mutex while writing, so that the queries can keep buffering documents up to
+    // kMaxDocumentsToInsertBytes. Inserts are serialized by '_dbWorkTaskRunner', and '_collLoader'
+    // is not released before the completion guard held by this callback.
+    lk.unlock();
     const auto status = _collLoader->insertDocuments(docs.cbegin(), docs.cend());
+    lk.lock();
     if (!status.isOK()) {
         onCompletionGuard->setResultAndCancelRemainingWork_inlock(lk, status);
         return;
@@ -793,6 +970,7 @@ void CollectionCloner::Stats::append(BSONObjBuilder* builder) const {
         }
     }
     builder->appendNumber("receivedBatches", receivedBatches);
+    builder->appendNumber("cursors", cursors);
 }
 }  // namespace repl
 }  // namespace mongo
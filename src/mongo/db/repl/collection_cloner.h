@@ -82,6 +82,7 @@ public:
         size_t indexes{0};
         size_t fetchedBatches{0};  // This is actually inserted batches.
         size_t receivedBatches{0};
+        size_t cursors{0};
 
         std::string toString() const;
         BSONObj toBSON() const;
@@ -219,9 +220,39 @@ private:
     void _runQuery(const executor::TaskExecutor::CallbackArgs& callbackData,
                    std::shared_ptr<OnCompletionGuard> onCompletionGuard);
 
+    /**
+     * Using its own DBClientConnection, executes a query to retrieve the documents in the range
+     * ['min', 'max') of the _id index. Used to read a large collection with multiple cursors.
+     */
+    void _runRangeQuery(const executor::TaskExecutor::CallbackArgs& callbackData,
+                        std::shared_ptr<OnCompletionGuard> onCompletionGuard,
+                        const BSONObj& min,
+                        const BSONObj& max);
+
+    /**
+     * Connects and authenticates 'conn' to the sync source.
+     */
+    Status _connect(DBClientConnection* conn);
+
+    /**
+     * Returns the _id index keys at which to split the collection so that each range can be read
+     * by its own cursor, or no keys if the collection should be read by a single cursor.
+     */
+    std::vector<BSONObj> _getSplitKeys(DBClientConnection* conn);
+
+    /**
+     * Reads the documents in the range ['min', 'max') of the _id index, or the whole collection if
+     * both are empty, and hands every batch to _handleNextBatch. The last query to finish waits
+     * for the remaining inserts and reports success.
+     */
+    void _queryRange(DBClientConnection* conn,
+                     std::shared_ptr<OnCompletionGuard> onCompletionGuard,
+                     const BSONObj& min,
+                     const BSONObj& max);
+
     /**
      * Put all results from a query batch into a buffer to be inserted, and schedule
-     * it to be inserted.
+     * it to be inserted. Waits for the inserts to catch up first if the buffer is full.
      */
     void _handleNextBatch(std::shared_ptr<OnCompletionGuard> onCompletionGuard,
                           DBClientCursorBatchIterator& iter);
@@ -275,6 +306,7 @@ private:
     std::vector<BSONObj> _indexSpecs;             // (M)
     BSONObj _idIndexSpec;                         // (M)
     std::vector<BSONObj> _documentsToInsert;      // (M) Documents read from source to insert.
+    size_t _documentsToInsertBytes = 0;           // (M) Total size of '_documentsToInsert'.
     TaskRunner _dbWorkTaskRunner;                 // (R)
     ScheduleDbWorkFn
         _scheduleDbWorkFn;  // (RT) Function for scheduling database work using the executor.
@@ -302,6 +334,14 @@ private:
     // allow cancellation, and those other threads may access it only when holding '_mutex'.
     std::unique_ptr<DBClientConnection> _clientConnection;
 
+    // (M) Client connections used by _runRangeQuery, following the same rules as
+    // '_clientConnection'.
+    std::vector<std::unique_ptr<DBClientConnection>> _rangeConnections;
+
+    // (M) Number of queries, over the whole collection or over a range of it, that have not
+    // finished yet.
+    size_t _activeQueries = 0;
+
     // State transitions:
     // PreStart --> Running --> ShuttingDown --> Complete
     // It is possible to skip intermediate states. For example,
@@ -36,11 +36,13 @@
 #include "mongo/db/operation_context.h"
 #include "mongo/db/repl/base_cloner_test_fixture.h"
 #include "mongo/db/repl/collection_cloner.h"
+#include "mongo/db/repl/repl_server_parameters_gen.h"
 #include "mongo/db/repl/storage_interface.h"
 #include "mongo/db/repl/storage_interface_mock.h"
 #include "mongo/dbtests/mock/mock_dbclient_connection.h"
 #include "mongo/unittest/task_executor_proxy.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/scopeguard.h"
 #include "mongo/util/str.h"
 
 namespace {
@@ -101,6 +103,7 @@ public:
                 lk.lock();
             }
             _waiting = false;
+            _queries.push_back(query.obj.getOwned());
         }
         auto result = MockDBClientConnection::query(
             f, nsOrUuid, query, fieldsToReturn, queryOptions, batchSize);
@@ -116,6 +119,11 @@ public:
         _failureForQuery = failure;
     }
 
+    std::vector<BSONObj> getQueries() {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        return _queries;
+    }
+
     void pause() {
         {
             stdx::lock_guard<stdx::mutex> lk(_mutex);
@@ -161,6 +169,7 @@ private:
     int _resumedQueryCount = 0;
     Status _failureForConnect = Status::OK();
     Status _failureForQuery = Status::OK();
+    std::vector<BSONObj> _queries;
 
     void _resume(stdx::unique_lock<stdx::mutex>* lk) {
         invariant(lk->owns_lock());
@@ -1074,6 +1083,112 @@ TEST_F(CollectionClonerTest, InsertDocumentsMultipleBatches) {
     ASSERT_FALSE(collectionCloner->isActive());
 }
 
+/**
+ * Reads collections of 200000 documents, which is enough for two cursors, with up to two cursors.
+ * The mock servers ignore the bounds of queries, so the connection that reads the second range is
+ * to a server of its own holding only the documents of that range.
+ */
+class CollectionClonerSplitRangesTest : public CollectionClonerTest {
+protected:
+    void setUp() override {
+        CollectionClonerTest::setUp();
+        _maxCursors = initialSyncMaxCursorsPerCollectionCloner.load();
+        initialSyncMaxCursorsPerCollectionCloner.store(2);
+
+        _server->insert(nss.ns(), BSON("_id" << 1));
+        _server->insert(nss.ns(), BSON("_id" << 2));
+        _server->setCommandReply("collStats", BSON("ok" << 1 << "size" << 1024));
+
+        _rangeServer = std::make_unique<MockRemoteDBServer>(target.toString());
+        _rangeServer->assignCollectionUuid(nss.ns(), *options.uuid);
+        _rangeServer->insert(nss.ns(), BSON("_id" << 3));
+        _rangeServer->insert(nss.ns(), BSON("_id" << 4));
+        _rangeServer->insert(nss.ns(), BSON("_id" << 5));
+        _rangeClient = new FailableMockDBClientConnection(_rangeServer.get(), getNet());
+
+        collectionCloner->setCreateClientFn_forTest([this]() {
+            if (!_clientCreated) {
+                _clientCreated = true;
+                return std::unique_ptr<DBClientConnection>(_client);
+            }
+            invariant(!_rangeClientCreated);
+            _rangeClientCreated = true;
+            return std::unique_ptr<DBClientConnection>(_rangeClient);
+        });
+    }
+
+    void tearDown() override {
+        CollectionClonerTest::tearDown();
+        if (!_rangeClientCreated)
+            delete _rangeClient;
+        _rangeServer.reset();
+        initialSyncMaxCursorsPerCollectionCloner.store(_maxCursors);
+    }
+
+    void runCloner() {
+        ASSERT_OK(collectionCloner->startup());
+        {
+            executor::NetworkInterfaceMock::InNetworkGuard guard(getNet());
+            processNetworkResponse(createCountResponse(200000));
+            processNetworkResponse(createListIndexesResponse(0, BSON_ARRAY(idIndexSpec)));
+        }
+        collectionCloner->join();
+    }
+
+    int _maxCursors = 1;
+    bool _rangeClientCreated = false;
+    FailableMockDBClientConnection* _rangeClient;  // owned by the CollectionCloner once created.
+    std::unique_ptr<MockRemoteDBServer> _rangeServer;
+};
+
+TEST_F(CollectionClonerSplitRangesTest, InsertDocumentsFromEachRange) {
+    _server->setCommandReply("splitVector",
+                             BSON("ok" << 1 << "splitKeys" << BSON_ARRAY(BSON("_id" << 3))));
+    runCloner();
+
+    ASSERT_OK(getStatus());
+    ASSERT_FALSE(collectionCloner->isActive());
+    ASSERT_EQUALS(5, collectionStats->insertCount);
+    ASSERT_TRUE(collectionStats->commitCalled);
+    ASSERT_EQUALS(2U, collectionCloner->getStats().cursors);
+
+    // The first range is read by the initial connection, the second one by its own connection.
+    ASSERT_TRUE(_rangeClientCreated);
+    auto queries = _client->getQueries();
+    ASSERT_EQUALS(1U, queries.size());
+    ASSERT_BSONOBJ_EQ(BSON("_id" << 1), queries[0]["$hint"].Obj());
+    ASSERT_FALSE(queries[0].hasField("$min"));
+    ASSERT_BSONOBJ_EQ(BSON("_id" << 3), queries[0]["$max"].Obj());
+
+    queries = _rangeClient->getQueries();
+    ASSERT_EQUALS(1U, queries.size());
+    ASSERT_BSONOBJ_EQ(BSON("_id" << 1), queries[0]["$hint"].Obj());
+    ASSERT_BSONOBJ_EQ(BSON("_id" << 3), queries[0]["$min"].Obj());
+    ASSERT_FALSE(queries[0].hasField("$max"));
+}
+
+TEST_F(CollectionClonerSplitRangesTest, SplitVectorFailureFallsBackToASingleCursor) {
+    _server->setCommandReply("splitVector",
+                             BSON("ok" << 0 << "errmsg"
+                                       << "splitVector failed"
+                                       << "code" << ErrorCodes::OperationFailed));
+    runCloner();
+
+    ASSERT_OK(getStatus());
+    ASSERT_FALSE(collectionCloner->isActive());
+    ASSERT_EQUALS(2, collectionStats->insertCount);
+    ASSERT_TRUE(collectionStats->commitCalled);
+    ASSERT_EQUALS(1U, collectionCloner->getStats().cursors);
+
+    // The whole collection is read by the initial connection, without bounds.
+    ASSERT_FALSE(_rangeClientCreated);
+    auto queries = _client->getQueries();
+    ASSERT_EQUALS(1U, queries.size());
+    ASSERT_FALSE(queries[0].hasField("$hint"));
+    ASSERT_FALSE(queries[0].hasField("$min"));
+    ASSERT_FALSE(queries[0].hasField("$max"));
+}
+
 TEST_F(CollectionClonerTest, CollectionClonerTransitionsToCompleteIfShutdownBeforeStartup) {
     collectionCloner->shutdown();
     ASSERT_EQUALS(ErrorCodes::ShutdownInProgress, collectionCloner->startup());
@@ -231,6 +231,7 @@ void DatabaseCloner::shutdown() {
 DatabaseCloner::Stats DatabaseCloner::getStats() const {
     LockGuard lk(_mutex);
     DatabaseCloner::Stats stats = _stats;
+    stats.activeCollections = _activeCollectionCloners;
     for (auto&& collectionCloner : _collectionCloners) {
         stats.collectionStats.emplace_back(collectionCloner.getStats());
     }
@@ -401,17 +402,33 @@ void DatabaseCloner::_listCollectionsCallback(const StatusWith<Fetcher::QueryRes
         }
     }
 
-    // Start first collection cloner.
-    _currentCollectionClonerIter = _collectionCloners.begin();
+    _nextCollectionClonerIter = _collectionCloners.begin();
+    _startCollectionCloners_inlock();
+    if (_activeCollectionCloners == 0) {
+        _finishCallback_inlock(lk, _failStatus);
+        return;
+    }
+}
 
-    LOG(1) << "    cloning collection " << _currentCollectionClonerIter->getSourceNamespace();
+void DatabaseCloner::_startCollectionCloners_inlock() {
+    const size_t maxActive = initialSyncMaxConcurrentCollectionCloners.load();
+    while (_failStatus.isOK() && _activeCollectionCloners < maxActive &&
+           _nextCollectionClonerIter != _collectionCloners.end()) {
+        auto& collectionCloner = *_nextCollectionClonerIter++;
 
-    Status startStatus = _startCollectionCloner(*_currentCollectionClonerIter);
-    if (!startStatus.isOK()) {
-        LOG(1) << "    failed to start collection cloning on "
-               << _currentCollectionClonerIter->getSourceNamespace() << ": " << redact(startStatus);
-        _finishCallback_inlock(lk, startStatus);
-        return;
+        LOG(1) << "    cloning collection " << collectionCloner.getSourceNamespace();
+
+        Status startStatus = _startCollectionCloner(collectionCloner);
+        if (!startStatus.isOK()) {
+            LOG(1) << "    failed to start collection cloning on "
+                   << collectionCloner.getSourceNamespace() << ": " << redact(startStatus);
+            _failStatus = startStatus;
+            for (auto&& cloner : _collectionCloners) {
+                cloner.shutdown();
+            }
+            return;
+        }
+        ++_activeCollectionCloners;
     }
 }
 
@@ -430,30 +447,26 @@ void DatabaseCloner::_collectionClonerCallback(const Status& status, const Names
     _collectionWork(collStatus, nss);
     lk.lock();
 
+    invariant(_activeCollectionCloners > 0);
+    --_activeCollectionCloners;
+
     // Failure to clone a collection will stop the database cloner from
     // cloning the rest of the collections in the listCollections result.
     if (!collStatus.isOK()) {
-        Status failStatus = {ErrorCodes::InitialSyncFailure, collStatus.toString()};
-        _finishCallback_inlock(lk, failStatus);
-        return;
-    }
-
-    ++_stats.clonedCollections;
-    _currentCollectionClonerIter++;
-
-    if (_currentCollectionClonerIter != _collectionCloners.end()) {
-        Status startStatus = _startCollectionCloner(*_currentCollectionClonerIter);
-        if (!startStatus.isOK()) {
-            LOG(1) << "    failed to start collection cloning on "
-                   << _currentCollectionClonerIter->getSourceNamespace() << ": "
-                   << redact(startStatus);
-            _finishCallback_inlock(lk, startStatus);
-            return;
+        if (_failStatus.isOK()) {
+            _failStatus = {ErrorCodes::InitialSyncFailure, collStatus.toString()};
+            for (auto&& collectionCloner : _collectionCloners) {
+                collectionCloner.shutdown();
+            }
         }
-        return;
+    } else {
+        ++_stats.clonedCollections;
     }
 
-    _finishCallback_inlock(lk, Status::OK());
+    _startCollectionCloners_inlock();
+    if (_activeCollectionCloners == 0) {
+        _finishCallback_inlock(lk, _failStatus);
+    }
 }
 
 void DatabaseCloner::_finishCallback(const Status& status) {
@@ -491,6 +504,7 @@ BSONObj DatabaseCloner::Stats::toBSON() const {
 void DatabaseCloner::Stats::append(BSONObjBuilder* builder) const {
     builder->appendNumber("collections", collections);
     builder->appendNumber("clonedCollections", clonedCollections);
+    builder->appendNumber("activeCollections", activeCollections);
     if (start != Date_t()) {
         builder->appendDate("start", start);
         if (end != Date_t()) {
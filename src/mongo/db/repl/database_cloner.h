@@ -62,6 +62,7 @@ public:
         Date_t end;
         size_t collections{0};
         size_t clonedCollections{0};
+        size_t activeCollections{0};
         std::vector<CollectionCloner::Stats> collectionStats;
 
         std::string toString() const;
@@ -189,9 +190,17 @@ private:
     /**
      * Forwards collection cloner result to client.
      * Starts a new cloner on a different collection.
+     * Reports completion once the last active collection cloner has finished.
      */
     void _collectionClonerCallback(const Status& status, const NamespaceString& nss);
 
+    /**
+     * Starts collection cloners until initialSyncMaxConcurrentCollectionCloners are active or
+     * every collection cloner has been started. If a cloner fails to start, records the failure in
+     * '_failStatus' and shuts down the active cloners.
+     */
+    void _startCollectionCloners_inlock();
+
     /**
      * Reports completion status.
      * Sets cloner to inactive.
@@ -234,8 +243,11 @@ private:
     // Holds all collection infos from listCollections.
     std::vector<BSONObj> _collectionInfos;                               // (M)
     std::vector<NamespaceString> _collectionNamespaces;                  // (M)
-    std::list<CollectionCloner> _collectionCloners;                      // (M)
-    std::list<CollectionCloner>::iterator _currentCollectionClonerIter;  // (M)
+    std::list<CollectionCloner> _collectionCloners;                   // (M)
+    std::list<CollectionCloner>::iterator _nextCollectionClonerIter;  // (M)
+    size_t _activeCollectionCloners = 0;                              // (M)
+    // (M) First error from a collection cloner. Reported once all active cloners have finished.
+    Status _failStatus = Status::OK();
     ScheduleDbWorkFn
         _scheduleDbWorkFn;  // (RT) Function for scheduling database work using the executor.
     StartCollectionClonerFn _startCollectionCloner;  // (RT)
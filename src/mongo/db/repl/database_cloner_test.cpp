@@ -38,10 +38,12 @@
 #include "mongo/db/jsobj.h"
 #include "mongo/db/repl/base_cloner_test_fixture.h"
 #include "mongo/db/repl/database_cloner.h"
+#include "mongo/db/repl/repl_server_parameters_gen.h"
 #include "mongo/db/repl/storage_interface.h"
 #include "mongo/dbtests/mock/mock_dbclient_connection.h"
 #include "mongo/unittest/task_executor_proxy.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/scopeguard.h"
 #include "mongo/util/str.h"
 #include "mongo/util/uuid.h"
 
@@ -882,4 +884,58 @@ TEST_F(DatabaseClonerTest, CreateCollections) {
     stats.commitCalled = true;
 }
 
+
+TEST_F(DatabaseClonerTest, CreateCollectionsConcurrently) {
+    auto maxConcurrentCollectionCloners = initialSyncMaxConcurrentCollectionCloners.load();
+    ON_BLOCK_EXIT([maxConcurrentCollectionCloners] {
+        initialSyncMaxConcurrentCollectionCloners.store(maxConcurrentCollectionCloners);
+    });
+    initialSyncMaxConcurrentCollectionCloners.store(2);
+
+    ASSERT_OK(_databaseCloner->startup());
+    ASSERT_EQUALS(DatabaseCloner::State::kRunning, _databaseCloner->getState_forTest());
+
+    const std::vector<BSONObj> sourceInfos = {BSON("name"
+                                                   << "a"
+                                                   << "options" << _options1.toBSON()),
+                                              BSON("name"
+                                                   << "b"
+                                                   << "options" << _options2.toBSON())};
+    auto net = getNet();
+    {
+        executor::NetworkInterfaceMock::InNetworkGuard guard(net);
+        processNetworkResponse(
+            createListCollectionsResponse(0, BSON_ARRAY(sourceInfos[0] << sourceInfos[1])));
+
+        // Both collection cloners start before either of them finishes.
+        auto noi = net->getNextReadyRequest();
+        assertRemoteCommandNameEquals("count", noi->getRequest());
+        ASSERT_EQUALS(*_options1.uuid, UUID::parse(noi->getRequest().cmdObj.firstElement()));
+        net->scheduleSuccessfulResponse(
+            noi, executor::RemoteCommandResponse(createCountResponse(0), Milliseconds(0)));
+
+        noi = net->getNextReadyRequest();
+        assertRemoteCommandNameEquals("count", noi->getRequest());
+        ASSERT_EQUALS(*_options2.uuid, UUID::parse(noi->getRequest().cmdObj.firstElement()));
+        net->scheduleSuccessfulResponse(
+            noi, executor::RemoteCommandResponse(createCountResponse(0), Milliseconds(0)));
+        net->runReadyNetworkOperations();
+
+        ASSERT_EQUALS(2U, _databaseCloner->getStats().activeCollections);
+
+        processNetworkResponse(createListIndexesResponse(0, BSON_ARRAY(idIndexSpec)));
+        processNetworkResponse(createListIndexesResponse(0, BSON_ARRAY(idIndexSpec)));
+    }
+
+    _databaseCloner->join();
+    ASSERT_OK(getStatus());
+    ASSERT_FALSE(_databaseCloner->isActive());
+    ASSERT_EQUALS(DatabaseCloner::State::kComplete, _databaseCloner->getState_forTest());
+
+    ASSERT_EQUALS(2U, _collections.size());
+    ASSERT_OK(_collections[NamespaceString{"db.a"}].status);
+    ASSERT_OK(_collections[NamespaceString{"db.b"}].status);
+    ASSERT_EQUALS(2U, _databaseCloner->getStats().clonedCollections);
+}
+
 }  // namespace
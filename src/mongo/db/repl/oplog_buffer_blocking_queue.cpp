@@ -39,16 +39,16 @@ namespace {
 // Limit buffer to 256MB
 const size_t kOplogBufferSize = 256 * 1024 * 1024;
 
-size_t getDocumentSize(const BSONObj& o) {
-    // SERVER-9808 Avoid Fortify complaint about implicit signed->unsigned conversion
-    return static_cast<size_t>(o.objsize());
-}
+// Limit buffer to 256K entries, which only binds before the size limit when entries are under 1KB
+// on average. That is still dozens of default sized batches of lookahead for the applier. Like the
+// size limit this is only enforced by waitForSpace(); push() spills past it rather than blocking.
+const size_t kOplogBufferSlots = 256 * 1024;
 
 }  // namespace
 
 OplogBufferBlockingQueue::OplogBufferBlockingQueue() : OplogBufferBlockingQueue(nullptr) {}
 OplogBufferBlockingQueue::OplogBufferBlockingQueue(Counters* counters)
-    : _counters(counters), _queue(kOplogBufferSize, &getDocumentSize) {}
+    : _counters(counters), _queue(kOplogBufferSlots, kOplogBufferSize) {}
 
 void OplogBufferBlockingQueue::startup(OperationContext*) {
     // Update server status metric to reflect the current oplog buffer's max size.
@@ -64,7 +64,7 @@ void OplogBufferBlockingQueue::shutdown(OperationContext* opCtx) {
 void OplogBufferBlockingQueue::push(OperationContext*,
                                     Batch::const_iterator begin,
                                     Batch::const_iterator end) {
-    _queue.pushAllNonBlocking(begin, end);
+    _queue.pushMany(begin, end);
     if (_counters) {
         for (auto i = begin; i != end; ++i) {
             _counters->increment(*i);
@@ -85,7 +85,7 @@ std::size_t OplogBufferBlockingQueue::getMaxSize() const {
 }
 
 std::size_t OplogBufferBlockingQueue::getSize() const {
-    return _queue.size();
+    return _queue.cost();
 }
 
 std::size_t OplogBufferBlockingQueue::getCount() const {
@@ -100,7 +100,7 @@ void OplogBufferBlockingQueue::clear(OperationContext*) {
 }
 
 bool OplogBufferBlockingQueue::tryPop(OperationContext*, Value* value) {
-    if (!_queue.tryPop(*value)) {
+    if (!_queue.tryPop(value)) {
         return false;
     }
     if (_counters) {
@@ -110,12 +110,11 @@ bool OplogBufferBlockingQueue::tryPop(OperationContext*, Value* value) {
 }
 
 bool OplogBufferBlockingQueue::waitForData(Seconds waitDuration) {
-    Value ignored;
-    return _queue.blockingPeek(ignored, static_cast<int>(durationCount<Seconds>(waitDuration)));
+    return _queue.waitForData(waitDuration);
 }
 
 bool OplogBufferBlockingQueue::peek(OperationContext*, Value* value) {
-    return _queue.peek(*value);
+    return _queue.peek(value);
 }
 
 boost::optional<OplogBuffer::Value> OplogBufferBlockingQueue::lastObjectPushed(
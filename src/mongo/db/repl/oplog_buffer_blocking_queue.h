@@ -30,13 +30,13 @@
 #pragma once
 
 #include "mongo/db/repl/oplog_buffer.h"
-#include "mongo/util/queue.h"
+#include "mongo/util/mpsc_ring_buffer.h"
 
 namespace mongo {
 namespace repl {
 
 /**
- * Oplog buffer backed by in memory blocking queue of BSONObj.
+ * Oplog buffer backed by an in memory ring buffer of BSONObj.
  */
 class OplogBufferBlockingQueue final : public OplogBuffer {
 public:
@@ -60,8 +60,15 @@ public:
     boost::optional<Value> lastObjectPushed(OperationContext* opCtx) const override;
 
 private:
+    struct DocumentSize {
+        size_t operator()(const BSONObj& o) const {
+            // SERVER-9808 Avoid Fortify complaint about implicit signed->unsigned conversion
+            return static_cast<size_t>(o.objsize());
+        }
+    };
+
     Counters* const _counters;
-    BlockingQueue<BSONObj> _queue;
+    MultiProducerSingleConsumerRingBuffer<BSONObj, DocumentSize> _queue;
 };
 
 }  // namespace repl
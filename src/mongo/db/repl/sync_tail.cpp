@@ -66,6 +66,7 @@
 #include "mongo/db/repl/initial_syncer.h"
 #include "mongo/db/repl/multiapplier.h"
 #include "mongo/db/repl/repl_client_info.h"
+#include "mongo/db/repl/repl_server_parameters_gen.h"
 #include "mongo/db/repl/repl_set_config.h"
 #include "mongo/db/repl/replication_auth.h"
 #include "mongo/db/repl/replication_coordinator.h"
@@ -75,6 +76,7 @@
 #include "mongo/db/stats/timer_stats.h"
 #include "mongo/db/transaction_participant.h"
 #include "mongo/db/transaction_participant_gen.h"
+#include "mongo/stdx/unordered_map.h"
 #include "mongo/util/exit.h"
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/log.h"
@@ -960,6 +962,49 @@ Status multiSyncApply(OperationContext* opCtx,
     return Status::OK();
 }
 
+/**
+ * Picks the writer thread for each operation of a batch from the hash of the document (or
+ * namespace) it depends on. Operations with the same hash always go to the same writer so that
+ * they are applied in oplog order. A hash that was not seen before in the batch goes to the writer
+ * with the fewest operations so far when 'replBalanceWriterVectors' is set, instead of the writer
+ * picked by the hash modulo the number of writers. This keeps a hot document or namespace from
+ * sharing its writer with unrelated operations that could run on idle writers.
+ */
+class SyncTail::WriterAssigner {
+    WriterAssigner(const WriterAssigner&) = delete;
+    WriterAssigner& operator=(const WriterAssigner&) = delete;
+
+public:
+    explicit WriterAssigner(std::vector<MultiApplier::OperationPtrs>* writerVectors)
+        : _writerVectors(writerVectors), _balance(replBalanceWriterVectors.load()) {}
+
+    MultiApplier::OperationPtrs& getWriter(uint32_t hash) {
+        const uint32_t numWriters = _writerVectors->size();
+        if (!_balance || numWriters == 1) {
+            return (*_writerVectors)[hash % numWriters];
+        }
+
+        auto it = _writerByHash.find(hash);
+        if (it == _writerByHash.end()) {
+            uint32_t leastLoaded = hash % numWriters;
+            for (uint32_t i = 0; i < numWriters; ++i) {
+                if ((*_writerVectors)[i].size() < (*_writerVectors)[leastLoaded].size()) {
+                    leastLoaded = i;
+                }
+            }
+            it = _writerByHash.emplace(hash, leastLoaded).first;
+        }
+        return (*_writerVectors)[it->second];
+    }
+
+private:
+    std::vector<MultiApplier::OperationPtrs>* const _writerVectors;
+    const bool _balance;
+
+    // Writer of every hash seen in this batch, including in the derived operations.
+    stdx::unordered_map<uint32_t, uint32_t> _writerByHash;
+};
+
 /**
  * ops - This only modifies the isForCappedCollection field on each op. It does not alter the ops
  *      vector in any other way.
@@ -968,17 +1013,19 @@ Status multiSyncApply(OperationContext* opCtx,
  *      and instructions for updating the transactions table.  Required if processing oplogs
  *      with transactions.
  * sessionUpdateTracker - if provided, keeps track of session info from ops.
+ * writerAssigner - Picks the writer vector of each op. Shared by all the recursive calls for a
+ *      batch.
  */
 void SyncTail::_fillWriterVectors(OperationContext* opCtx,
                                   MultiApplier::Operations* ops,
                                   std::vector<MultiApplier::OperationPtrs>* writerVectors,
                                   std::vector<MultiApplier::Operations>* derivedOps,
-                                  SessionUpdateTracker* sessionUpdateTracker) noexcept {
+                                  SessionUpdateTracker* sessionUpdateTracker,
+                                  WriterAssigner* writerAssigner) noexcept {
     const auto serviceContext = opCtx->getServiceContext();
     const auto storageEngine = serviceContext->getStorageEngine();
 
     const bool supportsDocLocking = storageEngine->supportsDocLocking();
-    const uint32_t numWriters = writerVectors->size();
 
     CachedCollectionProperties collPropertiesCache;
     LogicalSessionIdMap<std::vector<OplogEntry*>> partialTxnOps;
@@ -1001,7 +1048,8 @@ void SyncTail::_fillWriterVectors(OperationContext* opCtx,
         if (sessionUpdateTracker) {
             if (auto newOplogWrites = sessionUpdateTracker->updateSession(op)) {
                 derivedOps->emplace_back(std::move(*newOplogWrites));
-                _fillWriterVectors(opCtx, &derivedOps->back(), writerVectors, derivedOps, nullptr);
+                _fillWriterVectors(
+                    opCtx, &derivedOps->back(), writerVectors, derivedOps, nullptr, writerAssigner);
             }
         }
 
@@ -1065,14 +1113,16 @@ void SyncTail::_fillWriterVectors(OperationContext* opCtx,
                 partialTxnList.clear();
 
                 // Transaction entries cannot have different session updates.
-                _fillWriterVectors(opCtx, &derivedOps->back(), writerVectors, derivedOps, nullptr);
+                _fillWriterVectors(
+                    opCtx, &derivedOps->back(), writerVectors, derivedOps, nullptr, writerAssigner);
             } else {
                 // The applyOps entry was not generated as part of a transaction.
                 invariant(!op.getPrevWriteOpTimeInTransaction());
                 derivedOps->emplace_back(ApplyOps::extractOperations(op));
 
                 // Nested entries cannot have different session updates.
-                _fillWriterVectors(opCtx, &derivedOps->back(), writerVectors, derivedOps, nullptr);
+                _fillWriterVectors(
+                    opCtx, &derivedOps->back(), writerVectors, derivedOps, nullptr, writerAssigner);
             }
             continue;
         }
@@ -1088,11 +1138,12 @@ void SyncTail::_fillWriterVectors(OperationContext* opCtx,
                 readTransactionOperationsFromOplogChain(opCtx, op, partialTxnList));
             partialTxnList.clear();
 
-            _fillWriterVectors(opCtx, &derivedOps->back(), writerVectors, derivedOps, nullptr);
+            _fillWriterVectors(
+                opCtx, &derivedOps->back(), writerVectors, derivedOps, nullptr, writerAssigner);
             continue;
         }
 
-        auto& writer = (*writerVectors)[hash % numWriters];
+        auto& writer = writerAssigner->getWriter(hash);
         if (writer.empty()) {
             writer.reserve(8);  // Skip a few growth rounds
         }
@@ -1105,12 +1156,15 @@ void SyncTail::fillWriterVectors(OperationContext* opCtx,
                                  std::vector<MultiApplier::OperationPtrs>* writerVectors,
                                  std::vector<MultiApplier::Operations>* derivedOps) noexcept {
     SessionUpdateTracker sessionUpdateTracker;
-    _fillWriterVectors(opCtx, ops, writerVectors, derivedOps, &sessionUpdateTracker);
+    WriterAssigner writerAssigner(writerVectors);
+    _fillWriterVectors(
+        opCtx, ops, writerVectors, derivedOps, &sessionUpdateTracker, &writerAssigner);
 
     auto newOplogWrites = sessionUpdateTracker.flushAll();
     if (!newOplogWrites.empty()) {
         derivedOps->emplace_back(std::move(newOplogWrites));
-        _fillWriterVectors(opCtx, &derivedOps->back(), writerVectors, derivedOps, nullptr);
+        _fillWriterVectors(
+            opCtx, &derivedOps->back(), writerVectors, derivedOps, nullptr, &writerAssigner);
     }
 }
 
@@ -226,6 +226,7 @@ public:
 
 private:
     class OpQueueBatcher;
+    class WriterAssigner;
 
     void _oplogApplication(ReplicationCoordinator* replCoord, OpQueueBatcher* batcher) noexcept;
 
@@ -233,7 +234,8 @@ private:
                             MultiApplier::Operations* ops,
                             std::vector<MultiApplier::OperationPtrs>* writerVectors,
                             std::vector<MultiApplier::Operations>* derivedOps,
-                            SessionUpdateTracker* sessionUpdateTracker) noexcept;
+                            SessionUpdateTracker* sessionUpdateTracker,
+                            WriterAssigner* writerAssigner) noexcept;
 
     /**
      * Doles out all the work to the writer pool threads. Does not modify writerVectors, but passes
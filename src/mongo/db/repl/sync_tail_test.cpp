@@ -55,6 +55,7 @@
 #include "mongo/db/repl/drop_pending_collection_reaper.h"
 #include "mongo/db/repl/idempotency_test_fixture.h"
 #include "mongo/db/repl/oplog.h"
+#include "mongo/db/repl/repl_server_parameters_gen.h"
 #include "mongo/db/repl/replication_coordinator.h"
 #include "mongo/db/repl/replication_process.h"
 #include "mongo/db/repl/storage_interface.h"
@@ -368,6 +369,118 @@ TEST_F(SyncTailTest,
                                                      createOplogCollectionOptions()));
 }
 
+TEST_F(SyncTailTest, FillWriterVectorsKeepsUnrelatedOperationsOffTheWriterOfAHotDocument) {
+    const bool originalBalance = replBalanceWriterVectors.load();
+    replBalanceWriterVectors.store(true);
+    ON_BLOCK_EXIT([&] { replBalanceWriterVectors.store(originalBalance); });
+
+    const NamespaceString hotNss("test.hot");
+    MultiApplier::Operations ops;
+    for (int i = 0; i < 10; ++i) {
+        ops.push_back(makeInsertDocumentOplogEntry(
+            {Timestamp(Seconds(1), i), 1LL}, hotNss, BSON("_id" << 0)));
+    }
+    for (int i = 0; i < 6; ++i) {
+        ops.push_back(
+            makeInsertDocumentOplogEntry({Timestamp(Seconds(2), i), 1LL},
+                                         NamespaceString("test.cold" + std::to_string(i)),
+                                         BSON("_id" << 0)));
+    }
+
+    SyncTail syncTail(nullptr,
+                      getConsistencyMarkers(),
+                      getStorageInterface(),
+                      noopApplyOperationFn,
+                      nullptr,
+                      OplogApplier::Options(OplogApplication::Mode::kSecondary));
+    std::vector<MultiApplier::OperationPtrs> writerVectors(4);
+    std::vector<MultiApplier::Operations> derivedOps;
+    syncTail.fillWriterVectors(_opCtx.get(), &ops, &writerVectors, &derivedOps);
+
+    // All the operations on the hot document are applied in order by a single writer, which does
+    // not get any other operation.
+    std::size_t numOps = 0;
+    for (auto&& writer : writerVectors) {
+        numOps += writer.size();
+        if (!writer.empty() && writer.front()->getNss() == hotNss) {
+            ASSERT_EQUALS(10U, writer.size());
+            for (std::size_t i = 0; i < writer.size(); ++i) {
+                ASSERT_EQUALS(hotNss, writer[i]->getNss());
+                ASSERT_EQUALS(ops[i].getOpTime(), writer[i]->getOpTime());
+            }
+        } else {
+            ASSERT_EQUALS(2U, writer.size());
+        }
+    }
+    ASSERT_EQUALS(ops.size(), numOps);
+}
+
+TEST_F(SyncTailTest, FillWriterVectorsBalancesSessionUpdatesWithTheOperationsOfTheBatch) {
+    const bool originalBalance = replBalanceWriterVectors.load();
+    replBalanceWriterVectors.store(true);
+    ON_BLOCK_EXIT([&] { replBalanceWriterVectors.store(originalBalance); });
+
+    const NamespaceString hotNss("test.hot");
+    MultiApplier::Operations ops;
+    for (int i = 0; i < 10; ++i) {
+        ops.push_back(makeInsertDocumentOplogEntry(
+            {Timestamp(Seconds(1), i), 1LL}, hotNss, BSON("_id" << 0)));
+    }
+
+    // Retryable writes, whose session updates are only added to the batch once all of its
+    // operations have been assigned to writers.
+    const int numRetryableWrites = 3;
+    for (int i = 0; i < numRetryableWrites; ++i) {
+        ops.push_back(makeInsertDocumentOplogEntryWithSessionInfoAndStmtId(
+            {Timestamp(Seconds(2), i), 1LL},
+            NamespaceString("test.retryable" + std::to_string(i)),
+            UUID::gen(),
+            BSON("_id" << 0),
+            makeLogicalSessionIdForTest(),
+            1LL,
+            0));
+    }
+
+    SyncTail syncTail(nullptr,
+                      getConsistencyMarkers(),
+                      getStorageInterface(),
+                      noopApplyOperationFn,
+                      nullptr,
+                      OplogApplier::Options(OplogApplication::Mode::kSecondary));
+    std::vector<MultiApplier::OperationPtrs> writerVectors(4);
+    std::vector<MultiApplier::Operations> derivedOps;
+    syncTail.fillWriterVectors(_opCtx.get(), &ops, &writerVectors, &derivedOps);
+
+    ASSERT_EQUALS(1U, derivedOps.size());
+    const auto& sessionUpdates = derivedOps.back();
+    ASSERT_EQUALS(static_cast<std::size_t>(numRetryableWrites), sessionUpdates.size());
+    for (auto&& update : sessionUpdates) {
+        ASSERT_EQUALS(NamespaceString::kSessionTransactionsTableNamespace, update.getNss());
+    }
+
+    // The session updates were assigned by the same balancing as the rest of the batch, so none of
+    // them joined the operations on the hot document.
+    std::size_t numOps = 0;
+    std::size_t numSessionUpdates = 0;
+    for (auto&& writer : writerVectors) {
+        numOps += writer.size();
+        if (!writer.empty() && writer.front()->getNss() == hotNss) {
+            ASSERT_EQUALS(10U, writer.size());
+            for (auto&& op : writer) {
+                ASSERT_EQUALS(hotNss, op->getNss());
+            }
+            continue;
+        }
+        for (auto&& op : writer) {
+            if (op->getNss() == NamespaceString::kSessionTransactionsTableNamespace) {
+                ++numSessionUpdates;
+            }
+        }
+    }
+    ASSERT_EQUALS(sessionUpdates.size(), numSessionUpdates);
+    ASSERT_EQUALS(ops.size() + sessionUpdates.size(), numOps);
+}
+
 TEST_F(SyncTailTest, MultiSyncApplyUsesSyncApplyToApplyOperation) {
     NamespaceString nss("local." + _agent.getSuiteName() + "_" + _agent.getTestName());
     auto op = makeCreateCollectionOplogEntry({Timestamp(Seconds(1), 0), 1LL}, nss);
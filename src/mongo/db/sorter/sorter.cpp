@@ -48,8 +48,11 @@
 
 #include "mongo/db/sorter/sorter.h"
 
+#include <array>
 #include <boost/filesystem/operations.hpp>
+#include <cstring>
 #include <snappy.h>
+#include <type_traits>
 #include <vector>
 
 #include "mongo/base/string_data.h"
@@ -63,6 +66,7 @@
 #include "mongo/s/is_mongos.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/destructor_guard.h"
+#include "mongo/util/scopeguard.h"
 #include "mongo/util/str.h"
 #include "mongo/util/unowned_ptr.h"
 
@@ -117,6 +121,136 @@ void dassertCompIsSane(const Comparator& comp, const Data& lhs, const Data& rhs)
 #endif
 }
 
+/**
+ * A Comparator may declare
+ *
+ *     static constexpr bool kComparesKeyBytes = true;
+ *
+ * to promise that it orders Data exactly like KeyString::compare() orders the bytes of the keys,
+ * i.e. by memcmp() with a key sorting before any longer key it is a prefix of. The Key must then
+ * provide getBuffer() and getSize(). In-memory data for such comparators is sorted by radix sort
+ * over the key bytes rather than by calling the comparator.
+ */
+template <typename Comparator, typename = void>
+struct ComparesKeyBytes : std::false_type {};
+
+template <typename Comparator>
+struct ComparesKeyBytes<Comparator, std::enable_if_t<Comparator::kComparesKeyBytes>>
+    : std::true_type {};
+
+/**
+ * Stable MSD radix sort of Data by the bytes of its key. Sorts an array of small entries that
+ * point at the keys and then moves the Data into place once, so Data is never swapped around.
+ */
+template <typename Container>
+void radixSortByKeyBytes(Container* data) {
+    struct Entry {
+        const unsigned char* bytes;
+        size_t size;
+        size_t index;  // Position in 'data'. Breaks ties so the sort is stable.
+    };
+
+    // Ranges smaller than this are finished with a comparison sort.
+    const size_t kComparisonSortThreshold = 64;
+
+    // Returns the byte of 'entry' at 'depth' shifted up by one, or 0 if the key is shorter, so
+    // that keys ending at 'depth' sort first.
+    auto byteAt = [](const Entry& entry, size_t depth) -> size_t {
+        return depth < entry.size ? size_t(entry.bytes[depth]) + 1 : 0;
+    };
+
+    // Compares keys which are known to be equal in their first 'depth' bytes.
+    auto lessFrom = [](size_t depth) {
+        return [depth](const Entry& lhs, const Entry& rhs) {
+            const size_t lhsRest = lhs.size - std::min(depth, lhs.size);
+            const size_t rhsRest = rhs.size - std::min(depth, rhs.size);
+            const int cmp = memcmp(lhs.bytes + (lhs.size - lhsRest),
+                                   rhs.bytes + (rhs.size - rhsRest),
+                                   std::min(lhsRest, rhsRest));
+            if (cmp)
+                return cmp < 0;
+            if (lhsRest != rhsRest)
+                return lhsRest < rhsRest;
+            return lhs.index < rhs.index;
+        };
+    };
+
+    std::vector<Entry> entries;
+    entries.reserve(data->size());
+    for (size_t i = 0; i < data->size(); ++i) {
+        const auto& key = (*data)[i].first;
+        entries.push_back(
+            {reinterpret_cast<const unsigned char*>(key.getBuffer()), key.getSize(), i});
+    }
+    std::vector<Entry> scratch(entries.size());
+
+    // Each range is distributed into buckets by its byte at 'depth'. The largest bucket is handled
+    // by the next iteration of the loop and the others are pushed as new ranges, so there are never
+    // more than ~256 * log2(N) pending ranges.
+    struct Range {
+        size_t begin;
+        size_t end;
+        size_t depth;
+    };
+    std::vector<Range> pending{{0, entries.size(), 0}};
+    while (!pending.empty()) {
+        Range range = pending.back();
+        pending.pop_back();
+
+        while (range.end - range.begin > 1) {
+            if (range.end - range.begin < kComparisonSortThreshold) {
+                std::sort(entries.begin() + range.begin,
+                          entries.begin() + range.end,
+                          lessFrom(range.depth));
+                break;
+            }
+
+            std::array<size_t, 258> bucketStart{};
+            for (size_t i = range.begin; i < range.end; ++i) {
+                ++bucketStart[byteAt(entries[i], range.depth) + 1];
+            }
+            for (size_t bucket = 1; bucket < bucketStart.size(); ++bucket) {
+                bucketStart[bucket] += bucketStart[bucket - 1];
+            }
+
+            // Distributing in order keeps equal keys in their original order.
+            std::array<size_t, 258> next = bucketStart;
+            for (size_t i = range.begin; i < range.end; ++i) {
+                scratch[range.begin + next[byteAt(entries[i], range.depth)]++] = entries[i];
+            }
+            std::copy(scratch.begin() + range.begin,
+                      scratch.begin() + range.end,
+                      entries.begin() + range.begin);
+
+            // Bucket 0 holds keys that ended, which are all equal and already in order.
+            size_t largestBucket = 1;
+            for (size_t bucket = 1; bucket < 257; ++bucket) {
+                const size_t size = bucketStart[bucket + 1] - bucketStart[bucket];
+                if (size > bucketStart[largestBucket + 1] - bucketStart[largestBucket]) {
+                    largestBucket = bucket;
+                }
+            }
+            for (size_t bucket = 1; bucket < 257; ++bucket) {
+                if (bucket != largestBucket &&
+                    bucketStart[bucket + 1] - bucketStart[bucket] > 1) {
+                    pending.push_back({range.begin + bucketStart[bucket],
+                                       range.begin + bucketStart[bucket + 1],
+                                       range.depth + 1});
+                }
+            }
+            range = {range.begin + bucketStart[largestBucket],
+                     range.begin + bucketStart[largestBucket + 1],
+                     range.depth + 1};
+        }
+    }
+
+    Container sorted;
+    for (const auto& entry : entries) {
+        sorted.push_back(std::move((*data)[entry.index]));
+    }
+    data->swap(sorted);
+}
+
 /**
  * Returns results from sorted in-memory storage.
  */
@@ -246,6 +380,13 @@ public:
         return Data(std::move(first), std::move(second));
     }
 
+    /**
+     * Returns the location of the sorted data range in the file.
+     */
+    SorterRange getRange() const {
+        return {_fileStartOffset, _fileEndOffset, _originalChecksum};
+    }
+
 private:
     /**
      * Attempts to refill the _bufferReader if it is empty. Expects _done to be false.
@@ -367,6 +508,12 @@ private:
  * Merge-sorts results from 0 or more FileIterators, all of which should be iterating over sorted
  * ranges within the same file. This class is given the data source file name upon construction and
  * is responsible for deleting the data source file upon destruction.
+ *
+ * The inputs are merged with a tree of losers: every internal node of a complete binary tree over
+ * the inputs holds the input that lost the comparison at that node, and the overall winner is kept
+ * on the side. Replacing the winner with the next value from its input only requires replaying
+ * the matches on the path from its leaf to the root, which is one comparison per level rather
+ * than the two per level that re-heapifying a binary heap needs.
  */
 template <typename Key, typename Value, typename Comparator>
 class MergeIterator : public SortIteratorInterface<Key, Value> {
@@ -381,33 +528,30 @@ public:
         : _opts(opts),
           _remaining(opts.limit ? opts.limit : std::numeric_limits<unsigned long long>::max()),
           _first(true),
-          _greater(comp),
+          _less(comp),
           _itersSourceFileName(itersSourceFileName) {
         for (size_t i = 0; i < iters.size(); i++) {
             iters[i]->openSource();
             if (iters[i]->more()) {
-                _heap.push_back(std::make_shared<Stream>(i, iters[i]->next(), iters[i]));
+                _streams.push_back(std::make_unique<Stream>(i, iters[i]->next(), iters[i]));
             } else {
                 iters[i]->closeSource();
             }
         }
 
-        if (_heap.empty()) {
+        _liveStreams = _streams.size();
+        if (_streams.empty()) {
             _remaining = 0;
             return;
         }
 
-        std::make_heap(_heap.begin(), _heap.end(), _greater);
-        std::pop_heap(_heap.begin(), _heap.end(), _greater);
-        _current = _heap.back();
-        _heap.pop_back();
+        buildTree();
     }
 
     ~MergeIterator() {
         // Clear the remaining Stream objects first, to close the file handles before deleting the
         // file. Some systems will error closing the file if any file handles are still open.
-        _current.reset();
-        _heap.clear();
+        _streams.clear();
         DESTRUCTOR_GUARD(boost::filesystem::remove(_itersSourceFileName));
     }
 
@@ -415,7 +559,7 @@ public:
     void closeSource() {}
 
     bool more() {
-        if (_remaining > 0 && (_first || !_heap.empty() || _current->more()))
+        if (_remaining > 0 && (_first || _liveStreams > 1 || _streams[_winner]->more()))
             return true;
 
         _remaining = 0;
@@ -429,21 +573,18 @@ public:
 
         if (_first) {
             _first = false;
-            return _current->current();
+            return _streams[_winner]->current();
         }
 
-        if (!_current->advance()) {
-            verify(!_heap.empty());
-            std::pop_heap(_heap.begin(), _heap.end(), _greater);
-            _current = _heap.back();
-            _heap.pop_back();
-        } else if (!_heap.empty() && _greater(_current, _heap.front())) {
-            std::pop_heap(_heap.begin(), _heap.end(), _greater);
-            std::swap(_current, _heap.back());
-            std::push_heap(_heap.begin(), _heap.end(), _greater);
+        if (!_streams[_winner]->advance()) {
+            // Closes the input. An exhausted leaf loses every match it is replayed in.
+            _streams[_winner].reset();
+            --_liveStreams;
+            verify(_liveStreams > 0);
         }
+        replayFrom(_winner);
 
-        return _current->current();
+        return _streams[_winner]->current();
     }
 
 
@@ -485,7 +626,7 @@ private:
         std::shared_ptr<Input> _rest;
     };
 
-    class STLComparator {  // uses greater rather than less-than to maintain a MinHeap
+    class STLComparator {
     public:
         explicit STLComparator(const Comparator& comp) : _comp(comp) {}
         bool operator()(unowned_ptr<const Stream> lhs, unowned_ptr<const Stream> rhs) const {
@@ -493,25 +634,130 @@ private:
             dassertCompIsSane(_comp, lhs->current(), rhs->current());
             int ret = _comp(lhs->current(), rhs->current());
             if (ret)
-                return ret > 0;
+                return ret < 0;
 
             // then compare fileNums to ensure stability
-            return lhs->fileNum > rhs->fileNum;
+            return lhs->fileNum < rhs->fileNum;
         }
 
     private:
         const Comparator _comp;
     };
 
+    /**
+     * Returns true if the stream at leaf 'lhs' should be returned before the one at leaf 'rhs'.
+     * Exhausted streams sort after everything else.
+     */
+    bool beats(size_t lhs, size_t rhs) const {
+        if (!_streams[lhs])
+            return false;
+        if (!_streams[rhs])
+            return true;
+        return _less(_streams[lhs].get(), _streams[rhs].get());
+    }
+
+    /**
+     * Plays every match bottom up. Leaf i sits at node (i + _streams.size()) of the implicit tree,
+     * so node 1 is the root and nodes [1, _streams.size()) are the internal ones.
+     */
+    void buildTree() {
+        const size_t numLeaves = _streams.size();
+        std::vector<size_t> winners(2 * numLeaves);
+        for (size_t leaf = 0; leaf < numLeaves; ++leaf) {
+            winners[numLeaves + leaf] = leaf;
+        }
+
+        _losers.assign(numLeaves, 0);
+        for (size_t node = numLeaves - 1; node >= 1; --node) {
+            const size_t left = winners[2 * node];
+            const size_t right = winners[2 * node + 1];
+            if (beats(right, left)) {
+                winners[node] = right;
+                _losers[node] = left;
+            } else {
+                winners[node] = left;
+                _losers[node] = right;
+            }
+        }
+
+        _winner = winners[1];
+    }
+
+    /**
+     * Replays the matches on the path from 'leaf' to the root after the value at 'leaf' changed.
+     */
+    void replayFrom(size_t leaf) {
+        size_t winner = leaf;
+        for (size_t node = (leaf + _streams.size()) / 2; node >= 1; node /= 2) {
+            if (beats(_losers[node], winner)) {
+                std::swap(_losers[node], winner);
+            }
+        }
+        _winner = winner;
+    }
+
     SortOptions _opts;
     unsigned long long _remaining;
     bool _first;
-    std::shared_ptr<Stream> _current;
-    std::vector<std::shared_ptr<Stream>> _heap;  // MinHeap
-    STLComparator _greater;                      // named so calls make sense
+    std::vector<std::unique_ptr<Stream>> _streams;  // One per non-empty input. Null once exhausted.
+    std::vector<size_t> _losers;  // Indexes into _streams. _losers[0] is unused.
+    size_t _winner = 0;           // Index into _streams of the next value to return.
+    size_t _liveStreams = 0;      // Number of non-null entries in _streams.
+    STLComparator _less;
     std::string _itersSourceFileName;
 };
 
+/**
+ * Merges the ranges in 'iters', all spilled to 'fileName', until at most opts.maxMergeFanIn of
+ * them remain. Each pass merges groups of up to maxMergeFanIn ranges into single ranges of a new
+ * file and then removes the previous one, so the number of ranges shrinks by a factor of
+ * maxMergeFanIn per pass. On return 'fileName' and 'nextFileOffset' describe the file the
+ * remaining ranges live in.
+ */
+template <typename Key, typename Value, typename Comparator>
+void mergeSpilledRangesToFanIn(
+    std::vector<std::shared_ptr<SortIteratorInterface<Key, Value>>>* iters,
+    std::string* fileName,
+    std::streampos* nextFileOffset,
+    const SortOptions& opts,
+    const Comparator& comp,
+    const typename SortedFileWriter<Key, Value>::Settings& settings) {
+    typedef SortIteratorInterface<Key, Value> Iterator;
+
+    invariant(opts.maxMergeFanIn >= 2);
+    while (iters->size() > opts.maxMergeFanIn) {
+        const std::string mergedFileName = opts.tempDir + "/" + nextFileName();
+        auto removeMergedFile =
+            makeGuard([&] { DESTRUCTOR_GUARD(boost::filesystem::remove(mergedFileName)); });
+
+        std::streampos mergedFileOffset = 0;
+        std::vector<std::shared_ptr<Iterator>> mergedIters;
+        for (size_t start = 0; start < iters->size(); start += opts.maxMergeFanIn) {
+            const size_t end = std::min(start + opts.maxMergeFanIn, iters->size());
+            const std::vector<std::shared_ptr<Iterator>> group(iters->begin() + start,
+                                                               iters->begin() + end);
+
+            // The groups share a source file, which is removed once the whole pass is done.
+            MergeIterator<Key, Value, Comparator> merged(group, "", opts, comp);
+            SortedFileWriter<Key, Value> writer(opts, mergedFileName, mergedFileOffset, settings);
+            while (merged.more()) {
+                auto data = merged.next();
+                writer.addAlreadySorted(data.first, data.second);
+            }
+            mergedIters.push_back(std::shared_ptr<Iterator>(writer.done()));
+            mergedFileOffset = writer.getFileEndOffset();
+        }
+
+        removeMergedFile.dismiss();
+        iters->swap(mergedIters);
+        mergedIters.clear();
+        DESTRUCTOR_GUARD(boost::filesystem::remove(*fileName));
+
+        *fileName = mergedFileName;
+        *nextFileOffset = mergedFileOffset;
+    }
+}
+
 template <typename Key, typename Value, typename Comparator>
 class NoLimitSorter : public Sorter<Key, Value> {
 public:
@@ -531,6 +777,25 @@ public:
         }
     }
 
+    NoLimitSorter(const std::string& fileName,
+                  const std::vector<SorterRange>& ranges,
+                  const SortOptions& opts,
+                  const Comparator& comp,
+                  const Settings& settings = Settings())
+        : _comp(comp), _settings(settings), _opts(opts), _memUsed(0) {
+        verify(_opts.limit == 0);
+        invariant(_opts.extSortAllowed);
+
+        _fileName = _opts.tempDir + "/" + fileName;
+        for (const auto& range : ranges) {
+            _iters.push_back(std::make_shared<FileIterator<Key, Value>>(
+                _fileName, range.startOffset, range.endOffset, _settings, range.checksum));
+            _nextSortedFileWriterOffset =
+                std::max(_nextSortedFileWriterOffset, std::streampos(range.endOffset));
+        }
+        this->_usedDisk = !ranges.empty();
+    }
+
     ~NoLimitSorter() {
         if (!_done) {
             // If done() was never called to return a MergeIterator, then this Sorter still owns
@@ -560,11 +825,31 @@ public:
         }
 
         spill();
+        mergeSpilledRangesToFanIn<Key, Value, Comparator>(
+            &_iters, &_fileName, &_nextSortedFileWriterOffset, _opts, _comp, _settings);
         Iterator* mergeIt = Iterator::merge(_iters, _fileName, _opts, _comp);
         _done = true;
         return mergeIt;
     }
 
+    SorterPersistedState persistDataForShutdown() {
+        invariant(!_done);
+        invariant(_opts.extSortAllowed);
+
+        spill();
+
+        SorterPersistedState state;
+        state.fileName = boost::filesystem::path(_fileName).filename().string();
+        for (const auto& iter : _iters) {
+            // Everything in '_iters' was spilled to '_fileName' by spill().
+            state.ranges.push_back(static_cast<FileIterator<Key, Value>*>(iter.get())->getRange());
+        }
+
+        // The file now outlives this Sorter.
+        _done = true;
+        return state;
+    }
+
 private:
     class STLComparator {
     public:
@@ -579,6 +864,11 @@ private:
     };
 
     void sort() {
+        if constexpr (ComparesKeyBytes<Comparator>::value) {
+            radixSortByKeyBytes(&_data);
+            return;
+        }
+
         STLComparator less(_comp);
         std::stable_sort(_data.begin(), _data.end(), less);
 
@@ -768,6 +1058,8 @@ public:
         }
 
         spill();
+        mergeSpilledRangesToFanIn<Key, Value, Comparator>(
+            &_iters, &_fileName, &_nextSortedFileWriterOffset, _opts, _comp, _settings);
         Iterator* iterator = Iterator::merge(_iters, _fileName, _opts, _comp);
         _done = true;
         return iterator;
@@ -791,6 +1083,8 @@ private:
 
         if (_data.size() == _opts.limit) {
             std::sort_heap(_data.begin(), _data.end(), less);
+        } else if constexpr (ComparesKeyBytes<Comparator>::value) {
+            radixSortByKeyBytes(&_data);
         } else {
             std::stable_sort(_data.begin(), _data.end(), less);
         }
@@ -1077,6 +1371,25 @@ SortIteratorInterface<Key, Value>* SortIteratorInterface<Key, Value>::merge(
     return new sorter::MergeIterator<Key, Value, Comparator>(iters, fileName, opts, comp);
 }
 
+template <typename Key, typename Value>
+template <typename Comparator>
+Sorter<Key, Value>* Sorter<Key, Value>::makeFromExistingRanges(
+    const std::string& fileName,
+    const std::vector<SorterRange>& ranges,
+    const SortOptions& opts,
+    const Comparator& comp,
+    const Settings& settings) {
+    uassert(31290,
+            "Attempting to use external sort from mongos. This is not allowed.",
+            !isMongos());
+    uassert(31291,
+            "Attempting to use external sort without setting SortOptions::tempDir",
+            !opts.tempDir.empty());
+    invariant(opts.limit == 0);
+    return new sorter::NoLimitSorter<Key, Value, Comparator>(
+        fileName, ranges, opts, comp, settings);
+}
+
 template <typename Key, typename Value>
 template <typename Comparator>
 Sorter<Key, Value>* Sorter<Key, Value>::make(const SortOptions& opts,
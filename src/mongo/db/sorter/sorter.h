@@ -39,6 +39,7 @@
 #include <vector>
 
 #include "mongo/bson/util/builder.h"
+#include "mongo/util/assert_util.h"
 #include "mongo/util/bufreader.h"
 
 /**
@@ -106,7 +107,16 @@ struct SortOptions {
     // extSortAllowed is true.
     std::string tempDir;
 
-    SortOptions() : limit(0), maxMemoryUsageBytes(64 * 1024 * 1024), extSortAllowed(false) {}
+    // The maximum number of spilled data ranges merged at once. Every range being merged holds an
+    // open file handle, so if more ranges than this were spilled they are first merged in groups
+    // of this size into larger ranges until few enough remain. Must be at least 2.
+    size_t maxMergeFanIn;
+
+    SortOptions()
+        : limit(0),
+          maxMemoryUsageBytes(64 * 1024 * 1024),
+          extSortAllowed(false),
+          maxMergeFanIn(512) {}
 
     // Fluent API to support expressions like SortOptions().Limit(1000).ExtSortAllowed(true)
 
@@ -129,6 +139,29 @@ struct SortOptions {
         tempDir = newTempDir;
         return *this;
     }
+
+    SortOptions& MaxMergeFanIn(size_t newMaxMergeFanIn) {
+        maxMergeFanIn = newMaxMergeFanIn;
+        return *this;
+    }
+};
+
+/**
+ * Locates one sorted data range that a Sorter spilled to its file.
+ */
+struct SorterRange {
+    std::streamoff startOffset;
+    std::streamoff endOffset;
+    uint32_t checksum;
+};
+
+/**
+ * Describes the spilled data of a Sorter that outlives the Sorter itself, from which
+ * Sorter::makeFromExistingRanges() can rebuild it, for instance after a restart.
+ */
+struct SorterPersistedState {
+    std::string fileName;  // Relative to SortOptions::tempDir.
+    std::vector<SorterRange> ranges;
 };
 
 /**
@@ -217,6 +250,18 @@ public:
                         const Comparator& comp,
                         const Settings& settings = Settings());
 
+    /**
+     * Makes a Sorter without a limit that starts out with the data ranges previously spilled to
+     * 'fileName' in opts.tempDir, as described by persistDataForShutdown(). Data spilled by the
+     * new Sorter is appended to the same file.
+     */
+    template <typename Comparator>
+    static Sorter* makeFromExistingRanges(const std::string& fileName,
+                                          const std::vector<SorterRange>& ranges,
+                                          const SortOptions& opts,
+                                          const Comparator& comp,
+                                          const Settings& settings = Settings());
+
     virtual void add(const Key&, const Value&) = 0;
 
     /**
@@ -226,6 +271,17 @@ public:
      */
     virtual Iterator* done() = 0;
 
+    /**
+     * Spills any data held in memory and returns the location of everything this Sorter has been
+     * given. The spill file is left behind when this Sorter destructs, so that
+     * makeFromExistingRanges() can pick it up again. Cannot add more data afterwards.
+     *
+     * Only Sorters without a limit support this.
+     */
+    virtual SorterPersistedState persistDataForShutdown() {
+        MONGO_UNREACHABLE;
+    }
+
     virtual ~Sorter() {}
 
     bool usedDisk() {
@@ -319,4 +375,11 @@ private:
             const SortOptions& opts,                                                     \
             const Comparator& comp);                                                     \
     template ::mongo::Sorter<Key, Value>* ::mongo::Sorter<Key, Value>::make<Comparator>( \
-        const SortOptions& opts, const Comparator& comp, const Settings& settings);
+        const SortOptions& opts, const Comparator& comp, const Settings& settings);      \
+    template ::mongo::Sorter<Key, Value>*                                                \
+    ::mongo::Sorter<Key, Value>::makeFromExistingRanges<Comparator>(                     \
+        const std::string& fileName,                                                     \
+        const std::vector<SorterRange>& ranges,                                          \
+        const SortOptions& opts,                                                         \
+        const Comparator& comp,                                                          \
+        const Settings& settings);
@@ -38,6 +38,7 @@
 #include "mongo/base/static_assert.h"
 #include "mongo/config.h"
 #include "mongo/db/service_context_test_fixture.h"
+#include "mongo/db/storage/key_string.h"
 #include "mongo/platform/random.h"
 #include "mongo/stdx/thread.h"
 #include "mongo/unittest/temp_dir.h"
@@ -363,6 +364,106 @@ public:
                 mergeIterators(iterators, ASC, SortOptions().Limit(10)),
                 make_shared<LimitIterator>(10, make_shared<IntIterator>(0, 20, 1)));
         }
+        {  // test a number of inputs that is not a power of two
+            std::shared_ptr<IWIterator> iterators[] = {make_shared<IntIterator>(0, 70, 7),
+                                                       make_shared<IntIterator>(1, 70, 7),
+                                                       make_shared<IntIterator>(2, 70, 7),
+                                                       make_shared<IntIterator>(3, 70, 7),
+                                                       make_shared<IntIterator>(4, 70, 7),
+                                                       make_shared<IntIterator>(5, 70, 7),
+                                                       make_shared<IntIterator>(6, 70, 7)};
+
+            ASSERT_ITERATORS_EQUIVALENT(mergeIterators(iterators, ASC),
+                                        make_shared<IntIterator>(0, 70, 1));
+        }
+        {  // test inputs of different lengths
+            std::shared_ptr<IWIterator> iterators[] = {make_shared<IntIterator>(0, 3, 3),
+                                                       make_shared<IntIterator>(1, 30, 3),
+                                                       make_shared<EmptyIterator>(),
+                                                       make_shared<IntIterator>(2, 15, 3)};
+            const int expected[] = {0, 1, 2, 4, 5, 7, 8, 10, 11, 13, 14, 16, 19, 22, 25, 28};
+
+            ASSERT_ITERATORS_EQUIVALENT(mergeIterators(iterators, ASC),
+                                        makeInMemIterator(expected));
+        }
+    }
+};
+
+/**
+ * Orders KeyStrings by their bytes, which lets the Sorter radix sort them.
+ */
+struct KeyStringBytesComparator {
+    typedef std::pair<KeyString::Value, IntWrapper> Data;
+
+    static constexpr bool kComparesKeyBytes = true;
+
+    int operator()(const Data& lhs, const Data& rhs) const {
+        return lhs.first.compare(rhs.first);
+    }
+};
+
+class RadixSortTests {
+public:
+    typedef Sorter<KeyString::Value, IntWrapper> KSSorter;
+    typedef KeyStringBytesComparator::Data Data;
+
+    void run() {
+        // Short strings over a small alphabet and few distinct numbers produce keys that share long
+        // prefixes, are prefixes of each other, and are often exactly equal.
+        PseudoRandom random(int64_t(time(nullptr)));
+        std::vector<Data> input;
+        for (int i = 0; i < 5000; i++) {
+            std::string str;
+            const int length = random.nextInt32(8);
+            for (int j = 0; j < length; j++) {
+                str.push_back("ab\0"[random.nextInt32(3)]);
+            }
+            const BSONObj obj = BSON("" << str << "" << random.nextInt32(4));
+            input.emplace_back(KeyString::HeapBuilder(KeyString::Version::kLatestVersion,
+                                                      obj,
+                                                      Ordering::make(BSON("" << 1 << "" << -1)))
+                                   .release(),
+                               i);
+        }
+
+        // Ties keep their insertion order, which the IntWrapper values record.
+        std::vector<Data> expected = input;
+        std::stable_sort(expected.begin(), expected.end(), [](const Data& lhs, const Data& rhs) {
+            return KeyStringBytesComparator()(lhs, rhs) < 0;
+        });
+
+        {  // no limit
+            std::unique_ptr<KSSorter> sorter(makeSorter(SortOptions()));
+            assertSortsTo(sorter.get(), input, expected);
+        }
+        {  // a limit which is never reached sorts like no limit
+            std::unique_ptr<KSSorter> sorter(makeSorter(SortOptions().Limit(input.size() + 1)));
+            assertSortsTo(sorter.get(), input, expected);
+        }
+    }
+
+private:
+    static KSSorter* makeSorter(const SortOptions& opts) {
+        return KSSorter::make(opts,
+                              KeyStringBytesComparator(),
+                              KSSorter::Settings({KeyString::Version::kLatestVersion}, {}));
+    }
+
+    static void assertSortsTo(KSSorter* sorter,
+                              const std::vector<Data>& input,
+                              const std::vector<Data>& expected) {
+        for (const auto& data : input) {
+            sorter->add(data.first, data.second);
+        }
+
+        std::unique_ptr<KSSorter::Iterator> it(sorter->done());
+        for (const auto& data : expected) {
+            ASSERT(it->more());
+            const Data next = it->next();
+            ASSERT_EQ(0, next.first.compare(data.first));
+            ASSERT_EQ(int(data.second), int(next.second));
+        }
+        ASSERT_FALSE(it->more());
     }
 };
 
@@ -553,6 +654,15 @@ public:
 };
 
 
+template <bool Random = true>
+class LotsOfDataSmallMergeFanIn : public LotsOfDataLittleMemory<Random> {
+    typedef LotsOfDataLittleMemory<Random> Parent;
+    SortOptions adjustSortOptions(SortOptions opts) override {
+        // Forces several passes of merging spilled ranges before the final merge.
+        return Parent::adjustSortOptions(opts).MaxMergeFanIn(4);
+    }
+};
+
 template <long long Limit, bool Random = true>
 class LotsOfDataWithLimit : public LotsOfDataLittleMemory<Random> {
     typedef LotsOfDataLittleMemory<Random> Parent;
@@ -576,6 +686,45 @@ class LotsOfDataWithLimit : public LotsOfDataLittleMemory<Random> {
     }
     enum { MEM_LIMIT = 32 * 1024 };
 };
+
+class PersistDataForShutdown : public ScopedGlobalServiceContextForTest {
+public:
+    void run() {
+        unittest::TempDir tempDir("sorterTests");
+        const SortOptions opts =
+            SortOptions().TempDir(tempDir.path()).ExtSortAllowed().MaxMemoryUsageBytes(MEM_LIMIT);
+
+        // The even numbers are spilled by the first sorter, partly because of the memory limit and
+        // partly by persistDataForShutdown(), and outlive it on disk.
+        SorterPersistedState state;
+        {
+            std::unique_ptr<IWSorter> sorter(IWSorter::make(opts, IWComparator(ASC)));
+            for (int i = 0; i < NUM_ITEMS; i += 2) {
+                sorter->add(i, -i);
+            }
+            state = sorter->persistDataForShutdown();
+        }
+        ASSERT_GT(state.ranges.size(), 1U);
+        ASSERT(boost::filesystem::exists(tempDir.path() + "/" + state.fileName));
+
+        // The odd numbers are added to a sorter that picks up where the first one left off.
+        std::unique_ptr<IWSorter> sorter(IWSorter::makeFromExistingRanges(
+            state.fileName, state.ranges, opts, IWComparator(ASC)));
+        for (int i = 1; i < NUM_ITEMS; i += 2) {
+            sorter->add(i, -i);
+        }
+        ASSERT_ITERATORS_EQUIVALENT(std::shared_ptr<IWIterator>(sorter->done()),
+                                    make_shared<IntIterator>(0, NUM_ITEMS));
+
+        sorter.reset();
+        ASSERT(boost::filesystem::is_empty(tempDir.path()));
+    }
+
+    enum Constants {
+        NUM_ITEMS = 10 * 1000,
+        MEM_LIMIT = 4 * 1024,
+    };
+};
 }  // namespace SorterTests
 
 class SorterSuite : public mongo::unittest::Suite {
@@ -589,17 +738,21 @@ public:
         add<InMemIterTests>();
         add<SortedFileWriterAndFileIteratorTests>();
         add<MergeIteratorTests>();
+        add<RadixSortTests>();
         add<SorterTests::Basic>();
         add<SorterTests::Limit>();
         add<SorterTests::Dupes>();
         add<SorterTests::LotsOfDataLittleMemory</*random=*/false>>();
         add<SorterTests::LotsOfDataLittleMemory</*random=*/true>>();
+        add<SorterTests::LotsOfDataSmallMergeFanIn</*random=*/false>>();
+        add<SorterTests::LotsOfDataSmallMergeFanIn</*random=*/true>>();
         add<SorterTests::LotsOfDataWithLimit<1, /*random=*/false>>();     // limit=1 is special case
         add<SorterTests::LotsOfDataWithLimit<1, /*random=*/true>>();      // limit=1 is special case
         add<SorterTests::LotsOfDataWithLimit<100, /*random=*/false>>();   // fits in mem
         add<SorterTests::LotsOfDataWithLimit<100, /*random=*/true>>();    // fits in mem
         add<SorterTests::LotsOfDataWithLimit<5000, /*random=*/false>>();  // spills
         add<SorterTests::LotsOfDataWithLimit<5000, /*random=*/true>>();   // spills
+        add<SorterTests::PersistDataForShutdown>();
         add<SorterTests::LimitExtreme<kMaxAsU64<uint32_t>>>();
         add<SorterTests::LimitExtreme<kMaxAsU64<uint32_t> - 1>>();
         add<SorterTests::LimitExtreme<kMaxAsU64<uint32_t> + 1>>();
@@ -94,12 +94,17 @@ std::unique_ptr<mongo::RecordStore> KVEngine::getRecordStore(OperationContext* o
 }
 
 bool KVEngine::trySwapMaster(StringStore& newMaster, uint64_t version) {
-    stdx::lock_guard<stdx::mutex> lock(_masterLock);
-    invariant(!newMaster.hasBranch() && !_master.hasBranch());
-    if (_masterVersion != version)
-        return false;
-    _master = newMaster;
-    _masterVersion++;
+    // Nodes only referenced by the old master are freed after the lock is released.
+    StringStore oldMaster;
+    {
+        stdx::lock_guard<stdx::mutex> lock(_masterLock);
+        invariant(!newMaster.hasBranch() && !_master.hasBranch());
+        if (_masterVersion != version)
+            return false;
+        oldMaster = std::move(_master);
+        _master = newMaster;
+        _masterVersion++;
+    }
     return true;
 }
 
@@ -170,6 +170,9 @@ private:
     std::map<std::string, bool> _idents;  // TODO : replace with a query to _master.
     std::unique_ptr<VisibilityManager> _visibilityManager;
 
+    // Only held to copy or swap '_master'. Writers merge their changes into a copy of it without
+    // the lock, and retry if another writer swapped it first, so commits only serialize on the
+    // version check and the swap. Committing without this mutex is not implemented.
     mutable stdx::mutex _masterLock;
     StringStore _master;
     uint64_t _masterVersion = 0;
@@ -29,7 +29,7 @@
 
 #pragma once
 
-#include <array>
+#include <algorithm>
 #include <boost/optional.hpp>
 #include <cstring>
 #include <exception>
@@ -54,6 +54,11 @@ class merge_conflict_exception : std::exception {
  * minimize data duplication. Each node has a notion of ownership and if modifications are made to
  * non-uniquely owned nodes, they are copied to prevent dirtying the data for the other owners of
  * the node.
+ *
+ * A RadixStore is not thread-safe. Concurrent writers each modify a copy of their own and combine
+ * their changes with merge3(). Nodes are never modified in place once shared, and are freed when
+ * their last owner releases them, so the tree needs neither lock coupling nor epoch-based
+ * reclamation.
  */
 template <class Key, class T>
 class RadixStore {
@@ -191,25 +196,20 @@ public:
 
                 // Check the children right of the node that the iterator was at already. This way,
                 // there will be no backtracking in the traversal.
-                for (auto iter = oldKey + 1 + node->_children.begin();
-                     iter != node->_children.end();
-                     ++iter) {
-
-                    // If the node has a child, then the sub-tree must have a node with data that
-                    // has not yet been visited.
-                    if (*iter != nullptr) {
-
-                        // If the current node has data, return it and exit. If not, continue
-                        // following the nodes to find the next one with data. It is necessary to go
-                        // to the left-most node in this sub-tree.
-                        if ((*iter)->_data) {
-                            _current = iter->get();
-                            return;
-                        }
-                        _current = iter->get();
+                Node* next = node->_children.firstFrom(oldKey + 1);
+
+                // If the node has a child, then the sub-tree must have a node with data that
+                // has not yet been visited.
+                if (next != nullptr) {
+
+                    // If the current node has data, return it and exit. If not, continue
+                    // following the nodes to find the next one with data. It is necessary to go
+                    // to the left-most node in this sub-tree.
+                    _current = next;
+                    if (!next->_data) {
                         _traverseLeftSubtree();
-                        return;
                     }
+                    return;
                 }
             }
             return;
@@ -220,12 +220,7 @@ public:
             // '_current' is root. However, it cannot return the root, and hence at least 1
             // iteration of the while loop is required.
             do {
-                for (auto child : _current->_children) {
-                    if (child != nullptr) {
-                        _current = child.get();
-                        break;
-                    }
-                }
+                _current = _current->_children.firstFrom(0);
             } while (!_current->_data);
         }
 
@@ -399,14 +394,12 @@ public:
 
                 // After moving up in the tree, continue searching for neighboring nodes to see if
                 // they have data, moving from right to left.
-                for (int i = oldKey - 1; i >= 0; i--) {
-                    if (node->_children[i] != nullptr) {
-                        // If there is a sub-tree found, it must have data, therefore it's necessary
-                        // to traverse to the right most node.
-                        _current = node->_children[i].get();
-                        _traverseRightSubtree();
-                        return;
-                    }
+                if (Node* prev = node->_children.lastUpTo(oldKey - 1)) {
+                    // If there is a sub-tree found, it must have data, therefore it's necessary
+                    // to traverse to the right most node.
+                    _current = prev;
+                    _traverseRightSubtree();
+                    return;
                 }
 
                 // If there were no sub-trees that contained data, and the 'current' node has data,
@@ -421,15 +414,9 @@ public:
         void _traverseRightSubtree() {
             // This function traverses the given tree to the right most leaf of the subtree where
             // 'current' is the root.
-            do {
-                for (auto iter = _current->_children.rbegin(); iter != _current->_children.rend();
-                     ++iter) {
-                    if (*iter != nullptr) {
-                        _current = iter->get();
-                        break;
-                    }
-                }
-            } while (!_current->isLeaf());
+            while (!_current->isLeaf()) {
+                _current = _current->_children.lastUpTo(UINT8_MAX);
+            }
         }
 
         void updateTreeView(bool stopIfMultipleCursors = false) {
@@ -610,7 +597,7 @@ public:
 
             uint8_t childFirstChar = child->_trieKey.front();
             if (!isUniquelyOwned) {
-                parent->_children[childFirstChar] = std::make_shared<Node>(*child);
+                parent->_children.set(childFirstChar, std::make_shared<Node>(*child));
                 child = parent->_children[childFirstChar].get();
             }
 
@@ -618,7 +605,7 @@ public:
         }
 
         // Handle the deleted node, as it is a leaf.
-        parent->_children[deleted->_trieKey.front()] = nullptr;
+        parent->_children.set(deleted->_trieKey.front(), nullptr);
 
         // 'parent' may only have one child, in which case we need to evaluate whether or not
         // this node is redundant.
@@ -723,8 +710,8 @@ public:
                 return const_iterator(_root, node);
 
             // The search key is an exact prefix, so we need to search all of this node's
-            // children.
-            context.back() = std::make_pair(node, 0);
+            // children. The context may be empty here if the last byte of the key was UINT8_MAX.
+            context.push_back(std::make_pair(node, 0));
         }
 
         // The node with the provided key did not exist. Now we must find the next largest node, if
@@ -734,18 +721,14 @@ public:
             std::tie(node, idx) = context.back();
             context.pop_back();
 
-            for (auto iter = idx + node->_children.begin(); iter != node->_children.end(); ++iter) {
-                if (!(*iter))
-                    continue;
-
+            if (Node* next = node->_children.firstFrom(idx)) {
                 // There exists a node with a key larger than the one given.
-                node = iter->get();
+                node = next;
                 if (node->_data)
                     return const_iterator(_root, node);
 
                 // Need to search this node's children for the next largest node.
                 context.push_back(std::make_pair(node, 0));
-                break;
             }
 
             if (node->_trieKey.empty() && context.empty()) {
@@ -783,6 +766,310 @@ public:
     }
 
 private:
+    /**
+     * The children of a Node, indexed by the first byte of their trie key. Like the nodes of an
+     * adaptive radix tree, the representation grows with the number of children so that the many
+     * nodes with few children stay small:
+     *
+     *  - k4 and k16 keep up to 4 or 16 children in parallel arrays sorted by key,
+     *  - k48 keeps up to 48 children plus a 256-entry index of (slot + 1) by key,
+     *  - k256 keeps an array of 256 children indexed directly by key.
+     *
+     * Nodes without children do not allocate any storage.
+     */
+    class Children {
+    public:
+        Children() = default;
+
+        Children(const Children& other) : _kind(other._kind), _size(other._size) {
+            if (!other._slots)
+                return;
+            const size_t capacity = _capacity(_kind);
+            _slots.reset(new std::shared_ptr<Node>[capacity]);
+            std::copy(other._slots.get(), other._slots.get() + capacity, _slots.get());
+            if (const size_t indexSize = _indexSize(_kind)) {
+                _index.reset(new uint8_t[indexSize]);
+                std::memcpy(_index.get(), other._index.get(), indexSize);
+            }
+        }
+
+        Children(Children&& other) = default;
+
+        Children& operator=(Children other) {
+            std::swap(_kind, other._kind);
+            std::swap(_size, other._size);
+            std::swap(_index, other._index);
+            std::swap(_slots, other._slots);
+            return *this;
+        }
+
+        /**
+         * Returns the child whose trie key starts with 'key', or nullptr if there is none.
+         */
+        const std::shared_ptr<Node>& operator[](uint8_t key) const {
+            static const std::shared_ptr<Node> kNone;
+            const std::shared_ptr<Node>* slot = _find(key);
+            return slot ? *slot : kNone;
+        }
+
+        /**
+         * Replaces the child whose trie key starts with 'key'. Setting a nullptr removes it.
+         */
+        void set(uint8_t key, std::shared_ptr<Node> child) {
+            if (!child) {
+                _erase(key);
+                return;
+            }
+
+            if (std::shared_ptr<Node>* slot = _find(key)) {
+                *slot = std::move(child);
+                return;
+            }
+
+            if (!_slots) {
+                _allocate(Kind::k4);
+            } else if (_size == _capacity(_kind)) {
+                _convert(static_cast<Kind>(static_cast<uint8_t>(_kind) + 1));
+            }
+
+            switch (_kind) {
+                case Kind::k4:
+                case Kind::k16: {
+                    size_t pos = _size;
+                    while (pos > 0 && _index[pos - 1] > key) {
+                        _index[pos] = _index[pos - 1];
+                        _slots[pos] = std::move(_slots[pos - 1]);
+                        --pos;
+                    }
+                    _index[pos] = key;
+                    _slots[pos] = std::move(child);
+                    break;
+                }
+                case Kind::k48: {
+                    size_t slot = 0;
+                    while (_slots[slot])
+                        ++slot;
+                    _index[key] = slot + 1;
+                    _slots[slot] = std::move(child);
+                    break;
+                }
+                case Kind::k256:
+                    _slots[key] = std::move(child);
+                    break;
+            }
+            ++_size;
+        }
+
+        size_t size() const {
+            return _size;
+        }
+
+        bool empty() const {
+            return _size == 0;
+        }
+
+        /**
+         * Returns the child with the smallest key that is at least 'from', or nullptr.
+         */
+        Node* firstFrom(int from) const {
+            switch (_kind) {
+                case Kind::k4:
+                case Kind::k16:
+                    for (size_t i = 0; i < _size; ++i) {
+                        if (_index[i] >= from)
+                            return _slots[i].get();
+                    }
+                    return nullptr;
+                case Kind::k48:
+                    for (int key = from; key < 256; ++key) {
+                        if (_index[key])
+                            return _slots[_index[key] - 1].get();
+                    }
+                    return nullptr;
+                case Kind::k256:
+                    for (int key = from; key < 256; ++key) {
+                        if (_slots[key])
+                            return _slots[key].get();
+                    }
+                    return nullptr;
+            }
+            MONGO_UNREACHABLE;
+        }
+
+        /**
+         * Returns the child with the largest key that is at most 'to', or nullptr.
+         */
+        Node* lastUpTo(int to) const {
+            switch (_kind) {
+                case Kind::k4:
+                case Kind::k16:
+                    for (size_t i = _size; i > 0; --i) {
+                        if (_index[i - 1] <= to)
+                            return _slots[i - 1].get();
+                    }
+                    return nullptr;
+                case Kind::k48:
+                    for (int key = to; key >= 0; --key) {
+                        if (_index[key])
+                            return _slots[_index[key] - 1].get();
+                    }
+                    return nullptr;
+                case Kind::k256:
+                    for (int key = to; key >= 0; --key) {
+                        if (_slots[key])
+                            return _slots[key].get();
+                    }
+                    return nullptr;
+            }
+            MONGO_UNREACHABLE;
+        }
+
+        /**
+         * Calls 'func' with each child in increasing key order.
+         */
+        template <typename Func>
+        void forEach(Func func) const {
+            _forEachSlot([&](uint8_t, std::shared_ptr<Node>& child) { func(child.get()); });
+        }
+
+    private:
+        enum class Kind : uint8_t { k4, k16, k48, k256 };
+
+        static size_t _capacity(Kind kind) {
+            static constexpr size_t kCapacities[] = {4, 16, 48, 256};
+            return kCapacities[static_cast<uint8_t>(kind)];
+        }
+
+        static size_t _indexSize(Kind kind) {
+            static constexpr size_t kIndexSizes[] = {4, 16, 256, 0};
+            return kIndexSizes[static_cast<uint8_t>(kind)];
+        }
+
+        // A kind is shrunk to the next smaller one once it holds this many children, which leaves
+        // some room so that alternating inserts and removals do not convert back and forth.
+        static size_t _shrinkThreshold(Kind kind) {
+            static constexpr size_t kThresholds[] = {0, 2, 12, 40};
+            return kThresholds[static_cast<uint8_t>(kind)];
+        }
+
+        std::shared_ptr<Node>* _find(uint8_t key) const {
+            if (!_slots)
+                return nullptr;
+            switch (_kind) {
+                case Kind::k4:
+                case Kind::k16:
+                    for (size_t i = 0; i < _size; ++i) {
+                        if (_index[i] == key)
+                            return &_slots[i];
+                    }
+                    return nullptr;
+                case Kind::k48:
+                    return _index[key] ? &_slots[_index[key] - 1] : nullptr;
+                case Kind::k256:
+                    return _slots[key] ? &_slots[key] : nullptr;
+            }
+            MONGO_UNREACHABLE;
+        }
+
+        /**
+         * Calls 'func' with the key and slot of each child in increasing key order.
+         */
+        template <typename Func>
+        void _forEachSlot(Func func) const {
+            switch (_kind) {
+                case Kind::k4:
+                case Kind::k16:
+                    for (size_t i = 0; i < _size; ++i) {
+                        func(_index[i], _slots[i]);
+                    }
+                    return;
+                case Kind::k48:
+                    for (size_t key = 0; key < 256; ++key) {
+                        if (_index[key])
+                            func(key, _slots[_index[key] - 1]);
+                    }
+                    return;
+                case Kind::k256:
+                    for (size_t key = 0; key < 256; ++key) {
+                        if (_slots[key])
+                            func(key, _slots[key]);
+                    }
+                    return;
+            }
+        }
+
+        void _allocate(Kind kind) {
+            _kind = kind;
+            _slots.reset(new std::shared_ptr<Node>[_capacity(kind)]);
+            const size_t indexSize = _indexSize(kind);
+            _index.reset(indexSize ? new uint8_t[indexSize]() : nullptr);
+        }
+
+        void _erase(uint8_t key) {
+            if (!_find(key))
+                return;
+
+            switch (_kind) {
+                case Kind::k4:
+                case Kind::k16: {
+                    size_t pos = 0;
+                    while (_index[pos] != key)
+                        ++pos;
+                    for (; pos + 1 < _size; ++pos) {
+                        _index[pos] = _index[pos + 1];
+                        _slots[pos] = std::move(_slots[pos + 1]);
+                    }
+                    _slots[_size - 1].reset();
+                    break;
+                }
+                case Kind::k48:
+                    _slots[_index[key] - 1].reset();
+                    _index[key] = 0;
+                    break;
+                case Kind::k256:
+                    _slots[key].reset();
+                    break;
+            }
+            --_size;
+
+            if (_size == 0) {
+                _kind = Kind::k4;
+                _index.reset();
+                _slots.reset();
+            } else if (_size <= _shrinkThreshold(_kind)) {
+                _convert(static_cast<Kind>(static_cast<uint8_t>(_kind) - 1));
+            }
+        }
+
+        void _convert(Kind kind) {
+            Children converted;
+            converted._allocate(kind);
+            _forEachSlot([&](uint8_t key, std::shared_ptr<Node>& slot) {
+                switch (kind) {
+                    case Kind::k4:
+                    case Kind::k16:
+                        converted._index[converted._size] = key;
+                        converted._slots[converted._size] = std::move(slot);
+                        break;
+                    case Kind::k48:
+                        converted._index[key] = converted._size + 1;
+                        converted._slots[converted._size] = std::move(slot);
+                        break;
+                    case Kind::k256:
+                        converted._slots[key] = std::move(slot);
+                        break;
+                }
+                ++converted._size;
+            });
+            *this = std::move(converted);
+        }
+
+        Kind _kind = Kind::k4;
+        uint16_t _size = 0;
+        std::unique_ptr<uint8_t[]> _index;
+        std::unique_ptr<std::shared_ptr<Node>[]> _slots;
+    };
+
     class Node {
         friend class RadixStore;
 
@@ -822,18 +1109,14 @@ private:
         }
 
         bool isLeaf() const {
-            for (auto child : _children) {
-                if (child != nullptr)
-                    return false;
-            }
-            return true;
+            return _children.empty();
         }
 
     protected:
         unsigned int _depth = 0;
         std::vector<uint8_t> _trieKey;
         boost::optional<value_type> _data;
-        std::array<std::shared_ptr<Node>, 256> _children;
+        Children _children;
     };
 
     /**
@@ -910,11 +1193,7 @@ private:
         }
         ret.push_back('\n');
 
-        for (auto child : node->_children) {
-            if (child != nullptr) {
-                ret.append(_walkTree(child.get(), depth + 1));
-            }
-        }
+        node->_children.forEach([&](Node* child) { ret.append(_walkTree(child, depth + 1)); });
         return ret;
     }
 
@@ -1012,7 +1291,7 @@ private:
             if (node.use_count() - 1 > 1) {
                 // Copy node on a modifying operation when it isn't owned uniquely.
                 node = std::make_shared<Node>(*node);
-                prev->_children[childFirstChar] = node;
+                prev->_children.set(childFirstChar, node);
             }
 
             // 'node' is uniquely owned at this point, so we are free to modify it.
@@ -1045,7 +1324,7 @@ private:
 
                 // Change the current node's trieKey and make a child of the new node.
                 newKey = _makeKey(node->_trieKey, mismatchIdx, node->_trieKey.size() - mismatchIdx);
-                newNode->_children[newKey.front()] = node;
+                newNode->_children.set(newKey.front(), node);
 
                 node->_trieKey = newKey;
                 node->_depth = newNode->_depth + newNode->_trieKey.size();
@@ -1125,7 +1404,7 @@ private:
         if (value) {
             newNode->_data.emplace(value->first, value->second);
         }
-        node->_children[key.front()] = newNode;
+        node->_children.set(key.front(), newNode);
         return newNode.get();
     }
 
@@ -1181,16 +1460,11 @@ private:
         }
 
         // Determine if this node has only one child.
-        std::shared_ptr<Node> onlyChild = nullptr;
-
-        for (size_t i = 0; i < node->_children.size(); ++i) {
-            if (node->_children[i] != nullptr) {
-                if (onlyChild != nullptr) {
-                    return;
-                }
-                onlyChild = node->_children[i];
-            }
+        if (node->_children.size() != 1) {
+            return;
         }
+        const uint8_t onlyChildFirstChar = node->_children.firstFrom(0)->_trieKey.front();
+        std::shared_ptr<Node> onlyChild = node->_children[onlyChildFirstChar];
 
         // Append the child's key onto the parent.
         for (char item : onlyChild->_trieKey) {
@@ -1240,7 +1514,7 @@ private:
 
             if (prev->_children[node->_trieKey.front()].use_count() > 1) {
                 std::shared_ptr<Node> nodeCopy = std::make_shared<Node>(*node);
-                prev->_children[nodeCopy->_trieKey.front()] = nodeCopy;
+                prev->_children.set(nodeCopy->_trieKey.front(), nodeCopy);
                 context[idx] = nodeCopy.get();
                 prev = nodeCopy.get();
             } else {
@@ -1379,7 +1653,7 @@ private:
                     // modifications that go on in _makeBranchUnique.
                     _rebuildContext(context, trieKeyIndex);
 
-                    current->_children[key] = other->_children[key];
+                    current->_children.set(key, other->_children[key]);
                 } else if (!otherNode || (baseNode && baseNode != otherNode)) {
                     // Either the master tree and working tree remove the same branch, or the master
                     // tree updated the branch while the working tree removed the branch, resulting
@@ -1392,12 +1666,12 @@ private:
 
                     current = _makeBranchUnique(context);
                     _rebuildContext(context, trieKeyIndex);
-                    current->_children[key] = nullptr;
+                    current->_children.set(key, nullptr);
                 } else if (baseNode && otherNode && baseNode == node) {
                     // If base and current point to the same node, then master changed.
                     current = _makeBranchUnique(context);
                     _rebuildContext(context, trieKeyIndex);
-                    current->_children[key] = other->_children[key];
+                    current->_children.set(key, other->_children[key]);
                 }
             } else if (baseNode && otherNode && baseNode != otherNode) {
                 // If all three are unique and leaf nodes, then it is a merge conflict.
@@ -1440,12 +1714,7 @@ private:
             if (node->_children.empty())
                 return nullptr;
 
-            for (auto child : node->_children) {
-                if (child != nullptr) {
-                    node = child.get();
-                    break;
-                }
-            }
+            node = node->_children.firstFrom(0);
         }
         return node;
     }
@@ -2492,5 +2492,53 @@ TEST_F(RadixStoreTest, LowerBoundEndpoint) {
     ASSERT_TRUE(it == thisStore.end());
 }
 
+TEST_F(RadixStoreTest, LowerBoundPrefixEndingInMaxByte) {
+    value_type value1 = std::make_pair("\xff\x01", "1");
+    value_type value2 = std::make_pair("\xff\x02", "2");
+
+    thisStore.insert(value_type(value1));
+    thisStore.insert(value_type(value2));
+
+    auto it = thisStore.lower_bound("\xff");
+    ASSERT_TRUE(it->first == "\xff\x01");
+}
+
+TEST_F(RadixStoreTest, ManyChildrenGrowAndShrinkTest) {
+    // Fill a single node with every possible child so that it grows through each node size, then
+    // erase them again so that it shrinks back down.
+    for (int i = 0; i <= UINT8_MAX; ++i) {
+        std::string key(1, static_cast<char>(i));
+        thisStore.insert(value_type(key + "a", key));
+    }
+    ASSERT_EQ(thisStore.size(), 256u);
+
+    int expected = 0;
+    for (auto it = thisStore.begin(); it != thisStore.end(); ++it, ++expected) {
+        ASSERT_EQ(it->second, std::string(1, static_cast<char>(expected)));
+    }
+    ASSERT_EQ(expected, 256);
+
+    expected = UINT8_MAX;
+    for (auto it = thisStore.rbegin(); it != thisStore.rend(); ++it, --expected) {
+        ASSERT_EQ(it->second, std::string(1, static_cast<char>(expected)));
+    }
+    ASSERT_EQ(expected, -1);
+
+    for (int i = 0; i <= UINT8_MAX; ++i) {
+        if (i % 64 != 0)
+            ASSERT_TRUE(thisStore.erase(std::string(1, static_cast<char>(i)) + "a"));
+    }
+    ASSERT_EQ(thisStore.size(), 4u);
+
+    expected = 0;
+    for (auto it = thisStore.begin(); it != thisStore.end(); ++it, expected += 64) {
+        ASSERT_EQ(it->second, std::string(1, static_cast<char>(expected)));
+    }
+    ASSERT_EQ(expected, 256);
+
+    auto it = thisStore.lower_bound(std::string(1, static_cast<char>(65)));
+    ASSERT_EQ(it->second, std::string(1, static_cast<char>(128)));
+}
+
 }  // namespace biggie
 }  // namespace mongo
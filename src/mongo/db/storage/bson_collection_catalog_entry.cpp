@@ -186,6 +186,9 @@ BSONObj BSONCollectionCatalogEntry::MetaData::toBSON() const {
             if (indexes[i].sideWritesIdent) {
                 sub.append("sideWritesIdent", *indexes[i].sideWritesIdent);
             }
+            if (indexes[i].resumeState) {
+                sub.append("resumeState", *indexes[i].resumeState);
+            }
             sub.doneFast();
         }
         arr.doneFast();
@@ -234,6 +237,9 @@ void BSONCollectionCatalogEntry::MetaData::parse(const BSONObj& obj) {
             if (idx["sideWritesIdent"]) {
                 imd.sideWritesIdent = idx["sideWritesIdent"].str();
             }
+            if (idx["resumeState"].isABSONObj()) {
+                imd.resumeState = idx["resumeState"].Obj().getOwned();
+            }
             indexes.push_back(imd);
         }
     }
@@ -81,6 +81,10 @@ public:
         boost::optional<std::string> constraintViolationsIdent;
         boost::optional<std::string> sideWritesIdent;
 
+        // Set when a clean shutdown interrupted the build of this index during its collection
+        // scan. Holds what the build needs to resume after the restart.
+        boost::optional<BSONObj> resumeState;
+
         // If non-empty, 'multikeyPaths' is a vector with size equal to the number of elements in
         // the index key pattern. Each element in the vector is an ordered set of positions
         // (starting at 0) into the corresponding indexed field that represent what prefixes of the
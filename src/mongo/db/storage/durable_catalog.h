@@ -212,6 +212,24 @@ public:
                                       NamespaceString ns,
                                       StringData indexName) const = 0;
 
+    /**
+     * Records what an index build that was interrupted by a clean shutdown needs in order to
+     * resume after the restart instead of starting over, including the side writes table that
+     * must survive the restart.
+     */
+    virtual void setIndexBuildResumeState(OperationContext* opCtx,
+                                          NamespaceString ns,
+                                          StringData indexName,
+                                          std::string sideWritesIdent,
+                                          const BSONObj& resumeState) = 0;
+
+    /**
+     * Returns the state recorded by setIndexBuildResumeState(), if any.
+     */
+    virtual boost::optional<BSONObj> getIndexBuildResumeState(OperationContext* opCtx,
+                                                              NamespaceString ns,
+                                                              StringData indexName) const = 0;
+
     /**
      * Indicate that an index build is completed and the index is ready to use.
      */
@@ -1081,6 +1081,30 @@ bool DurableCatalogImpl::isIndexBuildDraining(OperationContext* opCtx,
         BSONCollectionCatalogEntry::kIndexBuildDraining.toString();
 }
 
+void DurableCatalogImpl::setIndexBuildResumeState(OperationContext* opCtx,
+                                                  NamespaceString ns,
+                                                  StringData indexName,
+                                                  std::string sideWritesIdent,
+                                                  const BSONObj& resumeState) {
+    BSONCollectionCatalogEntry::MetaData md = getMetaData(opCtx, ns);
+    int offset = md.findIndexOffset(indexName);
+    invariant(offset >= 0);
+    invariant(!md.indexes[offset].ready);
+
+    md.indexes[offset].sideWritesIdent = sideWritesIdent;
+    md.indexes[offset].resumeState = resumeState.getOwned();
+    putMetaData(opCtx, ns, md);
+}
+
+boost::optional<BSONObj> DurableCatalogImpl::getIndexBuildResumeState(OperationContext* opCtx,
+                                                                      NamespaceString ns,
+                                                                      StringData indexName) const {
+    BSONCollectionCatalogEntry::MetaData md = getMetaData(opCtx, ns);
+    int offset = md.findIndexOffset(indexName);
+    invariant(offset >= 0);
+    return md.indexes[offset].resumeState;
+}
+
 void DurableCatalogImpl::indexBuildSuccess(OperationContext* opCtx,
                                            NamespaceString ns,
                                            StringData indexName) {
@@ -1092,6 +1116,7 @@ void DurableCatalogImpl::indexBuildSuccess(OperationContext* opCtx,
     md.indexes[offset].buildPhase = boost::none;
     md.indexes[offset].sideWritesIdent = boost::none;
     md.indexes[offset].constraintViolationsIdent = boost::none;
+    md.indexes[offset].resumeState = boost::none;
     putMetaData(opCtx, ns, md);
 }
 
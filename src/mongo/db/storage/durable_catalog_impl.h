@@ -167,6 +167,16 @@ public:
                               NamespaceString ns,
                               StringData indexName) const;
 
+    void setIndexBuildResumeState(OperationContext* opCtx,
+                                  NamespaceString ns,
+                                  StringData indexName,
+                                  std::string sideWritesIdent,
+                                  const BSONObj& resumeState);
+
+    boost::optional<BSONObj> getIndexBuildResumeState(OperationContext* opCtx,
+                                                      NamespaceString ns,
+                                                      StringData indexName) const;
+
     void indexBuildSuccess(OperationContext* opCtx, NamespaceString ns, StringData indexName);
 
     bool isIndexMultikey(OperationContext* opCtx,
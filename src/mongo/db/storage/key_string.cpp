@@ -33,6 +33,8 @@
 
 #include "mongo/db/storage/key_string.h"
 
+#include <algorithm>
+#include <boost/optional.hpp>
 #include <cmath>
 #include <type_traits>
 
@@ -121,6 +123,25 @@ size_t numBytesForInt(uint8_t ctype) {
 }
 }  // namespace CType
 
+// Starting with V2, dates are stored relative to a pivot instant as a length-prefixed
+// big-endian magnitude of 0 to 8 bytes, rather than as a fixed 8-byte offset-binary value. The
+// pivot (2^40 ms, in 2004) puts every date between 1969 and 2039 within 5 bytes of it.
+//
+// The length byte orders the encodings: non-negative distances use kNonNegative + N,
+// while negative distances store the magnitude minus one, bitwise inverted, after
+// kNegative - N. Since every magnitude uses the minimal number of bytes, two dates
+// with the same length byte always have payloads of the same width.
+namespace DateV2 {
+const uint64_t kPivot = (1ULL << 40) ^ (1ULL << 63);  // in offset-binary
+const uint8_t kNonNegative = 0x80;
+const uint8_t kNegative = 0x7F;
+const int kMaxBytes = sizeof(uint64_t);
+
+int bytesNeeded(uint64_t magnitude) {
+    return (64 - countLeadingZeros64(magnitude) + 7) / 8;
+}
+}  // namespace DateV2
+
 uint8_t bsonTypeToGenericKeyStringType(BSONType type) {
     switch (type) {
         case MinKey:
@@ -524,7 +545,24 @@ void BuilderBase<BufferT>::_appendDate(Date_t val, bool invert) {
     // see: http://en.wikipedia.org/wiki/Offset_binary
     uint64_t encoded = static_cast<uint64_t>(val.asInt64());
     encoded ^= (1LL << 63);  // flip highest bit (equivalent to bias encoding)
-    _append(endian::nativeToBig(encoded), invert);
+    if (version < Version::V2) {
+        _append(endian::nativeToBig(encoded), invert);
+        return;
+    }
+
+    const bool isNegative = encoded < DateV2::kPivot;
+    const uint64_t magnitude =
+        isNegative ? DateV2::kPivot - 1 - encoded : encoded - DateV2::kPivot;
+    const int numBytes = DateV2::bytesNeeded(magnitude);
+    _append(uint8_t(isNegative ? DateV2::kNegative - numBytes : DateV2::kNonNegative + numBytes),
+            invert);
+    if (numBytes) {
+        const uint64_t payload = endian::nativeToBig(isNegative ? ~magnitude : magnitude);
+        // Only using the low-order numBytes bytes of payload.
+        _appendBytes(reinterpret_cast<const char*>(&payload) + sizeof(payload) - numBytes,
+                     numBytes,
+                     invert);
+    }
 }
 
 template <class BufferT>
@@ -1280,6 +1318,31 @@ Decimal128 readDecimalContinuation(BufReader* reader, bool inverted, Decimal128
     return num;
 }
 
+/**
+ * Reads a date encoded by _appendDate() in the format used by 'version'.
+ */
+Date_t readDate(BufReader* reader, bool inverted, Version version) {
+    if (version < Version::V2) {
+        return Date_t::fromMillisSinceEpoch(
+            endian::bigToNative(readType<uint64_t>(reader, inverted)) ^ (1LL << 63));
+    }
+
+    const uint8_t lengthByte = readType<uint8_t>(reader, inverted);
+    const bool isNegative = lengthByte <= DateV2::kNegative;
+    const int numBytes =
+        isNegative ? DateV2::kNegative - lengthByte : lengthByte - DateV2::kNonNegative;
+    uassert(4774900, "Invalid date length in KeyString", numBytes <= DateV2::kMaxBytes);
+
+    uint64_t magnitude = 0;
+    for (int i = 0; i < numBytes; ++i) {
+        const uint8_t byte = readType<uint8_t>(reader, inverted);
+        magnitude = (magnitude << 8) | (isNegative ? uint8_t(~byte) : byte);
+    }
+    const uint64_t encoded =
+        isNegative ? DateV2::kPivot - 1 - magnitude : DateV2::kPivot + magnitude;
+    return Date_t::fromMillisSinceEpoch(static_cast<long long>(encoded ^ (1ULL << 63)));
+}
+
 void toBsonValue(uint8_t ctype,
                  BufReader* reader,
                  TypeBits::Reader* typeBits,
@@ -1317,8 +1380,7 @@ void toBsonValue(uint8_t ctype,
             break;
 
         case CType::kDate:
-            *stream << Date_t::fromMillisSinceEpoch(
-                endian::bigToNative(readType<uint64_t>(reader, inverted)) ^ (1LL << 63));
+            *stream << readDate(reader, inverted, version);
             break;
 
         case CType::kTimestamp:
@@ -1469,7 +1531,7 @@ void toBsonValue(uint8_t ctype,
             } else {
                 uassert(50819,
                         "Invalid type bits for numeric NaN",
-                        type == TypeBits::kDecimal && version == Version::V1);
+                        type == TypeBits::kDecimal && version >= Version::V1);
                 *stream << Decimal128::kPositiveNaN;
             }
             break;
@@ -1860,6 +1922,9 @@ void filterKeyFromKeyString(uint8_t ctype, BufReader* reader, bool inverted, Ver
             break;
 
         case CType::kDate:
+            (void)readDate(reader, inverted, version);
+            break;
+
         case CType::kTimestamp:
             reader->skip(sizeof(std::uint64_t));
             break;
@@ -2410,6 +2475,59 @@ BSONObj toBson(StringData data, Ordering ord, const TypeBits& typeBits) {
     return toBson(data.rawData(), data.size(), ord, typeBits);
 }
 
+void appendToBson(const char* buffer,
+                  size_t len,
+                  Ordering ord,
+                  const TypeBits& typeBits,
+                  const std::vector<bool>& includeKey,
+                  const std::vector<StringData>& fieldNames,
+                  BSONObjBuilder* builder) {
+    invariant(includeKey.size() == fieldNames.size());
+
+    // Nothing after the last included field needs to be decoded.
+    const size_t numFieldsToDecode =
+        std::distance(std::find(includeKey.rbegin(), includeKey.rend(), true), includeKey.rend());
+
+    // Excluded fields before the last included one must still be decoded to consume their type
+    // bits, so they are discarded into a scratch builder that is only created if needed.
+    boost::optional<BSONObjBuilder> discarded;
+
+    BufReader reader(buffer, len);
+    TypeBits::Reader typeBitsReader(typeBits);
+    for (size_t i = 0; i < numFieldsToDecode && reader.remaining(); i++) {
+        const bool invert = (ord.get(i) == -1);
+        uint8_t ctype = readType<uint8_t>(&reader, invert);
+        if (ctype == kLess || ctype == kGreater) {
+            // This was just a discriminator, see toBsonSafe().
+            ctype = readType<uint8_t>(&reader, invert);
+        }
+
+        if (ctype == kEnd)
+            break;
+
+        if (includeKey[i]) {
+            toBsonValue(ctype,
+                        &reader,
+                        &typeBitsReader,
+                        invert,
+                        typeBits.version,
+                        &(*builder << fieldNames[i]),
+                        1);
+        } else {
+            if (!discarded) {
+                discarded.emplace();
+            }
+            toBsonValue(ctype,
+                        &reader,
+                        &typeBitsReader,
+                        invert,
+                        typeBits.version,
+                        &(*discarded << ""),
+                        1);
+        }
+    }
+}
+
 RecordId decodeRecordIdAtEnd(const void* bufferRaw, size_t bufSize) {
     invariant(bufSize >= 2);  // smallest possible encoding of a RecordId.
     const unsigned char* buffer = static_cast<const unsigned char*>(bufferRaw);
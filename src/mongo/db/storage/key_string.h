@@ -30,6 +30,7 @@
 #pragma once
 
 #include <limits>
+#include <vector>
 
 #include "mongo/base/static_assert.h"
 #include "mongo/bson/bsonelement_comparator_interface.h"
@@ -46,10 +47,23 @@ namespace mongo {
 
 namespace KeyString {
 
-enum class Version : uint8_t { V0 = 0, V1 = 1, kLatestVersion = V1 };
+/**
+ * V1 changed the encoding of numeric values. V2 stores dates in a variable-length format; it is
+ * only used for indexes whose storage format explicitly opts into it, so kLatestVersion remains
+ * V1.
+ */
+enum class Version : uint8_t { V0 = 0, V1 = 1, V2 = 2, kLatestVersion = V1 };
 
 static StringData keyStringVersionToString(Version version) {
-    return version == Version::V0 ? "V0" : "V1";
+    switch (version) {
+        case Version::V0:
+            return "V0";
+        case Version::V1:
+            return "V1";
+        case Version::V2:
+            return "V2";
+    }
+    MONGO_UNREACHABLE;
 }
 
 static const Ordering ALL_ASCENDING = Ordering::make(BSONObj());
@@ -606,7 +620,7 @@ public:
 
     /**
      * Version to use for conversion to/from KeyString. V1 has different encodings for numeric
-     * values.
+     * values and V2 has a more compact encoding for dates.
      */
     const Version version;
 
@@ -809,6 +823,20 @@ BSONObj toBson(const T& keyString, Ordering ord) noexcept {
     return toBson(keyString.getBuffer(), keyString.getSize(), ord, keyString.getTypeBits());
 }
 
+/**
+ * Decodes the elements of the given KeyString buffer straight into 'builder', skipping the
+ * intermediate BSONObj that toBson() would produce. The i-th element is appended under
+ * 'fieldNames[i]' if 'includeKey[i]' is true and is otherwise omitted. Elements following the last
+ * included one are not decoded at all.
+ */
+void appendToBson(const char* buffer,
+                  size_t len,
+                  Ordering ord,
+                  const TypeBits& typeBits,
+                  const std::vector<bool>& includeKey,
+                  const std::vector<StringData>& fieldNames,
+                  BSONObjBuilder* builder);
+
 /**
  * Decodes a RecordId from the end of a buffer.
  */
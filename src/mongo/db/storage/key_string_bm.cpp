@@ -66,6 +66,7 @@ enum BsonValueType {
     STRING,
     ARRAY,
     DECIMAL,
+    DATE,
 };
 
 BSONObj generateBson(BsonValueType bsonValueType) {
@@ -93,6 +94,11 @@ BSONObj generateBson(BsonValueType bsonValueType) {
                                          Decimal128::kRoundTo34Digits,
                                          Decimal128::kRoundTiesToAway)
                                   .quantize(Decimal128("0.01", Decimal128::kRoundTiesToAway)));
+        case DATE: {
+            // Dates within a few years of 2020.
+            const auto offsetMillis = static_cast<long long>(expReal(gen) * 100 * 1000 * 1000);
+            return BSON("" << Date_t::fromMillisSinceEpoch(1577836800000LL + offsetMillis));
+        }
     }
     MONGO_UNREACHABLE;
 }
@@ -132,6 +138,8 @@ void BM_BSONToKeyString(benchmark::State& state,
     }
     state.SetBytesProcessed(state.iterations() * bsonsAndKeyStrings.bsonSize);
     state.SetItemsProcessed(state.iterations() * kSampleSize);
+    state.counters["keyStringBytesPerItem"] =
+        static_cast<double>(bsonsAndKeyStrings.keystringSize) / kSampleSize;
 }
 
 void BM_KeyStringToBSON(benchmark::State& state,
@@ -235,6 +243,10 @@ BENCHMARK_CAPTURE(BM_BSONToKeyString, V0_String, KeyString::Version::V0, STRING)
 BENCHMARK_CAPTURE(BM_BSONToKeyString, V1_String, KeyString::Version::V1, STRING);
 BENCHMARK_CAPTURE(BM_BSONToKeyString, V0_Array, KeyString::Version::V0, ARRAY);
 BENCHMARK_CAPTURE(BM_BSONToKeyString, V1_Array, KeyString::Version::V1, ARRAY);
+BENCHMARK_CAPTURE(BM_BSONToKeyString, V1_Date, KeyString::Version::V1, DATE);
+BENCHMARK_CAPTURE(BM_BSONToKeyString, V2_Int, KeyString::Version::V2, INT);
+BENCHMARK_CAPTURE(BM_BSONToKeyString, V2_Double, KeyString::Version::V2, DOUBLE);
+BENCHMARK_CAPTURE(BM_BSONToKeyString, V2_Date, KeyString::Version::V2, DATE);
 
 BENCHMARK_CAPTURE(BM_KeyStringToBSON, V0_Int, KeyString::Version::V0, INT);
 BENCHMARK_CAPTURE(BM_KeyStringToBSON, V1_Int, KeyString::Version::V1, INT);
@@ -245,6 +257,10 @@ BENCHMARK_CAPTURE(BM_KeyStringToBSON, V0_String, KeyString::Version::V0, STRING)
 BENCHMARK_CAPTURE(BM_KeyStringToBSON, V1_String, KeyString::Version::V1, STRING);
 BENCHMARK_CAPTURE(BM_KeyStringToBSON, V0_Array, KeyString::Version::V0, ARRAY);
 BENCHMARK_CAPTURE(BM_KeyStringToBSON, V1_Array, KeyString::Version::V1, ARRAY);
+BENCHMARK_CAPTURE(BM_KeyStringToBSON, V1_Date, KeyString::Version::V1, DATE);
+BENCHMARK_CAPTURE(BM_KeyStringToBSON, V2_Int, KeyString::Version::V2, INT);
+BENCHMARK_CAPTURE(BM_KeyStringToBSON, V2_Double, KeyString::Version::V2, DOUBLE);
+BENCHMARK_CAPTURE(BM_KeyStringToBSON, V2_Date, KeyString::Version::V2, DATE);
 
 }  // namespace
 }  // namespace mongo
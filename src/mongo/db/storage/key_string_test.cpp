@@ -96,6 +96,8 @@ public:
             base->run();
             version = KeyString::Version::V1;
             base->run();
+            version = KeyString::Version::V2;
+            base->run();
         } catch (...) {
             log() << "exception while testing KeyStringBuilder version "
                   << mongo::KeyString::keyStringVersionToString(version);
@@ -860,6 +862,63 @@ TEST_F(KeyStringBuilderTest, Timestamp) {
     }
 }
 
+TEST_F(KeyStringBuilderTest, Dates) {
+    std::vector<BSONObj> dates;
+    dates.push_back(BSON("" << Date_t::min()));
+    for (int powerOfTwo = 62; powerOfTwo >= 0; powerOfTwo--) {
+        dates.push_back(BSON("" << Date_t::fromMillisSinceEpoch(-(1LL << powerOfTwo))));
+    }
+    dates.push_back(BSON("" << Date_t::fromMillisSinceEpoch(0)));
+    for (int powerOfTwo = 0; powerOfTwo < 63; powerOfTwo++) {
+        const long long millis = 1LL << powerOfTwo;
+        dates.push_back(BSON("" << Date_t::fromMillisSinceEpoch(millis - 1)));
+        dates.push_back(BSON("" << Date_t::fromMillisSinceEpoch(millis)));
+        dates.push_back(BSON("" << Date_t::fromMillisSinceEpoch(millis + 1)));
+    }
+    dates.push_back(BSON("" << Date_t::max()));
+
+    for (size_t i = 0; i < dates.size(); i++) {
+        ROUNDTRIP(version, dates[i]);
+        if (i > 0) {
+            COMPARES_SAME(version, dates[i - 1], dates[i]);
+        }
+    }
+
+    // KeyString V2 stores dates near the present in fewer bytes than earlier versions.
+    const BSONObj recent = BSON("" << Date_t::fromMillisSinceEpoch(1600000000000LL));
+    const KeyString::Builder ks(version, recent, ALL_ASCENDING);
+    const size_t expectedSize = version == KeyString::Version::V2 ? 8U : 10U;
+    ASSERT_EQUALS(expectedSize, ks.getSize());
+}
+
+TEST_F(KeyStringBuilderTest, AppendToBson) {
+    const BSONObj key = BSON("" << 1 << "" << BSON("x" << 1.5) << ""
+                                << "str"
+                                << "" << 2LL);
+    const Ordering ord = Ordering::make(BSON("a" << 1 << "b" << -1 << "c" << 1 << "d" << -1));
+    const KeyString::Builder ks(version, key, ord, RecordId(7));
+
+    auto appendFields = [&](const std::vector<bool>& includeKey) {
+        const std::vector<StringData> fieldNames{"a", "b", "c", "d"};
+        BSONObjBuilder bob;
+        KeyString::appendToBson(
+            ks.getBuffer(), ks.getSize(), ord, ks.getTypeBits(), includeKey, fieldNames, &bob);
+        return bob.obj();
+    };
+
+    ASSERT_BSONOBJ_EQ(appendFields({true, true, true, true}),
+                      BSON("a" << 1 << "b" << BSON("x" << 1.5) << "c"
+                               << "str"
+                               << "d" << 2LL));
+    ASSERT_BSONOBJ_EQ(appendFields({false, true, false, false}), BSON("b" << BSON("x" << 1.5)));
+    ASSERT_BSONOBJ_EQ(appendFields({true, false, false, false}), BSON("a" << 1));
+    ASSERT_BSONOBJ_EQ(appendFields({false, false, false, false}), BSONObj());
+
+    // Type bits of skipped fields must still be consumed.
+    const BSONObj appended = appendFields({false, false, false, true});
+    ASSERT(appended.binaryEqual(BSON("d" << 2LL)));
+}
+
 TEST_F(KeyStringBuilderTest, AllTypesRoundtrip) {
     for (int i = 1; i <= JSTypeMax; i++) {
         {
@@ -924,6 +983,12 @@ const std::vector<BSONObj>& getInterestingElements(KeyString::Version version) {
     elements.push_back(BSON("" << BSONUndefined));
     elements.push_back(BSON("" << OID("abcdefabcdefabcdefabcdef")));
     elements.push_back(BSON("" << Date_t::fromMillisSinceEpoch(123)));
+    elements.push_back(BSON("" << Date_t::fromMillisSinceEpoch(-123)));
+    elements.push_back(BSON("" << Date_t::fromMillisSinceEpoch(1LL << 40)));
+    elements.push_back(BSON("" << Date_t::fromMillisSinceEpoch((1LL << 40) - 1)));
+    elements.push_back(BSON("" << Date_t::fromMillisSinceEpoch((1LL << 40) + 1)));
+    elements.push_back(BSON("" << Date_t::min()));
+    elements.push_back(BSON("" << Date_t::max()));
     elements.push_back(BSON("" << BSONCode("abc_code")));
     elements.push_back(BSON("" << BSONCode(zeroBall)));
     elements.push_back(BSON("" << BSONCode(ball)));
@@ -41,7 +41,7 @@
 namespace mongo {
 
 TemporaryKVRecordStore::~TemporaryKVRecordStore() {
-    invariant(_recordStoreHasBeenDeleted);
+    invariant(_recordStoreHasBeenDeleted || _keep);
 }
 
 void TemporaryKVRecordStore::deleteTemporaryTable(OperationContext* opCtx) {
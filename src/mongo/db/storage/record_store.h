@@ -29,7 +29,9 @@
 
 #pragma once
 
+#include <algorithm>
 #include <boost/optional.hpp>
+#include <vector>
 
 #include "mongo/base/owned_pointer_vector.h"
 #include "mongo/bson/mutable/damage_vector.h"
@@ -186,6 +188,17 @@ public:
      */
     virtual boost::optional<Record> seekExact(const RecordId& id) = 0;
 
+    /**
+     * Seeks to the Record with the provided id or, if there is none, to the first Record past it in
+     * the direction of the cursor. Returns boost::none if there is no such Record.
+     *
+     * Only needs to be implemented by the cursors of record stores that return records in RecordId
+     * order, see RecordStore::isInRecordIdOrder().
+     */
+    virtual boost::optional<Record> seekAtOrPast(const RecordId& id) {
+        MONGO_UNREACHABLE;
+    }
+
     /**
      * Prepares for state changes in underlying data without necessarily saving the current
      * state.
@@ -339,6 +352,37 @@ public:
         return inOutRecords.front().id;
     }
 
+    /**
+     * Appends records to a newly created, empty RecordStore outside of any storage transaction.
+     * Records are assigned increasing RecordIds. They are not guaranteed to be visible to readers
+     * of this RecordStore, nor counted in its size, until commit() succeeds, and are not rolled
+     * back if the operation that created the BulkBuilder fails.
+     */
+    class BulkBuilder {
+    public:
+        virtual ~BulkBuilder() = default;
+
+        /**
+         * Copies the record data and returns the RecordId it was assigned.
+         */
+        virtual StatusWith<RecordId> insertRecord(const char* data, int len) = 0;
+
+        /**
+         * Finishes bulk loading. No records may be inserted afterwards. A BulkBuilder destroyed
+         * without a successful commit() leaves the record counts of this RecordStore unchanged.
+         */
+        virtual Status commit() = 0;
+    };
+
+    /**
+     * Returns a BulkBuilder for this RecordStore, or nullptr if the storage engine cannot bulk load
+     * it, for example because it already contains records. The caller must not use any other
+     * means of accessing this RecordStore while the returned BulkBuilder is alive.
+     */
+    virtual std::unique_ptr<BulkBuilder> makeBulkBuilder(OperationContext* opCtx) {
+        return nullptr;
+    }
+
     /**
      * Updates the record with id 'recordId', replacing its contents with those described by
      * 'data' and 'len'.
@@ -406,6 +450,62 @@ public:
         return {};
     }
 
+    /**
+     * Returns up to 'numRanges' - 1 RecordIds, in increasing order, which split this record store
+     * into 'numRanges' ranges of RecordIds holding roughly the same number of records. The ranges
+     * are [RecordId::min(), b0), [b0, b1), ..., [bN, RecordId::max()], and can be scanned
+     * independently of each other by bounded collection scans (see CollectionScanParams).
+     *
+     * The default implementation reads every record of a small record store, and otherwise samples
+     * it with getRandomCursor(), in which case the ranges are only approximately balanced. Returns
+     * an empty vector, i.e. a single range, if a large record store does not support random cursors
+     * or if the record store holds too few records to be split.
+     */
+    virtual std::vector<RecordId> getRangeBoundaries(OperationContext* opCtx,
+                                                     size_t numRanges) const {
+        // The number of sampled records for every requested range. More samples give better
+        // balanced ranges at the cost of more random reads.
+        const long long kSamplesPerRange = 64;
+
+        if (numRanges < 2) {
+            return {};
+        }
+
+        // A record store no larger than the sample is read in full, which makes the ranges exact.
+        const long long numSamples = kSamplesPerRange * static_cast<long long>(numRanges);
+        const bool readAll = numRecords(opCtx) <= numSamples;
+        std::unique_ptr<RecordCursor> cursor =
+            readAll ? getCursor(opCtx, true) : getRandomCursor(opCtx);
+        if (!cursor) {
+            return {};
+        }
+
+        std::vector<RecordId> samples;
+        samples.reserve(numSamples);
+        while (readAll || static_cast<long long>(samples.size()) < numSamples) {
+            auto record = cursor->next();
+            if (!record) {
+                break;
+            }
+            samples.push_back(record->id);
+        }
+
+        // Random cursors may return the same record more than once, and other cursors need not
+        // return records in RecordId order.
+        std::sort(samples.begin(), samples.end());
+        samples.erase(std::unique(samples.begin(), samples.end()), samples.end());
+
+        std::vector<RecordId> boundaries;
+        for (size_t range = 1; range < numRanges; ++range) {
+            // A boundary at the first sample would only split off the records preceding it.
+            const size_t idx = range * samples.size() / numRanges;
+            if (idx > 0 && (boundaries.empty() || boundaries.back() < samples[idx])) {
+                boundaries.push_back(samples[idx]);
+            }
+        }
+        return boundaries;
+    }
+
     // higher level
 
 
@@ -303,6 +303,31 @@ public:
 
         virtual boost::optional<KeyStringEntry> seekExact(const KeyString::Value& keyString) = 0;
 
+        //
+        // Decoding keys
+        //
+
+        /**
+         * Returns true if this cursor implements appendKeyFields().
+         */
+        virtual bool canAppendKeyFields() const {
+            return false;
+        }
+
+        /**
+         * Decodes the key at the current position straight into 'builder' without building the
+         * BSONObj that requesting kWantKey would return. See KeyString::appendToBson() for the
+         * meaning of 'includeKey' and 'fieldNames'.
+         *
+         * May only be called if canAppendKeyFields() is true and the most recent call to next()
+         * or a seek method returned an entry.
+         */
+        virtual void appendKeyFields(const std::vector<bool>& includeKey,
+                                     const std::vector<StringData>& fieldNames,
+                                     BSONObjBuilder* builder) const {
+            MONGO_UNREACHABLE;
+        }
+
         //
         // Saving and restoring state
         //
@@ -336,6 +336,14 @@ public:
     virtual std::unique_ptr<TemporaryRecordStore> makeTemporaryRecordStore(
         OperationContext* opCtx) = 0;
 
+    /**
+     * Opens the RecordStore 'ident' that an earlier makeTemporaryRecordStore() created and that was
+     * kept across a restart with TemporaryRecordStore::keep(). The returned TemporaryRecordStore
+     * takes over dropping it.
+     */
+    virtual std::unique_ptr<TemporaryRecordStore> makeTemporaryRecordStoreFromExistingIdent(
+        OperationContext* opCtx, StringData ident) = 0;
+
     /**
      * This method will be called before there is a clean shutdown.  Storage engines should
      * override this method if they have clean-up to do that is different from unclean shutdown.
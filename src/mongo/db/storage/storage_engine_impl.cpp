@@ -455,6 +455,21 @@ StorageEngineImpl::reconcileCatalogAndIdents(OperationContext* opCtx) {
                 }
             }
 
+            // An index build interrupted by a clean shutdown during its collection scan recorded
+            // what it needs to resume, including its side writes table. Return the index to be
+            // built again, which resumes from that state rather than starting over.
+            if (!indexMetaData.ready && indexMetaData.resumeState && foundIdent &&
+                serverGlobalParams.indexBuildRetry) {
+                if (indexMetaData.sideWritesIdent) {
+                    internalIdentsToDrop.erase(*indexMetaData.sideWritesIdent);
+                }
+
+                log() << "Index build was interrupted by a clean shutdown, resuming. Collection: "
+                      << coll << " Index: " << indexName;
+                ret.emplace_back(coll.ns(), indexName);
+                continue;
+            }
+
             // If the index was kicked off as a background secondary index build, replication
             // recovery will not run into the oplog entry to recreate the index. If the index
             // table is not found, or the index build did not successfully complete, this code
@@ -712,6 +727,14 @@ std::unique_ptr<TemporaryRecordStore> StorageEngineImpl::makeTemporaryRecordStor
     return std::make_unique<TemporaryKVRecordStore>(getEngine(), std::move(rs));
 }
 
+std::unique_ptr<TemporaryRecordStore> StorageEngineImpl::makeTemporaryRecordStoreFromExistingIdent(
+    OperationContext* opCtx, StringData ident) {
+    std::unique_ptr<RecordStore> rs =
+        _engine->getRecordStore(opCtx, "" /* internal table */, ident, CollectionOptions());
+    LOG(1) << "opened existing temporary record store: " << rs->getIdent();
+    return std::make_unique<TemporaryKVRecordStore>(getEngine(), std::move(rs));
+}
+
 void StorageEngineImpl::setJournalListener(JournalListener* jl) {
     _engine->setJournalListener(jl);
 }
@@ -48,12 +48,21 @@ public:
     TemporaryRecordStore& operator=(const TemporaryRecordStore&) = delete;
 
     // Move constructor.
-    TemporaryRecordStore(TemporaryRecordStore&& other) noexcept : _rs(std::move(other._rs)) {}
+    TemporaryRecordStore(TemporaryRecordStore&& other) noexcept
+        : _rs(std::move(other._rs)), _keep(other._keep) {}
 
     virtual ~TemporaryRecordStore() {}
 
     virtual void deleteTemporaryTable(OperationContext* opCtx) {}
 
+    /**
+     * Leaves the underlying RecordStore in place instead of deleting it, so that it can be opened
+     * again with StorageEngine::makeTemporaryRecordStoreFromExistingIdent() after a restart.
+     */
+    void keep() {
+        _keep = true;
+    }
+
     RecordStore* rs() {
         return _rs.get();
     }
@@ -64,5 +73,6 @@ public:
 
 protected:
     std::unique_ptr<RecordStore> _rs;
+    bool _keep = false;
 };
 }  // namespace mongo
@@ -43,10 +43,12 @@
 #include "mongo/db/index/index_descriptor.h"
 #include "mongo/db/json.h"
 #include "mongo/db/repl/repl_settings.h"
+#include "mongo/db/server_options.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/storage/storage_options.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_customization_hooks.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_global_options.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_parameters_gen.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_record_store.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
@@ -85,12 +87,25 @@ static const WiredTigerItem emptyItem(nullptr, 0);
 // Keystring format 7 was used in 3.3.6 - 3.3.8 development releases. 4.2 onwards, unique indexes
 // can be either format version 11 or 12. On upgrading to 4.2, an existing format 6 unique index
 // will upgrade to format 11 and an existing format 8 unique index will upgrade to format 12.
+// Formats 13 and 14 use KeyString V2 and are only chosen when wiredTigerIndexKeyStringV2 is
+// enabled and the featureCompatibilityVersion is 4.4.
 const int kDataFormatV1KeyStringV0IndexVersionV1 = 6;
 const int kDataFormatV2KeyStringV1IndexVersionV2 = 8;
 const int kDataFormatV3KeyStringV0UniqueIndexVersionV1 = 11;
 const int kDataFormatV4KeyStringV1UniqueIndexVersionV2 = 12;
+const int kDataFormatV5KeyStringV2IndexVersionV2 = 13;
+const int kDataFormatV6KeyStringV2UniqueIndexVersionV2 = 14;
 const int kMinimumIndexVersion = kDataFormatV1KeyStringV0IndexVersionV1;
-const int kMaximumIndexVersion = kDataFormatV4KeyStringV1UniqueIndexVersionV2;
+const int kMaximumIndexVersion = kDataFormatV6KeyStringV2UniqueIndexVersionV2;
+
+namespace {
+bool useKeyStringV2(const IndexDescriptor& desc) {
+    return gWiredTigerIndexKeyStringV2 && desc.version() >= IndexDescriptor::IndexVersion::kV2 &&
+        serverGlobalParams.featureCompatibility.isVersionInitialized() &&
+        serverGlobalParams.featureCompatibility.getVersion() ==
+        ServerGlobalParams::FeatureCompatibility::Version::kFullyUpgradedTo44;
+}
+}  // namespace
 
 void WiredTigerIndex::setKey(WT_CURSOR* cursor, const WT_ITEM* item) {
     if (_prefix == KVPrefix::kNotPrefixed) {
@@ -137,13 +152,21 @@ std::string WiredTigerIndex::generateAppMetadataString(const IndexDescriptor& de
     int keyStringVersion;
 
     if (desc.unique() && !desc.isIdIndex()) {
-        keyStringVersion = desc.version() >= IndexDescriptor::IndexVersion::kV2
-            ? kDataFormatV4KeyStringV1UniqueIndexVersionV2
-            : kDataFormatV3KeyStringV0UniqueIndexVersionV1;
+        if (useKeyStringV2(desc)) {
+            keyStringVersion = kDataFormatV6KeyStringV2UniqueIndexVersionV2;
+        } else {
+            keyStringVersion = desc.version() >= IndexDescriptor::IndexVersion::kV2
+                ? kDataFormatV4KeyStringV1UniqueIndexVersionV2
+                : kDataFormatV3KeyStringV0UniqueIndexVersionV1;
+        }
     } else {
-        keyStringVersion = desc.version() >= IndexDescriptor::IndexVersion::kV2
-            ? kDataFormatV2KeyStringV1IndexVersionV2
-            : kDataFormatV1KeyStringV0IndexVersionV1;
+        if (useKeyStringV2(desc)) {
+            keyStringVersion = kDataFormatV5KeyStringV2IndexVersionV2;
+        } else {
+            keyStringVersion = desc.version() >= IndexDescriptor::IndexVersion::kV2
+                ? kDataFormatV2KeyStringV1IndexVersionV2
+                : kDataFormatV1KeyStringV0IndexVersionV1;
+        }
     }
 
     // Index metadata
@@ -502,14 +525,15 @@ KeyString::Version WiredTigerIndex::_handleVersionInfo(OperationContext* ctx,
 
     if (!desc->isIdIndex() && desc->unique()) {
         Status versionStatus = _dataFormatVersion == kDataFormatV3KeyStringV0UniqueIndexVersionV1 ||
-                _dataFormatVersion == kDataFormatV4KeyStringV1UniqueIndexVersionV2
+                _dataFormatVersion == kDataFormatV4KeyStringV1UniqueIndexVersionV2 ||
+                _dataFormatVersion == kDataFormatV6KeyStringV2UniqueIndexVersionV2
             ? Status::OK()
             : Status(ErrorCodes::UnsupportedFormat,
                      str::stream()
                          << "Index: {name: " << desc->indexName() << ", ns: " << desc->parentNS()
                          << "} has incompatible format version: " << _dataFormatVersion
                          << ". MongoDB 4.2 onwards, WT secondary unique indexes use "
-                            "either format version 11 or 12. See "
+                            "either format version 11, 12 or 14. See "
                             "https://dochub.mongodb.org/core/upgrade-4.2-procedures for "
                             "detailed instructions on upgrading the index format.");
         fassertNoTrace(31179, versionStatus);
@@ -525,9 +549,14 @@ KeyString::Version WiredTigerIndex::_handleVersionInfo(OperationContext* ctx,
     }
 
     /*
-     * Index data format 6 and 11 correspond to KeyString version V0 and data format 8 and 12
-     * correspond to KeyString version V1.
+     * Index data format 6 and 11 correspond to KeyString version V0, data format 8 and 12
+     * correspond to KeyString version V1 and data format 13 and 14 correspond to KeyString
+     * version V2.
      */
+    if (_dataFormatVersion == kDataFormatV5KeyStringV2IndexVersionV2 ||
+        _dataFormatVersion == kDataFormatV6KeyStringV2UniqueIndexVersionV2) {
+        return KeyString::Version::V2;
+    }
     return (_dataFormatVersion == kDataFormatV2KeyStringV1IndexVersionV2 ||
             _dataFormatVersion == kDataFormatV4KeyStringV1UniqueIndexVersionV2)
         ? KeyString::Version::V1
@@ -804,6 +833,23 @@ public:
         return curr(parts);
     }
 
+    bool canAppendKeyFields() const override {
+        return true;
+    }
+
+    void appendKeyFields(const std::vector<bool>& includeKey,
+                         const std::vector<StringData>& fieldNames,
+                         BSONObjBuilder* builder) const override {
+        invariant(!_eof);
+        KeyString::appendToBson(_key.getBuffer(),
+                                _key.getSize(),
+                                _idx.getOrdering(),
+                                _typeBits,
+                                includeKey,
+                                fieldNames,
+                                builder);
+    }
+
     void setEndPosition(const BSONObj& key, bool inclusive) override {
         TRACE_CURSOR << "setEndPosition inclusive: " << inclusive << ' ' << key;
         if (key.isEmpty()) {
@@ -1322,7 +1368,8 @@ SortedDataBuilderInterface* WiredTigerIndexUnique::getBulkBuilder(OperationConte
 
 bool WiredTigerIndexUnique::isTimestampSafeUniqueIdx() const {
     if (_dataFormatVersion == kDataFormatV1KeyStringV0IndexVersionV1 ||
-        _dataFormatVersion == kDataFormatV2KeyStringV1IndexVersionV2) {
+        _dataFormatVersion == kDataFormatV2KeyStringV1IndexVersionV2 ||
+        _dataFormatVersion == kDataFormatV5KeyStringV2IndexVersionV2) {
         return false;
     }
     return true;
@@ -757,15 +757,22 @@ void WiredTigerKVEngine::startAsyncThreads() {
             _checkpointThread->go();
         }
     }
+
+    if (auto runner = getGlobalServiceContext()->getPeriodicRunner()) {
+        _ticketController = std::make_unique<WiredTigerTicketController>(
+            _sessionCache.get(), &openReadTransaction, &openWriteTransaction);
+        _ticketController->start(runner);
+    }
 }
 
-void WiredTigerKVEngine::appendGlobalStats(BSONObjBuilder& b) {
+void WiredTigerKVEngine::appendGlobalStats(BSONObjBuilder& b) const {
     BSONObjBuilder bb(b.subobjStart("concurrentTransactions"));
     {
         BSONObjBuilder bbb(bb.subobjStart("write"));
         bbb.append("out", openWriteTransaction.used());
         bbb.append("available", openWriteTransaction.available());
         bbb.append("totalTickets", openWriteTransaction.outof());
+        openWriteTransaction.appendStats(&bbb);
         bbb.done();
     }
     {
@@ -773,8 +780,12 @@ void WiredTigerKVEngine::appendGlobalStats(BSONObjBuilder& b) {
         bbb.append("out", openReadTransaction.used());
         bbb.append("available", openReadTransaction.available());
         bbb.append("totalTickets", openReadTransaction.outof());
+        openReadTransaction.appendStats(&bbb);
         bbb.done();
     }
+    if (_ticketController) {
+        _ticketController->appendStats(&bb);
+    }
     bb.done();
 }
 
@@ -848,6 +859,11 @@ void WiredTigerKVEngine::cleanShutdown() {
         return;
     }
 
+    if (_ticketController) {
+        log() << "Shutting down the ticket controller";
+        _ticketController.reset();
+    }
+
     // these must be the last things we do before _conn->close();
     if (_sessionSweeper) {
         log() << "Shutting down session sweeper thread";
@@ -38,6 +38,7 @@
 #include "mongo/db/storage/wiredtiger/wiredtiger_record_store.h"
 
 #include <memory>
+#include <utility>
 
 #include "mongo/base/checked_cast.h"
 #include "mongo/base/static_assert.h"
@@ -1244,6 +1245,87 @@ Status WiredTigerRecordStore::insertRecords(OperationContext* opCtx,
     return _insertRecords(opCtx, records->data(), timestamps.data(), records->size());
 }
 
+/**
+ * Appends records through a WiredTiger bulk cursor, which writes them directly into a newly created
+ * table without going through the cache or a transaction.
+ */
+class WiredTigerRecordStore::BulkCursorBuilder final : public RecordStore::BulkBuilder {
+public:
+    BulkCursorBuilder(WiredTigerRecordStore* rs, UniqueWiredTigerSession session, WT_CURSOR* cursor)
+        : _rs(rs), _session(std::move(session)), _cursor(cursor) {}
+
+    ~BulkCursorBuilder() {
+        if (!_cursor)
+            return;
+
+        // Not committed, for example because bulk loading failed or is unwinding an exception.
+        int ret = _cursor->close(_cursor);
+        if (ret) {
+            warning() << "Failed to close WiredTiger bulk cursor on " << _rs->ns() << ": "
+                      << wiredtiger_strerror(ret);
+        }
+    }
+
+    StatusWith<RecordId> insertRecord(const char* data, int len) final {
+        invariant(_cursor);
+        RecordId id = _rs->_nextId();
+        _rs->setKey(_cursor, id);
+        WiredTigerItem value(data, len);
+        _cursor->set_value(_cursor, value.Get());
+        int ret = WT_OP_CHECK(_cursor->insert(_cursor));
+        if (ret)
+            return wtRCToStatus(ret, "WiredTigerRecordStore::BulkCursorBuilder::insertRecord");
+
+        ++_numRecords;
+        _dataSize += len;
+        return id;
+    }
+
+    Status commit() final {
+        invariant(_cursor);
+        WT_CURSOR* cursor = std::exchange(_cursor, nullptr);
+        int ret = cursor->close(cursor);
+        if (ret)
+            return wtRCToStatus(ret, "WiredTigerRecordStore::BulkCursorBuilder::commit");
+
+        _rs->_changeNumRecords(nullptr, _numRecords);
+        _rs->_increaseDataSize(nullptr, _dataSize);
+        return Status::OK();
+    }
+
+private:
+    WiredTigerRecordStore* const _rs;
+    UniqueWiredTigerSession const _session;
+    WT_CURSOR* _cursor;
+    int64_t _numRecords = 0;
+    int64_t _dataSize = 0;
+};
+
+std::unique_ptr<RecordStore::BulkBuilder> WiredTigerRecordStore::makeBulkBuilder(
+    OperationContext* opCtx) {
+    if (_isCapped || _isOplog || _isEphemeral)
+        return nullptr;
+
+    // Open cursors can cause bulk open_cursor to fail with EBUSY.
+    WiredTigerRecoveryUnit* ru = WiredTigerRecoveryUnit::get(opCtx);
+    ru->getSession()->closeAllCursors(_uri);
+
+    // Use a different session so that the bulk cursor is not tied to the transaction of 'opCtx'.
+    // Like index bulk builds, do not wait for a running checkpoint to complete.
+    UniqueWiredTigerSession session = ru->getSessionCache()->getSession();
+    WT_SESSION* wtSession = session->getSession();
+    WT_CURSOR* cursor;
+    int ret = wtSession->open_cursor(
+        wtSession, _uri.c_str(), nullptr, "bulk,checkpoint_wait=false", &cursor);
+    if (ret) {
+        LOG(1) << "Not bulk loading " << ns() << ", failed to open WiredTiger bulk cursor: "
+               << wiredtiger_strerror(ret);
+        return nullptr;
+    }
+
+    return std::make_unique<BulkCursorBuilder>(this, std::move(session), cursor);
+}
+
 Status WiredTigerRecordStore::_insertRecords(OperationContext* opCtx,
                                              Record* records,
                                              const Timestamp* timestamps,
@@ -1674,7 +1756,8 @@ void WiredTigerRecordStore::_changeNumRecords(OperationContext* opCtx, int64_t d
         return;
     }
 
-    opCtx->recoveryUnit()->registerChange(new NumRecordsChange(this, diff));
+    if (opCtx)
+        opCtx->recoveryUnit()->registerChange(new NumRecordsChange(this, diff));
     if (_sizeInfo->numRecords.fetchAndAdd(diff) < 0)
         _sizeInfo->numRecords.store(std::max(diff, int64_t(0)));
 }
@@ -1909,6 +1992,48 @@ boost::optional<Record> WiredTigerRecordStoreCursorBase::seekExact(const RecordI
     return {{id, {static_cast<const char*>(value.data), static_cast<int>(value.size)}}};
 }
 
+boost::optional<Record> WiredTigerRecordStoreCursorBase::seekAtOrPast(const RecordId& id) {
+    invariant(_hasRestored);
+    _skipNextAdvance = false;
+    WT_CURSOR* c = _cursor->get();
+    setKey(c, id);
+
+    // 'WT_CURSOR::search_near' lands on a neighbour of 'id' on either side if it does not exist.
+    int cmp;
+    int ret = wiredTigerPrepareConflictRetry(_opCtx, [&] { return c->search_near(c, &cmp); });
+    if (ret == 0 && (_forward ? cmp < 0 : cmp > 0)) {
+        ret = wiredTigerPrepareConflictRetry(
+            _opCtx, [&] { return _forward ? c->next(c) : c->prev(c); });
+    }
+    // Nothing after the next line can throw WCEs.
+    if (ret == WT_NOTFOUND) {
+        _eof = true;
+        return {};
+    }
+    invariantWTOK(ret);
+
+    RecordId foundId;
+    if (hasWrongPrefix(c, &foundId)) {
+        _eof = true;
+        return {};
+    }
+    if (!foundId.isValid()) {
+        foundId = getKey(c);
+    }
+
+    if (_oplogVisibleTs && foundId.repr() > *_oplogVisibleTs) {
+        _eof = true;
+        return {};
+    }
+
+    WT_ITEM value;
+    invariantWTOK(c->get_value(c, &value));
+
+    _lastReturnedId = foundId;
+    _eof = false;
+    return {{foundId, {static_cast<const char*>(value.data), static_cast<int>(value.size)}}};
+}
+
 
 void WiredTigerRecordStoreCursorBase::save() {
     try {
@@ -144,6 +144,8 @@ public:
                                  std::vector<Record>* records,
                                  const std::vector<Timestamp>& timestamps);
 
+    std::unique_ptr<RecordStore::BulkBuilder> makeBulkBuilder(OperationContext* opCtx) override;
+
     virtual Status updateRecord(OperationContext* opCtx,
                                 const RecordId& recordId,
                                 const char* data,
@@ -269,6 +271,7 @@ protected:
     virtual void setKey(WT_CURSOR* cursor, RecordId id) const = 0;
 
 private:
+    class BulkCursorBuilder;
     class RandomCursor;
 
     class NumRecordsChange;
@@ -396,6 +399,11 @@ public:
     virtual std::unique_ptr<RecordCursor> getRandomCursorWithOptions(
         OperationContext* opCtx, StringData extraConfig) const override;
 
+    std::unique_ptr<RecordStore::BulkBuilder> makeBulkBuilder(OperationContext* opCtx) override {
+        // Bulk cursors require an empty table, but prefixed record stores may share their table.
+        return nullptr;
+    }
+
     virtual KVPrefix getPrefix() const {
         return _prefix;
     }
@@ -419,6 +427,8 @@ public:
 
     boost::optional<Record> seekExact(const RecordId& id);
 
+    boost::optional<Record> seekAtOrPast(const RecordId& id);
+
     void save();
 
     void saveUnpositioned();
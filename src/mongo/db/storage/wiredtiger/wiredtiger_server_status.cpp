@@ -78,7 +78,7 @@ BSONObj WiredTigerServerStatusSection::generateSection(OperationContext* opCtx,
         bob.append("reason", status.reason());
     }
 
-    WiredTigerKVEngine::appendGlobalStats(bob);
+    _engine->appendGlobalStats(bob);
 
     WiredTigerUtil::appendSnapshotWindowSettings(_engine, session, &bob);
 
@@ -29,6 +29,7 @@
 
 #include "mongo/platform/basic.h"
 
+#include <cstring>
 #include <memory>
 #include <sstream>
 #include <string>
@@ -213,6 +214,68 @@ TEST(WiredTigerRecordStoreTest, StorageSizeStatisticsDisabled) {
     ASSERT_THROWS(rs->storageSize(opCtx.get()), AssertionException);
 }
 
+TEST(WiredTigerRecordStoreTest, BulkBuilder) {
+    unique_ptr<WiredTigerHarnessHelper> harnessHelper(new WiredTigerHarnessHelper());
+    unique_ptr<RecordStore> rs(harnessHelper->newNonCappedRecordStore());
+    ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+
+    std::vector<RecordId> ids;
+    {
+        auto bulkBuilder = rs->makeBulkBuilder(opCtx.get());
+        ASSERT(bulkBuilder);
+        for (const char* data : {"a", "bb", "ccc"}) {
+            StatusWith<RecordId> res = bulkBuilder->insertRecord(data, strlen(data) + 1);
+            ASSERT_OK(res.getStatus());
+            if (!ids.empty())
+                ASSERT_LT(ids.back(), res.getValue());
+            ids.push_back(res.getValue());
+        }
+
+        // The counts only change once bulk loading is committed.
+        ASSERT_EQUALS(0, rs->numRecords(opCtx.get()));
+        ASSERT_OK(bulkBuilder->commit());
+    }
+
+    ASSERT_EQUALS(3, rs->numRecords(opCtx.get()));
+    ASSERT_EQUALS(9, rs->dataSize(opCtx.get()));
+    ASSERT_EQUALS(string("bb"), rs->dataFor(opCtx.get(), ids[1]).data());
+
+    // Only empty record stores can be bulk loaded.
+    ASSERT_FALSE(rs->makeBulkBuilder(opCtx.get()));
+
+    // Inserts after bulk loading continue from the last RecordId.
+    {
+        WriteUnitOfWork uow(opCtx.get());
+        StatusWith<RecordId> res = rs->insertRecord(opCtx.get(), "d", 2, Timestamp());
+        ASSERT_OK(res.getStatus());
+        ASSERT_LT(ids.back(), res.getValue());
+        uow.commit();
+    }
+    ASSERT_EQUALS(4, rs->numRecords(opCtx.get()));
+}
+
+TEST(WiredTigerRecordStoreTest, BulkBuilderDestroyedWithoutCommitLeavesCountsUnchanged) {
+    unique_ptr<WiredTigerHarnessHelper> harnessHelper(new WiredTigerHarnessHelper());
+    unique_ptr<RecordStore> rs(harnessHelper->newNonCappedRecordStore());
+    ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+
+    {
+        auto bulkBuilder = rs->makeBulkBuilder(opCtx.get());
+        ASSERT(bulkBuilder);
+        ASSERT_OK(bulkBuilder->insertRecord("a", 2).getStatus());
+    }
+
+    ASSERT_EQUALS(0, rs->numRecords(opCtx.get()));
+    ASSERT_EQUALS(0, rs->dataSize(opCtx.get()));
+}
+
+TEST(WiredTigerRecordStoreTest, BulkBuilderNotSupportedForCapped) {
+    unique_ptr<WiredTigerHarnessHelper> harnessHelper(new WiredTigerHarnessHelper());
+    unique_ptr<RecordStore> rs(harnessHelper->newCappedRecordStore("a.c", 100000, 10));
+    ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+    ASSERT_FALSE(rs->makeBulkBuilder(opCtx.get()));
+}
+
 TEST(WiredTigerRecordStoreTest, SizeStorer1) {
     unique_ptr<WiredTigerHarnessHelper> harnessHelper(new WiredTigerHarnessHelper());
     unique_ptr<RecordStore> rs(harnessHelper->newNonCappedRecordStore());
@@ -0,0 +1,263 @@
+/**
+ *    Copyright (C) 2019-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kStorage
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/wiredtiger/wiredtiger_ticket_controller.h"
+
+#include <algorithm>
+
+#include "mongo/db/concurrency/lock_stats.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_parameters_gen.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
+#include "mongo/util/concurrency/ticketholder.h"
+#include "mongo/util/log.h"
+#include "mongo/util/scopeguard.h"
+
+namespace mongo {
+
+namespace {
+
+const char* toString(WiredTigerTicketController::Reason reason) {
+    switch (reason) {
+        case WiredTigerTicketController::Reason::kBaseline:
+            return "baseline";
+        case WiredTigerTicketController::Reason::kIdle:
+            return "idle";
+        case WiredTigerTicketController::Reason::kCachePressure:
+            return "cachePressure";
+        case WiredTigerTicketController::Reason::kThroughputDropped:
+            return "throughputDropped";
+        case WiredTigerTicketController::Reason::kPlateau:
+            return "plateau";
+        case WiredTigerTicketController::Reason::kQueued:
+            return "queued";
+        case WiredTigerTicketController::Reason::kResizeFailed:
+            return "resizeFailed";
+        case WiredTigerTicketController::Reason::kNumReasons:
+            break;
+    }
+    MONGO_UNREACHABLE;
+}
+
+// The reasons counted in serverStatus. Baseline and idle periods never resize a pool.
+const WiredTigerTicketController::Reason kCountedReasons[] = {
+    WiredTigerTicketController::Reason::kCachePressure,
+    WiredTigerTicketController::Reason::kThroughputDropped,
+    WiredTigerTicketController::Reason::kPlateau,
+    WiredTigerTicketController::Reason::kQueued,
+    WiredTigerTicketController::Reason::kResizeFailed,
+};
+
+}  // namespace
+
+WiredTigerTicketController::WiredTigerTicketController(WiredTigerSessionCache* sessionCache,
+                                                       TicketHolder* readTickets,
+                                                       TicketHolder* writeTickets)
+    : _sessionCache(sessionCache),
+      _pools{{Pool("read", readTickets, MODE_IS, MODE_S),
+              Pool("write", writeTickets, MODE_IX, MODE_X)}} {}
+
+void WiredTigerTicketController::start(PeriodicRunner* runner) {
+    _jobAnchor = runner->makeJob(
+        {"WiredTigerTicketController", [this](Client*) { adjust(); }, Seconds(1)});
+    _jobAnchor.start();
+}
+
+WiredTigerTicketController::Decision WiredTigerTicketController::calculateNewTickets(
+    const Observation& observation) {
+    const int minTickets = gWiredTigerAdaptiveTicketsMinimum.load();
+    const int maxTickets = std::max(minTickets, gWiredTigerAdaptiveTicketsMaximum.load());
+    const double tolerance = gWiredTigerAdaptiveTicketsThroughputTolerance.load();
+
+    auto decide = [&](int tickets, Reason reason) -> Decision {
+        tickets = std::max(minTickets, std::min(maxTickets, tickets));
+        if (tickets > observation.tickets) {
+            return {tickets, Adjustment::kIncrease, reason};
+        }
+        if (tickets < observation.tickets) {
+            return {tickets, Adjustment::kDecrease, reason};
+        }
+        return {tickets, Adjustment::kNone, reason};
+    };
+    auto decreased = [&] {
+        return static_cast<int>(observation.tickets *
+                                gWiredTigerAdaptiveTicketsDecreaseFactor.load());
+    };
+
+    // Application threads only evict when the eviction server can't keep up, at which point more
+    // concurrent operations just means more threads stalled on eviction. A few pages a second are
+    // normal under a busy workload, so only a sustained rate counts as pressure.
+    if (observation.applicationEvictionsPerSecond >
+        gWiredTigerAdaptiveTicketsCachePressureEvictionsPerSecond.load()) {
+        return decide(decreased(), Reason::kCachePressure);
+    }
+
+    // Judge the last increase by the throughput it produced. An increase that made no measurable
+    // difference is held for a period before probing again.
+    if (observation.prevAdjustment == Adjustment::kIncrease) {
+        if (observation.throughput < observation.prevThroughput * (1.0 - tolerance)) {
+            return decide(decreased(), Reason::kThroughputDropped);
+        }
+        if (observation.throughput < observation.prevThroughput * (1.0 + tolerance)) {
+            return decide(observation.tickets, Reason::kPlateau);
+        }
+    }
+
+    if (observation.queued > 0 || observation.waitMicros > 0) {
+        return decide(observation.tickets + gWiredTigerAdaptiveTicketsIncrement.load(),
+                      Reason::kQueued);
+    }
+
+    return decide(observation.tickets, Reason::kIdle);
+}
+
+void WiredTigerTicketController::adjust() {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    if (!gWiredTigerAdaptiveTicketsEnabled.load()) {
+        // Take a fresh baseline if the controller is enabled again.
+        for (auto& pool : _pools) {
+            pool.lastAcquisitions = -1;
+        }
+        _lastApplicationEvictions = -1;
+        return;
+    }
+
+    const double elapsedSeconds = _sinceLastSample.micros() / 1000000.0;
+    _sinceLastSample.reset();
+
+    const long long applicationEvictions = _sampleApplicationEvictions();
+    double applicationEvictionsPerSecond = 0.0;
+    if (_lastApplicationEvictions >= 0 && applicationEvictions > _lastApplicationEvictions &&
+        elapsedSeconds > 0.0) {
+        applicationEvictionsPerSecond =
+            (applicationEvictions - _lastApplicationEvictions) / elapsedSeconds;
+    }
+    _lastApplicationEvictions = applicationEvictions;
+
+    SingleThreadedLockStats stats;
+    reportGlobalLockingStats(&stats);
+
+    for (auto& pool : _pools) {
+        long long acquisitions = 0;
+        for (auto mode : pool.modes) {
+            acquisitions += stats.get(resourceIdGlobal, mode).numAcquisitions;
+        }
+        const long long waitMicros = pool.holder->totalWaitMicros();
+        ON_BLOCK_EXIT([&] {
+            pool.lastAcquisitions = acquisitions;
+            pool.lastWaitMicros = waitMicros;
+        });
+
+        if (pool.lastAcquisitions < 0 || elapsedSeconds <= 0.0) {
+            pool.lastObservation = Observation();
+            pool.lastObservation.tickets = pool.holder->outof();
+            pool.lastDecision = {pool.holder->outof(), Adjustment::kNone, Reason::kBaseline};
+            continue;
+        }
+
+        Observation observation;
+        observation.tickets = pool.holder->outof();
+        observation.throughput = (acquisitions - pool.lastAcquisitions) / elapsedSeconds;
+        observation.prevThroughput = pool.lastObservation.throughput;
+        observation.prevAdjustment = pool.lastDecision.adjustment;
+        observation.queued = pool.holder->queued();
+        observation.waitMicros = waitMicros - pool.lastWaitMicros;
+        observation.applicationEvictionsPerSecond = applicationEvictionsPerSecond;
+
+        auto decision = calculateNewTickets(observation);
+        if (decision.adjustment != Adjustment::kNone) {
+            auto status = pool.holder->resize(decision.tickets);
+            if (!status.isOK()) {
+                warning() << "Failed to resize the " << pool.name
+                          << " ticket pool to " << decision.tickets << ": " << status;
+                decision = {observation.tickets, Adjustment::kNone, Reason::kResizeFailed};
+            }
+        }
+
+        ++pool.numByReason[static_cast<size_t>(decision.reason)];
+        if (decision.adjustment == Adjustment::kIncrease) {
+            ++pool.numIncreases;
+        } else if (decision.adjustment == Adjustment::kDecrease) {
+            ++pool.numDecreases;
+        }
+        if (decision.adjustment != Adjustment::kNone) {
+            LOG(1) << "Adjusted the " << pool.name << " ticket pool from "
+                   << observation.tickets << " to " << decision.tickets << " ("
+                   << toString(decision.reason) << "). Throughput: " << observation.throughput
+                   << "/s, previous: " << observation.prevThroughput
+                   << "/s, queued: " << observation.queued;
+        }
+
+        pool.lastObservation = observation;
+        pool.lastDecision = decision;
+    }
+}
+
+long long WiredTigerTicketController::_sampleApplicationEvictions() {
+    auto session = _sessionCache->getSession();
+    auto evictions = WiredTigerUtil::getStatisticsValue(
+        session->getSession(), "statistics:", "statistics=(fast)", WT_STAT_CONN_CACHE_EVICTION_APP);
+    if (!evictions.isOK()) {
+        LOG(1) << "Unable to read WiredTiger eviction statistics: " << evictions.getStatus();
+        return -1;
+    }
+    return evictions.getValue();
+}
+
+void WiredTigerTicketController::appendStats(BSONObjBuilder* b) const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    BSONObjBuilder controllerBuilder(b->subobjStart("adaptiveTickets"));
+    controllerBuilder.append("enabled", gWiredTigerAdaptiveTicketsEnabled.load());
+    for (const auto& pool : _pools) {
+        BSONObjBuilder poolBuilder(controllerBuilder.subobjStart(pool.name));
+        poolBuilder.append("throughput", pool.lastObservation.throughput);
+        poolBuilder.append("waitMicros", pool.lastObservation.waitMicros);
+        poolBuilder.append("queued", pool.lastObservation.queued);
+        poolBuilder.append("applicationEvictionsPerSecond",
+                           pool.lastObservation.applicationEvictionsPerSecond);
+        poolBuilder.append("targetTickets", pool.lastDecision.tickets);
+        // FTDC only records numeric fields, so report the change in tickets rather than its kind.
+        poolBuilder.append("lastAdjustment",
+                           pool.lastDecision.tickets - pool.lastObservation.tickets);
+        poolBuilder.append("lastReason", toString(pool.lastDecision.reason));
+        poolBuilder.append("numIncreases", pool.numIncreases);
+        poolBuilder.append("numDecreases", pool.numDecreases);
+
+        BSONObjBuilder reasonsBuilder(poolBuilder.subobjStart("reasons"));
+        for (auto reason : kCountedReasons) {
+            reasonsBuilder.append(toString(reason), pool.numByReason[static_cast<size_t>(reason)]);
+        }
+    }
+}
+
+}  // namespace mongo
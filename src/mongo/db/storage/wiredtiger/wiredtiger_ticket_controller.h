@@ -0,0 +1,156 @@
+/**
+ *    Copyright (C) 2019-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <array>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/concurrency/lock_manager_defs.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/util/periodic_runner.h"
+#include "mongo/util/timer.h"
+
+namespace mongo {
+
+class TicketHolder;
+class WiredTigerSessionCache;
+
+/**
+ * Adjusts the size of the WiredTiger read and write ticket pools while
+ * 'wiredTigerAdaptiveTicketsEnabled' is set. Once per second it samples, for each pool, how many
+ * global lock acquisitions completed, how long operations waited for a ticket and how many are
+ * still queued, along with how many pages application threads had to evict from the cache.
+ *
+ * Pool sizes follow an additive-increase/multiplicative-decrease scheme: a pool that has operations
+ * waiting on it grows by a fixed increment, and shrinks by a constant factor when application
+ * threads evict more than 'wiredTigerAdaptiveTicketsCachePressureEvictionsPerSecond' pages a second
+ * or when the previous increase cost throughput. Each decision is reported through appendStats() as
+ * numeric fields and per-reason counters, which FTDC captures from serverStatus.
+ */
+class WiredTigerTicketController {
+    WiredTigerTicketController(const WiredTigerTicketController&) = delete;
+    WiredTigerTicketController& operator=(const WiredTigerTicketController&) = delete;
+
+public:
+    enum class Adjustment { kNone, kIncrease, kDecrease };
+
+    /**
+     * Why a pool was, or was not, resized.
+     */
+    enum class Reason {
+        kBaseline,
+        kIdle,
+        kCachePressure,
+        kThroughputDropped,
+        kPlateau,
+        kQueued,
+        kResizeFailed,
+        kNumReasons
+    };
+
+    /**
+     * What was observed of a ticket pool over the last period.
+     */
+    struct Observation {
+        int tickets = 0;
+        double throughput = 0.0;
+        double prevThroughput = 0.0;
+        Adjustment prevAdjustment = Adjustment::kNone;
+        int queued = 0;
+        long long waitMicros = 0;
+        double applicationEvictionsPerSecond = 0.0;
+    };
+
+    struct Decision {
+        int tickets;
+        Adjustment adjustment;
+        Reason reason;
+    };
+
+    WiredTigerTicketController(WiredTigerSessionCache* sessionCache,
+                               TicketHolder* readTickets,
+                               TicketHolder* writeTickets);
+
+    /**
+     * Schedules the once-per-second adjustment on 'runner'. The job is stopped when this object is
+     * destroyed.
+     */
+    void start(PeriodicRunner* runner);
+
+    /**
+     * Appends the most recent sample and decision for each ticket pool.
+     */
+    void appendStats(BSONObjBuilder* b) const;
+
+    /**
+     * Samples the ticket pools and the cache and resizes the pools. Public for testing.
+     */
+    void adjust();
+
+    /**
+     * Computes the new size of a ticket pool from what was observed of it over the last period.
+     * Public for testing.
+     */
+    static Decision calculateNewTickets(const Observation& observation);
+
+private:
+    struct Pool {
+        Pool(const char* name, TicketHolder* holder, LockMode mode, LockMode exclusiveMode)
+            : name(name), holder(holder), modes{{mode, exclusiveMode}} {}
+
+        const char* const name;
+        TicketHolder* const holder;
+        // The global lock modes whose acquisitions draw tickets from this pool.
+        const std::array<LockMode, 2> modes;
+
+        // -1 until the first sample is taken.
+        long long lastAcquisitions = -1;
+        long long lastWaitMicros = 0;
+
+        Observation lastObservation;
+        Decision lastDecision{0, Adjustment::kNone, Reason::kBaseline};
+        long long numIncreases = 0;
+        long long numDecreases = 0;
+        std::array<long long, static_cast<size_t>(Reason::kNumReasons)> numByReason{};
+    };
+
+    long long _sampleApplicationEvictions();
+
+    WiredTigerSessionCache* const _sessionCache;
+
+    mutable stdx::mutex _mutex;
+    std::array<Pool, 2> _pools;
+    long long _lastApplicationEvictions = -1;
+    Timer _sinceLastSample;
+
+    PeriodicJobAnchor _jobAnchor;
+};
+
+}  // namespace mongo
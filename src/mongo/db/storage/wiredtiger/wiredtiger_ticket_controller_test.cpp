@@ -0,0 +1,162 @@
+/**
+ *    Copyright (C) 2019-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/wiredtiger/wiredtiger_parameters_gen.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_ticket_controller.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+using Adjustment = WiredTigerTicketController::Adjustment;
+using Observation = WiredTigerTicketController::Observation;
+using Reason = WiredTigerTicketController::Reason;
+
+class WiredTigerTicketControllerTest : public unittest::Test {
+public:
+    void setUp() override {
+        gWiredTigerAdaptiveTicketsMinimum.store(8);
+        gWiredTigerAdaptiveTicketsMaximum.store(256);
+        gWiredTigerAdaptiveTicketsIncrement.store(8);
+        gWiredTigerAdaptiveTicketsDecreaseFactor.store(0.5);
+        gWiredTigerAdaptiveTicketsThroughputTolerance.store(0.05);
+        gWiredTigerAdaptiveTicketsCachePressureEvictionsPerSecond.store(100.0);
+    }
+
+    void tearDown() override {
+        gWiredTigerAdaptiveTicketsMinimum.store(8);
+        gWiredTigerAdaptiveTicketsMaximum.store(1024);
+        gWiredTigerAdaptiveTicketsIncrement.store(8);
+        gWiredTigerAdaptiveTicketsDecreaseFactor.store(0.75);
+        gWiredTigerAdaptiveTicketsThroughputTolerance.store(0.05);
+        gWiredTigerAdaptiveTicketsCachePressureEvictionsPerSecond.store(100.0);
+    }
+
+    static Observation observe(int tickets, double throughput, int queued) {
+        Observation observation;
+        observation.tickets = tickets;
+        observation.throughput = throughput;
+        observation.queued = queued;
+        return observation;
+    }
+};
+
+TEST_F(WiredTigerTicketControllerTest, IdlePoolIsLeftAlone) {
+    auto decision = WiredTigerTicketController::calculateNewTickets(observe(128, 1000.0, 0));
+    ASSERT_EQ(128, decision.tickets);
+    ASSERT(decision.adjustment == Adjustment::kNone);
+}
+
+TEST_F(WiredTigerTicketControllerTest, QueuedOperationsGrowThePoolAdditively) {
+    auto decision = WiredTigerTicketController::calculateNewTickets(observe(128, 1000.0, 3));
+    ASSERT_EQ(136, decision.tickets);
+    ASSERT(decision.adjustment == Adjustment::kIncrease);
+
+    // Operations that waited during the period count as demand even if none are queued now.
+    auto observation = observe(128, 1000.0, 0);
+    observation.waitMicros = 10;
+    ASSERT_EQ(136, WiredTigerTicketController::calculateNewTickets(observation).tickets);
+}
+
+TEST_F(WiredTigerTicketControllerTest, GrowthIsCappedAtTheMaximum) {
+    auto decision = WiredTigerTicketController::calculateNewTickets(observe(252, 1000.0, 3));
+    ASSERT_EQ(256, decision.tickets);
+
+    decision = WiredTigerTicketController::calculateNewTickets(observe(256, 1000.0, 3));
+    ASSERT_EQ(256, decision.tickets);
+    ASSERT(decision.adjustment == Adjustment::kNone);
+}
+
+TEST_F(WiredTigerTicketControllerTest, CachePressureShrinksThePoolMultiplicatively) {
+    auto observation = observe(128, 1000.0, 3);
+    observation.applicationEvictionsPerSecond = 500.0;
+    auto decision = WiredTigerTicketController::calculateNewTickets(observation);
+    ASSERT_EQ(64, decision.tickets);
+    ASSERT(decision.adjustment == Adjustment::kDecrease);
+    ASSERT(decision.reason == Reason::kCachePressure);
+
+    observation.tickets = 10;
+    ASSERT_EQ(8, WiredTigerTicketController::calculateNewTickets(observation).tickets);
+}
+
+TEST_F(WiredTigerTicketControllerTest, OccasionalApplicationEvictionsAreNotCachePressure) {
+    auto observation = observe(128, 1000.0, 3);
+    observation.applicationEvictionsPerSecond = 1.0;
+    auto decision = WiredTigerTicketController::calculateNewTickets(observation);
+    ASSERT_EQ(136, decision.tickets);
+    ASSERT(decision.reason == Reason::kQueued);
+
+    gWiredTigerAdaptiveTicketsCachePressureEvictionsPerSecond.store(0.0);
+    ASSERT(WiredTigerTicketController::calculateNewTickets(observation).reason ==
+           Reason::kCachePressure);
+}
+
+TEST_F(WiredTigerTicketControllerTest, IncreaseThatLostThroughputIsBackedOff) {
+    auto observation = observe(136, 900.0, 3);
+    observation.prevThroughput = 1000.0;
+    observation.prevAdjustment = Adjustment::kIncrease;
+    auto decision = WiredTigerTicketController::calculateNewTickets(observation);
+    ASSERT_EQ(68, decision.tickets);
+    ASSERT(decision.adjustment == Adjustment::kDecrease);
+}
+
+TEST_F(WiredTigerTicketControllerTest, IncreaseWithinNoiseIsHeld) {
+    auto observation = observe(136, 1020.0, 3);
+    observation.prevThroughput = 1000.0;
+    observation.prevAdjustment = Adjustment::kIncrease;
+    auto decision = WiredTigerTicketController::calculateNewTickets(observation);
+    ASSERT_EQ(136, decision.tickets);
+    ASSERT(decision.adjustment == Adjustment::kNone);
+
+    // Once the hold has passed, a pool with operations queued is probed again.
+    observation.prevAdjustment = Adjustment::kNone;
+    ASSERT_EQ(144, WiredTigerTicketController::calculateNewTickets(observation).tickets);
+}
+
+TEST_F(WiredTigerTicketControllerTest, IncreaseThatRaisedThroughputKeepsGrowing) {
+    auto observation = observe(136, 1200.0, 3);
+    observation.prevThroughput = 1000.0;
+    observation.prevAdjustment = Adjustment::kIncrease;
+    ASSERT_EQ(144, WiredTigerTicketController::calculateNewTickets(observation).tickets);
+}
+
+TEST_F(WiredTigerTicketControllerTest, PoolOutsideTheBoundsIsBroughtWithinThem) {
+    auto decision = WiredTigerTicketController::calculateNewTickets(observe(1000, 1000.0, 0));
+    ASSERT_EQ(256, decision.tickets);
+    ASSERT(decision.adjustment == Adjustment::kDecrease);
+
+    decision = WiredTigerTicketController::calculateNewTickets(observe(2, 1000.0, 0));
+    ASSERT_EQ(8, decision.tickets);
+    ASSERT(decision.adjustment == Adjustment::kIncrease);
+}
+
+}  // namespace
+}  // namespace mongo
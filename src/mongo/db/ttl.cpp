@@ -125,6 +125,9 @@ private:
         const ServiceContext::UniqueOperationContext opCtxPtr = cc().makeOperationContext();
         OperationContext& opCtx = *opCtxPtr;
 
+        // TTL deletes can wait behind client operations for storage engine tickets.
+        opCtx.lockState()->setAdmissionPriority(AdmissionPriority::kBackground);
+
         // If part of replSet but not in a readable state (e.g. during initial sync), skip.
         if (repl::ReplicationCoordinator::get(&opCtx)->getReplicationMode() ==
                 repl::ReplicationCoordinator::modeReplSet &&
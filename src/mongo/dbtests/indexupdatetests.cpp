@@ -33,10 +33,13 @@
 
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/catalog/index_catalog.h"
+#include "mongo/db/catalog/index_catalog_entry.h"
 #include "mongo/db/catalog/multi_index_block.h"
+#include "mongo/db/catalog/multi_index_block_gen.h"
 #include "mongo/db/client.h"
 #include "mongo/db/db_raii.h"
 #include "mongo/db/dbdirectclient.h"
+#include "mongo/db/index/index_access_method.h"
 #include "mongo/db/index/index_descriptor.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/storage/storage_engine_init.h"
@@ -202,6 +205,101 @@ public:
     }
 };
 
+/** Index keys generated on several threads are merged into a single bulk load. */
+class InsertBuildParallelKeyGeneration : public IndexBuildBase {
+public:
+    void run() {
+        const auto originalThreads = maxIndexBuildKeyGenerationThreads.load();
+        maxIndexBuildKeyGenerationThreads.store(4);
+        ON_BLOCK_EXIT([&] { maxIndexBuildKeyGenerationThreads.store(originalThreads); });
+
+        // Every document has its own value of 'a' and two values of 'b', except for the first,
+        // whose array holds 0 twice.
+        Collection* coll = createCollection(false /* duplicateA */);
+
+        MultiIndexBlock indexer;
+        ON_BLOCK_EXIT([&] { indexer.cleanUpAfterBuild(&_opCtx, coll); });
+
+        ASSERT_OK(indexer.init(&_opCtx, coll, specs(), MultiIndexBlock::kNoopOnInitFn).getStatus());
+        ASSERT_OK(indexer.insertAllDocumentsInCollection(&_opCtx, coll));
+        ASSERT_OK(indexer.checkConstraints(&_opCtx));
+
+        WriteUnitOfWork wunit(&_opCtx);
+        ASSERT_OK(indexer.commit(
+            &_opCtx, coll, MultiIndexBlock::kNoopOnCreateEachFn, MultiIndexBlock::kNoopOnCommitFn));
+        wunit.commit();
+
+        auto indexCatalog = coll->getIndexCatalog();
+        auto entryA = indexCatalog->getEntry(indexCatalog->findIndexByName(&_opCtx, "a"));
+        auto entryB = indexCatalog->getEntry(indexCatalog->findIndexByName(&_opCtx, "b"));
+        ASSERT_EQUALS(kNumDocs,
+                      entryA->accessMethod()->getSortedDataInterface()->numEntries(&_opCtx));
+        ASSERT_EQUALS(2 * kNumDocs - 1,
+                      entryB->accessMethod()->getSortedDataInterface()->numEntries(&_opCtx));
+        ASSERT_FALSE(entryA->isMultikey());
+        ASSERT_TRUE(entryB->isMultikey());
+    }
+
+protected:
+    static constexpr int32_t kNumDocs = 5000;
+
+    /**
+     * Creates a collection of kNumDocs documents, large enough for the keys to be generated on
+     * several threads. If 'duplicateA' is true, the first and the last documents share a value of
+     * 'a'.
+     */
+    Collection* createCollection(bool duplicateA) {
+        Database* db = _ctx.db();
+        WriteUnitOfWork wunit(&_opCtx);
+        ASSERT_OK(db->dropCollection(&_opCtx, _nss));
+        Collection* coll = db->createCollection(&_opCtx, _nss);
+
+        OpDebug* const nullOpDebug = nullptr;
+        for (int32_t i = 0; i < kNumDocs; ++i) {
+            const auto a = duplicateA && i == kNumDocs - 1 ? 0 : i;
+            ASSERT_OK(coll->insertDocument(
+                &_opCtx,
+                InsertStatement(BSON("_id" << i << "a" << a << "b" << BSON_ARRAY(i << -i))),
+                nullOpDebug,
+                true));
+        }
+        wunit.commit();
+        return coll;
+    }
+
+    static std::vector<BSONObj> specs() {
+        return {BSON("name"
+                     << "a"
+                     << "key" << BSON("a" << 1) << "v" << static_cast<int>(kIndexVersion)
+                     << "unique" << true),
+                BSON("name"
+                     << "b"
+                     << "key" << BSON("b" << 1) << "v" << static_cast<int>(kIndexVersion))};
+    }
+};
+
+/** Duplicate keys are found whichever key generation threads the duplicates were given to. */
+class InsertBuildParallelKeyGenerationEnforceUnique : public InsertBuildParallelKeyGeneration {
+public:
+    void run() {
+        const auto originalThreads = maxIndexBuildKeyGenerationThreads.load();
+        maxIndexBuildKeyGenerationThreads.store(4);
+        ON_BLOCK_EXIT([&] { maxIndexBuildKeyGenerationThreads.store(originalThreads); });
+
+        // The first and the last documents are the only ones with equal values of 'a'.
+        Collection* coll = createCollection(true /* duplicateA */);
+
+        MultiIndexBlock indexer;
+        ON_BLOCK_EXIT([&] { indexer.cleanUpAfterBuild(&_opCtx, coll); });
+
+        ASSERT_OK(indexer.init(&_opCtx, coll, specs(), MultiIndexBlock::kNoopOnInitFn).getStatus());
+        ASSERT_OK(indexer.insertAllDocumentsInCollection(&_opCtx, coll));
+
+        auto status = indexer.checkConstraints(&_opCtx);
+        ASSERT_EQUALS(status.code(), ErrorCodes::DuplicateKey);
+    }
+};
+
 /** Index creation is killed if mayInterrupt is true. */
 class InsertBuildIndexInterrupt : public IndexBuildBase {
 public:
@@ -639,6 +737,8 @@ public:
             add<InsertBuildIgnoreUnique<false>>();
             add<InsertBuildEnforceUnique<true>>();
             add<InsertBuildEnforceUnique<false>>();
+            add<InsertBuildParallelKeyGeneration>();
+            add<InsertBuildParallelKeyGenerationEnforceUnique>();
         }
         add<InsertBuildIndexInterrupt>();
         add<InsertBuildIdIndexInterrupt>();
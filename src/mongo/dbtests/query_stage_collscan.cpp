@@ -33,6 +33,7 @@
 
 #include "mongo/platform/basic.h"
 
+#include <algorithm>
 #include <memory>
 
 #include "mongo/client/dbclient_cursor.h"
@@ -47,10 +48,12 @@
 #include "mongo/db/matcher/expression_parser.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/query/plan_executor.h"
+#include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/db/storage/record_store.h"
 #include "mongo/dbtests/dbtests.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/fail_point_service.h"
+#include "mongo/util/scopeguard.h"
 
 namespace query_stage_collection_scan {
 
@@ -144,6 +147,28 @@ public:
         }
     }
 
+    vector<int> getFooValuesInRange(Collection* collection,
+                                    CollectionScanParams::Direction direction,
+                                    boost::optional<RecordId> minRecord,
+                                    boost::optional<RecordId> maxRecord) {
+        WorkingSet ws;
+
+        CollectionScanParams params;
+        params.direction = direction;
+        params.minRecord = minRecord;
+        params.maxRecord = maxRecord;
+
+        CollectionScan scan(&_opCtx, collection, params, &ws, nullptr);
+        vector<int> out;
+        while (!scan.isEOF()) {
+            WorkingSetID id = WorkingSet::INVALID_ID;
+            if (PlanStage::ADVANCED == scan.work(&id)) {
+                out.push_back(ws.get(id)->obj.value()["foo"].numberInt());
+            }
+        }
+        return out;
+    }
+
     static int numObj() {
         return 50;
     }
@@ -238,6 +263,152 @@ TEST_F(QueryStageCollectionScanTest, QueryStageCollscanObjectsInOrderBackward) {
     ASSERT_EQUALS(numObj(), count);
 }
 
+// A selective filter is evaluated over a block of records per call to work(), rather than
+// returning NEED_TIME for every record which fails the filter.
+TEST_F(QueryStageCollectionScanTest, QueryStageCollscanSkipsNonMatchingRecordsInBatches) {
+    AutoGetCollectionForReadCommand ctx(&_opCtx, nss);
+    auto collection = ctx.getCollection();
+
+    CollectionScanParams params;
+    params.direction = CollectionScanParams::FORWARD;
+    params.tailable = false;
+
+    const boost::intrusive_ptr<ExpressionContext> expCtx(new ExpressionContext(&_opCtx, nullptr));
+    auto statusWithMatcher = MatchExpressionParser::parse(BSON("foo" << GTE << 45), expCtx);
+    ASSERT_OK(statusWithMatcher.getStatus());
+    auto filterExpr = std::move(statusWithMatcher.getValue());
+
+    auto runScan = [&](int batchSize, int* nWorks) {
+        const auto oldBatchSize = internalQueryExecCollectionScanFilterBatchSize.load();
+        internalQueryExecCollectionScanFilterBatchSize.store(batchSize);
+        ON_BLOCK_EXIT([&] { internalQueryExecCollectionScanFilterBatchSize.store(oldBatchSize); });
+
+        WorkingSet ws;
+        CollectionScan scan(&_opCtx, collection, params, &ws, filterExpr.get());
+        vector<int> results;
+        *nWorks = 0;
+        while (!scan.isEOF()) {
+            WorkingSetID id = WorkingSet::INVALID_ID;
+            PlanStage::StageState state = scan.work(&id);
+            ++*nWorks;
+            if (PlanStage::ADVANCED == state) {
+                results.push_back(ws.get(id)->obj.value()["foo"].numberInt());
+            }
+        }
+        return results;
+    };
+
+    int nWorksBatched = 0;
+    auto batched = runScan(numObj(), &nWorksBatched);
+    int nWorksUnbatched = 0;
+    auto unbatched = runScan(1, &nWorksUnbatched);
+
+    const vector<int> expected{45, 46, 47, 48, 49};
+    ASSERT(expected == batched);
+    ASSERT(expected == unbatched);
+    ASSERT_GT(nWorksUnbatched, numObj());
+    ASSERT_LT(nWorksBatched, nWorksUnbatched);
+}
+
+// A scan bounded to a RecordId range only returns the records within [minRecord, maxRecord).
+TEST_F(QueryStageCollectionScanTest, QueryStageCollscanBoundedByRecordIdRange) {
+    AutoGetCollectionForReadCommand ctx(&_opCtx, nss);
+    auto collection = ctx.getCollection();
+
+    vector<RecordId> recordIds;
+    getRecordIds(collection, CollectionScanParams::FORWARD, &recordIds);
+    ASSERT_EQUALS(static_cast<size_t>(numObj()), recordIds.size());
+
+    vector<int> forward = getFooValuesInRange(
+        collection, CollectionScanParams::FORWARD, recordIds[10], recordIds[20]);
+    vector<int> backward = getFooValuesInRange(
+        collection, CollectionScanParams::BACKWARD, recordIds[10], recordIds[20]);
+
+    vector<int> expected;
+    for (int i = 10; i < 20; ++i) {
+        expected.push_back(i);
+    }
+    ASSERT(expected == forward);
+    std::reverse(expected.begin(), expected.end());
+    ASSERT(expected == backward);
+
+    // Either end of the range may be left open.
+    ASSERT_EQUALS(
+        40u,
+        getFooValuesInRange(collection, CollectionScanParams::FORWARD, recordIds[10], boost::none)
+            .size());
+    ASSERT_EQUALS(
+        10u,
+        getFooValuesInRange(collection, CollectionScanParams::BACKWARD, boost::none, recordIds[10])
+            .size());
+}
+
+// If the record at the start of the range has been deleted, the scan still returns the rest of the
+// range.
+TEST_F(QueryStageCollectionScanTest, QueryStageCollscanRangeStartWasDeleted) {
+    dbtests::WriteContextForTests ctx(&_opCtx, nss.ns());
+    Collection* coll = ctx.getCollection();
+
+    vector<RecordId> recordIds;
+    getRecordIds(coll, CollectionScanParams::FORWARD, &recordIds);
+    remove(coll->docFor(&_opCtx, recordIds[10]).value());
+
+    vector<int> expected;
+    for (int i = 11; i < 20; ++i) {
+        expected.push_back(i);
+    }
+    ASSERT(expected ==
+           getFooValuesInRange(coll, CollectionScanParams::FORWARD, recordIds[10], recordIds[20]));
+
+    // A backward scan starts from the end of its range, which is exclusive.
+    remove(coll->docFor(&_opCtx, recordIds[30]).value());
+    expected.clear();
+    for (int i = 29; i >= 20; --i) {
+        expected.push_back(i);
+    }
+    ASSERT(expected ==
+           getFooValuesInRange(coll, CollectionScanParams::BACKWARD, recordIds[20], recordIds[30]));
+
+    // A range whose records have all been deleted is empty.
+    remove(coll->docFor(&_opCtx, recordIds[numObj() - 1]).value());
+    ASSERT(getFooValuesInRange(
+               coll, CollectionScanParams::FORWARD, recordIds[numObj() - 1], boost::none)
+               .empty());
+}
+
+// The ranges computed by the RecordStore cover the whole collection without overlapping.
+TEST_F(QueryStageCollectionScanTest, QueryStageCollscanRangesCoverCollection) {
+    AutoGetCollectionForReadCommand ctx(&_opCtx, nss);
+    auto collection = ctx.getCollection();
+
+    vector<RecordId> recordIds;
+    getRecordIds(collection, CollectionScanParams::FORWARD, &recordIds);
+    ASSERT_EQUALS(static_cast<size_t>(numObj()), recordIds.size());
+
+    // The collection is small enough to be read in full, so the ranges hold 12, 13, 12 and 13 of
+    // its 50 records.
+    const size_t numRanges = 4;
+    vector<RecordId> boundaries =
+        collection->getRecordStore()->getRangeBoundaries(&_opCtx, numRanges);
+    ASSERT(boundaries == vector<RecordId>({recordIds[12], recordIds[25], recordIds[37]}));
+
+    // Scanning every range returns each record of the collection exactly once.
+    vector<int> all;
+    for (size_t range = 0; range <= boundaries.size(); ++range) {
+        auto minRecord = range == 0 ? boost::none : boost::make_optional(boundaries[range - 1]);
+        auto maxRecord =
+            range == boundaries.size() ? boost::none : boost::make_optional(boundaries[range]);
+        vector<int> values =
+            getFooValuesInRange(collection, CollectionScanParams::FORWARD, minRecord, maxRecord);
+        all.insert(all.end(), values.begin(), values.end());
+    }
+
+    ASSERT_EQUALS(static_cast<size_t>(numObj()), all.size());
+    for (int i = 0; i < numObj(); ++i) {
+        ASSERT_EQUALS(i, all[i]);
+    }
+}
+
 // Scan through half the objects, delete the one we're about to fetch, then expect to get the "next"
 // object we would have gotten after that.
 TEST_F(QueryStageCollectionScanTest, QueryStageCollscanDeleteUpcomingObject) {
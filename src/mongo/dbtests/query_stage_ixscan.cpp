@@ -33,11 +33,15 @@
 #include "mongo/db/client.h"
 #include "mongo/db/db_raii.h"
 #include "mongo/db/exec/index_scan.h"
+#include "mongo/db/exec/projection.h"
 #include "mongo/db/exec/working_set.h"
 #include "mongo/db/index/index_descriptor.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/json.h"
+#include "mongo/db/query/index_bounds_builder.h"
+#include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/dbtests/dbtests.h"
+#include "mongo/util/scopeguard.h"
 
 namespace QueryStageIxscan {
 namespace {
@@ -314,6 +318,118 @@ public:
     }
 };
 
+// A covered projection over an index scan returns the same objects whether or not the scan decodes
+// the projected fields straight from the index cursor.
+class QueryStageIxscanCoveredProjectionDecodesKeyFields : public IndexScanTest {
+public:
+    void run() {
+        setup();
+
+        const BSONObj compoundKeyPattern = BSON("a" << 1 << "b" << -1 << "c" << 1);
+        const BSONObj collatedKeyPattern = BSON("s" << 1 << "n" << -1);
+        {
+            WriteUnitOfWork wunit(&_opCtx);
+            ASSERT_OK(_coll->getIndexCatalog()->createIndexOnEmptyCollection(
+                &_opCtx,
+                BSON("key" << compoundKeyPattern << "name"
+                           << "compound"
+                           << "v" << static_cast<int>(kIndexVersion))));
+            ASSERT_OK(_coll->getIndexCatalog()->createIndexOnEmptyCollection(
+                &_opCtx,
+                BSON("key" << collatedKeyPattern << "name"
+                           << "collated"
+                           << "v" << static_cast<int>(kIndexVersion) << "collation"
+                           << BSON("locale"
+                                   << "en_US"
+                                   << "strength" << 2))));
+            wunit.commit();
+        }
+
+        insert(fromjson("{_id: 1, a: 1, b: 'x', c: 2.5, s: 'Hello', n: 1}"));
+        insert(fromjson("{_id: 2, a: 1, b: 'y', c: -3, s: 'hello', n: 2}"));
+        insert(fromjson("{_id: 3, a: 1.5, b: {d: 1, e: 'f'}, c: null, s: 'WORLD', n: -1.5}"));
+        insert(fromjson("{_id: 4, a: NumberLong(2), b: true, s: 'world', n: NumberDecimal('2')}"));
+        insert(fromjson("{_id: 5, a: 'str', c: {$date: 0}, n: 'nine'}"));
+        insert(fromjson("{_id: 6, c: 7}"));
+
+        // None of these documents make the indexes multikey, which would prevent covering.
+        std::vector<const IndexDescriptor*> indexes;
+        _coll->getIndexCatalog()->findIndexesByKeyPattern(
+            &_opCtx, compoundKeyPattern, false, &indexes);
+        ASSERT_EQ(indexes.size(), 1U);
+        ASSERT_FALSE(indexes[0]->isMultikey());
+
+        for (int direction : {1, -1}) {
+            assertSameResults(compoundKeyPattern, BSON("_id" << 0 << "a" << 1), direction);
+            assertSameResults(compoundKeyPattern, BSON("_id" << 0 << "b" << 1), direction);
+            assertSameResults(
+                compoundKeyPattern, BSON("_id" << 0 << "a" << 1 << "c" << 1), direction);
+            assertSameResults(compoundKeyPattern,
+                              BSON("_id" << 0 << "c" << 1 << "b" << 1 << "a" << 1),
+                              direction);
+            assertSameResults(collatedKeyPattern, BSON("_id" << 0 << "s" << 1), direction);
+            assertSameResults(collatedKeyPattern, BSON("_id" << 0 << "n" << 1), direction);
+            assertSameResults(
+                collatedKeyPattern, BSON("_id" << 0 << "s" << 1 << "n" << 1), direction);
+        }
+    }
+
+private:
+    void assertSameResults(const BSONObj& keyPattern, const BSONObj& projection, int direction) {
+        const auto decoded = runCoveredProjection(keyPattern, projection, direction, true);
+        const auto projected = runCoveredProjection(keyPattern, projection, direction, false);
+        ASSERT_EQ(decoded.size(), 6U);
+        ASSERT_EQ(decoded.size(), projected.size());
+        for (size_t i = 0; i < decoded.size(); ++i) {
+            ASSERT(decoded[i].binaryEqual(projected[i]))
+                << "key pattern: " << keyPattern << ", projection: " << projection
+                << ", direction: " << direction << ", decoded: " << decoded[i]
+                << ", projected: " << projected[i];
+        }
+    }
+
+    std::vector<BSONObj> runCoveredProjection(const BSONObj& keyPattern,
+                                              const BSONObj& projection,
+                                              int direction,
+                                              bool decodeCoveredIndexFields) {
+        const bool originalDecode = internalQueryExecDecodeCoveredIndexFields.load();
+        internalQueryExecDecodeCoveredIndexFields.store(decodeCoveredIndexFields);
+        ON_BLOCK_EXIT([&] { internalQueryExecDecodeCoveredIndexFields.store(originalDecode); });
+
+        std::vector<const IndexDescriptor*> indexes;
+        _coll->getIndexCatalog()->findIndexesByKeyPattern(&_opCtx, keyPattern, false, &indexes);
+        ASSERT_EQ(indexes.size(), 1U);
+
+        // Scan the whole index. Bounds that are a single interval need no bounds checker.
+        IndexScanParams params(&_opCtx, indexes[0]);
+        IndexBoundsBuilder::allValuesBounds(keyPattern, &params.bounds);
+        if (direction < 0) {
+            params.bounds = params.bounds.reverse();
+        }
+        params.direction = direction;
+
+        MatchExpression* filter = nullptr;
+        ProjectionStageCovered projectionStage(
+            &_opCtx,
+            projection,
+            &_ws,
+            std::make_unique<IndexScan>(&_opCtx, params, &_ws, filter),
+            keyPattern);
+
+        std::vector<BSONObj> results;
+        WorkingSetID id = WorkingSet::INVALID_ID;
+        PlanStage::StageState state = PlanStage::NEED_TIME;
+        while (PlanStage::IS_EOF != (state = projectionStage.work(&id))) {
+            ASSERT_NE(PlanStage::FAILURE, state);
+            if (PlanStage::ADVANCED == state) {
+                results.push_back(_ws.get(id)->obj.value().getOwned());
+                _ws.free(id);
+            }
+        }
+        return results;
+    }
+};
+
 class All : public Suite {
 public:
     All() : Suite("query_stage_ixscan") {}
@@ -324,6 +440,7 @@ public:
         add<QueryStageIxscanInsertDuringSaveExclusive>();
         add<QueryStageIxscanInsertDuringSaveExclusive2>();
         add<QueryStageIxscanInsertDuringSaveReverse>();
+        add<QueryStageIxscanCoveredProjectionDecodesKeyFields>();
     }
 } QueryStageIxscanAll;
 
@@ -0,0 +1,63 @@
+/**
+ *    Copyright (C) 2019-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+
+/**
+ * The lane an operation queues in when it waits for a storage engine ticket. Lanes are served in
+ * this order, with lower lanes still getting a share of the tickets so that they can't starve.
+ */
+enum class AdmissionPriority {
+    // Replication and other internal threads.
+    kInternal,
+    // Operations run on behalf of clients. The default.
+    kInteractive,
+    // Bulk work that can wait, such as index builds and TTL deletes.
+    kBackground,
+};
+
+constexpr int kNumAdmissionPriorities = 3;
+
+inline const char* toString(AdmissionPriority priority) {
+    switch (priority) {
+        case AdmissionPriority::kInternal:
+            return "internal";
+        case AdmissionPriority::kInteractive:
+            return "interactive";
+        case AdmissionPriority::kBackground:
+            return "background";
+    }
+    MONGO_UNREACHABLE;
+}
+
+}  // namespace mongo
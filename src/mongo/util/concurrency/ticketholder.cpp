@@ -33,224 +33,205 @@
 
 #include "mongo/util/concurrency/ticketholder.h"
 
-#include <iostream>
+#include <algorithm>
 
-#include "mongo/util/log.h"
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/platform/bits.h"
+#include "mongo/util/scopeguard.h"
 #include "mongo/util/str.h"
 
 namespace mongo {
 
-#if defined(__linux__)
-namespace {
+TicketHolder::TicketHolder(int num) : _available(num), _outof(num) {}
 
-/**
- * Accepts an errno code, prints its error message, and exits.
- */
-void failWithErrno(int err) {
-    severe() << "error in Ticketholder: " << errnoWithDescription(err);
-    fassertFailed(28604);
-}
-
-/*
- * Checks the return value from a Linux semaphore function call, and fails with the set errno if the
- * call was unsucessful.
- */
-void check(int ret) {
-    if (ret == 0)
-        return;
-    failWithErrno(errno);
-}
-
-/**
- * Takes a Date_t deadline and sets the appropriate values in a timespec structure.
- */
-void tsFromDate(const Date_t& deadline, struct timespec& ts) {
-    ts.tv_sec = deadline.toTimeT();
-    ts.tv_nsec = (deadline.toMillisSinceEpoch() % 1000) * 1'000'000;
-}
-}  // namespace
+TicketHolder::~TicketHolder() = default;
 
-TicketHolder::TicketHolder(int num) : _outof(num) {
-    check(sem_init(&_sem, 0, num));
+bool TicketHolder::tryAcquire() {
+    return _tryAcquireFast();
 }
 
-TicketHolder::~TicketHolder() {
-    check(sem_destroy(&_sem));
+void TicketHolder::waitForTicket(OperationContext* opCtx, AdmissionPriority priority) {
+    invariant(waitForTicketUntil(opCtx, Date_t::max(), priority));
 }
 
-bool TicketHolder::tryAcquire() {
-    while (0 != sem_trywait(&_sem)) {
-        if (errno == EAGAIN)
-            return false;
-        if (errno != EINTR)
-            failWithErrno(errno);
+bool TicketHolder::waitForTicketUntil(OperationContext* opCtx,
+                                      Date_t until,
+                                      AdmissionPriority priority) {
+    if (_tryAcquireFast()) {
+        return true;
     }
-    return true;
-}
-
-void TicketHolder::waitForTicket(OperationContext* opCtx) {
-    waitForTicketUntil(opCtx, Date_t::max());
-}
 
-bool TicketHolder::waitForTicketUntil(OperationContext* opCtx, Date_t until) {
-    const Milliseconds intervalMs(500);
-    struct timespec ts;
-
-    // To support interrupting ticket acquisition while still benefiting from semaphores, we do a
-    // timed wait on an interval to periodically check for interrupts.
-    // The wait period interval is the smaller of the default interval and the provided
-    // deadline.
-    Date_t deadline = std::min(until, Date_t::now() + intervalMs);
-    tsFromDate(deadline, ts);
-
-    while (0 != sem_timedwait(&_sem, &ts)) {
-        if (errno == ETIMEDOUT) {
-            // If we reached the deadline without being interrupted, we have completely timed out.
-            if (deadline == until)
-                return false;
-
-            deadline = std::min(until, Date_t::now() + intervalMs);
-            tsFromDate(deadline, ts);
-        } else if (errno != EINTR) {
-            failWithErrno(errno);
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    _numWaiters.fetchAndAdd(1);
+    ON_BLOCK_EXIT([&] { _numWaiters.fetchAndSubtract(1); });
+
+    Waiter waiter;
+    waiter.seq = _nextWaiterSeq++;
+    auto& queue = _queues[static_cast<int>(priority)];
+    auto it = queue.insert(queue.end(), &waiter);
+
+    // A release() that happened before we were counted in '_numWaiters' did not hand its ticket
+    // to anyone.
+    _grantTickets_inlock();
+
+    auto granted = [&] { return waiter.granted; };
+    try {
+        if (opCtx) {
+            opCtx->waitForConditionOrInterruptUntil(waiter.cv, lk, until, granted);
+        } else if (until == Date_t::max()) {
+            waiter.cv.wait(lk, granted);
+        } else {
+            waiter.cv.wait_until(lk, until.toSystemTimePoint(), granted);
         }
+    } catch (const DBException&) {
+        if (waiter.granted) {
+            // The ticket was handed to us as we were interrupted, so pass it on.
+            _available.fetchAndAdd(1);
+            _grantTickets_inlock();
+        } else {
+            queue.erase(it);
+        }
+        throw;
+    }
 
-        // To correctly handle errors from sem_timedwait, we should check for interrupts last.
-        // It is possible to unset 'errno' after a call to checkForInterrupt().
-        if (opCtx)
-            opCtx->checkForInterrupt();
+    if (!waiter.granted) {
+        queue.erase(it);
+        return false;
     }
+    _recordWait_inlock(priority, waiter.timer.micros());
     return true;
 }
 
 void TicketHolder::release() {
-    check(sem_post(&_sem));
+    _available.fetchAndAdd(1);
+    if (_numWaiters.load() == 0) {
+        return;
+    }
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _grantTickets_inlock();
 }
 
 Status TicketHolder::resize(int newSize) {
-    stdx::lock_guard<stdx::mutex> lk(_resizeMutex);
-
-    if (newSize < 5)
-        return Status(ErrorCodes::BadValue,
-                      str::stream() << "Minimum value for semaphore is 5; given " << newSize);
-
-    if (newSize > SEM_VALUE_MAX)
+    if (newSize < 1) {
         return Status(ErrorCodes::BadValue,
-                      str::stream() << "Maximum value for semaphore is " << SEM_VALUE_MAX
-                                    << "; given " << newSize);
-
-    while (_outof.load() < newSize) {
-        release();
-        _outof.fetchAndAdd(1);
-    }
-
-    while (_outof.load() > newSize) {
-        waitForTicket();
-        _outof.subtractAndFetch(1);
+                      str::stream() << "Minimum value for tickets is 1; given " << newSize);
     }
 
-    invariant(_outof.load() == newSize);
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _available.fetchAndAdd(newSize - _outof.load());
+    _outof.store(newSize);
+    _grantTickets_inlock();
     return Status::OK();
 }
 
 int TicketHolder::available() const {
-    int val = 0;
-    check(sem_getvalue(&_sem, &val));
-    return val;
+    return std::max(0, _available.load());
 }
 
 int TicketHolder::used() const {
-    return outof() - available();
+    return outof() - _available.load();
 }
 
 int TicketHolder::outof() const {
     return _outof.load();
 }
 
-#else
-
-TicketHolder::TicketHolder(int num) : _outof(num), _num(num) {}
-
-TicketHolder::~TicketHolder() = default;
-
-bool TicketHolder::tryAcquire() {
-    stdx::lock_guard<stdx::mutex> lk(_mutex);
-    return _tryAcquire();
+int TicketHolder::queued() const {
+    return _numWaiters.load();
 }
 
-void TicketHolder::waitForTicket(OperationContext* opCtx) {
-    stdx::unique_lock<stdx::mutex> lk(_mutex);
-
-    if (opCtx) {
-        opCtx->waitForConditionOrInterrupt(_newTicket, lk, [this] { return _tryAcquire(); });
-    } else {
-        _newTicket.wait(lk, [this] { return _tryAcquire(); });
+long long TicketHolder::totalWaitMicros() const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    long long total = 0;
+    for (const auto& stats : _laneStats) {
+        total += stats.totalWaitMicros;
     }
+    return total;
 }
 
-bool TicketHolder::waitForTicketUntil(OperationContext* opCtx, Date_t until) {
-    stdx::unique_lock<stdx::mutex> lk(_mutex);
-
-    if (opCtx) {
-        return opCtx->waitForConditionOrInterruptUntil(
-            _newTicket, lk, until, [this] { return _tryAcquire(); });
-    } else {
-        return _newTicket.wait_until(
-            lk, until.toSystemTimePoint(), [this] { return _tryAcquire(); });
+void TicketHolder::appendStats(BSONObjBuilder* b) const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    BSONObjBuilder lanesBuilder(b->subobjStart("lanes"));
+    for (int lane = 0; lane < kNumAdmissionPriorities; ++lane) {
+        const auto& stats = _laneStats[lane];
+        BSONObjBuilder laneBuilder(
+            lanesBuilder.subobjStart(toString(static_cast<AdmissionPriority>(lane))));
+        laneBuilder.append("queued", static_cast<int>(_queues[lane].size()));
+        laneBuilder.append("waits", stats.waits);
+        laneBuilder.append("totalWaitMicros", stats.totalWaitMicros);
+        // Every bucket is always reported so that the shape of the document stays the same from
+        // one sample to the next, which FTDC relies on to compress it.
+        BSONArrayBuilder histogramBuilder(laneBuilder.subarrayStart("histogram"));
+        for (int i = 0; i < LaneStats::kNumBuckets; ++i) {
+            BSONObjBuilder entryBuilder(histogramBuilder.subobjStart());
+            entryBuilder.append("micros", i == 0 ? 0LL : 1LL << (i - 1));
+            entryBuilder.append("count", stats.buckets[i]);
+        }
     }
 }
 
-void TicketHolder::release() {
-    {
-        stdx::lock_guard<stdx::mutex> lk(_mutex);
-        _num++;
+bool TicketHolder::_tryAcquireFast() {
+    // Don't barge ahead of queued waiters.
+    if (_numWaiters.load() != 0) {
+        return false;
     }
-    _newTicket.notify_one();
-}
-
-Status TicketHolder::resize(int newSize) {
-    stdx::lock_guard<stdx::mutex> lk(_mutex);
-
-    int used = _outof.load() - _num;
-    if (used > newSize) {
-        std::stringstream ss;
-        ss << "can't resize since we're using (" << used << ") "
-           << "more than newSize(" << newSize << ")";
-
-        std::string errmsg = ss.str();
-        log() << errmsg;
-        return Status(ErrorCodes::BadValue, errmsg);
+    int available = _available.load();
+    while (available > 0) {
+        if (_available.compareAndSwap(&available, available - 1)) {
+            return true;
+        }
     }
+    return false;
+}
 
-    _outof.store(newSize);
-    _num = _outof.load() - used;
+void TicketHolder::_grantTickets_inlock() {
+    while (true) {
+        int lane = 0;
+        while (lane < kNumAdmissionPriorities && _queues[lane].empty()) {
+            ++lane;
+        }
+        if (lane == kNumAdmissionPriorities) {
+            return;
+        }
 
-    // Potentially wasteful, but easier to see is correct
-    _newTicket.notify_all();
-    return Status::OK();
-}
+        // Find the lower lane that has waited the longest.
+        int lowerLane = -1;
+        for (int i = lane + 1; i < kNumAdmissionPriorities; ++i) {
+            if (!_queues[i].empty() &&
+                (lowerLane < 0 || _queues[i].front()->seq < _queues[lowerLane].front()->seq)) {
+                lowerLane = i;
+            }
+        }
 
-int TicketHolder::available() const {
-    return _num;
-}
+        int available = _available.load();
+        do {
+            if (available <= 0) {
+                return;
+            }
+        } while (!_available.compareAndSwap(&available, available - 1));
+
+        if (lowerLane < 0) {
+            _grantsSinceLowerLane = 0;
+        } else if (_grantsSinceLowerLane >= kLowerLaneGrantInterval) {
+            lane = lowerLane;
+            _grantsSinceLowerLane = 0;
+        } else {
+            ++_grantsSinceLowerLane;
+        }
 
-int TicketHolder::used() const {
-    return outof() - _num;
+        Waiter* waiter = _queues[lane].front();
+        _queues[lane].pop_front();
+        waiter->granted = true;
+        waiter->cv.notify_one();
+    }
 }
 
-int TicketHolder::outof() const {
-    return _outof.load();
+void TicketHolder::_recordWait_inlock(AdmissionPriority priority, long long waitMicros) {
+    auto& stats = _laneStats[static_cast<int>(priority)];
+    int bucket = waitMicros <= 0 ? 0 : 64 - countLeadingZeros64(waitMicros);
+    stats.buckets[std::min(bucket, LaneStats::kNumBuckets - 1)]++;
+    stats.waits++;
+    stats.totalWaitMicros += waitMicros;
 }
 
-bool TicketHolder::_tryAcquire() {
-    if (_num <= 0) {
-        if (_num < 0) {
-            std::cerr << "DISASTER! in TicketHolder" << std::endl;
-        }
-        return false;
-    }
-    _num--;
-    return true;
-}
-#endif
 }  // namespace mongo
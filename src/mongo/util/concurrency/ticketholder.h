@@ -28,23 +28,37 @@
  */
 #pragma once
 
-#if defined(__linux__)
-#include <semaphore.h>
-#endif
+#include <array>
+#include <list>
 
 #include "mongo/db/operation_context.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/mutex.h"
-#include "mongo/util/concurrency/mutex.h"
+#include "mongo/util/concurrency/admission_priority.h"
 #include "mongo/util/time_support.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
+class BSONObjBuilder;
+
+/**
+ * Counting semaphore that hands out tickets in FIFO order within each AdmissionPriority lane.
+ *
+ * A ticket is taken with a compare and swap when nobody is queued. Otherwise the caller queues in
+ * its lane and release() hands the ticket directly to the next waiter, so that newcomers can't
+ * barge ahead of queued operations. Internal waiters are served before interactive ones, which are
+ * served before background ones, except that every kLowerLaneGrantInterval-th ticket handed out
+ * while a lower lane has waiters goes to the lane that has waited the longest.
+ */
 class TicketHolder {
     TicketHolder(const TicketHolder&) = delete;
     TicketHolder& operator=(const TicketHolder&) = delete;
 
 public:
+    static constexpr int kLowerLaneGrantInterval = 8;
+
     explicit TicketHolder(int num);
     ~TicketHolder();
 
@@ -55,7 +69,8 @@ public:
      * 'opCtx' is killed, throwing an AssertionException.
      * If 'opCtx' is not provided or equal to nullptr, the wait is not interruptible.
      */
-    void waitForTicket(OperationContext* opCtx);
+    void waitForTicket(OperationContext* opCtx,
+                       AdmissionPriority priority = AdmissionPriority::kInteractive);
     void waitForTicket() {
         waitForTicket(nullptr);
     }
@@ -67,12 +82,18 @@ public:
      * proceed.
      * If 'opCtx' is not provided or equal to nullptr, the wait is not interruptible.
      */
-    bool waitForTicketUntil(OperationContext* opCtx, Date_t until);
+    bool waitForTicketUntil(OperationContext* opCtx,
+                            Date_t until,
+                            AdmissionPriority priority = AdmissionPriority::kInteractive);
     bool waitForTicketUntil(Date_t until) {
         return waitForTicketUntil(nullptr, until);
     }
     void release();
 
+    /**
+     * Changes the number of tickets without waiting for the tickets in use to be released. When
+     * shrinking, no new ticket is handed out until the number in use drops under 'newSize'.
+     */
     Status resize(int newSize);
 
     int available() const;
@@ -81,21 +102,66 @@ public:
 
     int outof() const;
 
+    /**
+     * Returns the number of operations currently waiting for a ticket.
+     */
+    int queued() const;
+
+    /**
+     * Returns the total time, across all lanes, that operations have spent waiting for a ticket.
+     */
+    long long totalWaitMicros() const;
+
+    /**
+     * Appends the number of queued operations and a histogram of the time they waited for a ticket
+     * for each lane. The histogram lists all of its buckets, including empty ones.
+     */
+    void appendStats(BSONObjBuilder* b) const;
+
 private:
-#if defined(__linux__)
-    mutable sem_t _sem;
+    struct Waiter {
+        stdx::condition_variable cv;
+        // Order in which the waiters of all lanes queued.
+        uint64_t seq;
+        Timer timer;
+        bool granted = false;
+    };
+
+    struct LaneStats {
+        static constexpr int kNumBuckets = 32;
+
+        // Bucket i counts the waits that took [2^(i-1), 2^i) microseconds, bucket 0 those under a
+        // microsecond.
+        std::array<long long, kNumBuckets> buckets{};
+        long long waits = 0;
+        long long totalWaitMicros = 0;
+    };
+
+    bool _tryAcquireFast();
 
-    // You can read _outof without a lock, but have to hold _resizeMutex to change.
-    AtomicWord<int> _outof;
-    stdx::mutex _resizeMutex;
-#else
-    bool _tryAcquire();
+    /**
+     * Hands available tickets to queued waiters.
+     */
+    void _grantTickets_inlock();
+
+    void _recordWait_inlock(AdmissionPriority priority, long long waitMicros);
 
+    // Tickets left to hand out. Negative after shrinking while more tickets than the new size are
+    // in use.
+    AtomicWord<int> _available;
     AtomicWord<int> _outof;
-    int _num;
-    stdx::mutex _mutex;
-    stdx::condition_variable _newTicket;
-#endif
+
+    // Number of threads queued or about to queue. The fast path is only taken when it is zero.
+    AtomicWord<int> _numWaiters;
+
+    mutable stdx::mutex _mutex;
+    std::array<std::list<Waiter*>, kNumAdmissionPriorities> _queues;
+    std::array<LaneStats, kNumAdmissionPriorities> _laneStats;
+
+    uint64_t _nextWaiterSeq = 0;
+
+    // Number of tickets in a row handed to the highest queued lane while a lower lane was waiting.
+    int _grantsSinceLowerLane = 0;
 };
 
 class ScopedTicket {
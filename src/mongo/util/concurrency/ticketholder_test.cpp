@@ -32,6 +32,11 @@
 
 #include "mongo/platform/basic.h"
 
+#include <string>
+#include <vector>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/concurrency/ticketholder.h"
 
@@ -72,4 +77,87 @@ TEST(TicketholderTest, BasicTimeout) {
     holder.release();
     ASSERT_EQ(holder.used(), 0);
 }
+
+int queuedInLane(const TicketHolder& holder, AdmissionPriority priority) {
+    BSONObjBuilder b;
+    holder.appendStats(&b);
+    return b.obj()["lanes"][toString(priority)]["queued"].numberInt();
+}
+
+TEST(TicketholderTest, WaitersAreServedByPriorityThenInOrder) {
+    TicketHolder holder(1);
+    holder.waitForTicket();
+
+    stdx::mutex mutex;
+    std::vector<std::string> order;
+    std::vector<stdx::thread> threads;
+    auto startWaiter = [&](AdmissionPriority priority, std::string name) {
+        const int queued = queuedInLane(holder, priority);
+        threads.emplace_back([&, priority, name] {
+            holder.waitForTicket(nullptr, priority);
+            {
+                stdx::lock_guard<stdx::mutex> lk(mutex);
+                order.push_back(name);
+            }
+            holder.release();
+        });
+        while (queuedInLane(holder, priority) == queued) {
+            stdx::this_thread::yield();
+        }
+    };
+    startWaiter(AdmissionPriority::kBackground, "background");
+    startWaiter(AdmissionPriority::kInteractive, "interactive1");
+    startWaiter(AdmissionPriority::kInternal, "internal");
+    startWaiter(AdmissionPriority::kInteractive, "interactive2");
+
+    holder.release();
+
+    for (auto&& thread : threads) {
+        thread.join();
+    }
+    ASSERT_EQ(4U, order.size());
+    ASSERT_EQ("internal", order[0]);
+    ASSERT_EQ("interactive1", order[1]);
+    ASSERT_EQ("interactive2", order[2]);
+    ASSERT_EQ("background", order[3]);
+
+    BSONObjBuilder b;
+    holder.appendStats(&b);
+    auto stats = b.obj();
+    ASSERT_EQ(2, stats["lanes"]["interactive"]["waits"].numberInt());
+    ASSERT_EQ(1, stats["lanes"]["background"]["waits"].numberInt());
+    ASSERT_EQ(0, stats["lanes"]["background"]["queued"].numberInt());
+
+    // The histogram has the same buckets whether or not they counted any waits.
+    for (int lane = 0; lane < kNumAdmissionPriorities; ++lane) {
+        auto histogram =
+            stats["lanes"][toString(static_cast<AdmissionPriority>(lane))]["histogram"].Array();
+        ASSERT_EQ(32U, histogram.size());
+        ASSERT_EQ(0, histogram[0]["micros"].numberLong());
+        ASSERT_EQ(1LL << 30, histogram[31]["micros"].numberLong());
+    }
+}
+
+TEST(TicketholderTest, ResizeDoesNotWaitForTicketsInUse) {
+    TicketHolder holder(2);
+    holder.waitForTicket();
+    holder.waitForTicket();
+
+    ASSERT_OK(holder.resize(1));
+    ASSERT_EQ(holder.outof(), 1);
+    ASSERT_EQ(holder.used(), 2);
+    ASSERT_EQ(holder.available(), 0);
+
+    holder.release();
+    ASSERT_EQ(holder.used(), 1);
+    ASSERT_FALSE(holder.tryAcquire());
+
+    holder.release();
+    ASSERT_EQ(holder.used(), 0);
+    ASSERT_EQ(holder.available(), 1);
+
+    ASSERT_OK(holder.resize(3));
+    ASSERT_EQ(holder.available(), 3);
+    ASSERT_NOT_OK(holder.resize(0));
+}
 }  // namespace
@@ -0,0 +1,431 @@
+/**
+ *    Copyright (C) 2019-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <boost/optional.hpp>
+#include <deque>
+#include <limits>
+#include <memory>
+
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/chrono.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/duration.h"
+#include "mongo/util/with_alignment.h"
+
+namespace mongo {
+
+namespace mpsc_ring_buffer_detail {
+
+/**
+ * By default, all items in the ring buffer have equal weight.
+ */
+struct DefaultCostFunction {
+    template <typename T>
+    size_t operator()(const T&) const {
+        return 1;
+    }
+};
+
+}  // namespace mpsc_ring_buffer_detail
+
+/**
+ * Bounded queue over a fixed ring of slots. It is an alternative to BlockingQueue and
+ * MultiProducerSingleConsumerQueue when items are pushed and popped at a high rate.
+ *
+ * Producers claim a slot with a compare and swap on the enqueue position and publish the item by
+ * bumping the slot's sequence number, so they never take a lock unless the ring is full. Pushes
+ * never block: while the ring is full, items go to an overflow list under a mutex, and keep going
+ * there until the consumer has drained it, so that each producer's items stay in order. Consumer
+ * operations serialize on a mutex that only a single consumer ever takes in the steady state, which
+ * lets clear() run from any thread. Threads only block on a condition variable in waitForData()
+ * and waitForSpace(), and are only notified when someone is waiting.
+ *
+ * The queue also tracks the total cost of its items as given by 'CostFunc'. Pushes are not limited
+ * by cost or by the number of slots; producers that care call waitForSpace() before pushing, as
+ * with BlockingQueue::pushAllNonBlocking(). Callers may hold locks while pushing that the consumer
+ * needs to make progress, so the waiting must happen in waitForSpace() and not in push.
+ */
+template <typename T, typename CostFunc = mpsc_ring_buffer_detail::DefaultCostFunction>
+class MultiProducerSingleConsumerRingBuffer {
+    MultiProducerSingleConsumerRingBuffer(const MultiProducerSingleConsumerRingBuffer&) = delete;
+    MultiProducerSingleConsumerRingBuffer& operator=(const MultiProducerSingleConsumerRingBuffer&) =
+        delete;
+
+public:
+    /**
+     * 'capacity' is the number of slots and must be a power of two. 'maxCost' is the total cost
+     * that waitForSpace() waits for the queue to go under.
+     */
+    MultiProducerSingleConsumerRingBuffer(size_t capacity,
+                                          size_t maxCost = std::numeric_limits<size_t>::max(),
+                                          CostFunc costFunc = {})
+        : _capacity(capacity),
+          _mask(capacity - 1),
+          _maxCost(maxCost),
+          _costFunc(std::move(costFunc)),
+          _slots(new Slot[capacity]) {
+        invariant(capacity > 0 && (capacity & _mask) == 0);
+        for (size_t i = 0; i < capacity; ++i) {
+            _slots[i].sequence.store(i);
+        }
+    }
+
+    /**
+     * Pushes 't'. Never blocks, even if all slots are taken.
+     */
+    void push(T t) {
+        _push(std::move(t));
+        _notifyConsumer();
+    }
+
+    /**
+     * Pushes the items in [begin, end) in order without blocking. The consumer is notified once for
+     * the whole batch.
+     */
+    template <typename Iterator>
+    void pushMany(Iterator begin, Iterator end) {
+        for (auto it = begin; it != end; ++it) {
+            _push(*it);
+        }
+        _notifyConsumer();
+    }
+
+    /**
+     * Returns when the queue is empty, or when the cost of the queued items plus 'cost' is under
+     * the maximum cost and there is a free slot in the ring.
+     */
+    void waitForSpace(size_t cost) {
+        auto hasSpace = [&] {
+            auto current = _cost.load();
+            auto queued = count();
+            return queued == 0 || (current + cost <= _maxCost && queued < _capacity);
+        };
+        if (hasSpace()) {
+            return;
+        }
+        _waitingProducers.fetchAndAdd(1);
+        stdx::unique_lock<stdx::mutex> lk(_waitMutex);
+        _notFull.wait(lk, hasSpace);
+        _waitingProducers.fetchAndSubtract(1);
+    }
+
+    /**
+     * Pops the next item into 't'. Returns false without blocking if there is none, or if the next
+     * item is still being published by its producer.
+     */
+    bool tryPop(T* t) {
+        stdx::lock_guard<stdx::mutex> lk(_consumerMutex);
+        if (!_pop_inlock(t)) {
+            return false;
+        }
+        _notifyProducers();
+        return true;
+    }
+
+    /**
+     * Pops up to 'maxItems' items into 'out' without blocking. Returns the number of items popped.
+     */
+    template <typename OutputIterator>
+    size_t tryPopMany(size_t maxItems, OutputIterator out) {
+        stdx::lock_guard<stdx::mutex> lk(_consumerMutex);
+        size_t popped = 0;
+        T t;
+        while (popped < maxItems && _pop_inlock(&t)) {
+            *out++ = std::move(t);
+            ++popped;
+        }
+        if (popped) {
+            _notifyProducers();
+        }
+        return popped;
+    }
+
+    /**
+     * Copies the next item into 't' without popping it. Returns false if there is none. Only
+     * meaningful with a single consumer.
+     */
+    bool peek(T* t) const {
+        stdx::lock_guard<stdx::mutex> lk(_consumerMutex);
+        auto pos = _dequeuePos.loadRelaxed();
+        const Slot& slot = _slots[pos & _mask];
+        if (slot.sequence.load() == pos + 1) {
+            *t = slot.value;
+            return true;
+        }
+        if (_overflowCount.load() == 0 || pos != _enqueuePos.load()) {
+            return false;
+        }
+        stdx::lock_guard<stdx::mutex> overflowLk(_overflowMutex);
+        if (_overflow.empty()) {
+            return false;
+        }
+        *t = _overflow.front();
+        return true;
+    }
+
+    /**
+     * Waits up to 'timeout' for an item to be ready to pop. Returns false if there still is none,
+     * or if clear() was called while waiting.
+     */
+    bool waitForData(Milliseconds timeout) {
+        if (_hasData()) {
+            return true;
+        }
+        const auto clearGeneration = _clearGeneration.load();
+        _waitingConsumers.fetchAndAdd(1);
+        {
+            stdx::unique_lock<stdx::mutex> lk(_waitMutex);
+            _notEmpty.wait_for(lk, timeout.toSystemDuration(), [&] {
+                return _hasData() || _clearGeneration.load() != clearGeneration;
+            });
+        }
+        _waitingConsumers.fetchAndSubtract(1);
+        return _hasData() && _clearGeneration.load() == clearGeneration;
+    }
+
+    /**
+     * Returns the most recently pushed item, or nothing if the queue is empty.
+     */
+    boost::optional<T> lastObjectPushed() const {
+        stdx::lock_guard<stdx::mutex> lk(_consumerMutex);
+        if (_overflowCount.load() != 0) {
+            stdx::lock_guard<stdx::mutex> overflowLk(_overflowMutex);
+            if (!_overflow.empty()) {
+                return _overflow.back();
+            }
+        }
+        auto pos = _enqueuePos.load();
+        if (pos == _dequeuePos.loadRelaxed()) {
+            return boost::none;
+        }
+        // The producer that claimed the last slot publishes it without blocking.
+        const Slot& slot = _slots[(pos - 1) & _mask];
+        while (slot.sequence.load() != pos) {
+            stdx::this_thread::yield();
+        }
+        return slot.value;
+    }
+
+    /**
+     * Pops every pushed item and wakes up waiting consumers and producers.
+     */
+    void clear() {
+        {
+            stdx::lock_guard<stdx::mutex> lk(_consumerMutex);
+            T t;
+            while (true) {
+                if (_pop_inlock(&t)) {
+                    continue;
+                }
+                if (_dequeuePos.loadRelaxed() == _enqueuePos.load()) {
+                    break;
+                }
+                // The producer that claimed the next slot publishes it without blocking.
+                stdx::this_thread::yield();
+            }
+        }
+        _clearGeneration.fetchAndAdd(1);
+        stdx::lock_guard<stdx::mutex> lk(_waitMutex);
+        _notEmpty.notify_all();
+        _notFull.notify_all();
+    }
+
+    bool empty() const {
+        return count() == 0;
+    }
+
+    /**
+     * The number of pushed items that have not been popped, including items that are still being
+     * published.
+     */
+    size_t count() const {
+        // Load the dequeue position first so that the difference can't be negative.
+        auto dequeuePos = _dequeuePos.load();
+        return _enqueuePos.load() - dequeuePos + _overflowCount.load();
+    }
+
+    /**
+     * The total cost of the queued items.
+     */
+    size_t cost() const {
+        return _cost.load();
+    }
+
+    size_t maxCost() const {
+        return _maxCost;
+    }
+
+    size_t capacity() const {
+        return _capacity;
+    }
+
+private:
+    struct Slot {
+        // Equal to the enqueue position the slot is free for, or that position plus one once the
+        // item pushed at that position is published.
+        AtomicWord<uint64_t> sequence;
+        T value;
+    };
+
+    void _push(T t) {
+        if (_overflowCount.load() == 0 && _tryPushToRing(&t)) {
+            return;
+        }
+        stdx::lock_guard<stdx::mutex> lk(_overflowMutex);
+        // Once an item has spilled over, later ones must follow it until the consumer has taken it.
+        if (_overflow.empty() && _tryPushToRing(&t)) {
+            return;
+        }
+        _cost.fetchAndAdd(_costFunc(t));
+        _overflow.push_back(std::move(t));
+        _overflowCount.fetchAndAdd(1);
+    }
+
+    /**
+     * Moves '*t' into a free slot and returns true, or returns false if the ring is full.
+     */
+    bool _tryPushToRing(T* t) {
+        auto pos = _enqueuePos.load();
+        Slot* slot;
+        while (true) {
+            slot = &_slots[pos & _mask];
+            auto sequence = slot->sequence.load();
+            if (sequence == pos) {
+                if (_enqueuePos.compareAndSwap(&pos, pos + 1)) {
+                    break;
+                }
+            } else if (sequence < pos) {
+                // The item pushed 'capacity' positions earlier is not popped yet.
+                return false;
+            } else {
+                pos = _enqueuePos.load();
+            }
+        }
+        const auto cost = _costFunc(*t);
+        slot->value = std::move(*t);
+        // Account for the cost before publishing so the consumer never subtracts it first.
+        _cost.fetchAndAdd(cost);
+        slot->sequence.store(pos + 1);
+        return true;
+    }
+
+    bool _pop_inlock(T* t) {
+        auto pos = _dequeuePos.loadRelaxed();
+        Slot& slot = _slots[pos & _mask];
+        if (slot.sequence.load() != pos + 1) {
+            // While a claimed slot is unpublished, the items behind it in the ring and in the
+            // overflow list must wait for it.
+            if (pos != _enqueuePos.load()) {
+                return false;
+            }
+            return _popOverflow_inlock(t);
+        }
+        *t = std::move(slot.value);
+        slot.value = T();
+        _dequeuePos.store(pos + 1);
+        _cost.fetchAndSubtract(_costFunc(*t));
+        slot.sequence.store(pos + _capacity);
+        return true;
+    }
+
+    /**
+     * Must only be called once every claimed slot of the ring has been popped. A producer only
+     * spills over while the ring is full and keeps pushing to the overflow list until it has been
+     * drained, so its items in the overflow list come after all of its items in the ring, including
+     * an item whose slot is claimed but not yet published.
+     */
+    bool _popOverflow_inlock(T* t) {
+        if (_overflowCount.load() == 0) {
+            return false;
+        }
+        stdx::lock_guard<stdx::mutex> lk(_overflowMutex);
+        if (_overflow.empty()) {
+            return false;
+        }
+        *t = std::move(_overflow.front());
+        _overflow.pop_front();
+        _overflowCount.fetchAndSubtract(1);
+        _cost.fetchAndSubtract(_costFunc(*t));
+        return true;
+    }
+
+    bool _hasData() const {
+        auto pos = _dequeuePos.load();
+        return _slots[pos & _mask].sequence.load() == pos + 1 ||
+            (_overflowCount.load() != 0 && pos == _enqueuePos.load());
+    }
+
+    void _notifyConsumer() {
+        if (_waitingConsumers.load()) {
+            stdx::lock_guard<stdx::mutex> lk(_waitMutex);
+            _notEmpty.notify_all();
+        }
+    }
+
+    void _notifyProducers() {
+        if (_waitingProducers.load()) {
+            stdx::lock_guard<stdx::mutex> lk(_waitMutex);
+            _notFull.notify_all();
+        }
+    }
+
+    const size_t _capacity;
+    const size_t _mask;
+    const size_t _maxCost;
+    const CostFunc _costFunc;
+    const std::unique_ptr<Slot[]> _slots;
+
+    // Producers and the consumer each write their own position.
+    CacheAligned<AtomicWord<uint64_t>> _enqueuePos;
+    CacheAligned<AtomicWord<uint64_t>> _dequeuePos;
+    CacheAligned<AtomicWord<size_t>> _cost;
+
+    mutable stdx::mutex _consumerMutex;
+
+    // Items pushed while the ring was full, oldest first. Taken after '_consumerMutex' when both
+    // are needed.
+    mutable stdx::mutex _overflowMutex;
+    std::deque<T> _overflow;
+    AtomicWord<size_t> _overflowCount;
+
+    // Only used to block in waitForData() and waitForSpace().
+    stdx::mutex _waitMutex;
+    stdx::condition_variable _notEmpty;
+    stdx::condition_variable _notFull;
+    AtomicWord<int> _waitingConsumers;
+    AtomicWord<int> _waitingProducers;
+    AtomicWord<uint64_t> _clearGeneration;
+};
+
+}  // namespace mongo
@@ -0,0 +1,134 @@
+/**
+ *    Copyright (C) 2019-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <benchmark/benchmark.h>
+#include <vector>
+
+#include "mongo/stdx/thread.h"
+#include "mongo/util/mpsc_ring_buffer.h"
+#include "mongo/util/producer_consumer_queue.h"
+#include "mongo/util/queue.h"
+
+namespace mongo {
+namespace {
+
+// The oplog fetcher pushes whole batches that the applier then drains one entry at a time.
+constexpr int kBatchSize = 1000;
+constexpr size_t kRingCapacity = 4096;
+
+/**
+ * Adapters giving each queue the batch push and single item pop used by the oplog buffer.
+ */
+struct BlockingQueueAdapter {
+    BlockingQueue<int> queue;
+
+    void pushMany(const std::vector<int>& batch) {
+        queue.pushAllNonBlocking(batch.begin(), batch.end());
+    }
+    bool tryPop(int* value) {
+        return queue.tryPop(*value);
+    }
+};
+
+struct ProducerConsumerQueueAdapter {
+    MultiProducerSingleConsumerQueue<int> queue;
+
+    void pushMany(const std::vector<int>& batch) {
+        for (int value : batch) {
+            queue.push(int(value));
+        }
+    }
+    bool tryPop(int* value) {
+        auto popped = queue.tryPop();
+        if (!popped) {
+            return false;
+        }
+        *value = *popped;
+        return true;
+    }
+};
+
+struct RingBufferAdapter {
+    MultiProducerSingleConsumerRingBuffer<int> queue{kRingCapacity};
+
+    void pushMany(const std::vector<int>& batch) {
+        queue.pushMany(batch.begin(), batch.end());
+    }
+    bool tryPop(int* value) {
+        return queue.tryPop(value);
+    }
+};
+
+template <typename Adapter>
+void BM_PushBatchThenDrain(benchmark::State& state) {
+    Adapter adapter;
+    std::vector<int> batch(kBatchSize);
+    int value;
+    for (auto keepRunning : state) {
+        adapter.pushMany(batch);
+        while (adapter.tryPop(&value)) {
+            benchmark::DoNotOptimize(value);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * kBatchSize);
+}
+
+template <typename Adapter>
+void BM_ConcurrentProducer(benchmark::State& state) {
+    Adapter adapter;
+    std::vector<int> batch(kBatchSize);
+    int value;
+    for (auto keepRunning : state) {
+        stdx::thread producer([&] {
+            for (int i = 0; i < 10; ++i) {
+                adapter.pushMany(batch);
+            }
+        });
+        for (int popped = 0; popped < 10 * kBatchSize;) {
+            if (adapter.tryPop(&value)) {
+                ++popped;
+            }
+        }
+        producer.join();
+    }
+    state.SetItemsProcessed(state.iterations() * 10 * kBatchSize);
+}
+
+BENCHMARK_TEMPLATE(BM_PushBatchThenDrain, BlockingQueueAdapter);
+BENCHMARK_TEMPLATE(BM_PushBatchThenDrain, ProducerConsumerQueueAdapter);
+BENCHMARK_TEMPLATE(BM_PushBatchThenDrain, RingBufferAdapter);
+
+BENCHMARK_TEMPLATE(BM_ConcurrentProducer, BlockingQueueAdapter);
+BENCHMARK_TEMPLATE(BM_ConcurrentProducer, ProducerConsumerQueueAdapter);
+BENCHMARK_TEMPLATE(BM_ConcurrentProducer, RingBufferAdapter);
+
+}  // namespace
+}  // namespace mongo
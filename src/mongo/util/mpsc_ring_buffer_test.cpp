@@ -0,0 +1,318 @@
+/**
+ *    Copyright (C) 2019-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/mpsc_ring_buffer.h"
+
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+struct StringSize {
+    size_t operator()(const std::string& s) const {
+        return s.size();
+    }
+};
+
+/**
+ * An item whose move assignment, which is how a push stores the item in the slot it has claimed,
+ * waits for '*release' to be set. This keeps the slot claimed but unpublished.
+ */
+struct GatedItem {
+    GatedItem() = default;
+    GatedItem(int value, AtomicWord<bool>* storing = nullptr, AtomicWord<bool>* release = nullptr)
+        : value(value), storing(storing), release(release) {}
+    GatedItem(const GatedItem&) = default;
+    GatedItem(GatedItem&&) = default;
+    GatedItem& operator=(const GatedItem&) = default;
+
+    GatedItem& operator=(GatedItem&& other) {
+        if (other.release) {
+            other.storing->store(true);
+            while (!other.release->load()) {
+                stdx::this_thread::yield();
+            }
+        }
+        value = other.value;
+        storing = nullptr;
+        release = nullptr;
+        return *this;
+    }
+
+    int value = 0;
+    AtomicWord<bool>* storing = nullptr;
+    AtomicWord<bool>* release = nullptr;
+};
+
+TEST(MultiProducerSingleConsumerRingBufferTest, PushAndPopInOrder) {
+    MultiProducerSingleConsumerRingBuffer<int> queue(4);
+    ASSERT_TRUE(queue.empty());
+
+    queue.push(1);
+    queue.push(2);
+    ASSERT_EQ(2U, queue.count());
+    ASSERT_EQ(2U, queue.cost());
+
+    int value = 0;
+    ASSERT_TRUE(queue.peek(&value));
+    ASSERT_EQ(1, value);
+    ASSERT_TRUE(queue.tryPop(&value));
+    ASSERT_EQ(1, value);
+    ASSERT_TRUE(queue.tryPop(&value));
+    ASSERT_EQ(2, value);
+    ASSERT_FALSE(queue.tryPop(&value));
+    ASSERT_FALSE(queue.peek(&value));
+    ASSERT_TRUE(queue.empty());
+    ASSERT_EQ(0U, queue.cost());
+}
+
+TEST(MultiProducerSingleConsumerRingBufferTest, WrapsAroundTheRing) {
+    MultiProducerSingleConsumerRingBuffer<int> queue(4);
+    for (int i = 0; i < 100; ++i) {
+        std::vector<int> batch{3 * i, 3 * i + 1, 3 * i + 2};
+        queue.pushMany(batch.begin(), batch.end());
+        ASSERT_EQ(3 * i + 2, *queue.lastObjectPushed());
+
+        std::vector<int> popped;
+        ASSERT_EQ(3U, queue.tryPopMany(10, std::back_inserter(popped)));
+        ASSERT(batch == popped);
+    }
+    ASSERT(!queue.lastObjectPushed());
+}
+
+TEST(MultiProducerSingleConsumerRingBufferTest, TracksCostOfItems) {
+    MultiProducerSingleConsumerRingBuffer<std::string, StringSize> queue(8, 10);
+    queue.push("abcd");
+    queue.push("efghij");
+    ASSERT_EQ(10U, queue.cost());
+    ASSERT_EQ(10U, queue.maxCost());
+
+    std::string value;
+    ASSERT_TRUE(queue.tryPop(&value));
+    ASSERT_EQ("abcd", value);
+    ASSERT_EQ(6U, queue.cost());
+
+    // There is room for 4 more.
+    queue.waitForSpace(4);
+
+    queue.clear();
+    ASSERT_TRUE(queue.empty());
+    ASSERT_EQ(0U, queue.cost());
+
+    // An item costing more than the maximum can still go into an empty queue.
+    queue.waitForSpace(20);
+}
+
+TEST(MultiProducerSingleConsumerRingBufferTest, WaitForSpaceBlocksUntilConsumerPops) {
+    MultiProducerSingleConsumerRingBuffer<std::string, StringSize> queue(8, 10);
+    queue.push("0123456789");
+
+    stdx::thread producer([&] {
+        queue.waitForSpace(5);
+        queue.push("abcde");
+    });
+
+    std::string value;
+    while (!queue.tryPop(&value)) {
+    }
+    ASSERT_EQ("0123456789", value);
+    ASSERT_TRUE(queue.waitForData(Seconds(60)));
+    ASSERT_TRUE(queue.tryPop(&value));
+    ASSERT_EQ("abcde", value);
+    producer.join();
+}
+
+TEST(MultiProducerSingleConsumerRingBufferTest, PushSpillsOverAFullRingInOrder) {
+    MultiProducerSingleConsumerRingBuffer<int> queue(2);
+    std::vector<int> batch{0, 1, 2, 3, 4};
+    queue.pushMany(batch.begin(), batch.end());
+    ASSERT_EQ(5U, queue.count());
+    ASSERT_EQ(5U, queue.cost());
+    ASSERT_EQ(4, *queue.lastObjectPushed());
+
+    // Items pushed after the ring frees up a slot still queue behind the ones that spilled over.
+    int value;
+    ASSERT_TRUE(queue.tryPop(&value));
+    ASSERT_EQ(0, value);
+    queue.push(5);
+
+    for (int i = 1; i <= 5; ++i) {
+        ASSERT_TRUE(queue.peek(&value));
+        ASSERT_EQ(i, value);
+        ASSERT_TRUE(queue.tryPop(&value));
+        ASSERT_EQ(i, value);
+    }
+    ASSERT_FALSE(queue.tryPop(&value));
+    ASSERT_TRUE(queue.empty());
+    ASSERT_EQ(0U, queue.cost());
+}
+
+TEST(MultiProducerSingleConsumerRingBufferTest, SpilledOverItemsWaitForAnUnpublishedSlot) {
+    MultiProducerSingleConsumerRingBuffer<GatedItem> queue(2);
+
+    // The first producer claims slot 0 but does not publish its item until released.
+    AtomicWord<bool> storing{false};
+    AtomicWord<bool> release{false};
+    stdx::thread slowProducer([&] { queue.push(GatedItem(0, &storing, &release)); });
+    while (!storing.load()) {
+        stdx::this_thread::yield();
+    }
+
+    // The second producer takes the last slot, then spills over.
+    queue.push(GatedItem(1));
+    queue.push(GatedItem(2));
+    ASSERT_EQ(3U, queue.count());
+
+    // Item 2 must not overtake item 1, which is queued behind the unpublished slot.
+    GatedItem item;
+    ASSERT_FALSE(queue.tryPop(&item));
+    ASSERT_FALSE(queue.peek(&item));
+    ASSERT_FALSE(queue.waitForData(Milliseconds(10)));
+
+    release.store(true);
+    slowProducer.join();
+    for (int i = 0; i < 3; ++i) {
+        ASSERT_TRUE(queue.peek(&item));
+        ASSERT_EQ(i, item.value);
+        ASSERT_TRUE(queue.tryPop(&item));
+        ASSERT_EQ(i, item.value);
+    }
+    ASSERT_TRUE(queue.empty());
+}
+
+TEST(MultiProducerSingleConsumerRingBufferTest, PushOnAFullRingDoesNotWaitForTheConsumer) {
+    MultiProducerSingleConsumerRingBuffer<int> queue(2);
+    queue.push(0);
+    queue.push(1);
+
+    // The producer pushes under a mutex that the consumer must take before it pops anything, as
+    // the oplog fetcher does with the BackgroundSync mutex. Waiting for a free slot in push would
+    // deadlock.
+    stdx::mutex producerMutex;
+    AtomicWord<bool> producerHoldsMutex{false};
+    stdx::thread producer([&] {
+        stdx::lock_guard<stdx::mutex> lk(producerMutex);
+        producerHoldsMutex.store(true);
+        queue.push(2);
+    });
+    while (!producerHoldsMutex.load()) {
+        stdx::this_thread::yield();
+    }
+
+    {
+        stdx::lock_guard<stdx::mutex> lk(producerMutex);
+        int value;
+        for (int i = 0; i < 3; ++i) {
+            ASSERT_TRUE(queue.tryPop(&value));
+            ASSERT_EQ(i, value);
+        }
+    }
+    producer.join();
+}
+
+TEST(MultiProducerSingleConsumerRingBufferTest, WaitForSpaceWaitsForAFreeSlot) {
+    MultiProducerSingleConsumerRingBuffer<int> queue(2);
+    queue.push(0);
+    queue.push(1);
+
+    AtomicWord<bool> hasSpace{false};
+    stdx::thread producer([&] {
+        queue.waitForSpace(1);
+        hasSpace.store(true);
+    });
+
+    stdx::this_thread::sleep_for(Milliseconds(10).toSystemDuration());
+    ASSERT_FALSE(hasSpace.load());
+    int value;
+    ASSERT_TRUE(queue.tryPop(&value));
+    producer.join();
+    ASSERT_TRUE(hasSpace.load());
+}
+
+TEST(MultiProducerSingleConsumerRingBufferTest, WaitForDataTimesOutWhenEmpty) {
+    MultiProducerSingleConsumerRingBuffer<int> queue(2);
+    ASSERT_FALSE(queue.waitForData(Milliseconds(10)));
+}
+
+TEST(MultiProducerSingleConsumerRingBufferTest, ClearWakesUpWaitingConsumer) {
+    MultiProducerSingleConsumerRingBuffer<int> queue(2);
+    AtomicWord<bool> hasData{true};
+    AtomicWord<bool> woken{false};
+    stdx::thread consumer([&] {
+        hasData.store(queue.waitForData(Seconds(600)));
+        woken.store(true);
+    });
+
+    // Keep clearing since the consumer may not be waiting yet.
+    while (!woken.load()) {
+        queue.clear();
+        stdx::this_thread::sleep_for(Milliseconds(1).toSystemDuration());
+    }
+    consumer.join();
+    ASSERT_FALSE(hasData.load());
+}
+
+TEST(MultiProducerSingleConsumerRingBufferTest, MultipleProducersKeepTheirOwnOrder) {
+    const int kProducers = 4;
+    const int kItemsPerProducer = 10000;
+    MultiProducerSingleConsumerRingBuffer<std::pair<int, int>> queue(64);
+
+    std::vector<stdx::thread> producers;
+    for (int p = 0; p < kProducers; ++p) {
+        producers.emplace_back([&queue, p] {
+            for (int i = 0; i < kItemsPerProducer; ++i) {
+                queue.push({p, i});
+            }
+        });
+    }
+
+    std::vector<int> next(kProducers, 0);
+    std::pair<int, int> item;
+    for (int popped = 0; popped < kProducers * kItemsPerProducer; ++popped) {
+        while (!queue.tryPop(&item)) {
+            queue.waitForData(Milliseconds(100));
+        }
+        ASSERT_EQ(next[item.first]++, item.second);
+    }
+    for (auto&& producer : producers) {
+        producer.join();
+    }
+    ASSERT_TRUE(queue.empty());
+}
+
+}  // namespace
+}  // namespace mongo